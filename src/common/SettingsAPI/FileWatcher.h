@@ -1,26 +1,20 @@
 #pragma once
 
-#define WIN32_LEAN_AND_MEAN
-#define NOMINMAX
-#include <Windows.h>
+#include "FileWatcherService.h"
 
-#include <thread>
-#include <optional>
 #include <string>
 #include <functional>
 
+// Invokes the callback whenever the content of the file at the given path changes.
+// Notifications for all FileWatcher instances are served by the shared FileWatcherService thread.
 class FileWatcher
 {
-    DWORD m_refreshPeriod;
-    std::wstring m_path;
-    std::optional<FILETIME> m_lastWrite;
-    std::function<void()> m_callback;
-    HANDLE m_abortEvent;
-    std::thread m_thread;
-    
-    std::optional<FILETIME> MyFileTime();
-    void Run();
+    FileWatcherService::WatchId m_watchId;
+
 public:
-    FileWatcher(const std::wstring& path, std::function<void()> callback, DWORD refreshPeriod = 1000);
+    FileWatcher(const std::wstring& path, std::function<void()> callback, DWORD debouncePeriod = 100);
     ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
 };
@@ -0,0 +1,438 @@
+#include "pch.h"
+#include "FileWatcherService.h"
+
+#include <algorithm>
+#include <set>
+#include <string_view>
+
+namespace
+{
+    // Large enough to hold a burst of notifications for a settings folder.
+    const DWORD NotificationBufferSize = 16 * 1024;
+
+    // How often directories that couldn't be opened (e.g. not created yet) are retried.
+    const DWORD MissingDirectoryRetryPeriod = 1000;
+
+    std::wstring ToLower(std::wstring str)
+    {
+        if (!str.empty())
+        {
+            CharLowerBuffW(str.data(), static_cast<DWORD>(str.size()));
+        }
+
+        return str;
+    }
+}
+
+FileWatcherService& FileWatcherService::instance()
+{
+    static FileWatcherService instance;
+    return instance;
+}
+
+FileWatcherService::FileWatcherService()
+{
+    m_wakeEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+}
+
+FileWatcherService::~FileWatcherService()
+{
+    {
+        std::unique_lock lock{ m_mutex };
+        m_abort = true;
+    }
+
+    if (m_wakeEvent)
+    {
+        SetEvent(m_wakeEvent);
+    }
+
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+
+    if (m_wakeEvent)
+    {
+        CloseHandle(m_wakeEvent);
+    }
+}
+
+FileWatcherService::WatchId FileWatcherService::Watch(const std::wstring& path, std::function<void()> callback, DWORD debouncePeriod)
+{
+    std::filesystem::path fsPath{ path };
+
+    WatchedFile file{
+        .path = path,
+        .directory = ToLower(fsPath.parent_path().wstring()),
+        .fileName = ToLower(fsPath.filename().wstring()),
+        .callback = std::move(callback),
+        .debouncePeriod = debouncePeriod,
+        .contentHash = ReadContentHash(path)
+    };
+
+    std::unique_lock lock{ m_mutex };
+    const auto id = m_nextId++;
+    m_files.emplace(id, std::move(file));
+
+    if (!m_threadRunning && m_wakeEvent)
+    {
+        // The previous thread (if any) has observed an empty watch list and is about to exit.
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+
+        m_threadRunning = true;
+        m_startedThreads++;
+        m_thread = std::thread([this]() { Run(); });
+    }
+
+    SetEvent(m_wakeEvent);
+
+    // Wait until the worker has issued the first read for the directory, otherwise a write made right after
+    // this returns wouldn't be reported. A callback adding a watch can't wait for its own thread.
+    if (m_thread.get_id() != std::this_thread::get_id())
+    {
+        m_directoriesSynced.wait(lock, [this, id]() { return m_syncedUpTo >= id || m_abort || !m_threadRunning; });
+    }
+
+    return id;
+}
+
+void FileWatcherService::Unwatch(WatchId id)
+{
+    std::unique_lock lock{ m_mutex };
+    m_files.erase(id);
+
+    if (m_thread.get_id() != std::this_thread::get_id())
+    {
+        m_callbackDone.wait(lock, [this, id]() { return m_runningCallback != id; });
+    }
+
+    if (m_wakeEvent)
+    {
+        SetEvent(m_wakeEvent);
+    }
+}
+
+size_t FileWatcherService::RunningThreadCount() const
+{
+    std::unique_lock lock{ m_mutex };
+    return m_runningThreads;
+}
+
+size_t FileWatcherService::StartedThreadCount() const
+{
+    std::unique_lock lock{ m_mutex };
+    return m_startedThreads;
+}
+
+void FileWatcherService::Run()
+{
+    {
+        std::unique_lock lock{ m_mutex };
+        m_runningThreads++;
+    }
+
+    while (true)
+    {
+        std::vector<HANDLE> handles{ m_wakeEvent };
+        std::vector<WatchedDirectory*> directories{ nullptr };
+        DWORD timeout;
+
+        {
+            std::unique_lock lock{ m_mutex };
+            if (m_abort || m_files.empty())
+            {
+                // Counted here rather than on exit, since Watch joins an exiting thread while holding the mutex.
+                m_threadRunning = false;
+                m_runningThreads--;
+                m_directoriesSynced.notify_all();
+                break;
+            }
+
+            SyncDirectories();
+            m_syncedUpTo = m_nextId - 1;
+            m_directoriesSynced.notify_all();
+            timeout = NextTimeout();
+        }
+
+        for (auto& [directoryPath, directory] : m_directories)
+        {
+            if (handles.size() == MAXIMUM_WAIT_OBJECTS)
+            {
+                break;
+            }
+
+            handles.push_back(directory->event);
+            directories.push_back(directory.get());
+        }
+
+        auto result = WaitForMultipleObjects(static_cast<DWORD>(handles.size()), handles.data(), FALSE, timeout);
+        if (result > WAIT_OBJECT_0 && result < WAIT_OBJECT_0 + handles.size())
+        {
+            auto directory = directories[result - WAIT_OBJECT_0];
+            for (auto& [directoryPath, watchedDirectory] : m_directories)
+            {
+                if (watchedDirectory.get() == directory)
+                {
+                    OnDirectoryChanged(directoryPath, *directory);
+                    break;
+                }
+            }
+        }
+
+        InvokeDueCallbacks();
+    }
+
+    for (auto& [directoryPath, directory] : m_directories)
+    {
+        CloseDirectory(*directory);
+    }
+
+    m_directories.clear();
+}
+
+void FileWatcherService::SyncDirectories()
+{
+    std::set<std::wstring> required;
+    for (const auto& [id, file] : m_files)
+    {
+        required.insert(file.directory);
+    }
+
+    for (auto it = m_directories.begin(); it != m_directories.end();)
+    {
+        if (!required.contains(it->first))
+        {
+            CloseDirectory(*it->second);
+            it = m_directories.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    for (const auto& directoryPath : required)
+    {
+        if (m_directories.contains(directoryPath))
+        {
+            continue;
+        }
+
+        auto directory = std::make_unique<WatchedDirectory>();
+        directory->handle = CreateFileW(directoryPath.c_str(),
+                                        FILE_LIST_DIRECTORY,
+                                        FILE_SHARE_DELETE | FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                        nullptr,
+                                        OPEN_EXISTING,
+                                        FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+                                        nullptr);
+        if (directory->handle == INVALID_HANDLE_VALUE)
+        {
+            continue;
+        }
+
+        directory->event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        directory->buffer.resize(NotificationBufferSize / sizeof(DWORD));
+        if (!directory->event || !IssueRead(*directory))
+        {
+            CloseDirectory(*directory);
+            continue;
+        }
+
+        m_directories.emplace(directoryPath, std::move(directory));
+    }
+}
+
+bool FileWatcherService::IssueRead(WatchedDirectory& directory)
+{
+    directory.overlapped = {};
+    directory.overlapped.hEvent = directory.event;
+    directory.pending = ReadDirectoryChangesW(directory.handle,
+                                              directory.buffer.data(),
+                                              static_cast<DWORD>(directory.buffer.size() * sizeof(DWORD)),
+                                              FALSE,
+                                              FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE,
+                                              nullptr,
+                                              &directory.overlapped,
+                                              nullptr);
+    return directory.pending;
+}
+
+void FileWatcherService::OnDirectoryChanged(const std::wstring& directoryPath, WatchedDirectory& directory)
+{
+    DWORD bytes = 0;
+    const bool completed = GetOverlappedResult(directory.handle, &directory.overlapped, &bytes, FALSE);
+    directory.pending = false;
+
+    std::vector<std::wstring> changedFiles;
+    bool overflow = !completed || bytes == 0;
+    if (!overflow)
+    {
+        auto data = reinterpret_cast<const BYTE*>(directory.buffer.data());
+        while (true)
+        {
+            auto info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(data);
+            changedFiles.push_back(ToLower(std::wstring(info->FileName, info->FileNameLength / sizeof(wchar_t))));
+
+            if (info->NextEntryOffset == 0)
+            {
+                break;
+            }
+
+            data += info->NextEntryOffset;
+        }
+    }
+
+    {
+        std::unique_lock lock{ m_mutex };
+        const auto now = GetTickCount64();
+        for (auto& [id, file] : m_files)
+        {
+            if (file.directory != directoryPath)
+            {
+                continue;
+            }
+
+            // When the notification buffer overflows we don't know which files changed; check all of them.
+            if (overflow || std::find(changedFiles.begin(), changedFiles.end(), file.fileName) != changedFiles.end())
+            {
+                file.deadline = now + file.debouncePeriod;
+            }
+        }
+    }
+
+    if (!IssueRead(directory))
+    {
+        // Directory was removed or became inaccessible, it will be reopened on the next sync.
+        CloseDirectory(directory);
+        m_directories.erase(directoryPath);
+    }
+}
+
+void FileWatcherService::InvokeDueCallbacks()
+{
+    while (true)
+    {
+        WatchId id = 0;
+        std::wstring path;
+
+        {
+            std::unique_lock lock{ m_mutex };
+            const auto now = GetTickCount64();
+            for (auto& [fileId, file] : m_files)
+            {
+                if (file.deadline.has_value() && *file.deadline <= now)
+                {
+                    file.deadline.reset();
+                    id = fileId;
+                    path = file.path;
+                    break;
+                }
+            }
+        }
+
+        if (id == 0)
+        {
+            return;
+        }
+
+        auto hash = ReadContentHash(path);
+
+        std::function<void()> callback;
+        {
+            std::unique_lock lock{ m_mutex };
+            auto it = m_files.find(id);
+            if (it == m_files.end() || !hash.has_value() || it->second.contentHash == hash)
+            {
+                continue;
+            }
+
+            it->second.contentHash = hash;
+            callback = it->second.callback;
+            m_runningCallback = id;
+        }
+
+        callback();
+
+        {
+            std::unique_lock lock{ m_mutex };
+            m_runningCallback = 0;
+        }
+
+        m_callbackDone.notify_all();
+    }
+}
+
+DWORD FileWatcherService::NextTimeout() const
+{
+    ULONGLONG timeout = INFINITE;
+    const auto now = GetTickCount64();
+    for (const auto& [id, file] : m_files)
+    {
+        if (file.deadline.has_value())
+        {
+            timeout = std::min<ULONGLONG>(timeout, *file.deadline > now ? *file.deadline - now : 0);
+        }
+
+        if (!m_directories.contains(file.directory))
+        {
+            timeout = std::min<ULONGLONG>(timeout, MissingDirectoryRetryPeriod);
+        }
+    }
+
+    return static_cast<DWORD>(timeout);
+}
+
+void FileWatcherService::CloseDirectory(WatchedDirectory& directory)
+{
+    if (directory.handle != INVALID_HANDLE_VALUE)
+    {
+        if (directory.pending)
+        {
+            // The pending read references our buffer, wait for the cancellation to complete before releasing it.
+            DWORD bytes = 0;
+            CancelIoEx(directory.handle, &directory.overlapped);
+            GetOverlappedResult(directory.handle, &directory.overlapped, &bytes, TRUE);
+            directory.pending = false;
+        }
+
+        CloseHandle(directory.handle);
+        directory.handle = INVALID_HANDLE_VALUE;
+    }
+
+    if (directory.event)
+    {
+        CloseHandle(directory.event);
+        directory.event = nullptr;
+    }
+}
+
+std::optional<size_t> FileWatcherService::ReadContentHash(const std::wstring& path)
+{
+    // Writers may still hold the file open; share everything and treat failures as "no content yet".
+    HANDLE hFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_DELETE | FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+    {
+        return std::nullopt;
+    }
+
+    std::optional<size_t> result;
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(hFile, &size) && size.HighPart == 0)
+    {
+        std::string content(size.LowPart, '\0');
+        DWORD read = 0;
+        if (content.empty() || ReadFile(hFile, content.data(), size.LowPart, &read, nullptr))
+        {
+            content.resize(read);
+            result = std::hash<std::string_view>{}(content);
+        }
+    }
+
+    CloseHandle(hFile);
+    return result;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Watches files for changes using directory change notifications. All watched paths share a single
+// background thread. Change notifications are debounced per file, and the callback is only invoked
+// when the file content actually differs from the last observed content.
+class FileWatcherService
+{
+public:
+    using WatchId = uint64_t;
+
+    static FileWatcherService& instance();
+
+    FileWatcherService();
+    ~FileWatcherService();
+
+    FileWatcherService(const FileWatcherService&) = delete;
+    FileWatcherService& operator=(const FileWatcherService&) = delete;
+
+    // Returns once the directory of the file is watched, so that writes made afterwards are reported.
+    WatchId Watch(const std::wstring& path, std::function<void()> callback, DWORD debouncePeriod);
+
+    // Once this returns, the callback of the given watch is not running and won't be invoked again.
+    void Unwatch(WatchId id);
+
+    // Number of watcher threads currently running, counted by the threads themselves.
+    size_t RunningThreadCount() const;
+
+    // Number of watcher threads started since the service was created.
+    size_t StartedThreadCount() const;
+
+private:
+    struct WatchedFile
+    {
+        std::wstring path;
+        std::wstring directory;
+        std::wstring fileName;
+        std::function<void()> callback;
+        DWORD debouncePeriod;
+        std::optional<size_t> contentHash;
+        std::optional<ULONGLONG> deadline;
+    };
+
+    struct WatchedDirectory
+    {
+        HANDLE handle = INVALID_HANDLE_VALUE;
+        HANDLE event = nullptr;
+        OVERLAPPED overlapped{};
+        std::vector<DWORD> buffer;
+        bool pending = false;
+    };
+
+    void Run();
+    void SyncDirectories();
+    bool IssueRead(WatchedDirectory& directory);
+    void OnDirectoryChanged(const std::wstring& directoryPath, WatchedDirectory& directory);
+    void InvokeDueCallbacks();
+    DWORD NextTimeout() const;
+    void CloseDirectory(WatchedDirectory& directory);
+
+    static std::optional<size_t> ReadContentHash(const std::wstring& path);
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_callbackDone;
+    std::condition_variable m_directoriesSynced;
+    std::map<WatchId, WatchedFile> m_files;
+    std::map<std::wstring, std::unique_ptr<WatchedDirectory>> m_directories;
+    WatchId m_nextId = 1;
+    WatchId m_runningCallback = 0;
+    WatchId m_syncedUpTo = 0;
+    size_t m_runningThreads = 0;
+    size_t m_startedThreads = 0;
+    HANDLE m_wakeEvent = nullptr;
+    bool m_abort = false;
+    bool m_threadRunning = false;
+    std::thread m_thread;
+};
@@ -0,0 +1,170 @@
+#include "pch.h"
+#include <common/SettingsAPI/FileWatcher.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestsCommonLib
+{
+    namespace
+    {
+        const DWORD DebouncePeriod = 50;
+        const auto CallbackTimeout = std::chrono::seconds(5);
+
+        void WriteFile(const std::filesystem::path& path, const std::string& content)
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file << content;
+        }
+
+        template<typename Predicate>
+        bool WaitFor(Predicate predicate, std::chrono::milliseconds timeout)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            while (!predicate())
+            {
+                if (std::chrono::steady_clock::now() - start > timeout)
+                {
+                    return false;
+                }
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+
+            return true;
+        }
+    }
+
+    TEST_CLASS (FileWatcherUnitTests)
+    {
+        std::filesystem::path m_directory;
+
+        TEST_METHOD_INITIALIZE(Init)
+        {
+            m_directory = std::filesystem::temp_directory_path() / L"PowerToysFileWatcherTests";
+            std::filesystem::create_directories(m_directory);
+        }
+
+        TEST_METHOD_CLEANUP(Cleanup)
+        {
+            std::error_code err;
+            std::filesystem::remove_all(m_directory, err);
+        }
+
+        TEST_METHOD (CallbackInvokedOnContentChange)
+        {
+            const auto path = m_directory / L"settings.json";
+            WriteFile(path, "{}");
+
+            std::atomic<int> calls = 0;
+            FileWatcher watcher(path.wstring(), [&calls]() { ++calls; }, DebouncePeriod);
+
+            const auto start = std::chrono::steady_clock::now();
+            WriteFile(path, "{\"a\": 1}");
+            Assert::IsTrue(WaitFor([&calls]() { return calls > 0; }, CallbackTimeout));
+
+            const auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+            Logger::WriteMessage((L"File change latency: " + std::to_wstring(latency.count()) + L" ms\n").c_str());
+
+            // Latency is bounded by the debounce period instead of the old 1 s polling interval.
+            Assert::IsTrue(latency < std::chrono::milliseconds(500));
+        }
+
+        TEST_METHOD (CallbackNotInvokedForSameContent)
+        {
+            const auto path = m_directory / L"settings.json";
+            WriteFile(path, "{}");
+
+            std::atomic<int> calls = 0;
+            FileWatcher watcher(path.wstring(), [&calls]() { ++calls; }, DebouncePeriod);
+
+            WriteFile(path, "{}");
+            Assert::IsFalse(WaitFor([&calls]() { return calls > 0; }, std::chrono::milliseconds(500)));
+        }
+
+        TEST_METHOD (BurstOfWritesIsDebounced)
+        {
+            const auto path = m_directory / L"settings.json";
+            WriteFile(path, "{}");
+
+            std::atomic<int> calls = 0;
+            FileWatcher watcher(path.wstring(), [&calls]() { ++calls; }, DebouncePeriod);
+
+            for (int i = 0; i < 10; ++i)
+            {
+                WriteFile(path, "{\"a\": " + std::to_string(i) + "}");
+            }
+
+            Assert::IsTrue(WaitFor([&calls]() { return calls > 0; }, CallbackTimeout));
+            std::this_thread::sleep_for(std::chrono::milliseconds(DebouncePeriod * 4));
+            Assert::AreEqual(1, calls.load());
+        }
+
+        TEST_METHOD (OtherFilesInDirectoryIgnored)
+        {
+            const auto path = m_directory / L"settings.json";
+            WriteFile(path, "{}");
+
+            std::atomic<int> calls = 0;
+            FileWatcher watcher(path.wstring(), [&calls]() { ++calls; }, DebouncePeriod);
+
+            WriteFile(m_directory / L"other.json", "{\"a\": 1}");
+            Assert::IsFalse(WaitFor([&calls]() { return calls > 0; }, std::chrono::milliseconds(500)));
+        }
+
+        TEST_METHOD (SingleThreadForAllWatchers)
+        {
+            auto& service = FileWatcherService::instance();
+            Assert::IsTrue(WaitFor([&service]() { return service.RunningThreadCount() == 0; }, CallbackTimeout));
+            const auto startedBefore = service.StartedThreadCount();
+
+            std::vector<std::unique_ptr<FileWatcher>> watchers;
+            for (int i = 0; i < 8; ++i)
+            {
+                const auto path = m_directory / (L"settings" + std::to_wstring(i) + L".json");
+                WriteFile(path, "{}");
+                watchers.push_back(std::make_unique<FileWatcher>(path.wstring(), []() {}, DebouncePeriod));
+            }
+
+            // Watch returns once the worker has armed the directory, so the thread is already running here.
+            Assert::AreEqual(startedBefore + 1, service.StartedThreadCount());
+            Assert::AreEqual(static_cast<size_t>(1), service.RunningThreadCount());
+
+            watchers.clear();
+            Assert::IsTrue(WaitFor([&service]() { return service.RunningThreadCount() == 0; }, CallbackTimeout));
+        }
+
+        TEST_METHOD (WriteRightAfterWatchIsReported)
+        {
+            // Repeated, since a write racing the first ReadDirectoryChangesW would only be lost now and then.
+            for (int i = 0; i < 20; ++i)
+            {
+                const auto path = m_directory / (L"settings" + std::to_wstring(i) + L".json");
+                WriteFile(path, "{}");
+
+                std::atomic<int> calls = 0;
+                FileWatcher watcher(path.wstring(), [&calls]() { ++calls; }, DebouncePeriod);
+                WriteFile(path, "{\"a\": 1}");
+                Assert::IsTrue(WaitFor([&calls]() { return calls > 0; }, CallbackTimeout));
+            }
+        }
+
+        TEST_METHOD (NoCallbackAfterDestruction)
+        {
+            const auto path = m_directory / L"settings.json";
+            WriteFile(path, "{}");
+
+            std::atomic<int> calls = 0;
+            {
+                FileWatcher watcher(path.wstring(), [&calls]() { ++calls; }, DebouncePeriod);
+            }
+
+            WriteFile(path, "{\"a\": 1}");
+            Assert::IsFalse(WaitFor([&calls]() { return calls > 0; }, std::chrono::milliseconds(500)));
+        }
+    };
+}
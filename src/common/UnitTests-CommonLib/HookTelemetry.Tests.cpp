@@ -0,0 +1,108 @@
+#include "pch.h"
+#include <common/hooks/HookTelemetry.h>
+
+#include <memory>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestsCommonLib
+{
+    namespace
+    {
+        LONGLONG MicrosecondsToTicks(LONGLONG us)
+        {
+            LARGE_INTEGER frequency;
+            QueryPerformanceFrequency(&frequency);
+            return us * frequency.QuadPart / 1000000;
+        }
+    }
+
+    TEST_CLASS (HookTelemetryUnitTests)
+    {
+        TEST_METHOD (AggregateReportsPercentilesOfRecordedEvents)
+        {
+            HookTelemetry::Recorder recorder(L"", nullptr, false);
+
+            // 1..1000 us, every tenth event suppressed
+            for (LONGLONG i = 1; i <= 1000; i++)
+            {
+                recorder.Record(MicrosecondsToTicks(i), i % 2 ? WM_KEYDOWN : WM_KEYUP, 0x41, i % 10 == 0 ? HookTelemetry::Decision::Suppressed : HookTelemetry::Decision::PassThrough);
+            }
+
+            const auto stats = recorder.Aggregate();
+            Assert::AreEqual<uint64_t>(1000, stats.eventCount);
+            Assert::AreEqual<uint64_t>(100, stats.suppressedEventCount);
+            Assert::AreEqual<uint64_t>(500, stats.keyDownEventCount);
+            Assert::AreEqual<uint64_t>(0, stats.droppedRecordCount);
+            Assert::AreEqual(501.0, stats.p50Us, 1.0);
+            Assert::AreEqual(991.0, stats.p99Us, 1.0);
+            Assert::AreEqual(1000.0, stats.maxUs, 1.0);
+
+            // The next aggregation only contains the new events
+            recorder.Record(MicrosecondsToTicks(5), WM_KEYDOWN, 0x41, HookTelemetry::Decision::PassThrough);
+            const auto nextStats = recorder.Aggregate();
+            Assert::AreEqual<uint64_t>(1, nextStats.eventCount);
+            Assert::AreEqual(5.0, nextStats.maxUs, 1.0);
+        }
+
+        TEST_METHOD (AggregateCountsSlowAndTimeoutRiskEvents)
+        {
+            HookTelemetry::Recorder recorder(L"", nullptr, false);
+            recorder.Record(MicrosecondsToTicks(10), WM_KEYDOWN, 0x41, HookTelemetry::Decision::PassThrough);
+
+            const auto timeoutUs = static_cast<LONGLONG>(recorder.Aggregate().hookTimeoutMs) * 1000;
+            recorder.Record(MicrosecondsToTicks(10), WM_KEYDOWN, 0x41, HookTelemetry::Decision::PassThrough);
+            recorder.Record(MicrosecondsToTicks(timeoutUs / 10), WM_KEYDOWN, 0x41, HookTelemetry::Decision::PassThrough);
+            recorder.Record(MicrosecondsToTicks(timeoutUs * 3 / 4), WM_KEYDOWN, 0x41, HookTelemetry::Decision::PassThrough);
+
+            const auto stats = recorder.Aggregate();
+            Assert::AreEqual<uint64_t>(2, stats.slowEventCount);
+            Assert::AreEqual<uint64_t>(1, stats.timeoutRiskEventCount);
+        }
+
+        TEST_METHOD (AggregateDropsOverwrittenRecords)
+        {
+            HookTelemetry::Recorder recorder(L"", nullptr, false);
+            const size_t extraRecords = 100;
+            for (size_t i = 0; i < HookTelemetry::Recorder::Capacity + extraRecords; i++)
+            {
+                recorder.Record(MicrosecondsToTicks(1), WM_KEYDOWN, 0x41, HookTelemetry::Decision::PassThrough);
+            }
+
+            const auto stats = recorder.Aggregate();
+            Assert::AreEqual<uint64_t>(HookTelemetry::Recorder::Capacity, stats.eventCount);
+            Assert::AreEqual<uint64_t>(extraRecords, stats.droppedRecordCount);
+        }
+
+        TEST_METHOD (AggregatePublishesSharedStatsBlock)
+        {
+            const std::wstring name = L"Local\\PowerToysHookTelemetryTest-" + std::to_wstring(GetCurrentProcessId());
+            uint64_t callbackEventCount = 0;
+            HookTelemetry::Recorder recorder(name, [&callbackEventCount](const HookTelemetry::IntervalStats& stats) { callbackEventCount = stats.eventCount; }, false);
+
+            for (LONGLONG i = 1; i <= 10; i++)
+            {
+                recorder.Record(MicrosecondsToTicks(i * 100), WM_KEYDOWN, 0x41, HookTelemetry::Decision::PassThrough);
+            }
+
+            recorder.Aggregate();
+            Assert::AreEqual<uint64_t>(10, callbackEventCount);
+
+            HANDLE mapping = OpenFileMappingW(FILE_MAP_READ, false, name.c_str());
+            Assert::IsNotNull(mapping);
+            auto block = static_cast<const HookTelemetry::SharedStatsBlock*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, sizeof(HookTelemetry::SharedStatsBlock)));
+            Assert::IsNotNull(block);
+
+            Assert::AreEqual(HookTelemetry::SharedStatsBlock::CurrentVersion, block->version);
+            Assert::AreEqual<uint32_t>(sizeof(HookTelemetry::SharedStatsBlock), block->size);
+            Assert::AreEqual<uint32_t>(0, block->sequence.load() % 2);
+            Assert::AreEqual<uint64_t>(10, block->totalEventCount);
+            Assert::AreEqual<uint64_t>(10, block->intervalEventCount);
+            Assert::IsTrue(block->intervalMaxNs >= 999000 && block->intervalMaxNs <= 1001000);
+            Assert::AreNotEqual<uint64_t>(0, block->lastUpdateTime);
+
+            UnmapViewOfFile(block);
+            CloseHandle(mapping);
+        }
+    };
+}
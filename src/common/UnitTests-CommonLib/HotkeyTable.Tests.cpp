@@ -0,0 +1,256 @@
+#include "pch.h"
+#include <common/hooks/HotkeyTable.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestsCommonLib
+{
+    namespace
+    {
+        // Counts the live instances so that the tests can check when the snapshot frees a table
+        struct CountedTable
+        {
+            static inline int liveCount = 0;
+            int id = 0;
+
+            CountedTable() { liveCount++; }
+            explicit CountedTable(int id) :
+                id(id) { liveCount++; }
+            ~CountedTable() { liveCount--; }
+        };
+
+        // 200 hotkeys on letters, digits and function keys with all the modifier combinations which contain Win, Ctrl or Alt
+        std::vector<std::pair<uint8_t, uint8_t>> CreateHotkeys(size_t count)
+        {
+            std::vector<uint8_t> keys;
+            for (uint8_t key = 'A'; key <= 'Z'; key++)
+            {
+                keys.push_back(key);
+            }
+
+            for (uint8_t key = VK_F1; key <= VK_F12; key++)
+            {
+                keys.push_back(key);
+            }
+
+            std::vector<std::pair<uint8_t, uint8_t>> hotkeys;
+            for (uint8_t mask = 1; mask < LowlevelHotkeys::ModifierMaskCount && hotkeys.size() < count; mask++)
+            {
+                if (mask == LowlevelHotkeys::Shift)
+                {
+                    continue;
+                }
+
+                for (size_t i = 0; i < keys.size() && hotkeys.size() < count; i++)
+                {
+                    hotkeys.emplace_back(mask, keys[i]);
+                }
+            }
+
+            return hotkeys;
+        }
+
+        void LogLatencies(const wchar_t* name, std::vector<double>& latencies)
+        {
+            std::sort(latencies.begin(), latencies.end());
+            std::wstring message = std::wstring(name) +
+                                   L": p50 " + std::to_wstring(latencies[latencies.size() / 2]) +
+                                   L" ns, p99 " + std::to_wstring(latencies[latencies.size() * 99 / 100]) +
+                                   L" ns, max " + std::to_wstring(latencies.back()) + L" ns\n";
+            Logger::WriteMessage(message.c_str());
+        }
+    }
+
+    TEST_CLASS (HotkeyTableUnitTests)
+    {
+        TEST_METHOD (FindReturnsActionOfHotkey)
+        {
+            LowlevelHotkeys::Table<int> table;
+            Assert::IsTrue(table.Add(LowlevelHotkeys::Win | LowlevelHotkeys::Shift, 'S', 1));
+            Assert::IsTrue(table.Add(LowlevelHotkeys::Win, 'S', 2));
+
+            Assert::IsTrue(table.HasKey('S'));
+            Assert::IsFalse(table.HasKey('T'));
+            Assert::AreEqual(1, *table.Find(LowlevelHotkeys::Win | LowlevelHotkeys::Shift, 'S'));
+            Assert::AreEqual(2, *table.Find(LowlevelHotkeys::Win, 'S'));
+            Assert::IsNull(table.Find(LowlevelHotkeys::Ctrl, 'S'));
+            Assert::IsNull(table.Find(0, 'S'));
+        }
+
+        TEST_METHOD (AddKeepsFirstActionOfDuplicateHotkey)
+        {
+            LowlevelHotkeys::Table<int> table;
+            Assert::IsTrue(table.Add(LowlevelHotkeys::Ctrl, 'A', 1));
+            Assert::IsFalse(table.Add(LowlevelHotkeys::Ctrl, 'A', 2));
+
+            Assert::AreEqual<size_t>(1, table.Size());
+            Assert::AreEqual(1, *table.Find(LowlevelHotkeys::Ctrl, 'A'));
+        }
+
+        TEST_METHOD (ModifierTrackerTracksLeftAndRightKeys)
+        {
+            LowlevelHotkeys::ModifierTracker tracker;
+            Assert::AreEqual<uint8_t>(0, tracker.Mask());
+
+            tracker.Update(VK_LCONTROL, WM_KEYDOWN);
+            tracker.Update(VK_RCONTROL, WM_KEYDOWN);
+            tracker.Update(VK_LMENU, WM_SYSKEYDOWN);
+            Assert::AreEqual<uint8_t>(LowlevelHotkeys::Ctrl | LowlevelHotkeys::Alt, tracker.Mask());
+
+            // Releasing one of the two Ctrl keys keeps the modifier pressed
+            tracker.Update(VK_LCONTROL, WM_KEYUP);
+            Assert::AreEqual<uint8_t>(LowlevelHotkeys::Ctrl | LowlevelHotkeys::Alt, tracker.Mask());
+
+            tracker.Update(VK_RCONTROL, WM_KEYUP);
+            tracker.Update(VK_LMENU, WM_SYSKEYUP);
+            Assert::AreEqual<uint8_t>(0, tracker.Mask());
+
+            // Generic key codes of injected events and non modifier keys
+            tracker.Update(VK_SHIFT, WM_KEYDOWN);
+            tracker.Update(VK_RWIN, WM_KEYDOWN);
+            tracker.Update('A', WM_KEYDOWN);
+            Assert::AreEqual<uint8_t>(LowlevelHotkeys::Shift | LowlevelHotkeys::Win, tracker.Mask());
+            tracker.Update(VK_SHIFT, WM_KEYUP);
+            Assert::AreEqual<uint8_t>(LowlevelHotkeys::Win, tracker.Mask());
+        }
+
+        TEST_METHOD (SnapshotAdoptsPublishedTableAndFreesReplacedOne)
+        {
+            {
+                LowlevelHotkeys::Snapshot<CountedTable> snapshot;
+                Assert::AreEqual(0, snapshot.Adopt().id);
+
+                snapshot.Publish(std::make_unique<CountedTable>(1));
+                Assert::AreEqual(2, CountedTable::liveCount);
+
+                // A table which was never adopted is freed when it is replaced
+                snapshot.Publish(std::make_unique<CountedTable>(2));
+                Assert::AreEqual(2, CountedTable::liveCount);
+
+                // The replaced table is kept until the next publish
+                Assert::AreEqual(2, snapshot.Adopt().id);
+                Assert::AreEqual(2, CountedTable::liveCount);
+                Assert::AreEqual(2, snapshot.Adopt().id);
+
+                snapshot.Publish(std::make_unique<CountedTable>(3));
+                Assert::AreEqual(2, CountedTable::liveCount);
+                Assert::AreEqual(3, snapshot.Adopt().id);
+            }
+
+            Assert::AreEqual(0, CountedTable::liveCount);
+        }
+
+        // Compare the hook lookup with 200 hotkeys against the previous mutex + multiset + std::function copy lookup
+        TEST_METHOD (HookLookupLatencyWith200Hotkeys)
+        {
+            const auto hotkeys = CreateHotkeys(200);
+            Assert::AreEqual<size_t>(200, hotkeys.size());
+
+            LowlevelHotkeys::Snapshot<LowlevelHotkeys::Table<std::shared_ptr<const std::function<bool()>>>> snapshot;
+            auto table = std::make_unique<LowlevelHotkeys::Table<std::shared_ptr<const std::function<bool()>>>>();
+
+            struct Descriptor
+            {
+                uint16_t hotkey;
+                std::function<bool()> action;
+                bool operator<(const Descriptor& other) const { return hotkey < other.hotkey; }
+            };
+            std::multiset<Descriptor> descriptors;
+            std::mutex mutex;
+
+            int invokedCount = 0;
+            for (const auto& [mask, key] : hotkeys)
+            {
+                auto action = [&invokedCount] {
+                    invokedCount++;
+                    return true;
+                };
+                table->Add(mask, key, std::make_shared<const std::function<bool()>>(action));
+                descriptors.insert({ static_cast<uint16_t>((mask << 8) | key), action });
+            }
+
+            snapshot.Publish(std::move(table));
+
+            // Typing with an occasional Ctrl hotkey: Ctrl down, letter, Ctrl up, then plain letters
+            std::vector<std::pair<DWORD, WPARAM>> events;
+            for (int i = 0; i < 1000; i++)
+            {
+                if (i % 10 == 0)
+                {
+                    events.emplace_back(VK_LCONTROL, WM_KEYDOWN);
+                    events.emplace_back('A' + i % 26, WM_KEYDOWN);
+                    events.emplace_back('A' + i % 26, WM_KEYUP);
+                    events.emplace_back(VK_LCONTROL, WM_KEYUP);
+                }
+                else
+                {
+                    events.emplace_back('A' + i % 26, WM_KEYDOWN);
+                    events.emplace_back('A' + i % 26, WM_KEYUP);
+                }
+            }
+
+            const int iterations = 200;
+            std::vector<double> tableLatencies;
+            std::vector<double> multisetLatencies;
+            LowlevelHotkeys::ModifierTracker tracker;
+            uint8_t multisetMask = 0;
+            for (int iteration = 0; iteration < iterations; iteration++)
+            {
+                for (const auto& [vkCode, message] : events)
+                {
+                    const bool keyDown = message == WM_KEYDOWN;
+
+                    auto start = std::chrono::high_resolution_clock::now();
+                    const auto& current = snapshot.Adopt();
+                    if (keyDown && current.HasKey(static_cast<uint8_t>(vkCode)))
+                    {
+                        if (const auto* entry = current.Find(tracker.Mask(), static_cast<uint8_t>(vkCode)))
+                        {
+                            const auto action = *entry;
+                            (*action)();
+                        }
+                    }
+                    tracker.Update(vkCode, message);
+                    auto end = std::chrono::high_resolution_clock::now();
+                    tableLatencies.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+
+                    // The previous hook queried the key state here, which is simulated by the tracked mask
+                    start = std::chrono::high_resolution_clock::now();
+                    if (keyDown)
+                    {
+                        std::function<bool()> action;
+                        {
+                            std::unique_lock lock{ mutex };
+                            auto it = descriptors.find({ static_cast<uint16_t>((multisetMask << 8) | vkCode) });
+                            if (it != descriptors.end())
+                            {
+                                action = it->action;
+                            }
+                        }
+
+                        if (action)
+                        {
+                            action();
+                        }
+                    }
+                    multisetMask = vkCode == VK_LCONTROL ? (keyDown ? LowlevelHotkeys::Ctrl : 0) : multisetMask;
+                    end = std::chrono::high_resolution_clock::now();
+                    multisetLatencies.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+                }
+            }
+
+            // Every tenth letter is pressed with Ctrl, once for each lookup
+            Assert::AreEqual(iterations * 100 * 2, invokedCount);
+            LogLatencies(L"Hotkey table lookup", tableLatencies);
+            LogLatencies(L"Mutex and multiset lookup", multisetLatencies);
+        }
+    };
+}
@@ -0,0 +1,152 @@
+#include "pch.h"
+#include <common/utils/json.h>
+#include <common/utils/profiler.h>
+
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestsCommonLib
+{
+    namespace
+    {
+        // The spans of the other tests are in the same process wide registry, so the tests only look at the spans with their own names
+        std::vector<Profiler::Span> CollectSpans(const char* name)
+        {
+            std::vector<Profiler::Span> result;
+            for (const auto& span : Profiler::collect_spans())
+            {
+                if (span.name == name)
+                {
+                    result.push_back(span);
+                }
+            }
+
+            return result;
+        }
+    }
+
+    TEST_CLASS (ProfilerUnitTests)
+    {
+        TEST_METHOD (ScopeRecordsNestedSpans)
+        {
+            static const char* outer = "ScopeRecordsNestedSpans.Outer";
+            static const char* inner = "ScopeRecordsNestedSpans.Inner";
+            Assert::IsTrue(Profiler::RegisterCurrentThread());
+            {
+                POWERTOYS_PROFILE_SCOPE(outer);
+                {
+                    POWERTOYS_PROFILE_SCOPE(inner);
+                    Sleep(1);
+                }
+            }
+
+            const auto outerSpans = CollectSpans(outer);
+            const auto innerSpans = CollectSpans(inner);
+            Assert::AreEqual<size_t>(1, outerSpans.size());
+            Assert::AreEqual<size_t>(1, innerSpans.size());
+            Assert::AreEqual<uint32_t>(GetCurrentThreadId(), outerSpans[0].thread_id);
+            Assert::IsTrue(innerSpans[0].duration_ns >= 1000000);
+            Assert::IsTrue(innerSpans[0].start_ns >= outerSpans[0].start_ns);
+            Assert::IsTrue(innerSpans[0].start_ns + innerSpans[0].duration_ns <= outerSpans[0].start_ns + outerSpans[0].duration_ns);
+        }
+
+        TEST_METHOD (BufferKeepsTheLastSpansOfExitedThreads)
+        {
+            static const char* name = "BufferKeepsTheLastSpansOfExitedThreads";
+            DWORD threadId = 0;
+            std::thread([&threadId] {
+                threadId = GetCurrentThreadId();
+                Profiler::RegisterCurrentThread();
+                for (size_t i = 0; i < Profiler::SpansPerThread + 100; i++)
+                {
+                    POWERTOYS_PROFILE_SCOPE(name);
+                }
+            }).join();
+
+            const auto spans = CollectSpans(name);
+            Assert::AreEqual(Profiler::SpansPerThread, spans.size());
+            for (const auto& span : spans)
+            {
+                Assert::AreEqual<uint32_t>(threadId, span.thread_id);
+            }
+        }
+
+        TEST_METHOD (UnregisteredThreadDoesntRecord)
+        {
+            static const char* name = "UnregisteredThreadDoesntRecord";
+            std::thread([] {
+                POWERTOYS_PROFILE_SCOPE(name);
+            }).join();
+
+            Assert::AreEqual<size_t>(0, CollectSpans(name).size());
+        }
+
+        TEST_METHOD (DisabledProfilerDoesntRecord)
+        {
+            static const char* name = "DisabledProfilerDoesntRecord";
+            Profiler::RegisterCurrentThread();
+            Profiler::set_enabled(false);
+            {
+                POWERTOYS_PROFILE_SCOPE(name);
+            }
+
+            Profiler::set_enabled(true);
+            Assert::AreEqual<size_t>(0, CollectSpans(name).size());
+        }
+
+        TEST_METHOD (ChromeTraceHasCompleteEventsInMicroseconds)
+        {
+            const std::vector<Profiler::Span> spans = {
+                { "Drag \"window\"", 12, 1234567, 89 },
+                { "Hook", 13, 2000000, 1500 },
+            };
+
+            const auto trace = Profiler::format_chrome_trace(spans, "FancyZones", 42);
+            const auto json = json::JsonObject::Parse(winrt::to_hstring(trace));
+            const auto events = json.GetNamedArray(L"traceEvents");
+            Assert::AreEqual<uint32_t>(3, events.Size());
+
+            const auto metadata = events.GetObjectAt(0);
+            Assert::AreEqual(std::wstring(L"M"), std::wstring(metadata.GetNamedString(L"ph")));
+            Assert::AreEqual(std::wstring(L"FancyZones"), std::wstring(metadata.GetNamedObject(L"args").GetNamedString(L"name")));
+
+            const auto drag = events.GetObjectAt(1);
+            Assert::AreEqual(std::wstring(L"Drag \"window\""), std::wstring(drag.GetNamedString(L"name")));
+            Assert::AreEqual(std::wstring(L"X"), std::wstring(drag.GetNamedString(L"ph")));
+            Assert::AreEqual(1234.567, drag.GetNamedNumber(L"ts"), 0.0001);
+            Assert::AreEqual(0.089, drag.GetNamedNumber(L"dur"), 0.0001);
+            Assert::AreEqual(42.0, drag.GetNamedNumber(L"pid"));
+            Assert::AreEqual(12.0, drag.GetNamedNumber(L"tid"));
+
+            const auto hook = events.GetObjectAt(2);
+            Assert::AreEqual(2000.0, hook.GetNamedNumber(L"ts"), 0.0001);
+            Assert::AreEqual(1.5, hook.GetNamedNumber(L"dur"), 0.0001);
+        }
+
+        TEST_METHOD (CollectWhileRecordingOnlyReturnsCompleteSpans)
+        {
+            static const char* name = "CollectWhileRecordingOnlyReturnsCompleteSpans";
+            std::atomic_bool stop = false;
+            std::thread recorder([&stop] {
+                Profiler::RegisterCurrentThread();
+                while (!stop)
+                {
+                    POWERTOYS_PROFILE_SCOPE(name);
+                }
+            });
+
+            for (int i = 0; i < 20; i++)
+            {
+                for (const auto& span : Profiler::collect_spans())
+                {
+                    Assert::IsNotNull(span.name);
+                    Assert::IsTrue(span.duration_ns >= 0);
+                }
+            }
+
+            stop = true;
+            recorder.join();
+        }
+    };
+}
@@ -0,0 +1,331 @@
+#pragma once
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Records the processing time of low level hook events. Windows silently removes a low level hook which doesn't return within LowLevelHooksTimeout,
+// so the hook thread only writes a packed record into a lock-free ring buffer and a background thread aggregates the records periodically.
+namespace HookTelemetry
+{
+    // Decision made by the hook for an event
+    enum class Decision : uint8_t
+    {
+        PassThrough,
+        Suppressed
+    };
+
+    // Statistics of the events recorded since the previous aggregation
+    struct IntervalStats
+    {
+        uint64_t eventCount = 0;
+        uint64_t suppressedEventCount = 0;
+        uint64_t keyDownEventCount = 0;
+        double p50Us = 0;
+        double p99Us = 0;
+        double maxUs = 0;
+
+        // Events slower than SlowEventTimeoutFraction and TimeoutRiskFraction of the hook timeout
+        uint64_t slowEventCount = 0;
+        uint64_t timeoutRiskEventCount = 0;
+
+        // Records which were overwritten before they could be aggregated
+        uint64_t droppedRecordCount = 0;
+        uint32_t hookTimeoutMs = 0;
+    };
+
+    // Layout of the shared memory block with the statistics of a hook, so that they can be read by diagnostic tools.
+    // The block is written with a sequence lock: sequence is odd while the block is updated, readers retry if it is odd or has changed after reading
+    struct SharedStatsBlock
+    {
+        static constexpr uint32_t CurrentVersion = 1;
+
+        uint32_t version;
+        uint32_t size;
+        std::atomic<uint32_t> sequence;
+        uint32_t hookTimeoutMs;
+
+        // Totals since the hook was started
+        uint64_t totalEventCount;
+        uint64_t totalSuppressedEventCount;
+        uint64_t totalSlowEventCount;
+        uint64_t totalTimeoutRiskEventCount;
+        uint64_t totalDroppedRecordCount;
+        uint64_t totalMaxNs;
+
+        // Statistics of the last aggregation interval
+        uint64_t intervalEventCount;
+        uint64_t intervalP50Ns;
+        uint64_t intervalP99Ns;
+        uint64_t intervalMaxNs;
+
+        // FILETIME of the last update
+        uint64_t lastUpdateTime;
+    };
+
+    class Recorder
+    {
+    public:
+        // Number of records kept between two aggregations. Must be a power of two
+        static constexpr size_t Capacity = 8192;
+
+        // Interval between two aggregations on the background thread
+        static constexpr DWORD AggregationIntervalMs = 30000;
+
+        // Fractions of LowLevelHooksTimeout above which an event is counted as slow and at risk of the hook being removed
+        static constexpr double SlowEventTimeoutFraction = 0.05;
+        static constexpr double TimeoutRiskFraction = 0.5;
+
+        // Creates the shared memory block with the given name (no block if it is empty) and starts the aggregation thread if aggregateInBackground is set.
+        // onAggregated is called on the aggregation thread for each interval with events, typically to log the statistics
+        Recorder(const std::wstring& sharedMemoryName, std::function<void(const IntervalStats&)> onAggregated, bool aggregateInBackground = true) :
+            onAggregated(std::move(onAggregated))
+        {
+            LARGE_INTEGER frequency;
+            QueryPerformanceFrequency(&frequency);
+            nsPerTick = 1000000000.0 / frequency.QuadPart;
+            hookTimeoutMs = ReadHookTimeoutMs();
+            copiedRecords.reserve(Capacity);
+            durations.reserve(Capacity);
+
+            if (!sharedMemoryName.empty())
+            {
+                CreateSharedStatsBlock(sharedMemoryName);
+            }
+
+            if (aggregateInBackground)
+            {
+                exitEvent = CreateEvent(nullptr, false, false, nullptr);
+                aggregationThread = std::thread([this]() {
+                    while (WaitForSingleObject(exitEvent, AggregationIntervalMs) == WAIT_TIMEOUT)
+                    {
+                        Aggregate();
+                    }
+                });
+            }
+        }
+
+        Recorder(const Recorder&) = delete;
+        Recorder& operator=(const Recorder&) = delete;
+
+        ~Recorder()
+        {
+            if (aggregationThread.joinable())
+            {
+                SetEvent(exitEvent);
+                aggregationThread.join();
+            }
+
+            if (exitEvent)
+            {
+                CloseHandle(exitEvent);
+            }
+
+            if (sharedStats)
+            {
+                UnmapViewOfFile(sharedStats);
+            }
+
+            if (sharedMemoryHandle)
+            {
+                CloseHandle(sharedMemoryHandle);
+            }
+        }
+
+        // Function to record an event. Must only be called from the hook thread. The cost is two stores, so it can stay enabled in production
+        void Record(LONGLONG durationTicks, WPARAM message, DWORD vkCode, Decision decision) noexcept
+        {
+            const uint64_t duration = static_cast<uint64_t>(std::clamp<LONGLONG>(durationTicks, 0, DurationMask));
+            const uint64_t messageType = (message == WM_KEYUP || message == WM_SYSKEYUP) ? KeyUpBit : 0;
+            const uint64_t record = duration | (static_cast<uint64_t>(vkCode & 0xFF) << VkCodeShift) | messageType | (decision == Decision::Suppressed ? SuppressedBit : 0);
+
+            const uint64_t index = writeIndex.load(std::memory_order_relaxed);
+            records[index & (Capacity - 1)].store(record, std::memory_order_relaxed);
+            writeIndex.store(index + 1, std::memory_order_release);
+        }
+
+        // Function to aggregate the records since the previous call, publish them to the shared memory block and call onAggregated. Called on the aggregation thread, or directly if it isn't started
+        IntervalStats Aggregate()
+        {
+            std::unique_lock lock{ aggregationMutex };
+
+            IntervalStats stats;
+            stats.hookTimeoutMs = hookTimeoutMs;
+
+            const uint64_t end = writeIndex.load(std::memory_order_acquire);
+            uint64_t begin = readIndex;
+            if (end - begin > Capacity)
+            {
+                stats.droppedRecordCount += end - begin - Capacity;
+                begin = end - Capacity;
+            }
+
+            copiedRecords.clear();
+            for (uint64_t index = begin; index < end; index++)
+            {
+                copiedRecords.push_back(records[index & (Capacity - 1)].load(std::memory_order_relaxed));
+            }
+
+            // Records which the hook thread may have overwritten while they were copied are discarded
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint64_t writeIndexAfterCopy = writeIndex.load(std::memory_order_relaxed);
+            if (writeIndexAfterCopy - begin >= Capacity)
+            {
+                const uint64_t overwritten = std::min<uint64_t>(writeIndexAfterCopy - begin - Capacity + 1, copiedRecords.size());
+                copiedRecords.erase(copiedRecords.begin(), copiedRecords.begin() + overwritten);
+                stats.droppedRecordCount += overwritten;
+            }
+
+            readIndex = end;
+
+            const uint64_t slowThresholdTicks = static_cast<uint64_t>(hookTimeoutMs * 1000000.0 * SlowEventTimeoutFraction / nsPerTick);
+            const uint64_t timeoutRiskThresholdTicks = static_cast<uint64_t>(hookTimeoutMs * 1000000.0 * TimeoutRiskFraction / nsPerTick);
+            durations.clear();
+            for (const uint64_t record : copiedRecords)
+            {
+                const uint64_t duration = record & DurationMask;
+                durations.push_back(duration);
+                stats.suppressedEventCount += (record & SuppressedBit) ? 1 : 0;
+                stats.keyDownEventCount += (record & KeyUpBit) ? 0 : 1;
+                stats.slowEventCount += duration > slowThresholdTicks ? 1 : 0;
+                stats.timeoutRiskEventCount += duration > timeoutRiskThresholdTicks ? 1 : 0;
+            }
+
+            stats.eventCount = durations.size();
+            if (!durations.empty())
+            {
+                std::sort(durations.begin(), durations.end());
+                stats.p50Us = durations[durations.size() / 2] * nsPerTick / 1000.0;
+                stats.p99Us = durations[durations.size() * 99 / 100] * nsPerTick / 1000.0;
+                stats.maxUs = durations.back() * nsPerTick / 1000.0;
+            }
+
+            PublishSharedStats(stats);
+
+            if (onAggregated && (stats.eventCount > 0 || stats.droppedRecordCount > 0))
+            {
+                onAggregated(stats);
+            }
+
+            return stats;
+        }
+
+    private:
+        // Record layout: duration in performance counter ticks in the low 40 bits, then the virtual key code, the key up bit and the suppressed bit
+        static constexpr LONGLONG DurationMask = (1LL << 40) - 1;
+        static constexpr int VkCodeShift = 40;
+        static constexpr uint64_t KeyUpBit = 1ULL << 48;
+        static constexpr uint64_t SuppressedBit = 1ULL << 49;
+
+        // Default and maximum value of LowLevelHooksTimeout since Windows 7
+        static constexpr uint32_t DefaultHookTimeoutMs = 1000;
+
+        std::array<std::atomic<uint64_t>, Capacity> records{};
+        std::atomic<uint64_t> writeIndex = 0;
+
+        // Aggregation state, only used under aggregationMutex
+        std::mutex aggregationMutex;
+        uint64_t readIndex = 0;
+        std::vector<uint64_t> copiedRecords;
+        std::vector<uint64_t> durations;
+
+        double nsPerTick = 1;
+        uint32_t hookTimeoutMs = DefaultHookTimeoutMs;
+        std::function<void(const IntervalStats&)> onAggregated;
+
+        HANDLE exitEvent = nullptr;
+        std::thread aggregationThread;
+
+        HANDLE sharedMemoryHandle = nullptr;
+        SharedStatsBlock* sharedStats = nullptr;
+
+        static uint32_t ReadHookTimeoutMs()
+        {
+            DWORD timeout = 0;
+            DWORD size = sizeof(timeout);
+            if (RegGetValueW(HKEY_CURRENT_USER, L"Control Panel\\Desktop", L"LowLevelHooksTimeout", RRF_RT_REG_DWORD, nullptr, &timeout, &size) == ERROR_SUCCESS && timeout > 0)
+            {
+                return std::min<uint32_t>(timeout, DefaultHookTimeoutMs);
+            }
+
+            return DefaultHookTimeoutMs;
+        }
+
+        void CreateSharedStatsBlock(const std::wstring& name)
+        {
+            sharedMemoryHandle = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(SharedStatsBlock), name.c_str());
+            if (!sharedMemoryHandle)
+            {
+                return;
+            }
+
+            sharedStats = static_cast<SharedStatsBlock*>(MapViewOfFile(sharedMemoryHandle, FILE_MAP_WRITE, 0, 0, sizeof(SharedStatsBlock)));
+            if (!sharedStats)
+            {
+                CloseHandle(sharedMemoryHandle);
+                sharedMemoryHandle = nullptr;
+                return;
+            }
+
+            // The mapping is zero initialized, or left over from a previous run of the same process if a reader keeps it open
+            uint32_t sequence = sharedStats->sequence.load(std::memory_order_relaxed);
+            sequence += sequence & 1;
+            sharedStats->sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            sharedStats->version = SharedStatsBlock::CurrentVersion;
+            sharedStats->size = sizeof(SharedStatsBlock);
+            sharedStats->hookTimeoutMs = hookTimeoutMs;
+            sharedStats->totalEventCount = 0;
+            sharedStats->totalSuppressedEventCount = 0;
+            sharedStats->totalSlowEventCount = 0;
+            sharedStats->totalTimeoutRiskEventCount = 0;
+            sharedStats->totalDroppedRecordCount = 0;
+            sharedStats->totalMaxNs = 0;
+            sharedStats->intervalEventCount = 0;
+            sharedStats->intervalP50Ns = 0;
+            sharedStats->intervalP99Ns = 0;
+            sharedStats->intervalMaxNs = 0;
+            sharedStats->lastUpdateTime = 0;
+            sharedStats->sequence.store(sequence + 2, std::memory_order_release);
+        }
+
+        void PublishSharedStats(const IntervalStats& stats)
+        {
+            if (!sharedStats)
+            {
+                return;
+            }
+
+            FILETIME now;
+            GetSystemTimeAsFileTime(&now);
+            const uint64_t maxNs = static_cast<uint64_t>(stats.maxUs * 1000.0);
+
+            // Make the sequence odd while the block is written
+            const uint32_t sequence = sharedStats->sequence.load(std::memory_order_relaxed);
+            sharedStats->sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            sharedStats->totalEventCount += stats.eventCount;
+            sharedStats->totalSuppressedEventCount += stats.suppressedEventCount;
+            sharedStats->totalSlowEventCount += stats.slowEventCount;
+            sharedStats->totalTimeoutRiskEventCount += stats.timeoutRiskEventCount;
+            sharedStats->totalDroppedRecordCount += stats.droppedRecordCount;
+            sharedStats->totalMaxNs = std::max(sharedStats->totalMaxNs, maxNs);
+            sharedStats->intervalEventCount = stats.eventCount;
+            sharedStats->intervalP50Ns = static_cast<uint64_t>(stats.p50Us * 1000.0);
+            sharedStats->intervalP99Ns = static_cast<uint64_t>(stats.p99Us * 1000.0);
+            sharedStats->intervalMaxNs = maxNs;
+            sharedStats->lastUpdateTime = (static_cast<uint64_t>(now.dwHighDateTime) << 32) | now.dwLowDateTime;
+
+            sharedStats->sequence.store(sequence + 2, std::memory_order_release);
+        }
+    };
+}
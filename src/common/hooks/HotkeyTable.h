@@ -0,0 +1,220 @@
+#pragma once
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Building blocks for dispatching hotkeys from a low level keyboard hook without locks or allocations on the hook thread
+namespace LowlevelHotkeys
+{
+    // Bits of a modifier mask
+    enum ModifierMask : uint8_t
+    {
+        Win = 1,
+        Ctrl = 2,
+        Shift = 4,
+        Alt = 8
+    };
+
+    // Number of different modifier masks
+    constexpr size_t ModifierMaskCount = 16;
+
+    constexpr uint8_t MakeModifierMask(bool win, bool ctrl, bool shift, bool alt)
+    {
+        return static_cast<uint8_t>((win ? Win : 0) | (ctrl ? Ctrl : 0) | (shift ? Shift : 0) | (alt ? Alt : 0));
+    }
+
+    // Tracks the pressed modifier keys from the events seen by a low level keyboard hook, so that the hook doesn't have to query the key state on every event
+    class ModifierTracker
+    {
+    public:
+        // Function to update the tracked state with a hook event
+        void Update(DWORD vkCode, WPARAM message) noexcept
+        {
+            const uint8_t bit = KeyBit(vkCode);
+            if (bit == 0)
+            {
+                return;
+            }
+
+            if (message == WM_KEYUP || message == WM_SYSKEYUP)
+            {
+                pressedKeys &= ~bit;
+            }
+            else
+            {
+                pressedKeys |= bit;
+            }
+        }
+
+        // Function to get the modifier mask of the tracked keys
+        uint8_t Mask() const noexcept
+        {
+            return MakeModifierMask((pressedKeys & (LWinBit | RWinBit)) != 0, (pressedKeys & (LCtrlBit | RCtrlBit)) != 0, (pressedKeys & (LShiftBit | RShiftBit)) != 0, (pressedKeys & (LAltBit | RAltBit)) != 0);
+        }
+
+        // Function to replace the tracked state with the current keyboard state. Used when a key down or key up was missed, e.g. while the secure desktop was active or before the hook was installed
+        void Resync() noexcept
+        {
+            pressedKeys = 0;
+            const DWORD keys[] = { VK_LWIN, VK_RWIN, VK_LCONTROL, VK_RCONTROL, VK_LSHIFT, VK_RSHIFT, VK_LMENU, VK_RMENU };
+            for (const DWORD key : keys)
+            {
+                if (GetAsyncKeyState(key) & 0x8000)
+                {
+                    pressedKeys |= KeyBit(key);
+                }
+            }
+        }
+
+    private:
+        static constexpr uint8_t LWinBit = 1 << 0;
+        static constexpr uint8_t RWinBit = 1 << 1;
+        static constexpr uint8_t LCtrlBit = 1 << 2;
+        static constexpr uint8_t RCtrlBit = 1 << 3;
+        static constexpr uint8_t LShiftBit = 1 << 4;
+        static constexpr uint8_t RShiftBit = 1 << 5;
+        static constexpr uint8_t LAltBit = 1 << 6;
+        static constexpr uint8_t RAltBit = 1 << 7;
+
+        // Left and right keys are tracked separately so that releasing one of them doesn't clear the modifier. Injected events may use the generic key codes, which are treated as the left key
+        static constexpr uint8_t KeyBit(DWORD vkCode) noexcept
+        {
+            switch (vkCode)
+            {
+            case VK_LWIN:
+                return LWinBit;
+            case VK_RWIN:
+                return RWinBit;
+            case VK_CONTROL:
+            case VK_LCONTROL:
+                return LCtrlBit;
+            case VK_RCONTROL:
+                return RCtrlBit;
+            case VK_SHIFT:
+            case VK_LSHIFT:
+                return LShiftBit;
+            case VK_RSHIFT:
+                return RShiftBit;
+            case VK_MENU:
+            case VK_LMENU:
+                return LAltBit;
+            case VK_RMENU:
+                return RAltBit;
+            default:
+                return 0;
+            }
+        }
+
+        uint8_t pressedKeys = 0;
+    };
+
+    // Immutable lookup table from (modifier mask, virtual key code) to an action. It is filled before it is published to the hook and only read afterwards
+    template<typename Action>
+    class Table
+    {
+    public:
+        // Function to add a hotkey. If the hotkey is already in the table, the action added first is kept. Returns false in that case
+        bool Add(uint8_t modifierMask, uint8_t vkCode, Action action)
+        {
+            uint16_t& slot = slots[SlotIndex(modifierMask, vkCode)];
+            if (slot != 0)
+            {
+                return false;
+            }
+
+            actions.push_back(std::move(action));
+            slot = static_cast<uint16_t>(actions.size());
+            masksByKey[vkCode] |= static_cast<uint16_t>(1 << (modifierMask & 0xF));
+            return true;
+        }
+
+        // Function to check if any hotkey uses the key. This is the only lookup done for most key events
+        bool HasKey(uint8_t vkCode) const noexcept
+        {
+            return masksByKey[vkCode] != 0;
+        }
+
+        // Function to get the action of a hotkey, or nullptr if it isn't in the table
+        const Action* Find(uint8_t modifierMask, uint8_t vkCode) const noexcept
+        {
+            const uint16_t slot = slots[SlotIndex(modifierMask, vkCode)];
+            return slot != 0 ? &actions[slot - 1] : nullptr;
+        }
+
+        size_t Size() const noexcept
+        {
+            return actions.size();
+        }
+
+    private:
+        static constexpr size_t SlotIndex(uint8_t modifierMask, uint8_t vkCode) noexcept
+        {
+            return (static_cast<size_t>(modifierMask & 0xF) << 8) | vkCode;
+        }
+
+        // Bit per modifier mask for each key
+        std::array<uint16_t, 256> masksByKey{};
+
+        // Index + 1 of the action of each (modifier mask, key), 0 if there is none
+        std::array<uint16_t, ModifierMaskCount * 256> slots{};
+        std::vector<Action> actions;
+    };
+
+    // Hands over tables built on other threads to the hook thread. The hook adopts the last published table with a single atomic exchange before an event,
+    // and the replaced table is freed by the next Publish call, so neither allocation nor deallocation happens on the hook thread
+    template<typename T>
+    class Snapshot
+    {
+    public:
+        Snapshot() :
+            current(std::make_unique<T>())
+        {
+        }
+
+        ~Snapshot()
+        {
+            delete published.exchange(nullptr);
+            delete retired.exchange(nullptr);
+        }
+
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+
+        // Function to publish a new table. Can be called from any thread, but calls must not be concurrent with each other
+        void Publish(std::unique_ptr<T> table)
+        {
+            delete retired.exchange(nullptr, std::memory_order_acq_rel);
+
+            // If the previously published table wasn't adopted yet, the hook never accessed it and it can be freed here
+            delete published.exchange(table.release(), std::memory_order_acq_rel);
+        }
+
+        // Function to adopt the published table if there is one and get the current table. Must only be called from the hook thread
+        const T& Adopt() noexcept
+        {
+            if (published.load(std::memory_order_relaxed) != nullptr)
+            {
+                if (T* table = published.exchange(nullptr, std::memory_order_acq_rel))
+                {
+                    // The replaced table is normally freed by the next Publish, unless the previously retired table wasn't reclaimed yet
+                    delete retired.exchange(current.release(), std::memory_order_acq_rel);
+                    current.reset(table);
+                }
+            }
+
+            return *current;
+        }
+
+    private:
+        // Only accessed from the hook thread
+        std::unique_ptr<T> current;
+
+        std::atomic<T*> published = nullptr;
+        std::atomic<T*> retired = nullptr;
+    };
+}
@@ -13,19 +13,21 @@ private:
     std::condition_variable message_ready;
     bool interrupted = false;
 
-    //Disable copy
-    AsyncMessageQueue(const AsyncMessageQueue&);
-    AsyncMessageQueue& operator=(const AsyncMessageQueue&);
-
 public:
     AsyncMessageQueue()
     {
     }
+
+    AsyncMessageQueue(const AsyncMessageQueue&) = delete;
+    AsyncMessageQueue& operator=(const AsyncMessageQueue&) = delete;
+
+    // The message is moved into the queue, and moved out of it by pop_message, so that large messages are never copied
     void queue_message(std::wstring message)
     {
-        this->queue_mutex.lock();
-        this->message_queue.push(message);
-        this->queue_mutex.unlock();
+        {
+            std::lock_guard<std::mutex> lock(this->queue_mutex);
+            this->message_queue.push(std::move(message));
+        }
         this->message_ready.notify_one();
     }
     std::wstring pop_message()
@@ -40,7 +42,7 @@ public:
             //Just returns a empty string if the queue was interrupted.
             return std::wstring(L"");
         }
-        std::wstring message = this->message_queue.front();
+        std::wstring message = std::move(this->message_queue.front());
         this->message_queue.pop();
         return message;
     }
@@ -0,0 +1,351 @@
+#include "framed_message_protocol.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace FramedMessageProtocol
+{
+    namespace
+    {
+        constexpr char32_t ReplacementCharacter = 0xFFFD;
+
+        void append_code_point(char32_t code_point, std::string& output)
+        {
+            if (code_point < 0x80)
+            {
+                output.push_back(static_cast<char>(code_point));
+            }
+            else if (code_point < 0x800)
+            {
+                output.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+                output.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+            }
+            else if (code_point < 0x10000)
+            {
+                output.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+                output.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+                output.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+            }
+            else
+            {
+                output.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+                output.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+                output.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+                output.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+            }
+        }
+
+        void append_wide(char32_t code_point, std::wstring& output)
+        {
+            if constexpr (sizeof(wchar_t) == 2)
+            {
+                if (code_point >= 0x10000)
+                {
+                    code_point -= 0x10000;
+                    output.push_back(static_cast<wchar_t>(0xD800 + (code_point >> 10)));
+                    output.push_back(static_cast<wchar_t>(0xDC00 + (code_point & 0x3FF)));
+                    return;
+                }
+            }
+
+            output.push_back(static_cast<wchar_t>(code_point));
+        }
+
+        bool is_surrogate(char32_t code_point)
+        {
+            return code_point >= 0xD800 && code_point <= 0xDFFF;
+        }
+    }
+
+    void append_utf8(std::wstring_view text, std::string& output)
+    {
+        for (size_t i = 0; i < text.size(); i++)
+        {
+            char32_t code_point = static_cast<char32_t>(text[i]);
+
+            // Fast path for ASCII, which is most of the settings JSON
+            if (code_point < 0x80)
+            {
+                output.push_back(static_cast<char>(code_point));
+                continue;
+            }
+
+            if constexpr (sizeof(wchar_t) == 2)
+            {
+                if (code_point >= 0xD800 && code_point <= 0xDBFF && i + 1 < text.size() && text[i + 1] >= 0xDC00 && text[i + 1] <= 0xDFFF)
+                {
+                    code_point = 0x10000 + ((code_point - 0xD800) << 10) + (static_cast<char32_t>(text[i + 1]) - 0xDC00);
+                    i++;
+                }
+            }
+
+            if (is_surrogate(code_point) || code_point > 0x10FFFF)
+            {
+                code_point = ReplacementCharacter;
+            }
+
+            append_code_point(code_point, output);
+        }
+    }
+
+    std::string to_utf8(std::wstring_view text)
+    {
+        std::string output;
+        output.reserve(text.size());
+        append_utf8(text, output);
+        return output;
+    }
+
+    std::wstring from_utf8(std::string_view text)
+    {
+        std::wstring output;
+        output.reserve(text.size());
+        size_t i = 0;
+        while (i < text.size())
+        {
+            const auto lead = static_cast<unsigned char>(text[i]);
+            if (lead < 0x80)
+            {
+                output.push_back(static_cast<wchar_t>(lead));
+                i++;
+                continue;
+            }
+
+            size_t length = 0;
+            char32_t code_point = 0;
+            char32_t minimum = 0;
+            if ((lead & 0xE0) == 0xC0)
+            {
+                length = 2;
+                code_point = lead & 0x1F;
+                minimum = 0x80;
+            }
+            else if ((lead & 0xF0) == 0xE0)
+            {
+                length = 3;
+                code_point = lead & 0x0F;
+                minimum = 0x800;
+            }
+            else if ((lead & 0xF8) == 0xF0)
+            {
+                length = 4;
+                code_point = lead & 0x07;
+                minimum = 0x10000;
+            }
+
+            size_t consumed = 1;
+            bool valid = length != 0 && i + length <= text.size();
+            for (; valid && consumed < length; consumed++)
+            {
+                const auto continuation = static_cast<unsigned char>(text[i + consumed]);
+                if ((continuation & 0xC0) != 0x80)
+                {
+                    valid = false;
+                    break;
+                }
+
+                code_point = (code_point << 6) | (continuation & 0x3F);
+            }
+
+            // Overlong encodings, surrogates and values above U+10FFFF are invalid
+            if (!valid || code_point < minimum || is_surrogate(code_point) || code_point > 0x10FFFF)
+            {
+                append_wide(ReplacementCharacter, output);
+                i += std::max<size_t>(consumed, 1);
+                continue;
+            }
+
+            append_wide(code_point, output);
+            i += length;
+        }
+
+        return output;
+    }
+
+    void encode_frame(std::wstring_view message, std::string& frame)
+    {
+        frame.clear();
+        frame.resize(FrameHeaderSize);
+        append_utf8(message, frame);
+
+        const auto payload_size = static_cast<uint32_t>(frame.size() - FrameHeaderSize);
+        for (size_t i = 0; i < FrameHeaderSize; i++)
+        {
+            frame[i] = static_cast<char>((payload_size >> (8 * i)) & 0xFF);
+        }
+    }
+
+    FrameReader::FrameReader(MessageConnection& connection) :
+        connection(connection), buffer(TransportBufferSize)
+    {
+    }
+
+    // Function to read until at least minimum_size bytes are buffered
+    bool FrameReader::fill(size_t minimum_size)
+    {
+        if (end - begin >= minimum_size)
+        {
+            return true;
+        }
+
+        // Move the partial frame to the start of the buffer
+        if (begin != 0)
+        {
+            std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+            end -= begin;
+            begin = 0;
+        }
+
+        while (end < minimum_size)
+        {
+            const size_t bytes_read = connection.read_some(buffer.data() + end, buffer.size() - end);
+            if (bytes_read == 0)
+            {
+                return false;
+            }
+
+            end += bytes_read;
+        }
+
+        return true;
+    }
+
+    bool FrameReader::read_frame(std::string& payload)
+    {
+        if (!fill(FrameHeaderSize))
+        {
+            return false;
+        }
+
+        uint32_t payload_size = 0;
+        for (size_t i = 0; i < FrameHeaderSize; i++)
+        {
+            payload_size |= static_cast<uint32_t>(static_cast<unsigned char>(buffer[begin + i])) << (8 * i);
+        }
+
+        if (payload_size > MaxPayloadSize)
+        {
+            return false;
+        }
+
+        begin += FrameHeaderSize;
+        if (payload_size <= buffer.size())
+        {
+            if (!fill(payload_size))
+            {
+                return false;
+            }
+
+            payload.assign(buffer.data() + begin, payload_size);
+            begin += payload_size;
+            return true;
+        }
+
+        // Large payloads are read directly into the output after the buffered part
+        const size_t buffered = end - begin;
+        payload.resize(payload_size);
+        std::memcpy(payload.data(), buffer.data() + begin, buffered);
+        begin = end = 0;
+
+        size_t received = buffered;
+        while (received < payload_size)
+        {
+            const size_t bytes_read = connection.read_some(payload.data() + received, payload_size - received);
+            if (bytes_read == 0)
+            {
+                return false;
+            }
+
+            received += bytes_read;
+        }
+
+        return true;
+    }
+
+    FramedMessageServer::FramedMessageServer(MessageTransport& transport, message_handler handler, size_t pool_size) :
+        transport(transport), handler(std::move(handler)), pool_size(pool_size)
+    {
+    }
+
+    FramedMessageServer::~FramedMessageServer()
+    {
+        stop();
+    }
+
+    void FramedMessageServer::start()
+    {
+        stopped = false;
+        for (size_t i = 0; i < pool_size; i++)
+        {
+            workers.emplace_back(&FramedMessageServer::serve_connections, this);
+        }
+    }
+
+    void FramedMessageServer::stop()
+    {
+        stopped = true;
+        transport.cancel();
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+
+        workers.clear();
+    }
+
+    void FramedMessageServer::serve_connections()
+    {
+        std::string payload;
+        while (!stopped)
+        {
+            auto connection = transport.accept();
+            if (!connection)
+            {
+                break;
+            }
+
+            FrameReader reader(*connection);
+            while (!stopped && reader.read_frame(payload))
+            {
+                handler(from_utf8(payload));
+            }
+        }
+    }
+
+    FramedMessageClient::FramedMessageClient(MessageTransport& transport) :
+        transport(transport)
+    {
+    }
+
+    bool FramedMessageClient::send(std::wstring_view message)
+    {
+        encode_frame(message, frame);
+
+        // A connection which was closed by the remote endpoint is only detected on write, in which case the frame is sent again on a new connection
+        for (int attempt = 0; attempt < 2; attempt++)
+        {
+            if (!connection)
+            {
+                connection = transport.connect();
+                if (!connection)
+                {
+                    return false;
+                }
+            }
+
+            if (connection->write_all(frame.data(), frame.size()))
+            {
+                return true;
+            }
+
+            connection.reset();
+        }
+
+        return false;
+    }
+
+    void FramedMessageClient::close()
+    {
+        connection.reset();
+    }
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Length prefixed framing for the messages exchanged by TwoWayPipeMessageIPC. Each frame is the payload length as a 4 byte little endian integer followed by the payload in UTF-8,
+// so that a connection can be kept open and reused for any number of messages. The protocol only depends on the standard library and the MessageTransport interface,
+// so it can be tested on other platforms with another transport (see unix_socket_transport.h)
+namespace FramedMessageProtocol
+{
+    constexpr size_t FrameHeaderSize = 4;
+
+    // Frames with a larger payload are treated as a corrupted stream and close the connection
+    constexpr uint32_t MaxPayloadSize = 64 * 1024 * 1024;
+
+    // Size of the buffers of the transports and of the frame reader. Settings JSON messages usually fit in a single read
+    constexpr uint32_t TransportBufferSize = 64 * 1024;
+
+    // Function to convert UTF-16 (UTF-32 where wchar_t is 4 bytes) text to UTF-8. Invalid code units are replaced by U+FFFD
+    void append_utf8(std::wstring_view text, std::string& output);
+    std::string to_utf8(std::wstring_view text);
+
+    // Function to convert UTF-8 text to a wide string. Invalid sequences are replaced by U+FFFD
+    std::wstring from_utf8(std::string_view text);
+
+    // Function to encode a message as a frame into the buffer, which is reused between messages to avoid allocations. The message is converted to UTF-8 directly after the header
+    void encode_frame(std::wstring_view message, std::string& frame);
+
+    // A connected stream between two endpoints
+    class MessageConnection
+    {
+    public:
+        virtual ~MessageConnection() = default;
+
+        // Function to read up to size bytes, blocking until at least one byte is available. Returns 0 if the connection was closed, cancelled or failed
+        virtual size_t read_some(char* buffer, size_t size) = 0;
+
+        // Function to write all the bytes. Returns false if the connection was closed or failed
+        virtual bool write_all(const char* data, size_t size) = 0;
+    };
+
+    // Creates the connections of one side of a two way channel: incoming connections on the local endpoint, and outgoing connections to the remote endpoint
+    class MessageTransport
+    {
+    public:
+        virtual ~MessageTransport() = default;
+
+        // Function to wait for a connection on the local endpoint. Returns nullptr once cancel was called, or if the endpoint can't be created
+        virtual std::unique_ptr<MessageConnection> accept() = 0;
+
+        // Function to connect to the remote endpoint. Returns nullptr if it isn't available
+        virtual std::unique_ptr<MessageConnection> connect() = 0;
+
+        // Function to make the pending and future accept calls return nullptr, and the reads of the accepted connections fail
+        virtual void cancel() = 0;
+    };
+
+    // Reads frames from a connection through a buffer, so that small frames don't take a read each. Payloads which don't fit in the buffer are read directly into the output string
+    class FrameReader
+    {
+    public:
+        explicit FrameReader(MessageConnection& connection);
+
+        // Function to read the next frame. Returns false if the connection was closed or the frame is invalid
+        bool read_frame(std::string& payload);
+
+    private:
+        bool fill(size_t minimum_size);
+
+        MessageConnection& connection;
+        std::vector<char> buffer;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+    // Accepts connections on a fixed pool of threads and reads the frames of each connection until it is closed, instead of starting a thread for each connection
+    class FramedMessageServer
+    {
+    public:
+        using message_handler = std::function<void(std::wstring&&)>;
+
+        FramedMessageServer(MessageTransport& transport, message_handler handler, size_t pool_size = 2);
+        ~FramedMessageServer();
+
+        FramedMessageServer(const FramedMessageServer&) = delete;
+        FramedMessageServer& operator=(const FramedMessageServer&) = delete;
+
+        void start();
+        void stop();
+
+    private:
+        void serve_connections();
+
+        MessageTransport& transport;
+        message_handler handler;
+        size_t pool_size;
+        std::vector<std::thread> workers;
+        std::atomic_bool stopped = false;
+    };
+
+    // Sends frames over a connection which is kept open for the next messages, and reconnects when the connection breaks
+    class FramedMessageClient
+    {
+    public:
+        explicit FramedMessageClient(MessageTransport& transport);
+
+        // Function to send a message. Returns false if the remote endpoint isn't available
+        bool send(std::wstring_view message);
+
+        void close();
+
+    private:
+        MessageTransport& transport;
+        std::unique_ptr<MessageConnection> connection;
+        std::string frame;
+    };
+}
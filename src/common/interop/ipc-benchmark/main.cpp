@@ -0,0 +1,134 @@
+// Checks and benchmarks the framed message protocol of TwoWayPipeMessageIPC over Unix domain sockets. See README.md
+#include "../async_message_queue.h"
+#include "../framed_message_protocol.h"
+#include "../unix_socket_transport.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+    int failures = 0;
+
+    void check(bool condition, const char* description)
+    {
+        if (!condition)
+        {
+            std::printf("FAILED: %s\n", description);
+            failures++;
+        }
+    }
+
+    // Function to make a settings-like JSON message of about the given size, with non ASCII characters so that the UTF-8 conversion is exercised
+    std::wstring make_message(size_t size, size_t index)
+    {
+        std::wstring message = L"{\"index\":" + std::to_wstring(index) + L",\"values\":[";
+        while (message.size() + 32 < size)
+        {
+            message += L"{\"name\":\"Grüße 日本 \U0001F600\",\"v\":1},";
+        }
+
+        message += L"0]}";
+        return message;
+    }
+
+    std::string socket_path(const char* name)
+    {
+        return "/tmp/ipc-benchmark-" + std::to_string(getpid()) + "-" + name;
+    }
+
+    void check_utf8_conversion()
+    {
+        const std::wstring text = L"ascii é ß 日本語 \U0001F600 \U0010FFFF";
+        check(FramedMessageProtocol::from_utf8(FramedMessageProtocol::to_utf8(text)) == text, "UTF-8 round trip");
+        check(FramedMessageProtocol::to_utf8(L"é") == "\xC3\xA9", "UTF-8 encoding of a two byte character");
+        check(FramedMessageProtocol::from_utf8("a\xC3(b") == L"a�(b", "invalid continuation byte is replaced");
+        check(FramedMessageProtocol::from_utf8("\xC0\xAF") == L"�", "overlong encoding is replaced");
+        check(FramedMessageProtocol::from_utf8("\xED\xA0\x80") == L"�", "encoded surrogate is replaced");
+        check(FramedMessageProtocol::from_utf8("\xE6\x97") == L"��", "truncated sequence is replaced");
+
+        std::string frame;
+        FramedMessageProtocol::encode_frame(L"été", frame);
+        check(frame.size() == FramedMessageProtocol::FrameHeaderSize + 5 && frame[0] == 5 && frame[1] == 0 && frame[2] == 0 && frame[3] == 0, "frame header is the little endian payload size");
+    }
+
+    // Function to send messages of the given size from one transport to another and check that they arrive complete and in order
+    void run(const char* name, size_t message_size, size_t message_count)
+    {
+        const std::string server_path = socket_path("server");
+        const std::string client_path = socket_path("client");
+        UnixSocketTransport server_transport(server_path, client_path);
+        UnixSocketTransport client_transport(client_path, server_path);
+
+        AsyncMessageQueue received;
+        FramedMessageProtocol::FramedMessageServer server(server_transport, [&received](std::wstring&& message) {
+            received.queue_message(std::move(message));
+        });
+        server.start();
+
+        std::vector<std::wstring> messages;
+        for (size_t i = 0; i < 16; i++)
+        {
+            messages.push_back(make_message(message_size, i));
+        }
+
+        FramedMessageProtocol::FramedMessageClient client(client_transport);
+
+        // Wait for the server to listen
+        while (!client.send(messages[0]))
+        {
+            usleep(1000);
+        }
+
+        check(received.pop_message() == messages[0], "first message");
+
+        size_t bytes = 0;
+        const auto start = std::chrono::steady_clock::now();
+        std::thread sender([&]() {
+            for (size_t i = 0; i < message_count; i++)
+            {
+                check(client.send(messages[i % messages.size()]), "send");
+            }
+        });
+
+        for (size_t i = 0; i < message_count; i++)
+        {
+            const std::wstring message = received.pop_message();
+            bytes += FramedMessageProtocol::to_utf8(message).size();
+            if (message != messages[i % messages.size()])
+            {
+                check(false, "message received complete and in order");
+                break;
+            }
+        }
+
+        sender.join();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("%-8s %8zu messages of %8zu bytes: %10.0f messages/s, %8.1f MB/s\n", name, message_count, bytes / message_count, message_count / seconds, bytes / seconds / (1024 * 1024));
+
+        // Stopping the server must interrupt the reads of the open connection
+        client.close();
+        server.stop();
+    }
+}
+
+int main()
+{
+    check_utf8_conversion();
+    run("small", 64, 200000);
+    run("settings", 4 * 1024, 50000);
+    run("large", 256 * 1024, 1000);
+    run("huge", 8 * 1024 * 1024, 20);
+
+    if (failures != 0)
+    {
+        std::printf("%d checks failed\n", failures);
+        return 1;
+    }
+
+    return 0;
+}
@@ -11,8 +11,11 @@ public:
     ~LayoutMap();
     void UpdateLayout();
     std::wstring GetKeyName(DWORD key);
-    std::vector<DWORD> GetKeyCodeList(const bool isShortcut = false);
-    std::vector<std::pair<DWORD, std::wstring>> GetKeyNameList(const bool isShortcut = false);
+
+    // The lists are built once per keyboard layout and shared by all the instances. The returned references stay valid for the lifetime of the process.
+    // If withDisable is true, the name list starts with the Disable key
+    const std::vector<DWORD>& GetKeyCodeList(const bool isShortcut = false);
+    const std::vector<std::pair<DWORD, std::wstring>>& GetKeyNameList(const bool isShortcut = false, const bool withDisable = false);
 
 private:
     class LayoutMapImpl;
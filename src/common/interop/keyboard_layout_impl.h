@@ -1,34 +1,44 @@
 #pragma once
 #include "keyboard_layout.h"
+#include <array>
 #include <string>
-#include <map>
 #include <mutex>
 
+// Key names and drop down lists of a keyboard layout. They are built once for each layout and shared by all the LayoutMap instances, since building them takes a ToUnicodeEx call for every key
+struct LayoutTables
+{
+    // Key codes up to VK_WIN_BOTH have a name
+    static constexpr DWORD KeyNameCount = 0x105;
+
+    // Stores the name of each virtual key code
+    std::array<std::wstring, KeyNameCount> keyNames;
+
+    // Stores the keys which have a unicode representation and the keys which do not have a name, in increasing order. Keys which were renamed with a special name are not included
+    std::vector<DWORD> unicodeKeys;
+    std::vector<DWORD> unknownKeys;
+
+    // Stores the lists of key name pairs for the drop down menus, in the order of the key code lists
+    std::vector<std::pair<DWORD, std::wstring>> keyNameList;
+    std::vector<std::pair<DWORD, std::wstring>> shortcutKeyNameList;
+
+    // Same lists with the Disable key at the start, for the drop downs of the remap targets
+    std::vector<std::pair<DWORD, std::wstring>> keyNameListWithDisable;
+    std::vector<std::pair<DWORD, std::wstring>> shortcutKeyNameListWithDisable;
+};
+
 // Wrapper class to handle keyboard layout
 class LayoutMap::LayoutMapImpl
 {
 private:
-    // Stores mappings for all the virtual key codes to the name of the key
     std::mutex keyboardLayoutMap_mutex;
 
     // Stores the previous layout
     HKL previousLayout = 0;
 
-    // Stores the keys which have a unicode representation
-    std::map<DWORD, std::wstring> unicodeKeys;
-
-    // Stores the keys which do not have a name
-    std::map<DWORD, std::wstring> unknownKeys;
-
-    // Stores true if the fixed ordering key code list has already been set
-    bool isKeyCodeListGenerated = false;
-
-    // Stores a fixed order key code list for the drop down menus. It is kept fixed to change in ordering due to languages
-    std::vector<DWORD> keyCodeList;
+    // Stores the tables of the previous layout
+    const LayoutTables* tables = nullptr;
 
 public:
-    std::map<DWORD, std::wstring> keyboardLayoutMap;
-
     // Update Keyboard layout according to input locale identifier
     void UpdateLayout();
 
@@ -40,9 +50,9 @@ public:
     // Function to return the unicode string name of the key
     std::wstring GetKeyName(DWORD key);
 
-    // Function to return the list of key codes in the order for the drop down. It creates it if it doesn't exist
-    std::vector<DWORD> GetKeyCodeList(const bool isShortcut);
+    // Function to return the list of key codes in the order for the drop down
+    const std::vector<DWORD>& GetKeyCodeList(const bool isShortcut);
 
     // Function to return the list of key name pairs in the order for the drop down based on the key codes
-    std::vector<std::pair<DWORD, std::wstring>> GetKeyNameList(const bool isShortcut);
-};
\ No newline at end of file
+    const std::vector<std::pair<DWORD, std::wstring>>& GetKeyNameList(const bool isShortcut, const bool withDisable);
+};
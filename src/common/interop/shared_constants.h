@@ -31,6 +31,14 @@ namespace CommonSharedConstants
     // Path to the event used by Awake
     const wchar_t AWAKE_EXIT_EVENT[] = L"Local\\PowerToysAwakeExitEvent-c0d5e305-35fc-4fb5-83ec-f6070cfaf7fe";
 
+    // Shared memory blocks with the processing time statistics of the low level keyboard hooks, see HookTelemetry::SharedStatsBlock
+    const wchar_t KEYBOARD_MANAGER_HOOK_STATS_SHARED_MEMORY[] = L"Local\\PowerToysKeyboardManagerHookStats-4b4d5e2a-0f67-4c1b-9a2d-6f3e8c71d5b0";
+
+    const wchar_t CENTRALIZED_KEYBOARD_HOOK_STATS_SHARED_MEMORY[] = L"Local\\PowerToysCentralizedKeyboardHookStats-9e2c7a41-3d58-4f0b-b6e1-28a4c90d7f3e";
+
+    // Prefix of the events used to ask the processes to write their profiler trace, followed by the process id. See Profiler::request_export
+    const wchar_t PROFILER_EXPORT_EVENT[] = L"Local\\PowerToysProfilerExportEvent-7d3f9b62-5a1e-4c8d-9e27-b4f06a13c5d8";
+
     // Max DWORD for key code to disable keys.
     const DWORD VK_DISABLED = 0x100;
 }
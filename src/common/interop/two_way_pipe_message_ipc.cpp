@@ -1,9 +1,298 @@
 #include "pch.h"
 #include "two_way_pipe_message_ipc_impl.h"
 
+#include <functional>
 #include <iterator>
+#include <vector>
 
-constexpr DWORD BUFSIZE = 1024;
+constexpr DWORD BUFSIZE = FramedMessageProtocol::TransportBufferSize;
+
+namespace
+{
+    // Transport of the framed message protocol over byte mode named pipes. The server side pipe instances are disconnected and reused for the next connection instead of being closed
+    class NamedPipeTransport : public FramedMessageProtocol::MessageTransport
+    {
+    public:
+        using instance_created_callback = std::function<void(HANDLE)>;
+
+        NamedPipeTransport(std::wstring _input_pipe_name, std::wstring _output_pipe_name, instance_created_callback _on_instance_created) :
+            input_pipe_name(std::move(_input_pipe_name)), output_pipe_name(std::move(_output_pipe_name)), on_instance_created(std::move(_on_instance_created))
+        {
+            cancel_event = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+        }
+
+        ~NamedPipeTransport()
+        {
+            for (HANDLE instance : idle_instances)
+            {
+                CloseHandle(instance);
+            }
+
+            CloseHandle(cancel_event);
+        }
+
+        std::unique_ptr<FramedMessageProtocol::MessageConnection> accept() override;
+        std::unique_ptr<FramedMessageProtocol::MessageConnection> connect() override;
+
+        void cancel() override
+        {
+            SetEvent(cancel_event);
+        }
+
+    private:
+        class ServerConnection;
+        class ClientConnection;
+
+        bool is_cancelled() const
+        {
+            return WaitForSingleObject(cancel_event, 0) == WAIT_OBJECT_0;
+        }
+
+        HANDLE take_instance();
+        void return_instance(HANDLE instance);
+        bool complete_io(HANDLE instance, OVERLAPPED& overlapped, DWORD& bytes_transferred);
+
+        std::wstring input_pipe_name;
+        std::wstring output_pipe_name;
+        instance_created_callback on_instance_created;
+        HANDLE cancel_event = NULL;
+
+        std::mutex instances_mutex;
+        std::vector<HANDLE> idle_instances;
+    };
+
+    // Connection accepted on a server side pipe instance. Reads are overlapped so that they can be interrupted by cancel
+    class NamedPipeTransport::ServerConnection : public FramedMessageProtocol::MessageConnection
+    {
+    public:
+        ServerConnection(NamedPipeTransport& _transport, HANDLE _instance) :
+            transport(_transport), instance(_instance)
+        {
+            io_event = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+        }
+
+        ~ServerConnection()
+        {
+            CloseHandle(io_event);
+            DisconnectNamedPipe(instance);
+            transport.return_instance(instance);
+        }
+
+        size_t read_some(char* buffer, size_t size) override
+        {
+            OVERLAPPED overlapped = { 0 };
+            overlapped.hEvent = io_event;
+            DWORD bytes_read = 0;
+            if (!ReadFile(instance, buffer, static_cast<DWORD>(size), nullptr, &overlapped) && GetLastError() != ERROR_IO_PENDING)
+            {
+                return 0;
+            }
+
+            return transport.complete_io(instance, overlapped, bytes_read) ? bytes_read : 0;
+        }
+
+        bool write_all(const char* data, size_t size) override
+        {
+            while (size > 0)
+            {
+                OVERLAPPED overlapped = { 0 };
+                overlapped.hEvent = io_event;
+                DWORD bytes_written = 0;
+                if (!WriteFile(instance, data, static_cast<DWORD>(size), nullptr, &overlapped) && GetLastError() != ERROR_IO_PENDING)
+                {
+                    return false;
+                }
+
+                if (!transport.complete_io(instance, overlapped, bytes_written))
+                {
+                    return false;
+                }
+
+                data += bytes_written;
+                size -= bytes_written;
+            }
+
+            return true;
+        }
+
+    private:
+        NamedPipeTransport& transport;
+        HANDLE instance;
+        HANDLE io_event;
+    };
+
+    // Connection to the pipe of the other process, used synchronously by the output queue thread
+    class NamedPipeTransport::ClientConnection : public FramedMessageProtocol::MessageConnection
+    {
+    public:
+        explicit ClientConnection(HANDLE _pipe) :
+            pipe(_pipe)
+        {
+        }
+
+        ~ClientConnection()
+        {
+            CloseHandle(pipe);
+        }
+
+        size_t read_some(char* buffer, size_t size) override
+        {
+            DWORD bytes_read = 0;
+            return ReadFile(pipe, buffer, static_cast<DWORD>(size), &bytes_read, nullptr) ? bytes_read : 0;
+        }
+
+        bool write_all(const char* data, size_t size) override
+        {
+            while (size > 0)
+            {
+                DWORD bytes_written = 0;
+                if (!WriteFile(pipe, data, static_cast<DWORD>(size), &bytes_written, nullptr))
+                {
+                    return false;
+                }
+
+                data += bytes_written;
+                size -= bytes_written;
+            }
+
+            return true;
+        }
+
+    private:
+        HANDLE pipe;
+    };
+
+    // Function to wait for an overlapped operation on a server side pipe instance. The operation is cancelled if the transport is cancelled before it completes
+    bool NamedPipeTransport::complete_io(HANDLE instance, OVERLAPPED& overlapped, DWORD& bytes_transferred)
+    {
+        HANDLE events[] = { overlapped.hEvent, cancel_event };
+        if (WaitForMultipleObjects(2, events, FALSE, INFINITE) != WAIT_OBJECT_0)
+        {
+            CancelIoEx(instance, &overlapped);
+        }
+
+        // Wait for the cancelled operation as well, since the overlapped structure has to stay valid until it completes
+        return GetOverlappedResult(instance, &overlapped, &bytes_transferred, TRUE);
+    }
+
+    // Function to get an idle pipe instance, or to create one if all of them are connected
+    HANDLE NamedPipeTransport::take_instance()
+    {
+        std::unique_lock lock(instances_mutex);
+        if (!idle_instances.empty())
+        {
+            HANDLE instance = idle_instances.back();
+            idle_instances.pop_back();
+            return instance;
+        }
+
+        HANDLE instance = CreateNamedPipe(
+            input_pipe_name.c_str(),
+            PIPE_ACCESS_DUPLEX |
+                WRITE_DAC |
+                FILE_FLAG_OVERLAPPED,
+            PIPE_TYPE_BYTE |
+                PIPE_READMODE_BYTE |
+                PIPE_WAIT,
+            PIPE_UNLIMITED_INSTANCES,
+            BUFSIZE,
+            BUFSIZE,
+            0,
+            NULL);
+
+        if (instance != INVALID_HANDLE_VALUE && on_instance_created)
+        {
+            on_instance_created(instance);
+        }
+
+        return instance;
+    }
+
+    void NamedPipeTransport::return_instance(HANDLE instance)
+    {
+        std::unique_lock lock(instances_mutex);
+        if (is_cancelled())
+        {
+            CloseHandle(instance);
+            return;
+        }
+
+        idle_instances.push_back(instance);
+    }
+
+    std::unique_ptr<FramedMessageProtocol::MessageConnection> NamedPipeTransport::accept()
+    {
+        if (is_cancelled())
+        {
+            return nullptr;
+        }
+
+        HANDLE instance = take_instance();
+        if (instance == INVALID_HANDLE_VALUE)
+        {
+            return nullptr;
+        }
+
+        OVERLAPPED overlapped = { 0 };
+        overlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+        bool connected = ConnectNamedPipe(instance, &overlapped) != FALSE;
+        if (!connected)
+        {
+            const DWORD error = GetLastError();
+            DWORD bytes_transferred = 0;
+            connected = error == ERROR_PIPE_CONNECTED || (error == ERROR_IO_PENDING && complete_io(instance, overlapped, bytes_transferred));
+        }
+
+        CloseHandle(overlapped.hEvent);
+        if (!connected)
+        {
+            // Client could not connect.
+            DisconnectNamedPipe(instance);
+            return_instance(instance);
+            return nullptr;
+        }
+
+        return std::make_unique<ServerConnection>(*this, instance);
+    }
+
+    std::unique_ptr<FramedMessageProtocol::MessageConnection> NamedPipeTransport::connect()
+    {
+        // Adapted from https://docs.microsoft.com/en-us/windows/win32/ipc/named-pipe-client
+        const wchar_t* lpszPipename = output_pipe_name.c_str();
+
+        // Try to open a named pipe; wait for it, if necessary.
+        while (1)
+        {
+            HANDLE output_pipe_handle = CreateFile(
+                lpszPipename, // pipe name
+                GENERIC_READ | // read and write access
+                    GENERIC_WRITE,
+                0, // no sharing
+                NULL, // default security attributes
+                OPEN_EXISTING, // opens existing pipe
+                0, // default attributes
+                NULL); // no template file
+
+            // Return if the pipe handle is valid.
+            if (output_pipe_handle != INVALID_HANDLE_VALUE)
+            {
+                return std::make_unique<ClientConnection>(output_pipe_handle);
+            }
+
+            // Exit if an error other than ERROR_PIPE_BUSY occurs.
+            if (GetLastError() != ERROR_PIPE_BUSY)
+            {
+                return nullptr;
+            }
+
+            // All pipe instances are busy, so wait for 20 seconds.
+            if (!WaitNamedPipe(lpszPipename, 20000))
+            {
+                return nullptr;
+            }
+        }
+    }
+}
 
 TwoWayPipeMessageIPC::TwoWayPipeMessageIPC(
     std::wstring _input_pipe_name,
@@ -23,7 +312,7 @@ TwoWayPipeMessageIPC::~TwoWayPipeMessageIPC()
 
 void TwoWayPipeMessageIPC::send(std::wstring msg)
 {
-    impl->send(msg);
+    impl->send(std::move(msg));
 }
 
 void TwoWayPipeMessageIPC::start(HANDLE _restricted_pipe_token)
@@ -48,14 +337,32 @@ TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::TwoWayPipeMessageIPCImpl(
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::send(std::wstring msg)
 {
-    output_queue.queue_message(msg);
+    output_queue.queue_message(std::move(msg));
 }
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::start(HANDLE _restricted_pipe_token)
 {
+    NamedPipeTransport::instance_created_callback on_instance_created;
+    if (_restricted_pipe_token != NULL)
+    {
+        on_instance_created = [this, _restricted_pipe_token](HANDLE instance) {
+            change_pipe_security_allow_restricted_token(instance, _restricted_pipe_token);
+        };
+    }
+
+    transport = std::make_unique<NamedPipeTransport>(input_pipe_name, output_pipe_name, std::move(on_instance_created));
+
+    // An empty message stops the input queue thread, so empty messages are dropped
+    server = std::make_unique<FramedMessageProtocol::FramedMessageServer>(*transport, [this](std::wstring&& message) {
+        if (!message.empty())
+        {
+            input_queue.queue_message(std::move(message));
+        }
+    });
+
     output_queue_thread = std::thread(&TwoWayPipeMessageIPCImpl::consume_output_queue_thread, this);
     input_queue_thread = std::thread(&TwoWayPipeMessageIPCImpl::consume_input_queue_thread, this);
-    input_pipe_thread = std::thread(&TwoWayPipeMessageIPCImpl::start_named_pipe_server, this, _restricted_pipe_token);
+    server->start();
 }
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::end()
@@ -65,89 +372,17 @@ void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::end()
     input_queue_thread.join();
     output_queue.interrupt();
     output_queue_thread.join();
-    pipe_connect_handle_mutex.lock();
-    if (current_connect_pipe_handle != NULL)
+    if (server)
     {
-        //Cancels the Pipe currently waiting for a connection.
-        CancelIoEx(current_connect_pipe_handle, NULL);
+        // Cancels the pipes currently waiting for a connection or a message.
+        server->stop();
     }
-    pipe_connect_handle_mutex.unlock();
-    input_pipe_thread.join();
-}
-
-void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::send_pipe_message(std::wstring message)
-{
-    // Adapted from https://docs.microsoft.com/en-us/windows/win32/ipc/named-pipe-client
-    HANDLE output_pipe_handle;
-    const wchar_t* message_send = message.c_str();
-    BOOL fSuccess = FALSE;
-    DWORD cbToWrite, cbWritten, dwMode;
-    const wchar_t* lpszPipename = output_pipe_name.c_str();
-
-    // Try to open a named pipe; wait for it, if necessary.
-
-    while (1)
-    {
-        output_pipe_handle = CreateFile(
-            lpszPipename, // pipe name
-            GENERIC_READ | // read and write access
-                GENERIC_WRITE,
-            0, // no sharing
-            NULL, // default security attributes
-            OPEN_EXISTING, // opens existing pipe
-            0, // default attributes
-            NULL); // no template file
-
-        // Break if the pipe handle is valid.
-
-        if (output_pipe_handle != INVALID_HANDLE_VALUE)
-            break;
-
-        // Exit if an error other than ERROR_PIPE_BUSY occurs.
-        DWORD curr_error = 0;
-        if ((curr_error = GetLastError()) != ERROR_PIPE_BUSY)
-        {
-            return;
-        }
-
-        // All pipe instances are busy, so wait for 20 seconds.
-
-        if (!WaitNamedPipe(lpszPipename, 20000))
-        {
-            return;
-        }
-    }
-    dwMode = PIPE_READMODE_MESSAGE;
-    fSuccess = SetNamedPipeHandleState(
-        output_pipe_handle, // pipe handle
-        &dwMode, // new pipe mode
-        NULL, // don't set maximum bytes
-        NULL); // don't set maximum time
-    if (!fSuccess)
-    {
-        return;
-    }
-
-    // Send a message to the pipe server.
-
-    cbToWrite = (lstrlen(message_send)) * sizeof(WCHAR); // no need to send final '\0'. Pipe is in message mode.
-
-    fSuccess = WriteFile(
-        output_pipe_handle, // pipe handle
-        message_send, // message
-        cbToWrite, // message length
-        &cbWritten, // bytes written
-        NULL); // not overlapped
-    if (!fSuccess)
-    {
-        return;
-    }
-    CloseHandle(output_pipe_handle);
-    return;
 }
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::consume_output_queue_thread()
 {
+    // The connection to the other process is kept open for the next messages
+    FramedMessageProtocol::FramedMessageClient client(*transport);
     while (!closed)
     {
         std::wstring message = output_queue.pop_message();
@@ -155,7 +390,7 @@ void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::consume_output_queue_thread
         {
             break;
         }
-        send_pipe_message(message);
+        client.send(message);
     }
 }
 
@@ -347,105 +582,6 @@ HANDLE TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::create_medium_integrity_t
     return restricted_token_handle;
 }
 
-void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::handle_pipe_connection(HANDLE input_pipe_handle)
-{
-    if (!input_pipe_handle)
-    {
-        return;
-    }
-    constexpr DWORD readBlockBytes = BUFSIZE;
-    std::wstring message;
-    size_t iBlock = 0;
-    message.reserve(BUFSIZE);
-    bool ok;
-    do
-    {
-        constexpr size_t charsPerBlock = readBlockBytes / sizeof(message[0]);
-        message.resize(message.size() + charsPerBlock);
-        DWORD bytesRead = 0;
-        ok = ReadFile(
-            input_pipe_handle,
-            // read the message directly into the string block by block simultaneously resizing it
-            message.data() + iBlock * charsPerBlock,
-            readBlockBytes,
-            &bytesRead,
-            nullptr);
-
-        if (!ok && GetLastError() != ERROR_MORE_DATA)
-        {
-            break;
-        }
-        iBlock++;
-    } while (!ok);
-    // trim the message's buffer
-    const auto nullCharPos = message.find_last_not_of(L'\0');
-    if (nullCharPos != std::wstring::npos)
-    {
-        message.resize(nullCharPos + 1);
-    }
-
-    input_queue.queue_message(std::move(message));
-
-    // Flush the pipe to allow the client to read the pipe's contents
-    // before disconnecting. Then disconnect the pipe, and close the
-    // handle to this pipe instance.
-
-    FlushFileBuffers(input_pipe_handle);
-    DisconnectNamedPipe(input_pipe_handle);
-    CloseHandle(input_pipe_handle);
-}
-
-void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::start_named_pipe_server(HANDLE token)
-{
-    // Adapted from https://docs.microsoft.com/en-us/windows/win32/ipc/multithreaded-pipe-server
-    const wchar_t* pipe_name = input_pipe_name.c_str();
-    BOOL connected = FALSE;
-    HANDLE connect_pipe_handle = INVALID_HANDLE_VALUE;
-    while (!closed)
-    {
-        {
-            std::unique_lock lock(pipe_connect_handle_mutex);
-            connect_pipe_handle = CreateNamedPipe(
-                pipe_name,
-                PIPE_ACCESS_DUPLEX |
-                    WRITE_DAC,
-                PIPE_TYPE_MESSAGE |
-                    PIPE_READMODE_MESSAGE |
-                    PIPE_WAIT,
-                PIPE_UNLIMITED_INSTANCES,
-                BUFSIZE,
-                BUFSIZE,
-                0,
-                NULL);
-
-            if (connect_pipe_handle == INVALID_HANDLE_VALUE)
-            {
-                return;
-            }
-
-            if (token != NULL)
-            {
-                int err = change_pipe_security_allow_restricted_token(connect_pipe_handle, token);
-            }
-            current_connect_pipe_handle = connect_pipe_handle;
-        }
-        connected = ConnectNamedPipe(connect_pipe_handle, NULL) ? TRUE : (GetLastError() == ERROR_PIPE_CONNECTED);
-        {
-            std::unique_lock lock(pipe_connect_handle_mutex);
-            current_connect_pipe_handle = NULL;
-        }
-        if (connected)
-        {
-            std::thread(&TwoWayPipeMessageIPCImpl::handle_pipe_connection, this, connect_pipe_handle).detach();
-        }
-        else
-        {
-            // Client could not connect.
-            CloseHandle(connect_pipe_handle);
-        }
-    }
-}
-
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::consume_input_queue_thread()
 {
     while (!closed)
@@ -463,6 +599,6 @@ void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::consume_input_queue_thread(
         {
             dispatch_inc_message_function(message);
         }
-        outgoing_message = message;
+        outgoing_message = std::move(message);
     }
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 #include <accctrl.h>
 #include <aclapi.h>
 #include <list>
+#include <memory>
+#include "framed_message_protocol.h"
 #include "two_way_pipe_message_ipc.h"
 
 class TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl
@@ -22,21 +24,17 @@ private:
     std::wstring input_pipe_name;
     std::thread input_queue_thread;
     std::thread output_queue_thread;
-    std::thread input_pipe_thread;
-    std::mutex pipe_connect_handle_mutex; // For manipulating the current_connect_pipe
+    std::unique_ptr<FramedMessageProtocol::MessageTransport> transport;
+    std::unique_ptr<FramedMessageProtocol::FramedMessageServer> server; // Reads the frames of the incoming connections on a pool of threads
     std::wstring outgoing_message; // Store the updated json settings.
 
-    HANDLE current_connect_pipe_handle = NULL;
     bool closed = false;
     TwoWayPipeMessageIPC::callback_function dispatch_inc_message_function;
 
-    void send_pipe_message(std::wstring message);
     void consume_output_queue_thread();
     BOOL GetLogonSID(HANDLE hToken, PSID* ppsid);
     VOID FreeLogonSID(PSID* ppsid);
     int change_pipe_security_allow_restricted_token(HANDLE handle, HANDLE token);
     HANDLE create_medium_integrity_token();
-    void handle_pipe_connection(HANDLE input_pipe_handle);
-    void start_named_pipe_server(HANDLE token);
     void consume_input_queue_thread();
 };
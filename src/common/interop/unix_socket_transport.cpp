@@ -0,0 +1,212 @@
+#include "unix_socket_transport.h"
+
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+    bool make_address(const std::string& path, sockaddr_un& address)
+    {
+        if (path.size() >= sizeof(address.sun_path))
+        {
+            return false;
+        }
+
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return true;
+    }
+
+    void set_buffer_sizes(int socket)
+    {
+        const int buffer_size = FramedMessageProtocol::TransportBufferSize;
+        setsockopt(socket, SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size));
+        setsockopt(socket, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+    }
+}
+
+class UnixSocketTransport::Connection : public FramedMessageProtocol::MessageConnection
+{
+public:
+    // Accepted connections are released from the transport on destruction, so that cancel doesn't shut down a reused descriptor
+    Connection(int socket, UnixSocketTransport* owner) :
+        socket(socket), owner(owner)
+    {
+    }
+
+    ~Connection()
+    {
+        if (owner)
+        {
+            owner->release_connection(socket);
+        }
+
+        ::close(socket);
+    }
+
+    size_t read_some(char* buffer, size_t size) override
+    {
+        while (true)
+        {
+            const ssize_t result = ::recv(socket, buffer, size, 0);
+            if (result >= 0)
+            {
+                return static_cast<size_t>(result);
+            }
+
+            if (errno != EINTR)
+            {
+                return 0;
+            }
+        }
+    }
+
+    bool write_all(const char* data, size_t size) override
+    {
+        while (size > 0)
+        {
+            const ssize_t result = ::send(socket, data, size, MSG_NOSIGNAL);
+            if (result < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+
+                return false;
+            }
+
+            data += result;
+            size -= static_cast<size_t>(result);
+        }
+
+        return true;
+    }
+
+private:
+    int socket;
+    UnixSocketTransport* owner;
+};
+
+UnixSocketTransport::UnixSocketTransport(std::string local_path, std::string remote_path) :
+    local_path(std::move(local_path)), remote_path(std::move(remote_path))
+{
+}
+
+UnixSocketTransport::~UnixSocketTransport()
+{
+    if (listen_socket != -1)
+    {
+        ::close(listen_socket);
+        ::unlink(local_path.c_str());
+    }
+}
+
+std::unique_ptr<FramedMessageProtocol::MessageConnection> UnixSocketTransport::accept()
+{
+    int socket = -1;
+    {
+        std::lock_guard lock(sockets_mutex);
+        if (cancelled)
+        {
+            return nullptr;
+        }
+
+        if (listen_socket == -1)
+        {
+            sockaddr_un address;
+            if (!make_address(local_path, address))
+            {
+                return nullptr;
+            }
+
+            listen_socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (listen_socket == -1)
+            {
+                return nullptr;
+            }
+
+            ::unlink(local_path.c_str());
+            if (::bind(listen_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listen_socket, SOMAXCONN) != 0)
+            {
+                ::close(listen_socket);
+                listen_socket = -1;
+                return nullptr;
+            }
+        }
+
+        socket = listen_socket;
+    }
+
+    // Shutting down the listening socket on cancel makes the pending accept calls fail
+    int connection_socket = -1;
+    do
+    {
+        connection_socket = ::accept(socket, nullptr, nullptr);
+    } while (connection_socket == -1 && errno == EINTR);
+
+    if (connection_socket == -1)
+    {
+        return nullptr;
+    }
+
+    std::lock_guard lock(sockets_mutex);
+    if (cancelled)
+    {
+        ::close(connection_socket);
+        return nullptr;
+    }
+
+    set_buffer_sizes(connection_socket);
+    accepted_sockets.insert(connection_socket);
+    return std::make_unique<Connection>(connection_socket, this);
+}
+
+std::unique_ptr<FramedMessageProtocol::MessageConnection> UnixSocketTransport::connect()
+{
+    sockaddr_un address;
+    if (!make_address(remote_path, address))
+    {
+        return nullptr;
+    }
+
+    const int socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (socket == -1)
+    {
+        return nullptr;
+    }
+
+    set_buffer_sizes(socket);
+    if (::connect(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        ::close(socket);
+        return nullptr;
+    }
+
+    return std::make_unique<Connection>(socket, nullptr);
+}
+
+void UnixSocketTransport::cancel()
+{
+    std::lock_guard lock(sockets_mutex);
+    cancelled = true;
+    if (listen_socket != -1)
+    {
+        ::shutdown(listen_socket, SHUT_RDWR);
+    }
+
+    for (int socket : accepted_sockets)
+    {
+        ::shutdown(socket, SHUT_RDWR);
+    }
+}
+
+void UnixSocketTransport::release_connection(int socket)
+{
+    std::lock_guard lock(sockets_mutex);
+    accepted_sockets.erase(socket);
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "framed_message_protocol.h"
+
+#include <mutex>
+#include <set>
+#include <string>
+
+// Transport of the framed message protocol over Unix domain stream sockets. Only used to test and benchmark the protocol on platforms without named pipes
+class UnixSocketTransport : public FramedMessageProtocol::MessageTransport
+{
+public:
+    // The local endpoint is created on the first accept call, and removed when the transport is destroyed
+    UnixSocketTransport(std::string local_path, std::string remote_path);
+    ~UnixSocketTransport();
+
+    std::unique_ptr<FramedMessageProtocol::MessageConnection> accept() override;
+    std::unique_ptr<FramedMessageProtocol::MessageConnection> connect() override;
+    void cancel() override;
+
+private:
+    class Connection;
+
+    void release_connection(int socket);
+
+    std::string local_path;
+    std::string remote_path;
+
+    std::mutex sockets_mutex;
+    int listen_socket = -1;
+    bool cancelled = false;
+
+    // Accepted connections which have to be shut down on cancel
+    std::set<int> accepted_sockets;
+};
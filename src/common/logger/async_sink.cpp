@@ -0,0 +1,179 @@
+#include "async_sink.h"
+
+namespace
+{
+    // Payloads up to this size never allocate once the slot was used, since the slot keeps the capacity of its string
+    constexpr size_t ReservedPayloadSize = 256;
+}
+
+AsyncSink::Record::Record()
+{
+    payload.reserve(ReservedPayloadSize);
+}
+
+AsyncSink::AsyncSink(std::shared_ptr<spdlog::sinks::sink> target, size_t capacity, std::chrono::milliseconds flush_interval) :
+    target(std::move(target)), ring(capacity), flush_interval(flush_interval)
+{
+    flusher = std::thread(&AsyncSink::run, this);
+}
+
+AsyncSink::~AsyncSink()
+{
+    {
+        std::lock_guard lock(flusher_mutex);
+        stopping = true;
+    }
+
+    wake.notify_one();
+    flusher.join();
+}
+
+void AsyncSink::log(const spdlog::details::log_msg& msg)
+{
+    const bool important = msg.level >= spdlog::level::warn;
+    if ((!important && blocked_producers.load(std::memory_order_relaxed) > 0) || !try_push(msg))
+    {
+        // Warnings and errors are the messages which are needed to investigate a problem, so they are worth waiting for
+        if (!important || !push_blocking(msg))
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            wake_flusher();
+        }
+        return;
+    }
+
+    // Errors are written right away, in case the process is about to crash. Otherwise the flusher only has to be woken before the ring fills up
+    if (msg.level >= spdlog::level::err || ring.size_approx() >= ring.capacity() / 2)
+    {
+        wake_flusher();
+    }
+}
+
+bool AsyncSink::try_push(const spdlog::details::log_msg& msg)
+{
+    return ring.try_push([&msg](Record& record) {
+        record.level = msg.level;
+        record.time = msg.time;
+        record.thread_id = msg.thread_id;
+        record.logger_name.assign(msg.logger_name.data(), msg.logger_name.size());
+        record.payload.assign(msg.payload.data(), msg.payload.size());
+    });
+}
+
+// Function to wake the flusher and push the message each time it drained the ring. Returns false if the flusher didn't drain the ring within BlockTimeout
+bool AsyncSink::push_blocking(const spdlog::details::log_msg& msg)
+{
+    blocked_producers.fetch_add(1, std::memory_order_relaxed);
+    bool pushed = false;
+    std::unique_lock lock(flusher_mutex);
+    while (!pushed && !stopping)
+    {
+        const uint64_t passes = drain_passes;
+        wake_requested = true;
+        wake.notify_one();
+        const bool drained = flushed.wait_for(lock, BlockTimeout, [this, passes] { return drain_passes != passes || stopping; });
+        pushed = try_push(msg);
+        if (!drained)
+        {
+            break;
+        }
+    }
+
+    lock.unlock();
+    blocked_producers.fetch_sub(1, std::memory_order_relaxed);
+    return pushed;
+}
+
+void AsyncSink::wake_flusher()
+{
+    if (wake_pending.exchange(true, std::memory_order_acq_rel))
+    {
+        return;
+    }
+
+    {
+        std::lock_guard lock(flusher_mutex);
+        wake_requested = true;
+    }
+
+    wake.notify_one();
+}
+
+void AsyncSink::flush()
+{
+    std::unique_lock lock(flusher_mutex);
+    const uint64_t request = ++flush_requests;
+    wake_requested = true;
+    wake.notify_one();
+    flushed.wait(lock, [this, request] { return flush_completions >= request || stopping; });
+}
+
+void AsyncSink::set_pattern(const std::string& pattern)
+{
+    target->set_pattern(pattern);
+}
+
+void AsyncSink::set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter)
+{
+    target->set_formatter(std::move(sink_formatter));
+}
+
+uint64_t AsyncSink::dropped_count() const
+{
+    return dropped.load(std::memory_order_relaxed);
+}
+
+// Function to write all the queued messages to the wrapped sink. Returns the number of messages written
+size_t AsyncSink::drain()
+{
+    size_t count = 0;
+    while (ring.try_pop([this](Record& record) {
+        spdlog::details::log_msg msg(spdlog::source_loc{}, record.logger_name, record.level, record.payload);
+        msg.time = record.time;
+        msg.thread_id = record.thread_id;
+        target->log(msg);
+    }))
+    {
+        count++;
+    }
+
+    const uint64_t dropped_now = dropped.load(std::memory_order_relaxed);
+    if (dropped_now != reported_dropped)
+    {
+        const std::string message = std::to_string(dropped_now - reported_dropped) + " log messages were dropped because the log buffer was full";
+        spdlog::details::log_msg msg(spdlog::source_loc{}, spdlog::string_view_t{}, spdlog::level::warn, message);
+        target->log(msg);
+        reported_dropped = dropped_now;
+    }
+
+    return count;
+}
+
+void AsyncSink::run()
+{
+    std::unique_lock lock(flusher_mutex);
+    while (true)
+    {
+        wake.wait_for(lock, flush_interval, [this] { return wake_requested || stopping; });
+        wake_requested = false;
+        const bool stop = stopping;
+        const uint64_t request = flush_requests;
+        lock.unlock();
+
+        wake_pending.store(false, std::memory_order_release);
+        drain();
+        if (request != flush_completions || stop)
+        {
+            target->flush();
+        }
+
+        lock.lock();
+        flush_completions = request;
+        drain_passes++;
+        flushed.notify_all();
+        if (stop)
+        {
+            break;
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "log_ring_buffer.h"
+
+#include <spdlog/details/log_msg.h>
+#include <spdlog/sinks/sink.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Sink which copies the messages into a lock free ring buffer, and writes them to the wrapped sink in batches on a background thread, so that logging
+// from a hot path neither takes the lock of the file sink nor waits for the disk. Warnings and errors logged while the ring is full wait for the
+// flusher to make room, and are only dropped if the flusher makes no progress for BlockTimeout, e.g. because the disk hangs. Other messages
+// logged while the ring is full or while a warning waits are dropped and counted, and the count is written to the log as a warning.
+// The background thread is joined when the sink is destroyed, which must not happen while a DLL is being unloaded
+class AsyncSink : public spdlog::sinks::sink
+{
+public:
+    static constexpr size_t DefaultCapacity = 8192;
+    static constexpr std::chrono::milliseconds DefaultFlushInterval{ 50 };
+    static constexpr std::chrono::milliseconds BlockTimeout{ 100 };
+
+    explicit AsyncSink(std::shared_ptr<spdlog::sinks::sink> target, size_t capacity = DefaultCapacity, std::chrono::milliseconds flush_interval = DefaultFlushInterval);
+    ~AsyncSink() override;
+
+    AsyncSink(const AsyncSink&) = delete;
+    AsyncSink& operator=(const AsyncSink&) = delete;
+
+    void log(const spdlog::details::log_msg& msg) override;
+
+    // Function to write the messages logged before the call and flush the wrapped sink
+    void flush() override;
+
+    void set_pattern(const std::string& pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+
+    // Number of messages dropped because the ring was full
+    uint64_t dropped_count() const;
+
+private:
+    struct Record
+    {
+        Record();
+
+        spdlog::level::level_enum level = spdlog::level::off;
+        spdlog::log_clock::time_point time;
+        size_t thread_id = 0;
+        std::string logger_name;
+        std::string payload;
+    };
+
+    bool try_push(const spdlog::details::log_msg& msg);
+    bool push_blocking(const spdlog::details::log_msg& msg);
+    void run();
+    void wake_flusher();
+    size_t drain();
+
+    std::shared_ptr<spdlog::sinks::sink> target;
+    LogRingBuffer<Record> ring;
+    std::chrono::milliseconds flush_interval;
+
+    std::atomic<uint64_t> dropped = 0;
+    // Number of warnings and errors waiting in push_blocking. Other messages don't take the room made for them
+    std::atomic<uint32_t> blocked_producers = 0;
+    uint64_t reported_dropped = 0;
+
+    // Set by the first producer which wakes the flusher, so that the others don't take the mutex until the flusher ran
+    std::atomic_bool wake_pending = false;
+
+    std::mutex flusher_mutex;
+    std::condition_variable wake;
+    std::condition_variable flushed;
+    bool wake_requested = false;
+    bool stopping = false;
+    uint64_t flush_requests = 0;
+    uint64_t flush_completions = 0;
+    // Number of times the flusher drained the ring, so that push_blocking knows when to try again
+    uint64_t drain_passes = 0;
+
+    std::thread flusher;
+};
@@ -0,0 +1,384 @@
+// Checks and benchmarks the asynchronous logger backend: the lock free ring buffer, the asynchronous sink against the synchronous file sink
+// and the structured events. See README.md for how to build it
+#include "../async_sink.h"
+#include "../log_events.h"
+#include "../log_ring_buffer.h"
+#include "../logger.h"
+
+#include <spdlog/async.h>
+#include <spdlog/sinks/basic_file_sink.h>
+#include <spdlog/sinks/null_sink.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Defined in logger.cpp, which depends on Windows. The level filters out the trace messages of benchmark_filtered_trace
+std::shared_ptr<spdlog::logger> Logger::logger = [] {
+    auto logger = std::make_shared<spdlog::logger>("filtered", std::make_shared<spdlog::sinks::null_sink_mt>());
+    logger->set_level(spdlog::level::info);
+    return logger;
+}();
+std::unique_ptr<LogEvents::EventWriter> Logger::eventWriter;
+
+namespace
+{
+    using benchmark_clock = std::chrono::steady_clock;
+
+    int failures = 0;
+
+    void check(bool condition, const std::string& message)
+    {
+        if (!condition)
+        {
+            std::cout << "FAILED: " << message << std::endl;
+            failures++;
+        }
+    }
+
+    double seconds_since(benchmark_clock::time_point start)
+    {
+        return std::chrono::duration<double>(benchmark_clock::now() - start).count();
+    }
+
+    template<typename Function>
+    void run_threads(size_t thread_count, Function function)
+    {
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < thread_count; i++)
+        {
+            threads.emplace_back(function, i);
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    size_t count_lines(const std::filesystem::path& path, const std::string& needle)
+    {
+        std::ifstream file(path);
+        size_t count = 0;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (line.find(needle) != std::string::npos)
+            {
+                count++;
+            }
+        }
+
+        return count;
+    }
+
+    // Several producers push increasing values, and the consumer checks that the values of each producer arrive once and in order
+    void check_ring_buffer()
+    {
+        constexpr size_t producer_count = 4;
+        constexpr uint64_t values_per_producer = 1'000'000;
+        LogRingBuffer<uint64_t> ring(1024);
+
+        std::atomic_bool producing = true;
+        std::vector<uint64_t> next_values(producer_count, 0);
+        uint64_t received = 0;
+        bool ordered = true;
+
+        const auto start = benchmark_clock::now();
+        std::thread consumer([&] {
+            const auto consume = [&](uint64_t& value) {
+                const size_t producer = value >> 32;
+                ordered = ordered && (value & 0xFFFFFFFF) == next_values[producer];
+                next_values[producer]++;
+                received++;
+            };
+
+            while (producing)
+            {
+                if (!ring.try_pop(consume))
+                {
+                    std::this_thread::yield();
+                }
+            }
+
+            while (ring.try_pop(consume))
+            {
+            }
+        });
+
+        run_threads(producer_count, [&](size_t producer) {
+            for (uint64_t i = 0; i < values_per_producer; i++)
+            {
+                while (!ring.try_push([&](uint64_t& value) { value = (static_cast<uint64_t>(producer) << 32) | i; }))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        producing = false;
+        consumer.join();
+        const double elapsed = seconds_since(start);
+
+        check(received == producer_count * values_per_producer, "the ring buffer lost values");
+        check(ordered, "the ring buffer reordered the values of a producer");
+        std::printf("ring buffer: %zu producers, %.1f M values/s\n", producer_count, received / elapsed / 1e6);
+    }
+
+    enum class Backend
+    {
+        Synchronous,
+        Asynchronous,
+        SpdlogAsync
+    };
+
+    const char* backend_name(Backend backend)
+    {
+        switch (backend)
+        {
+        case Backend::Synchronous:
+            return "synchronous file sink";
+        case Backend::Asynchronous:
+            return "AsyncSink";
+        case Backend::SpdlogAsync:
+            return "spdlog async_logger";
+        }
+
+        return "";
+    }
+
+    void benchmark_logger(Backend backend, size_t thread_count, spdlog::level::level_enum level, const std::filesystem::path& directory)
+    {
+        constexpr size_t messages_per_thread = 200'000;
+        const auto path = directory / ("log-" + std::to_string(static_cast<int>(backend)) + "-" + std::to_string(thread_count) + ".txt");
+        std::filesystem::remove(path);
+
+        auto file_sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(path.string(), true);
+        std::shared_ptr<AsyncSink> async_sink;
+        std::shared_ptr<spdlog::logger> logger;
+        switch (backend)
+        {
+        case Backend::Synchronous:
+            logger = std::make_shared<spdlog::logger>("benchmark", file_sink);
+            break;
+        case Backend::Asynchronous:
+            async_sink = std::make_shared<AsyncSink>(file_sink);
+            logger = std::make_shared<spdlog::logger>("benchmark", async_sink);
+            break;
+        case Backend::SpdlogAsync:
+            spdlog::init_thread_pool(AsyncSink::DefaultCapacity, 1);
+            logger = std::make_shared<spdlog::async_logger>("benchmark", file_sink, spdlog::thread_pool(), spdlog::async_overflow_policy::block);
+            break;
+        }
+
+        logger->set_pattern("[%Y-%m-%d %H:%M:%S.%f] [p-%P] [t-%t] [%l] %v");
+        logger->set_level(spdlog::level::trace);
+
+        std::vector<double> worst_latencies(thread_count);
+        const auto start = benchmark_clock::now();
+        run_threads(thread_count, [&](size_t thread) {
+            double worst = 0;
+            for (size_t i = 0; i < messages_per_thread; i++)
+            {
+                const auto message_start = benchmark_clock::now();
+                logger->log(level, "benchmark message {} from thread {} with a payload of typical length", i, thread);
+                worst = std::max(worst, std::chrono::duration<double, std::micro>(benchmark_clock::now() - message_start).count());
+            }
+
+            worst_latencies[thread] = worst;
+        });
+        const double logging_time = seconds_since(start);
+
+        logger->flush();
+        const double total_time = seconds_since(start);
+        const uint64_t dropped = async_sink ? async_sink->dropped_count() : 0;
+        logger.reset();
+        async_sink.reset();
+        file_sink.reset();
+        if (backend == Backend::SpdlogAsync)
+        {
+            spdlog::shutdown();
+        }
+
+        const size_t total = thread_count * messages_per_thread;
+        const size_t written = count_lines(path, "benchmark message");
+        check(written + dropped == total, std::string(backend_name(backend)) + " lost messages");
+        if (dropped > 0)
+        {
+            check(count_lines(path, "log messages were dropped") > 0, "AsyncSink didn't report the dropped messages");
+        }
+        if (level >= spdlog::level::warn)
+        {
+            check(dropped == 0, "AsyncSink dropped warnings");
+        }
+
+        std::printf("%-22s %-5s %zu threads: %6.2f M msgs/s in the threads, %6.2f M msgs/s written, worst call %8.1f us, %llu dropped\n",
+                    backend_name(backend),
+                    spdlog::level::to_string_view(level).data(),
+                    thread_count,
+                    total / logging_time / 1e6,
+                    (total - dropped) / total_time / 1e6,
+                    *std::max_element(worst_latencies.begin(), worst_latencies.end()),
+                    static_cast<unsigned long long>(dropped));
+        std::filesystem::remove(path);
+    }
+
+    void check_events(const std::filesystem::path& directory)
+    {
+        constexpr LogEvents::EventDescriptor first{ 1, "Benchmark.First", { "thread", "index" } };
+        constexpr LogEvents::EventDescriptor second{ 2, "Benchmark.Second", { "thread", "index", "a", "b" } };
+        constexpr size_t thread_count = 4;
+        constexpr int64_t events_per_thread = 500'000;
+
+        const auto path = directory / "events.bin";
+        uint64_t dropped = 0;
+        double elapsed = 0;
+        {
+            LogEvents::EventWriter writer(path);
+            const auto start = benchmark_clock::now();
+            run_threads(thread_count, [&](size_t thread) {
+                for (int64_t i = 0; i < events_per_thread; i++)
+                {
+                    if (i % 2 == 0)
+                    {
+                        writer.record(first, thread, i);
+                    }
+                    else
+                    {
+                        writer.record(second, thread, i, -i, INT64_MAX);
+                    }
+                }
+            });
+            elapsed = seconds_since(start);
+            writer.flush();
+            dropped = writer.dropped_count();
+        }
+
+        std::ifstream file(path, std::ios::binary);
+        const std::string data{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+        std::vector<int64_t> last_index(thread_count, -1);
+        uint64_t decoded = 0;
+        uint64_t reported_dropped = 0;
+        bool valid = true;
+        std::string first_line;
+        const bool decoded_file = LogEvents::decode(data, [&](const LogEvents::DecodedEvent& event) {
+            if (event.name == "LogEvents.Dropped")
+            {
+                reported_dropped += event.fields[0].second;
+                return;
+            }
+
+            if (first_line.empty())
+            {
+                first_line = LogEvents::format_event(event);
+            }
+
+            const auto thread = static_cast<size_t>(event.fields[0].second);
+            const auto index = event.fields[1].second;
+            valid = valid && thread < thread_count && index > last_index[thread];
+            valid = valid && event.name == (index % 2 == 0 ? "Benchmark.First" : "Benchmark.Second");
+            valid = valid && event.fields.size() == (index % 2 == 0 ? 2u : 4u);
+            if (index % 2 != 0)
+            {
+                valid = valid && event.fields[2].second == -index && event.fields[3].second == INT64_MAX;
+            }
+
+            if (thread < thread_count)
+            {
+                last_index[thread] = index;
+            }
+
+            decoded++;
+        });
+
+        check(decoded_file, "the events file couldn't be decoded");
+        check(valid, "the decoded events don't match the recorded ones");
+        check(decoded + dropped == thread_count * events_per_thread, "events were lost");
+        check(reported_dropped == dropped, "the dropped events weren't reported in the file");
+        check(!LogEvents::decode(data.substr(0, data.size() - 3), [](const LogEvents::DecodedEvent&) {}), "a truncated events file was decoded");
+
+        std::printf("events: %zu threads, %.2f M events/s recorded, %.1f bytes per event, %llu dropped\n",
+                    thread_count,
+                    thread_count * events_per_thread / elapsed / 1e6,
+                    static_cast<double>(data.size()) / std::max<uint64_t>(decoded, 1),
+                    static_cast<unsigned long long>(dropped));
+        std::printf("decoded: %s\n", first_line.c_str());
+        std::filesystem::remove(path);
+    }
+
+    // Logger::trace builds its arguments in the caller even when the message is filtered or compiled out. POWERTOYS_LOG_TRACE only builds them when the message is written
+    void benchmark_filtered_trace()
+    {
+        constexpr size_t calls = 1'000'000;
+        size_t evaluated = 0;
+        const auto build_argument = [&evaluated](size_t i) {
+            evaluated++;
+            return std::to_string(i);
+        };
+
+        auto start = benchmark_clock::now();
+        for (size_t i = 0; i < calls; i++)
+        {
+            Logger::trace("filtered trace {}", build_argument(i));
+        }
+        const double function_elapsed = seconds_since(start);
+        const size_t function_evaluated = std::exchange(evaluated, 0);
+
+        start = benchmark_clock::now();
+        for (size_t i = 0; i < calls; i++)
+        {
+            POWERTOYS_LOG_TRACE("filtered trace {}", build_argument(i));
+        }
+        const double macro_elapsed = seconds_since(start);
+
+        check(evaluated == 0, "the arguments of a filtered POWERTOYS_LOG_TRACE were evaluated");
+        std::printf("trace below the runtime level (%s): Logger::trace %.2f ns per call (%zu arguments built), POWERTOYS_LOG_TRACE %.2f ns per call (%zu arguments built)\n",
+                    Logger::is_compiled(spdlog::level::trace) ? "compiled in" : "compiled out",
+                    function_elapsed / calls * 1e9,
+                    function_evaluated,
+                    macro_elapsed / calls * 1e9,
+                    evaluated);
+    }
+}
+
+int main()
+{
+    const auto directory = std::filesystem::temp_directory_path() / "powertoys-log-benchmark";
+    std::filesystem::create_directories(directory);
+
+    check_ring_buffer();
+    for (const size_t thread_count : { 1, 4, 8 })
+    {
+        for (const auto backend : { Backend::Synchronous, Backend::Asynchronous, Backend::SpdlogAsync })
+        {
+            benchmark_logger(backend, thread_count, spdlog::level::trace, directory);
+        }
+    }
+
+    // Warnings wait for room instead of being dropped
+    for (const size_t thread_count : { 1, 8 })
+    {
+        benchmark_logger(Backend::Asynchronous, thread_count, spdlog::level::warn, directory);
+    }
+
+    check_events(directory);
+    benchmark_filtered_trace();
+
+    std::filesystem::remove_all(directory);
+    if (failures > 0)
+    {
+        std::cout << failures << " checks failed" << std::endl;
+        return 1;
+    }
+
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}
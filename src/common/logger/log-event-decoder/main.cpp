@@ -0,0 +1,37 @@
+// Prints the structured events written by a logger in asynchronous mode (<log name>-events.bin) as lines of text. See README.md for how to build it
+#include "../log_events.h"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage: log-event-decoder <events file>" << std::endl;
+        return 1;
+    }
+
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "Failed to open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    const std::string data{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+    const bool decoded = LogEvents::decode(data, [](const LogEvents::DecodedEvent& event) {
+        std::cout << LogEvents::format_event(event) << '\n';
+    });
+
+    if (!decoded)
+    {
+        // A file which is still being written, or which was left by a crash, usually ends with a truncated block
+        std::cerr << argv[1] << " isn't an events file, or is truncated or corrupted after the events above" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
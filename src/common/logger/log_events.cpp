@@ -0,0 +1,413 @@
+#include "log_events.h"
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <type_traits>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace LogEvents
+{
+    namespace
+    {
+        constexpr char DescriptorTag = 'D';
+        constexpr char EventTag = 'E';
+        constexpr size_t HeaderSize = sizeof(FileMagic) + sizeof(uint16_t);
+
+        const EventDescriptor DroppedEvents{ DroppedEventsId, "LogEvents.Dropped", { "count" } };
+
+        uint32_t current_thread_id()
+        {
+            thread_local const uint32_t thread_id =
+#ifdef _WIN32
+                static_cast<uint32_t>(GetCurrentThreadId());
+#else
+                static_cast<uint32_t>(::syscall(SYS_gettid));
+#endif
+            return thread_id;
+        }
+
+        template<typename T>
+        void append_integer(T value, std::string& output)
+        {
+            const auto bits = static_cast<std::make_unsigned_t<T>>(value);
+            for (size_t i = 0; i < sizeof(T); i++)
+            {
+                output.push_back(static_cast<char>((bits >> (8 * i)) & 0xFF));
+            }
+        }
+
+        void append_string(std::string_view text, std::string& output)
+        {
+            append_integer(static_cast<uint16_t>(text.size()), output);
+            output.append(text.data(), text.size());
+        }
+
+        // Reads the blocks of an events file and checks that they aren't truncated
+        class Reader
+        {
+        public:
+            explicit Reader(std::string_view data) :
+                data(data)
+            {
+            }
+
+            bool at_end() const
+            {
+                return position == data.size();
+            }
+
+            template<typename T>
+            bool read_integer(T& value)
+            {
+                if (data.size() - position < sizeof(T))
+                {
+                    return false;
+                }
+
+                std::make_unsigned_t<T> bits = 0;
+                for (size_t i = 0; i < sizeof(T); i++)
+                {
+                    bits |= static_cast<std::make_unsigned_t<T>>(static_cast<unsigned char>(data[position + i])) << (8 * i);
+                }
+
+                value = static_cast<T>(bits);
+                position += sizeof(T);
+                return true;
+            }
+
+            bool read_string(std::string_view& text)
+            {
+                uint16_t size = 0;
+                if (!read_integer(size) || data.size() - position < size)
+                {
+                    return false;
+                }
+
+                text = data.substr(position, size);
+                position += size;
+                return true;
+            }
+
+        private:
+            std::string_view data;
+            size_t position = 0;
+        };
+
+        struct DecodedDescriptor
+        {
+            std::string_view name;
+            std::vector<std::string_view> fields;
+        };
+    }
+
+    size_t field_count(const EventDescriptor& descriptor)
+    {
+        size_t count = 0;
+        while (count < MaxFields && descriptor.fields[count])
+        {
+            count++;
+        }
+
+        return count;
+    }
+
+    void encode_header(std::string& output)
+    {
+        output.append(FileMagic, sizeof(FileMagic));
+        append_integer(FormatVersion, output);
+    }
+
+    void encode_descriptor(const EventDescriptor& descriptor, std::string& output)
+    {
+        const size_t count = field_count(descriptor);
+        output.push_back(DescriptorTag);
+        append_integer(descriptor.id, output);
+        append_integer(static_cast<uint8_t>(count), output);
+        append_string(descriptor.name, output);
+        for (size_t i = 0; i < count; i++)
+        {
+            append_string(descriptor.fields[i], output);
+        }
+    }
+
+    void encode_event(const EventRecord& event, size_t field_count, std::string& output)
+    {
+        output.push_back(EventTag);
+        append_integer(event.id, output);
+        append_integer(event.thread_id, output);
+        append_integer(event.timestamp, output);
+        for (size_t i = 0; i < field_count; i++)
+        {
+            append_integer(event.fields[i], output);
+        }
+    }
+
+    bool decode(std::string_view data, const std::function<void(const DecodedEvent&)>& callback)
+    {
+        if (data.size() < HeaderSize || std::memcmp(data.data(), FileMagic, sizeof(FileMagic)) != 0)
+        {
+            return false;
+        }
+
+        Reader reader(data.substr(sizeof(FileMagic)));
+        uint16_t version = 0;
+        if (!reader.read_integer(version) || version != FormatVersion)
+        {
+            return false;
+        }
+
+        std::map<uint16_t, DecodedDescriptor> descriptors;
+        DecodedEvent event;
+        while (!reader.at_end())
+        {
+            char tag = 0;
+            uint16_t id = 0;
+            if (!reader.read_integer(tag) || !reader.read_integer(id))
+            {
+                return false;
+            }
+
+            if (tag == DescriptorTag)
+            {
+                uint8_t count = 0;
+                DecodedDescriptor descriptor;
+                if (!reader.read_integer(count) || count > MaxFields || !reader.read_string(descriptor.name))
+                {
+                    return false;
+                }
+
+                descriptor.fields.resize(count);
+                for (auto& field : descriptor.fields)
+                {
+                    if (!reader.read_string(field))
+                    {
+                        return false;
+                    }
+                }
+
+                descriptors[id] = std::move(descriptor);
+            }
+            else if (tag == EventTag)
+            {
+                auto descriptor = descriptors.find(id);
+                if (descriptor == descriptors.end() || !reader.read_integer(event.thread_id) || !reader.read_integer(event.timestamp))
+                {
+                    return false;
+                }
+
+                event.name = descriptor->second.name;
+                event.fields.clear();
+                for (const auto& field : descriptor->second.fields)
+                {
+                    int64_t value = 0;
+                    if (!reader.read_integer(value))
+                    {
+                        return false;
+                    }
+
+                    event.fields.emplace_back(field, value);
+                }
+
+                callback(event);
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::string format_event(const DecodedEvent& event)
+    {
+        const std::time_t seconds = static_cast<std::time_t>(event.timestamp / 1000000000);
+        const auto microseconds = static_cast<int>((event.timestamp % 1000000000) / 1000);
+        std::tm time{};
+#ifdef _WIN32
+        gmtime_s(&time, &seconds);
+#else
+        gmtime_r(&seconds, &time);
+#endif
+
+        char prefix[64];
+        const size_t length = std::strftime(prefix, sizeof(prefix), "[%Y-%m-%d %H:%M:%S", &time);
+        std::string result(prefix, length);
+
+        char fraction[16];
+        std::snprintf(fraction, sizeof(fraction), ".%06d] ", microseconds);
+        result += fraction;
+        result += "[t-" + std::to_string(event.thread_id) + "] ";
+        result += event.name;
+        for (const auto& [name, value] : event.fields)
+        {
+            result += ' ';
+            result += name;
+            result += '=';
+            result += std::to_string(value);
+        }
+
+        return result;
+    }
+
+    EventWriter::EventWriter(const std::filesystem::path& path, size_t capacity, std::chrono::milliseconds flush_interval) :
+        file(path, std::ios::binary | std::ios::trunc), ring(capacity), flush_interval(flush_interval), registered(std::make_unique<std::atomic_bool[]>(0x10000))
+    {
+        encode_header(buffer);
+        flusher = std::thread(&EventWriter::run, this);
+    }
+
+    EventWriter::~EventWriter()
+    {
+        {
+            std::lock_guard lock(flusher_mutex);
+            stopping = true;
+        }
+
+        wake.notify_one();
+        flusher.join();
+    }
+
+    bool EventWriter::is_open() const
+    {
+        return file.is_open();
+    }
+
+    void EventWriter::record(const EventDescriptor& descriptor, int64_t field0, int64_t field1, int64_t field2, int64_t field3) noexcept
+    {
+        if (!registered[descriptor.id].load(std::memory_order_acquire))
+        {
+            register_descriptor(descriptor);
+        }
+
+        const auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        const bool pushed = ring.try_push([&](EventRecord& event) {
+            event.id = descriptor.id;
+            event.thread_id = current_thread_id();
+            event.timestamp = timestamp;
+            event.fields = { field0, field1, field2, field3 };
+        });
+
+        if (!pushed)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if ((!pushed || ring.size_approx() >= ring.capacity() / 2) && !wake_pending.exchange(true, std::memory_order_acq_rel))
+        {
+            {
+                std::lock_guard lock(flusher_mutex);
+                wake_requested = true;
+            }
+
+            wake.notify_one();
+        }
+    }
+
+    void EventWriter::register_descriptor(const EventDescriptor& descriptor)
+    {
+        std::lock_guard lock(descriptors_mutex);
+        if (!registered[descriptor.id].load(std::memory_order_relaxed))
+        {
+            // The descriptor is queued before the first event with its id, so the flusher always writes it first
+            pending_descriptors.push_back(descriptor);
+            registered[descriptor.id].store(true, std::memory_order_release);
+        }
+    }
+
+    void EventWriter::flush()
+    {
+        std::unique_lock lock(flusher_mutex);
+        const uint64_t request = ++flush_requests;
+        wake_requested = true;
+        wake.notify_one();
+        flushed.wait(lock, [this, request] { return flush_completions >= request || stopping; });
+    }
+
+    uint64_t EventWriter::dropped_count() const
+    {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    // Function to write the registered descriptors and the recorded events to the file
+    void EventWriter::write_pending()
+    {
+        {
+            std::lock_guard lock(descriptors_mutex);
+            for (const auto& descriptor : pending_descriptors)
+            {
+                encode_descriptor(descriptor, buffer);
+                field_counts[descriptor.id] = static_cast<uint8_t>(field_count(descriptor));
+            }
+
+            pending_descriptors.clear();
+        }
+
+        while (ring.try_pop([this](const EventRecord& event) {
+            encode_event(event, field_counts[event.id], buffer);
+        }))
+        {
+        }
+
+        const uint64_t dropped_now = dropped.load(std::memory_order_relaxed);
+        if (dropped_now != reported_dropped)
+        {
+            if (reported_dropped == 0)
+            {
+                encode_descriptor(DroppedEvents, buffer);
+                field_counts[DroppedEventsId] = 1;
+            }
+
+            EventRecord event;
+            event.id = DroppedEventsId;
+            event.thread_id = current_thread_id();
+            event.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+            event.fields[0] = static_cast<int64_t>(dropped_now - reported_dropped);
+            encode_event(event, 1, buffer);
+            reported_dropped = dropped_now;
+        }
+
+        if (!buffer.empty() && file.is_open())
+        {
+            file.write(buffer.data(), buffer.size());
+        }
+
+        buffer.clear();
+    }
+
+    void EventWriter::run()
+    {
+        std::unique_lock lock(flusher_mutex);
+        while (true)
+        {
+            wake.wait_for(lock, flush_interval, [this] { return wake_requested || stopping; });
+            wake_requested = false;
+            const bool stop = stopping;
+            const uint64_t request = flush_requests;
+            lock.unlock();
+
+            wake_pending.store(false, std::memory_order_release);
+            write_pending();
+            if ((request != flush_completions || stop) && file.is_open())
+            {
+                file.flush();
+            }
+
+            lock.lock();
+            flush_completions = request;
+            flushed.notify_all();
+            if (stop)
+            {
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include "log_ring_buffer.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Structured events for hot paths. An event is an id and up to four integers, which are recorded in a lock free ring buffer and written to a binary file
+// by a background thread, without any formatting on the thread which records them. The file contains the descriptors of its events, so that it can be decoded
+// offline (see log-event-decoder). Event ids only have to be unique within a process, since each process writes its own file
+namespace LogEvents
+{
+    constexpr size_t MaxFields = 4;
+
+    struct EventDescriptor
+    {
+        uint16_t id;
+        const char* name;
+
+        // Names of the fields, nullptr after the last one
+        std::array<const char*, MaxFields> fields;
+    };
+
+    struct EventRecord
+    {
+        uint16_t id = 0;
+        uint32_t thread_id = 0;
+
+        // Nanoseconds since the Unix epoch
+        int64_t timestamp = 0;
+        std::array<int64_t, MaxFields> fields{};
+    };
+
+    // Reserved for the number of events dropped because the ring was full
+    constexpr uint16_t DroppedEventsId = 0xFFFF;
+
+    // The file starts with the magic and the format version (u16), followed by blocks. All the integers are little endian.
+    // A descriptor block is the tag 'D', the id (u16), the field count (u8), the name and the field names, each as its length (u16) followed by its UTF-8 characters.
+    // An event block is the tag 'E', the id (u16), the thread id (u32), the timestamp (i64), and as many fields (i64) as its descriptor has
+    constexpr char FileMagic[4] = { 'P', 'T', 'E', 'V' };
+    constexpr uint16_t FormatVersion = 1;
+
+    size_t field_count(const EventDescriptor& descriptor);
+
+    void encode_header(std::string& output);
+    void encode_descriptor(const EventDescriptor& descriptor, std::string& output);
+    void encode_event(const EventRecord& event, size_t field_count, std::string& output);
+
+    struct DecodedEvent
+    {
+        std::string_view name;
+        uint32_t thread_id = 0;
+        int64_t timestamp = 0;
+        std::vector<std::pair<std::string_view, int64_t>> fields;
+    };
+
+    // Function to decode the content of an events file. Returns false if the data isn't an events file or is corrupted, after calling the callback for the events before the error
+    bool decode(std::string_view data, const std::function<void(const DecodedEvent&)>& callback);
+
+    // Function to format a decoded event as a line of text, with the timestamp in UTC
+    std::string format_event(const DecodedEvent& event);
+
+    // Records events from any thread and writes them to a file on a background thread. The background thread is joined when the writer is destroyed,
+    // which must not happen while a DLL is being unloaded
+    class EventWriter
+    {
+    public:
+        static constexpr size_t DefaultCapacity = 16384;
+        static constexpr std::chrono::milliseconds DefaultFlushInterval{ 100 };
+
+        explicit EventWriter(const std::filesystem::path& path, size_t capacity = DefaultCapacity, std::chrono::milliseconds flush_interval = DefaultFlushInterval);
+        ~EventWriter();
+
+        EventWriter(const EventWriter&) = delete;
+        EventWriter& operator=(const EventWriter&) = delete;
+
+        bool is_open() const;
+
+        // Function to record an event. Lock free, except the first time an event id is recorded. Events recorded while the ring is full are dropped and counted
+        void record(const EventDescriptor& descriptor, int64_t field0 = 0, int64_t field1 = 0, int64_t field2 = 0, int64_t field3 = 0) noexcept;
+
+        // Function to write the events recorded before the call to the file
+        void flush();
+
+        uint64_t dropped_count() const;
+
+    private:
+        void register_descriptor(const EventDescriptor& descriptor);
+        void run();
+        void write_pending();
+
+        std::ofstream file;
+        LogRingBuffer<EventRecord> ring;
+        std::chrono::milliseconds flush_interval;
+
+        // Whether the descriptor of each id was registered. Registration takes descriptors_mutex, and only happens once per id
+        std::unique_ptr<std::atomic_bool[]> registered;
+        std::mutex descriptors_mutex;
+        std::vector<EventDescriptor> pending_descriptors;
+
+        // Only used by the background thread
+        std::array<uint8_t, 0x10000> field_counts{};
+        std::string buffer;
+        uint64_t reported_dropped = 0;
+
+        std::atomic<uint64_t> dropped = 0;
+        std::atomic_bool wake_pending = false;
+
+        std::mutex flusher_mutex;
+        std::condition_variable wake;
+        std::condition_variable flushed;
+        bool wake_requested = false;
+        bool stopping = false;
+        uint64_t flush_requests = 0;
+        uint64_t flush_completions = 0;
+
+        std::thread flusher;
+    };
+}
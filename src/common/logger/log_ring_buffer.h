@@ -0,0 +1,109 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Bounded lock free queue for any number of producers and a single consumer. Each slot has a sequence number which tells whether it can be written
+// or read in the current lap of the ring, so producers only contend on the write position and never wait for each other or for the consumer.
+// The values are written and read in place, so a slot which owns memory (e.g. a string) keeps its capacity from one lap to the next
+template<typename T>
+class LogRingBuffer
+{
+public:
+    // The capacity is rounded up to a power of two
+    explicit LogRingBuffer(size_t capacity)
+    {
+        size_t size = 1;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+
+        slots = std::make_unique<Slot[]>(size);
+        mask = size - 1;
+        for (size_t i = 0; i < size; i++)
+        {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    LogRingBuffer(const LogRingBuffer&) = delete;
+    LogRingBuffer& operator=(const LogRingBuffer&) = delete;
+
+    // Function to write a value with fill(T&). Returns false without calling fill if the ring is full
+    template<typename Fill>
+    bool try_push(Fill&& fill)
+    {
+        size_t position = write_position.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Slot& slot = slots[position & mask];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (difference == 0)
+            {
+                if (write_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    fill(slot.value);
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                // The slot still holds the value of the previous lap
+                return false;
+            }
+            else
+            {
+                position = write_position.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Function to read the oldest value with consume(T&). Returns false if the ring is empty, or if the oldest value is still being written.
+    // Must only be called from the consumer thread
+    template<typename Consume>
+    bool try_pop(Consume&& consume)
+    {
+        const size_t position = read_position.load(std::memory_order_relaxed);
+        Slot& slot = slots[position & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+        {
+            return false;
+        }
+
+        consume(slot.value);
+        slot.sequence.store(position + mask + 1, std::memory_order_release);
+        read_position.store(position + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    size_t capacity() const
+    {
+        return mask + 1;
+    }
+
+    // Number of values which are written or being written, and not read yet. Only an estimate while producers or the consumer are running
+    size_t size_approx() const
+    {
+        const size_t write = write_position.load(std::memory_order_relaxed);
+        const size_t read = read_position.load(std::memory_order_relaxed);
+        return write > read ? write - read : 0;
+    }
+
+private:
+    struct alignas(64) Slot
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask = 0;
+
+    // On separate cache lines, since the producers write one and the consumer the other
+    alignas(64) std::atomic<size_t> write_position = 0;
+    alignas(64) std::atomic<size_t> read_position = 0;
+};
@@ -3,6 +3,8 @@
 #include "pch.h"
 #include "framework.h"
 #include "logger.h"
+#include "async_sink.h"
+#include <filesystem>
 #include <map>
 #include <spdlog/sinks/daily_file_sink.h>
 #include <spdlog/sinks/msvc_sink.h>
@@ -39,6 +41,27 @@ level_enum getLogLevel(std::wstring_view logSettingsPath)
 }
 
 std::shared_ptr<spdlog::logger> Logger::logger = spdlog::null_logger_mt("null");
+std::unique_ptr<LogEvents::EventWriter> Logger::eventWriter;
+
+namespace
+{
+    // The events of the previous run are kept next to the ones of this run, since they're the ones needed after a crash
+    std::unique_ptr<LogEvents::EventWriter> create_event_writer(const std::wstring& logFilePath)
+    {
+        std::filesystem::path eventsPath(logFilePath);
+        const auto stem = eventsPath.stem().wstring();
+        eventsPath.replace_filename(stem + L"-events.bin");
+
+        auto previousPath = eventsPath;
+        previousPath.replace_filename(stem + L"-events.previous.bin");
+
+        std::error_code error;
+        std::filesystem::rename(eventsPath, previousPath, error);
+
+        auto writer = std::make_unique<LogEvents::EventWriter>(eventsPath);
+        return writer->is_open() ? std::move(writer) : nullptr;
+    }
+}
 
 bool Logger::wasLogFailedShown()
 {
@@ -49,12 +72,18 @@ bool Logger::wasLogFailedShown()
     return len;
 }
 
-void Logger::init(std::string loggerName, std::wstring logFilePath, std::wstring_view logSettingsPath)
+void Logger::init(std::string loggerName, std::wstring logFilePath, std::wstring_view logSettingsPath, Mode mode)
 {
     auto logLevel = getLogLevel(logSettingsPath);
     try
     {
-        auto sink = make_shared<daily_file_sink_mt>(logFilePath, 0, 0, false, LogSettings::retention);
+        spdlog::sink_ptr sink = make_shared<daily_file_sink_mt>(logFilePath, 0, 0, false, LogSettings::retention);
+        if (mode == Mode::Asynchronous)
+        {
+            sink = make_shared<AsyncSink>(sink);
+            eventWriter = create_event_writer(logFilePath);
+        }
+
         if (IsDebuggerPresent())
         {
             auto msvc_sink = make_shared<msvc_sink_mt>();
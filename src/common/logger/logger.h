@@ -1,63 +1,155 @@
 #pragma once
 #include <spdlog/spdlog.h>
 #include "logger_settings.h"
+#include "log_events.h"
+
+// Messages below this level are removed at compile time. Define it to one of the SPDLOG_LEVEL_ values in a project to remove the trace or debug messages of its hot paths.
+// The Logger functions still evaluate their arguments when their level is removed or filtered, the POWERTOYS_LOG_TRACE and POWERTOYS_LOG_DEBUG macros below don't
+#ifndef POWERTOYS_LOG_ACTIVE_LEVEL
+#define POWERTOYS_LOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+#endif
 
 class Logger
 {
 private:
     inline const static std::wstring logFailedShown = L"logFailedShown";
     static std::shared_ptr<spdlog::logger> logger;
+    static std::unique_ptr<LogEvents::EventWriter> eventWriter;
     static bool wasLogFailedShown();
 
 public:
+    enum class Mode
+    {
+        Synchronous,
+
+        // Messages are written by a background thread (see async_sink.h), and structured events are recorded to a binary file next to the log.
+        // Only for executables, since the background threads are joined when the logger is destroyed, which can't happen while a DLL is unloaded
+        Asynchronous
+    };
+
     Logger() = delete;
 
-    static void init(std::string loggerName, std::wstring logFilePath, std::wstring_view logSettingsPath);
+    static void init(std::string loggerName, std::wstring logFilePath, std::wstring_view logSettingsPath, Mode mode = Mode::Synchronous);
+
+    static constexpr bool is_compiled(spdlog::level::level_enum level)
+    {
+        return level >= POWERTOYS_LOG_ACTIVE_LEVEL;
+    }
+
+    // Function to check whether messages of a level are written, so that a hot path can skip building them
+    static bool should_log(spdlog::level::level_enum level)
+    {
+        return is_compiled(level) && logger->should_log(level);
+    }
+
+    // Function to record a structured event. Does nothing unless the logger is asynchronous
+    static void event(const LogEvents::EventDescriptor& descriptor, int64_t field0 = 0, int64_t field1 = 0, int64_t field2 = 0, int64_t field3 = 0) noexcept
+    {
+        if (eventWriter)
+        {
+            eventWriter->record(descriptor, field0, field1, field2, field3);
+        }
+    }
 
     // log message should not be localized
     template<typename FormatString, typename... Args>
     static void trace(const FormatString& fmt, const Args&... args)
     {
-        logger->trace(fmt, args...);
+        if constexpr (POWERTOYS_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE)
+        {
+            logger->trace(fmt, args...);
+        }
     }
 
     // log message should not be localized
     template<typename FormatString, typename... Args>
     static void debug(const FormatString& fmt, const Args&... args)
     {
-        logger->debug(fmt, args...);
+        if constexpr (POWERTOYS_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG)
+        {
+            logger->debug(fmt, args...);
+        }
     }
 
     // log message should not be localized
     template<typename FormatString, typename... Args>
     static void info(const FormatString& fmt, const Args&... args)
     {
-        logger->info(fmt, args...);
+        if constexpr (POWERTOYS_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO)
+        {
+            logger->info(fmt, args...);
+        }
     }
 
     // log message should not be localized
     template<typename FormatString, typename... Args>
     static void warn(const FormatString& fmt, const Args&... args)
     {
-        logger->warn(fmt, args...);
+        if constexpr (POWERTOYS_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_WARN)
+        {
+            logger->warn(fmt, args...);
+        }
     }
 
     // log message should not be localized
     template<typename FormatString, typename... Args>
     static void error(const FormatString& fmt, const Args&... args)
     {
-        logger->error(fmt, args...);
+        if constexpr (POWERTOYS_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_ERROR)
+        {
+            logger->error(fmt, args...);
+        }
     }
 
     // log message should not be localized
     template<typename FormatString, typename... Args>
     static void critical(const FormatString& fmt, const Args&... args)
     {
-        logger->critical(fmt, args...);
+        if constexpr (POWERTOYS_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_CRITICAL)
+        {
+            logger->critical(fmt, args...);
+        }
     }
 
     static void flush()
     {
         logger->flush();
+        if (eventWriter)
+        {
+            eventWriter->flush();
+        }
     }
 };
+
+// Trace and debug messages for hot paths. The arguments are only evaluated when the message is written, and the statement is removed when the level is compiled out
+#if POWERTOYS_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+#define POWERTOYS_LOG_TRACE(...)                      \
+    do                                                \
+    {                                                 \
+        if (Logger::should_log(spdlog::level::trace)) \
+        {                                             \
+            Logger::trace(__VA_ARGS__);               \
+        }                                             \
+    } while (0)
+#else
+#define POWERTOYS_LOG_TRACE(...) \
+    do                           \
+    {                            \
+    } while (0)
+#endif
+
+#if POWERTOYS_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define POWERTOYS_LOG_DEBUG(...)                      \
+    do                                                \
+    {                                                 \
+        if (Logger::should_log(spdlog::level::debug)) \
+        {                                             \
+            Logger::debug(__VA_ARGS__);               \
+        }                                             \
+    } while (0)
+#else
+#define POWERTOYS_LOG_DEBUG(...) \
+    do                           \
+    {                            \
+    } while (0)
+#endif
@@ -81,7 +81,7 @@ namespace LoggerHelpers
         return result;
     }
 
-    inline void init_logger(std::wstring moduleName, std::wstring internalPath, std::string loggerName)
+    inline void init_logger(std::wstring moduleName, std::wstring internalPath, std::string loggerName, Logger::Mode mode = Logger::Mode::Synchronous)
     {
         std::filesystem::path rootFolder(PTSettingsHelper::get_module_save_folder_location(moduleName));
         rootFolder.append(internalPath);
@@ -92,7 +92,7 @@ namespace LoggerHelpers
 
         auto logsPath = currentFolder;
         logsPath.append(L"log.txt");
-        Logger::init(loggerName, logsPath.wstring(), PTSettingsHelper::get_log_settings_file_location());
+        Logger::init(loggerName, logsPath.wstring(), PTSettingsHelper::get_log_settings_file_location(), mode);
 
         delete_other_versions_log_folders(rootFolder.wstring(), currentFolder); 
     }
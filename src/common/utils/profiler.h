@@ -0,0 +1,442 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <ShlObj.h>
+#include <TlHelp32.h>
+#include <common/interop/shared_constants.h>
+#else
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Scoped timing for hot paths. POWERTOYS_PROFILE_SCOPE records the duration of the enclosing scope into a buffer of the current thread, which keeps
+// the last SpansPerThread spans, so the recording stays on like a flight recorder and costs two clock reads and a few stores per scope.
+// Only the threads which called RegisterCurrentThread record their scopes, so that a scope never allocates or takes a lock.
+// The spans of all the threads of a process are exported as Chrome trace event JSON, which can be opened in chrome://tracing or https://ui.perfetto.dev.
+// The runner asks every process with an ExportListener to write its trace to the traces folder (see request_export).
+// Define POWERTOYS_PROFILER_DISABLED in a project to remove the scopes at compile time
+#define POWERTOYS_PROFILE_CONCAT_IMPL(a, b) a##b
+#define POWERTOYS_PROFILE_CONCAT(a, b) POWERTOYS_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef POWERTOYS_PROFILER_DISABLED
+#define POWERTOYS_PROFILE_SCOPE(name)
+#else
+// The name must be a string literal or have static storage duration, since only the pointer is recorded
+#define POWERTOYS_PROFILE_SCOPE(name) Profiler::Zone POWERTOYS_PROFILE_CONCAT(profilerZone, __LINE__)(name)
+#endif
+
+namespace Profiler
+{
+    // Number of spans kept per thread. Must be a power of two
+    constexpr size_t SpansPerThread = 8192;
+
+    // Buffers of exited threads are kept so that their spans can be exported, and given to new threads above this count
+    constexpr size_t MaxRetiredBuffers = 16;
+
+    // Nanoseconds of a monotonic clock. On Windows it's the performance counter, which is the same in all the processes, so their traces can be compared
+    inline int64_t now_ns() noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    inline uint32_t current_thread_id() noexcept
+    {
+#ifdef _WIN32
+        return static_cast<uint32_t>(GetCurrentThreadId());
+#else
+        return static_cast<uint32_t>(::syscall(SYS_gettid));
+#endif
+    }
+
+    inline uint32_t current_process_id() noexcept
+    {
+#ifdef _WIN32
+        return static_cast<uint32_t>(GetCurrentProcessId());
+#else
+        return static_cast<uint32_t>(::getpid());
+#endif
+    }
+
+    struct Span
+    {
+        const char* name = nullptr;
+        uint32_t thread_id = 0;
+        int64_t start_ns = 0;
+        int64_t duration_ns = 0;
+    };
+
+    namespace details
+    {
+        struct SpanSlot
+        {
+            std::atomic<const char*> name = nullptr;
+            std::atomic<int64_t> start_ns = 0;
+            std::atomic<int64_t> duration_ns = 0;
+        };
+
+        // Written by its thread only. The exporter copies the spans, then discards the ones which the thread may have overwritten during the copy
+        struct ThreadBuffer
+        {
+            uint32_t thread_id = 0;
+            std::atomic_bool retired = false;
+            std::atomic<uint64_t> write_index = 0;
+            std::array<SpanSlot, SpansPerThread> spans;
+        };
+
+        struct Registry
+        {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+        };
+
+        inline std::atomic_bool enabled = true;
+
+        // Never destroyed, since threads can exit after the static objects were destroyed
+        inline Registry& registry()
+        {
+            static Registry* instance = new Registry();
+            return *instance;
+        }
+
+        inline ThreadBuffer* acquire_thread_buffer() noexcept
+        {
+            try
+            {
+                auto& instance = registry();
+                std::lock_guard lock(instance.mutex);
+
+                const auto retired_count = std::count_if(instance.buffers.begin(), instance.buffers.end(), [](const auto& buffer) {
+                    return buffer->retired.load(std::memory_order_acquire);
+                });
+
+                if (static_cast<size_t>(retired_count) >= MaxRetiredBuffers)
+                {
+                    const auto reused = std::find_if(instance.buffers.begin(), instance.buffers.end(), [](const auto& buffer) {
+                        return buffer->retired.load(std::memory_order_acquire);
+                    });
+
+                    (*reused)->thread_id = current_thread_id();
+                    (*reused)->write_index.store(0, std::memory_order_relaxed);
+                    (*reused)->retired.store(false, std::memory_order_relaxed);
+                    return reused->get();
+                }
+
+                auto buffer = std::make_unique<ThreadBuffer>();
+                buffer->thread_id = current_thread_id();
+                instance.buffers.push_back(std::move(buffer));
+                return instance.buffers.back().get();
+            }
+            catch (...)
+            {
+                return nullptr;
+            }
+        }
+
+        struct ThreadBufferHolder
+        {
+            ThreadBuffer* buffer = nullptr;
+
+            ~ThreadBufferHolder()
+            {
+                if (buffer)
+                {
+                    buffer->retired.store(true, std::memory_order_release);
+                }
+            }
+        };
+
+        inline ThreadBufferHolder& thread_buffer_holder() noexcept
+        {
+            thread_local ThreadBufferHolder holder;
+            return holder;
+        }
+
+        inline void record(const char* name, int64_t start_ns, int64_t end_ns) noexcept
+        {
+            auto buffer = thread_buffer_holder().buffer;
+            if (!buffer)
+            {
+                return;
+            }
+
+            const uint64_t index = buffer->write_index.load(std::memory_order_relaxed);
+            auto& slot = buffer->spans[index & (SpansPerThread - 1)];
+            slot.name.store(name, std::memory_order_relaxed);
+            slot.start_ns.store(start_ns, std::memory_order_relaxed);
+            slot.duration_ns.store(end_ns - start_ns, std::memory_order_relaxed);
+            buffer->write_index.store(index + 1, std::memory_order_release);
+        }
+
+        inline void append_json_string(std::string_view text, std::string& output)
+        {
+            output += '"';
+            for (const char c : text)
+            {
+                if (c == '"' || c == '\\')
+                {
+                    output += '\\';
+                    output += c;
+                }
+                else if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    output += escaped;
+                }
+                else
+                {
+                    output += c;
+                }
+            }
+
+            output += '"';
+        }
+
+        // Chrome traces are in microseconds, the three decimals keep the nanoseconds
+        inline void append_microseconds(int64_t ns, std::string& output)
+        {
+            char text[32];
+            std::snprintf(text, sizeof(text), "%lld.%03lld", static_cast<long long>(ns / 1000), static_cast<long long>(ns % 1000));
+            output += text;
+        }
+    }
+
+    // Function to give the current thread a buffer for its spans, before it runs the scopes to record, e.g. when a hook is installed.
+    // The scopes of the threads which didn't call it aren't recorded. Returns false if the buffer couldn't be allocated
+    inline bool RegisterCurrentThread() noexcept
+    {
+        auto& holder = details::thread_buffer_holder();
+        if (!holder.buffer)
+        {
+            holder.buffer = details::acquire_thread_buffer();
+        }
+
+        return holder.buffer != nullptr;
+    }
+
+    // Function to stop or restart the recording at runtime. Scopes which started while the recording was stopped aren't recorded
+    inline void set_enabled(bool enabled) noexcept
+    {
+        details::enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    class Zone
+    {
+    public:
+        explicit Zone(const char* name) noexcept :
+            name(name), start_ns(details::enabled.load(std::memory_order_relaxed) ? now_ns() : -1)
+        {
+        }
+
+        ~Zone()
+        {
+            if (start_ns >= 0)
+            {
+                details::record(name, start_ns, now_ns());
+            }
+        }
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+    private:
+        const char* name;
+        int64_t start_ns;
+    };
+
+    // Function to copy the spans recorded by all the threads of the process, ordered by start time
+    inline std::vector<Span> collect_spans()
+    {
+        std::vector<Span> result;
+        auto& instance = details::registry();
+        std::lock_guard lock(instance.mutex);
+        for (const auto& buffer : instance.buffers)
+        {
+            const bool retired = buffer->retired.load(std::memory_order_acquire);
+            const uint64_t end = buffer->write_index.load(std::memory_order_acquire);
+            const uint64_t begin = end > SpansPerThread ? end - SpansPerThread : 0;
+            const size_t first = result.size();
+            for (uint64_t index = begin; index < end; index++)
+            {
+                const auto& slot = buffer->spans[index & (SpansPerThread - 1)];
+                result.push_back({ slot.name.load(std::memory_order_relaxed), buffer->thread_id, slot.start_ns.load(std::memory_order_relaxed), slot.duration_ns.load(std::memory_order_relaxed) });
+            }
+
+            // Spans which the thread may have overwritten while they were copied are discarded
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint64_t end_after_copy = buffer->write_index.load(std::memory_order_relaxed);
+            if (!retired && end_after_copy - begin >= SpansPerThread)
+            {
+                const uint64_t overwritten = std::min<uint64_t>(end_after_copy - begin - SpansPerThread + 1, result.size() - first);
+                result.erase(result.begin() + first, result.begin() + first + overwritten);
+            }
+        }
+
+        std::sort(result.begin(), result.end(), [](const Span& a, const Span& b) { return a.start_ns < b.start_ns; });
+        return result;
+    }
+
+    // Function to format spans as Chrome trace event JSON, with one complete event per span
+    inline std::string format_chrome_trace(const std::vector<Span>& spans, std::string_view process_name, uint32_t process_id = current_process_id())
+    {
+        const std::string pid = std::to_string(process_id);
+        std::string result;
+        result.reserve(128 + spans.size() * 96);
+        result += "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" + pid + ",\"tid\":0,\"args\":{\"name\":";
+        details::append_json_string(process_name, result);
+        result += "}}";
+
+        for (const auto& span : spans)
+        {
+            result += ",\n{\"name\":";
+            details::append_json_string(span.name ? span.name : "", result);
+            result += ",\"cat\":\"PowerToys\",\"ph\":\"X\",\"ts\":";
+            details::append_microseconds(span.start_ns, result);
+            result += ",\"dur\":";
+            details::append_microseconds(span.duration_ns, result);
+            result += ",\"pid\":" + pid + ",\"tid\":" + std::to_string(span.thread_id) + "}";
+        }
+
+        result += "]}\n";
+        return result;
+    }
+
+    // Function to write the spans of the process to a Chrome trace file. Returns false if the file couldn't be written
+    inline bool write_chrome_trace(const std::filesystem::path& path, std::string_view process_name)
+    {
+        const std::string trace = format_chrome_trace(collect_spans(), process_name);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(trace.data(), trace.size());
+        return file.good();
+    }
+
+#ifdef _WIN32
+    // Path of the folder where the processes write their traces: %LOCALAPPDATA%\Microsoft\PowerToys\Traces
+    inline std::filesystem::path traces_folder()
+    {
+        PWSTR local_app_data = nullptr;
+        std::filesystem::path result;
+        if (SUCCEEDED(SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, nullptr, &local_app_data)))
+        {
+            result = std::filesystem::path(local_app_data) / CommonSharedConstants::APPDATA_PATH / L"Traces";
+        }
+
+        CoTaskMemFree(local_app_data);
+        return result;
+    }
+
+    // Name of the auto-reset event on which the ExportListener of a process waits
+    inline std::wstring export_event_name(uint32_t process_id)
+    {
+        return std::wstring(CommonSharedConstants::PROFILER_EXPORT_EVENT) + L"-" + std::to_wstring(process_id);
+    }
+
+    // Function to ask every process with an ExportListener to write its trace to the traces folder. Each listener has its own auto-reset event,
+    // so the wait of the listener resets it. Returns false if no listener was found
+    inline bool request_export()
+    {
+        HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+        if (snapshot == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        bool requested = false;
+        PROCESSENTRY32W process{};
+        process.dwSize = sizeof(process);
+        for (BOOL found = Process32FirstW(snapshot, &process); found; found = Process32NextW(snapshot, &process))
+        {
+            HANDLE event = OpenEventW(EVENT_MODIFY_STATE, false, export_event_name(process.th32ProcessID).c_str());
+            if (event)
+            {
+                requested = SetEvent(event) || requested;
+                CloseHandle(event);
+            }
+        }
+
+        CloseHandle(snapshot);
+        return requested;
+    }
+
+    // Writes the trace of the process to <traces folder>\<process name>-<pid>.json each time an export is requested.
+    // The thread is joined when the listener is destroyed, which must not happen while a DLL is being unloaded
+    class ExportListener
+    {
+    public:
+        explicit ExportListener(std::wstring process_name) :
+            process_name(std::move(process_name))
+        {
+            export_event = CreateEventW(nullptr, false, false, export_event_name(current_process_id()).c_str());
+            exit_event = CreateEventW(nullptr, true, false, nullptr);
+            if (export_event && exit_event)
+            {
+                listener = std::thread([this] { run(); });
+            }
+        }
+
+        ExportListener(const ExportListener&) = delete;
+        ExportListener& operator=(const ExportListener&) = delete;
+
+        ~ExportListener()
+        {
+            if (listener.joinable())
+            {
+                SetEvent(exit_event);
+                listener.join();
+            }
+
+            if (export_event)
+            {
+                CloseHandle(export_event);
+            }
+
+            if (exit_event)
+            {
+                CloseHandle(exit_event);
+            }
+        }
+
+    private:
+        void run()
+        {
+            HANDLE events[2] = { exit_event, export_event };
+            while (WaitForMultipleObjects(2, events, false, INFINITE) == WAIT_OBJECT_0 + 1)
+            {
+                const auto folder = traces_folder();
+                std::error_code error;
+                if (!folder.empty())
+                {
+                    std::filesystem::create_directories(folder, error);
+                }
+
+                if (!folder.empty() && !error)
+                {
+                    const auto file_name = process_name + L"-" + std::to_wstring(current_process_id()) + L".json";
+                    write_chrome_trace(folder / file_name, std::filesystem::path(process_name).string());
+                }
+            }
+        }
+
+        std::wstring process_name;
+        HANDLE export_event = nullptr;
+        HANDLE exit_event = nullptr;
+        std::thread listener;
+    };
+#endif
+}
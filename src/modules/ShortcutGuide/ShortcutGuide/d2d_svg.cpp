@@ -49,8 +49,16 @@ D2DSVG& D2DSVG::resize(int x, int y, int width, int height, float fill, float ma
 
 D2DSVG& D2DSVG::recolor(uint32_t oldcolor, uint32_t newcolor)
 {
-    auto new_color = D2D1::ColorF(newcolor & 0xFFFFFF, 1);
-    auto old_color = D2D1::ColorF(oldcolor & 0xFFFFFF, 1);
+    return recolor({ { oldcolor, newcolor } });
+}
+
+D2DSVG& D2DSVG::recolor(const std::vector<std::pair<uint32_t, uint32_t>>& colors)
+{
+    std::vector<std::pair<D2D1_COLOR_F, D2D1_COLOR_F>> replacements;
+    for (const auto& [oldcolor, newcolor] : colors)
+    {
+        replacements.emplace_back(D2D1::ColorF(oldcolor & 0xFFFFFF, 1), D2D1::ColorF(newcolor & 0xFFFFFF, 1));
+    }
     std::function<void(ID2D1SvgElement * element)> recurse = [&](ID2D1SvgElement* element) {
         if (!element)
             return;
@@ -60,9 +68,13 @@ D2DSVG& D2DSVG::recolor(uint32_t oldcolor, uint32_t newcolor)
             winrt::com_ptr<ID2D1SvgPaint> paint;
             element->GetAttributeValue(L"fill", paint.put());
             paint->GetColor(&elem_fill);
-            if (elem_fill.r == old_color.r && elem_fill.g == old_color.g && elem_fill.b == old_color.b)
+            for (const auto& [old_color, new_color] : replacements)
             {
-                winrt::check_hresult(element->SetAttributeValue(L"fill", new_color));
+                if (elem_fill.r == old_color.r && elem_fill.g == old_color.g && elem_fill.b == old_color.b)
+                {
+                    winrt::check_hresult(element->SetAttributeValue(L"fill", new_color));
+                    break;
+                }
             }
         }
         winrt::com_ptr<ID2D1SvgElement> sub;
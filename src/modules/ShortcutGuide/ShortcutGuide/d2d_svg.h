@@ -3,6 +3,8 @@
 #include <d2d1_3helper.h>
 #include <winrt/base.h>
 #include <string>
+#include <utility>
+#include <vector>
 
 class D2DSVG
 {
@@ -11,6 +13,8 @@ public:
     D2DSVG& resize(int x, int y, int width, int height, float fill, float max_scale = -1.0f);
     D2DSVG& render(ID2D1DeviceContext5* d2d_dc);
     D2DSVG& recolor(uint32_t oldcolor, uint32_t newcolor);
+    // Replaces each old color by its new color in a single walk of the document. The first matching pair wins
+    D2DSVG& recolor(const std::vector<std::pair<uint32_t, uint32_t>>& colors);
     float get_scale() const { return used_scale; }
     int width() const { return svg_width; }
     int height() const { return svg_height; }
@@ -36,6 +36,7 @@ void D2DWindow::show(UINT x, UINT y, UINT width, UINT height)
     }
     base_resize(width, height);
     render_empty();
+    frame_stats = {};
     hidden = false;
     on_show();
     SetWindowPos(hwnd, HWND_TOPMOST, x, y, width, height, 0);
@@ -156,9 +157,14 @@ void D2DWindow::base_render()
     std::unique_lock lock(mutex);
     if (!initialized || !d2d_dc || !d2d_bitmap)
         return;
+    auto frame_start = std::chrono::steady_clock::now();
     d2d_dc->BeginDraw();
     render(d2d_dc.get());
     winrt::check_hresult(d2d_dc->EndDraw());
+    auto frame_time = std::chrono::steady_clock::now() - frame_start;
+    frame_stats.count++;
+    frame_stats.total += frame_time;
+    frame_stats.slowest = std::max(frame_stats.slowest, frame_time);
     winrt::check_hresult(dxgi_swap_chain->Present(1, 0));
     winrt::check_hresult(composition_device->Commit());
 }
@@ -204,6 +210,9 @@ LRESULT __stdcall D2DWindow::d2d_window_proc(HWND window, UINT message, WPARAM w
     case WM_PAINT:
         self->base_render();
         return 0;
+    case WM_DISPLAYCHANGE:
+        self->on_display_change();
+        return DefWindowProc(window, message, wparam, lparam);
 
     default:
         return DefWindowProc(window, message, wparam, lparam);
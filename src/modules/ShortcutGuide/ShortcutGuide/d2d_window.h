@@ -11,6 +11,7 @@
 #include <string>
 #include "d2d_svg.h"
 
+#include <chrono>
 #include <functional>
 #include <optional>
 
@@ -36,6 +37,8 @@ protected:
     // on_show, on_hide - called when the window is about to be shown or about to be hidden
     virtual void on_show() = 0;
     virtual void on_hide() = 0;
+    // on_display_change - called when the resolution or the layout of the monitors changed
+    virtual void on_display_change() = 0;
 
     static LRESULT __stdcall d2d_window_proc(HWND window, UINT message, WPARAM wparam, LPARAM lparam);
     static D2DWindow* this_from_hwnd(HWND window);
@@ -45,6 +48,14 @@ protected:
     void base_render();
     void render_empty();
 
+    // Time spent drawing the frames since the window was shown, from BeginDraw to EndDraw
+    struct FrameStats
+    {
+        uint64_t count = 0;
+        std::chrono::steady_clock::duration total{};
+        std::chrono::steady_clock::duration slowest{};
+    } frame_stats;
+
     std::recursive_mutex mutex;
     bool hidden = true;
     bool initialized = false;
@@ -10,6 +10,8 @@
 #include "trace.h"
 #include "Generated Files/resource.h"
 
+#include <cmath>
+
 namespace
 {
     // Gets position of given window.
@@ -40,6 +42,14 @@ namespace
         RESTORED
     };
 
+    // Each atlas is about the size of the overlay, the oldest ones are dropped after a few window sizes or themes
+    constexpr size_t MaxOverlayAtlases = 16;
+
+    long long microseconds_between(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    }
+
     inline WindowState get_window_state(HWND hwnd)
     {
         WINDOWPLACEMENT placement;
@@ -268,70 +278,111 @@ D2D1_RECT_F D2DOverlaySVG::get_snap_right() const
 }
 
 D2DOverlayWindow::D2DOverlayWindow() :
-    total_screen({}), animation(0.3), D2DWindow()
+    total_screen({}), primary_screen({}), animation(0.3), D2DWindow()
 {
-    tasklist_thread = std::thread([&] {
-        while (running)
-        {
-            // Removing <std::mutex> causes C3538 on std::unique_lock lock(mutex); in show(..)
-            std::unique_lock<std::mutex> lock(tasklist_cv_mutex);
-            tasklist_cv.wait(lock, [&] { return !running || tasklist_update; });
-            if (!running)
-                return;
-            lock.unlock();
-            while (running && tasklist_update)
-            {
-                std::vector<TasklistButton> buttons;
-                if (tasklist.update_buttons(buttons))
-                {
-                    std::unique_lock lock(mutex);
-                    tasklist_buttons.swap(buttons);
-                }
-                std::this_thread::sleep_for(std::chrono::milliseconds(500));
-            }
-        }
-    });
 }
 
 void D2DOverlayWindow::show(HWND active_window, bool snappable)
 {
+    const auto show_time = std::chrono::steady_clock::now();
+
+    // Check if taskbar is auto-hidden. If so, don't display the number arrows
+    APPBARDATA param = {};
+    param.cbSize = sizeof(APPBARDATA);
+    const bool taskbar_auto_hidden = (UINT)SHAppBarMessage(ABM_GETSTATE, &param) == ABS_AUTOHIDE;
+
     std::unique_lock lock(mutex);
     hidden = false;
+    show_requested_time = show_time;
+    first_frame_pending = true;
+    first_buttons_frame_pending = !taskbar_auto_hidden;
+
+    // The taskbar buttons are kept up to date in the background, so their last positions are shown right away
+    show_tasklist_buttons = !taskbar_auto_hidden;
     tasklist_buttons.clear();
+    tasklist_version = 0;
+    if (show_tasklist_buttons)
+    {
+        tasklist.get_buttons(tasklist_buttons, tasklist_version);
+    }
     this->active_window = active_window;
     this->active_window_snappable = snappable;
-    auto old_bck = colors.start_color_menu;
-    auto colors_updated = colors.update();
-    auto new_light_mode = (theme_setting == Light) || (theme_setting == System && colors.light_mode);
-    if (initialized && (colors_updated || light_mode != new_light_mode))
-    {
-        // update background colors
-        landscape.recolor(old_bck, colors.start_color_menu);
-        portrait.recolor(old_bck, colors.start_color_menu);
-        for (auto& arrow : arrows)
-        {
-            arrow.recolor(old_bck, colors.start_color_menu);
-        }
-        light_mode = new_light_mode;
-        if (light_mode)
-        {
-            landscape.recolor(0xDDDDDD, 0x222222);
-            portrait.recolor(0xDDDDDD, 0x222222);
-            for (auto& arrow : arrows)
-            {
-                arrow.recolor(0xDDDDDD, 0x222222);
-            }
-        }
-        else
+    colors.update();
+    light_mode = (theme_setting == Light) || (theme_setting == System && colors.light_mode);
+    if (initialized)
+    {
+        // The SVGs of a theme which was already used are swapped in, the resize done by D2DWindow::show applies the layout to them
+        current_theme = &get_theme_svgs(colors.start_color_menu, light_mode);
+    }
+    const auto theme_time = std::chrono::steady_clock::now();
+
+    if (!monitors_valid)
+    {
+        update_monitors();
+    }
+    const auto monitors_time = std::chrono::steady_clock::now();
+
+    if (active_window)
+    {
+        // Ignore errors, if this fails we will just not show the thumbnail
+        DwmRegisterThumbnail(hwnd, active_window, &thumbnail);
+    }
+    animation.reset();
+    auto screen = primary_screen;
+    shown_start_time = std::chrono::steady_clock::now();
+    lock.unlock();
+    D2DWindow::show(screen.left(), screen.top(), screen.width(), screen.height());
+    const auto window_time = std::chrono::steady_clock::now();
+
+    Logger::trace(L"Show took {} us: theme {} us, monitors {} us, thumbnail {} us, window {} us",
+                  microseconds_between(show_time, window_time),
+                  microseconds_between(show_time, theme_time),
+                  microseconds_between(theme_time, monitors_time),
+                  microseconds_between(monitors_time, shown_start_time),
+                  microseconds_between(shown_start_time, window_time));
+}
+
+// Function to get the SVGs recolored for a theme, loading and recoloring them the first time the theme is used
+OverlayThemeSVGs& D2DOverlayWindow::get_theme_svgs(uint32_t background_color, bool light_mode)
+{
+    for (auto& theme : themes)
+    {
+        if (theme->background_color == background_color && theme->light_mode == light_mode)
         {
-            landscape.recolor(0x222222, 0xDDDDDD);
-            portrait.recolor(0x222222, 0xDDDDDD);
-            for (auto& arrow : arrows)
-            {
-                arrow.recolor(0x222222, 0xDDDDDD);
-            }
+            return *theme;
         }
     }
+
+    // The SVGs have black backgrounds and 0x222222 text, which get the accent color and the text color of the theme in a single walk
+    std::vector<std::pair<uint32_t, uint32_t>> theme_colors = { { 0x000000, background_color } };
+    if (!light_mode)
+    {
+        theme_colors.emplace_back(0x222222, 0xDDDDDD);
+    }
+
+    auto theme = std::make_unique<OverlayThemeSVGs>();
+    theme->background_color = background_color;
+    theme->light_mode = light_mode;
+    theme->landscape.load(L"svgs\\overlay.svg", d2d_dc.get())
+        .find_thumbnail(L"path-1")
+        .find_window_group(L"Group-1")
+        .recolor(theme_colors);
+    theme->portrait.load(L"svgs\\overlay_portrait.svg", d2d_dc.get())
+        .find_thumbnail(L"path-1")
+        .find_window_group(L"Group-1")
+        .recolor(theme_colors);
+    theme->arrows.resize(10);
+    for (unsigned i = 0; i < theme->arrows.size(); ++i)
+    {
+        theme->arrows[i].load(L"svgs\\" + std::to_wstring((i + 1) % 10) + L".svg", d2d_dc.get()).recolor(theme_colors);
+    }
+    themes.push_back(std::move(theme));
+    return *themes.back();
+}
+
+// Function to query the monitors and the rect covering all of them
+void D2DOverlayWindow::update_monitors()
+{
     monitors = MonitorInfo::GetMonitors(true);
     // calculate the rect covering all the screens
     total_screen = ScreenSize(monitors[0].rect);
@@ -349,27 +400,8 @@ void D2DOverlayWindow::show(HWND active_window, bool snappable)
     total_screen.rect.right += monitor_dx;
     total_screen.rect.top += monitor_dy;
     total_screen.rect.bottom += monitor_dy;
-    tasklist.update();
-    if (active_window)
-    {
-        // Ignore errors, if this fails we will just not show the thumbnail
-        DwmRegisterThumbnail(hwnd, active_window, &thumbnail);
-    }
-    animation.reset();
-    auto primary_screen = MonitorInfo::GetPrimaryMonitor();
-    shown_start_time = std::chrono::steady_clock::now();
-    lock.unlock();
-    D2DWindow::show(primary_screen.left(), primary_screen.top(), primary_screen.width(), primary_screen.height());
-    // Check if taskbar is auto-hidden. If so, don't display the number arrows
-    APPBARDATA param = {};
-    param.cbSize = sizeof(APPBARDATA);
-    if ((UINT)SHAppBarMessage(ABM_GETSTATE, &param) != ABS_AUTOHIDE)
-    {
-        tasklist_cv_mutex.lock();
-        tasklist_update = true;
-        tasklist_cv_mutex.unlock();
-        tasklist_cv.notify_one();
-    }
+    primary_screen = MonitorInfo::GetPrimaryMonitor();
+    monitors_valid = true;
 }
 
 void D2DOverlayWindow::on_show()
@@ -380,10 +412,7 @@ void D2DOverlayWindow::on_show()
 void D2DOverlayWindow::on_hide()
 {
     Logger::trace("D2DOverlayWindow::on_hide()");
-    tasklist_cv_mutex.lock();
-    tasklist_update = false;
-    tasklist_cv_mutex.unlock();
-    tasklist_cv.notify_one();
+    show_tasklist_buttons = false;
     if (thumbnail)
     {
         DwmUnregisterThumbnail(thumbnail);
@@ -394,18 +423,23 @@ void D2DOverlayWindow::on_hide()
     {
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(shown_end_time - shown_start_time).count();
         Logger::trace(L"Duration: {}. Close Type: {}", duration, windowCloseType);
+        if (frame_stats.count > 0)
+        {
+            Logger::trace(L"Rendered {} frames from the {}: average {} us, slowest {} us",
+                          frame_stats.count,
+                          atlas_rendering ? L"atlases" : L"SVG",
+                          std::chrono::duration_cast<std::chrono::microseconds>(frame_stats.total).count() / frame_stats.count,
+                          std::chrono::duration_cast<std::chrono::microseconds>(frame_stats.slowest).count());
+        }
         Trace::SendGuideSession(duration, windowCloseType.c_str());
         shown_start_time = {};
     }
 }
 
-D2DOverlayWindow::~D2DOverlayWindow()
+void D2DOverlayWindow::on_display_change()
 {
-    tasklist_cv_mutex.lock();
-    running = false;
-    tasklist_cv_mutex.unlock();
-    tasklist_cv.notify_one();
-    tasklist_thread.join();
+    std::unique_lock lock(mutex);
+    monitors_valid = false;
 }
 
 void D2DOverlayWindow::apply_overlay_opacity(float opacity)
@@ -462,30 +496,9 @@ float D2DOverlayWindow::get_overlay_opacity()
 void D2DOverlayWindow::init()
 {
     colors.update();
-    landscape.load(L"svgs\\overlay.svg", d2d_dc.get())
-        .find_thumbnail(L"path-1")
-        .find_window_group(L"Group-1")
-        .recolor(0x000000, colors.start_color_menu);
-    portrait.load(L"svgs\\overlay_portrait.svg", d2d_dc.get())
-        .find_thumbnail(L"path-1")
-        .find_window_group(L"Group-1")
-        .recolor(0x000000, colors.start_color_menu);
     no_active.load(L"svgs\\no_active_window.svg", d2d_dc.get());
-    arrows.resize(10);
-    for (unsigned i = 0; i < arrows.size(); ++i)
-    {
-        arrows[i].load(L"svgs\\" + std::to_wstring((i + 1) % 10) + L".svg", d2d_dc.get()).recolor(0x000000, colors.start_color_menu);
-    }
     light_mode = (theme_setting == Light) || (theme_setting == System && colors.light_mode);
-    if (!light_mode)
-    {
-        landscape.recolor(0x222222, 0xDDDDDD);
-        portrait.recolor(0x222222, 0xDDDDDD);
-        for (auto& arrow : arrows)
-        {
-            arrow.recolor(0x222222, 0xDDDDDD);
-        }
-    }
+    current_theme = &get_theme_svgs(colors.start_color_menu, light_mode);
 }
 
 void D2DOverlayWindow::resize()
@@ -494,13 +507,13 @@ void D2DOverlayWindow::resize()
     float no_active_scale, font;
     if (window_width >= window_height)
     { // portrait is broke right now
-        use_overlay = &landscape;
+        use_overlay = &current_theme->landscape;
         no_active_scale = 0.3f;
         font = 15.0f;
     }
     else
     {
-        use_overlay = &portrait;
+        use_overlay = &current_theme->portrait;
         no_active_scale = 0.5f;
         font = 16.0f;
     }
@@ -571,6 +584,168 @@ void render_arrow(D2DSVG& arrow, TasklistButton& button, RECT window, float max_
     }
 }
 
+// Function to render the overlay and the labels of the window arrows. The overlay atlases are rasterized with it too
+void render_overlay_layer(D2DOverlaySVG& overlay, D2DText& text, bool light_mode, WindowState window_state, bool window_group_active, bool labels_enabled, ID2D1DeviceContext5* d2d_dc)
+{
+    std::wstring left, right, up, down;
+    bool left_disabled = false;
+    bool right_disabled = false;
+    bool up_disabled = false;
+    bool down_disabled = false;
+    switch (window_state)
+    {
+    case MINIMIZED:
+        left = GET_RESOURCE_STRING(IDS_NO_ACTION);
+        left_disabled = true;
+        right = GET_RESOURCE_STRING(IDS_NO_ACTION);
+        right_disabled = true;
+        up = GET_RESOURCE_STRING(IDS_RESTORE);
+        down = GET_RESOURCE_STRING(IDS_NO_ACTION);
+        down_disabled = true;
+        break;
+    case MAXIMIZED:
+        left = GET_RESOURCE_STRING(IDS_SNAP_LEFT);
+        right = GET_RESOURCE_STRING(IDS_SNAP_RIGHT);
+        up = GET_RESOURCE_STRING(IDS_NO_ACTION);
+        up_disabled = true;
+        down = GET_RESOURCE_STRING(IDS_RESTORE);
+        break;
+    case SNAPPED_TOP_LEFT:
+        left = GET_RESOURCE_STRING(IDS_SNAP_UPPER_RIGHT);
+        right = GET_RESOURCE_STRING(IDS_SNAP_UPPER_RIGHT);
+        up = GET_RESOURCE_STRING(IDS_MAXIMIZE);
+        down = GET_RESOURCE_STRING(IDS_SNAP_LEFT);
+        break;
+    case SNAPPED_LEFT:
+        left = GET_RESOURCE_STRING(IDS_SNAP_RIGHT);
+        right = GET_RESOURCE_STRING(IDS_RESTORE);
+        up = GET_RESOURCE_STRING(IDS_SNAP_UPPER_LEFT);
+        down = GET_RESOURCE_STRING(IDS_SNAP_LOWER_LEFT);
+        break;
+    case SNAPPED_BOTTOM_LEFT:
+        left = GET_RESOURCE_STRING(IDS_SNAP_LOWER_RIGHT);
+        right = GET_RESOURCE_STRING(IDS_SNAP_LOWER_RIGHT);
+        up = GET_RESOURCE_STRING(IDS_SNAP_LEFT);
+        down = GET_RESOURCE_STRING(IDS_MINIMIZE);
+        break;
+    case SNAPPED_TOP_RIGHT:
+        left = GET_RESOURCE_STRING(IDS_SNAP_UPPER_LEFT);
+        right = GET_RESOURCE_STRING(IDS_SNAP_UPPER_LEFT);
+        up = GET_RESOURCE_STRING(IDS_MAXIMIZE);
+        down = GET_RESOURCE_STRING(IDS_SNAP_RIGHT);
+        break;
+    case SNAPPED_RIGHT:
+        left = GET_RESOURCE_STRING(IDS_RESTORE);
+        right = GET_RESOURCE_STRING(IDS_SNAP_LEFT);
+        up = GET_RESOURCE_STRING(IDS_SNAP_UPPER_RIGHT);
+        down = GET_RESOURCE_STRING(IDS_SNAP_LOWER_RIGHT);
+        break;
+    case SNAPPED_BOTTOM_RIGHT:
+        left = GET_RESOURCE_STRING(IDS_SNAP_LOWER_LEFT);
+        right = GET_RESOURCE_STRING(IDS_SNAP_LOWER_LEFT);
+        up = GET_RESOURCE_STRING(IDS_SNAP_RIGHT);
+        down = GET_RESOURCE_STRING(IDS_MINIMIZE);
+        break;
+    case RESTORED:
+        left = GET_RESOURCE_STRING(IDS_SNAP_LEFT);
+        right = GET_RESOURCE_STRING(IDS_SNAP_RIGHT);
+        up = GET_RESOURCE_STRING(IDS_MAXIMIZE);
+        down = GET_RESOURCE_STRING(IDS_MINIMIZE);
+        break;
+    default:
+        left = GET_RESOURCE_STRING(IDS_NO_ACTION);
+        left_disabled = true;
+        right = GET_RESOURCE_STRING(IDS_NO_ACTION);
+        right_disabled = true;
+        up = GET_RESOURCE_STRING(IDS_NO_ACTION);
+        up_disabled = true;
+        down = GET_RESOURCE_STRING(IDS_NO_ACTION);
+        down_disabled = true;
+    }
+    overlay.toggle_window_group(window_group_active);
+    overlay.find_element(L"KeyUpGroup")->SetAttributeValue(L"fill-opacity", up_disabled ? 0.3f : 1.0f);
+    overlay.find_element(L"KeyDownGroup")->SetAttributeValue(L"fill-opacity", down_disabled ? 0.3f : 1.0f);
+    overlay.find_element(L"KeyLeftGroup")->SetAttributeValue(L"fill-opacity", left_disabled ? 0.3f : 1.0f);
+    overlay.find_element(L"KeyRightGroup")->SetAttributeValue(L"fill-opacity", right_disabled ? 0.3f : 1.0f);
+    overlay.render(d2d_dc);
+
+    auto text_color = D2D1::ColorF(light_mode ? 0x222222 : 0xDDDDDD, labels_enabled ? 1.0f : 0.3f);
+    text.set_alignment_center().write(d2d_dc, text_color, overlay.get_maximize_label(), up);
+    text.write(d2d_dc, text_color, overlay.get_minimize_label(), down);
+    text.set_alignment_right().write(d2d_dc, text_color, overlay.get_snap_left(), left);
+    text.set_alignment_left().write(d2d_dc, text_color, overlay.get_snap_right(), right);
+}
+
+// Function to get the overlay and its labels rasterized for the current window, rasterizing them the first time.
+// Returns nullptr when the overlay has to be drawn from the SVG
+const OverlayAtlas* D2DOverlayWindow::get_overlay_atlas(int window_state, bool window_group_active, bool labels_enabled)
+{
+    // The key animations change the overlay every frame
+    if (!atlas_rendering || !key_animations.empty())
+    {
+        return nullptr;
+    }
+
+    float dpi_x, dpi_y;
+    d2d_dc->GetDpi(&dpi_x, &dpi_y);
+    for (const auto& atlas : overlay_atlases)
+    {
+        if (atlas.window_width == window_width && atlas.window_height == window_height && atlas.dpi == dpi_x &&
+            atlas.theme == current_theme && atlas.overlay == use_overlay && atlas.window_state == window_state &&
+            atlas.window_group_active == window_group_active && atlas.labels_enabled == labels_enabled)
+        {
+            return &atlas;
+        }
+    }
+
+    // The labels can be outside of the overlay, the bounds cover both and are aligned to pixels so the atlas is drawn without filtering
+    auto bounds = use_overlay->rescale(D2D1::RectF(0, 0, (float)use_overlay->width(), (float)use_overlay->height()));
+    for (const auto& label : { use_overlay->get_maximize_label(), use_overlay->get_minimize_label(), use_overlay->get_snap_left(), use_overlay->get_snap_right() })
+    {
+        bounds.left = std::min(bounds.left, label.left);
+        bounds.top = std::min(bounds.top, label.top);
+        bounds.right = std::max(bounds.right, label.right);
+        bounds.bottom = std::max(bounds.bottom, label.bottom);
+    }
+    bounds = D2D1::RectF(std::floor(bounds.left), std::floor(bounds.top), std::ceil(bounds.right), std::ceil(bounds.bottom));
+
+    OverlayAtlas atlas;
+    try
+    {
+        winrt::com_ptr<ID2D1BitmapRenderTarget> target;
+        winrt::check_hresult(d2d_dc->CreateCompatibleRenderTarget(D2D1::SizeF(bounds.right - bounds.left, bounds.bottom - bounds.top), target.put()));
+        auto target_dc = target.as<ID2D1DeviceContext5>();
+        target_dc->BeginDraw();
+        target_dc->Clear();
+        target_dc->SetTransform(D2D1::Matrix3x2F::Translation(-bounds.left, -bounds.top));
+        render_overlay_layer(*use_overlay, text, light_mode, (WindowState)window_state, window_group_active, labels_enabled, target_dc.get());
+        winrt::check_hresult(target_dc->EndDraw());
+        winrt::check_hresult(target->GetBitmap(atlas.bitmap.put()));
+    }
+    catch (const winrt::hresult_error& e)
+    {
+        Logger::warn(L"Failed to rasterize the overlay, it will be drawn from the SVG. {}", e.message());
+        atlas_rendering = false;
+        return nullptr;
+    }
+
+    atlas.window_width = window_width;
+    atlas.window_height = window_height;
+    atlas.dpi = dpi_x;
+    atlas.theme = current_theme;
+    atlas.overlay = use_overlay;
+    atlas.window_state = window_state;
+    atlas.window_group_active = window_group_active;
+    atlas.labels_enabled = labels_enabled;
+    atlas.bounds = bounds;
+    if (overlay_atlases.size() >= MaxOverlayAtlases)
+    {
+        overlay_atlases.erase(overlay_atlases.begin());
+    }
+    overlay_atlases.push_back(std::move(atlas));
+    return &overlay_atlases.back();
+}
+
 bool D2DOverlayWindow::show_thumbnail(const RECT& rect, double alpha)
 {
     if (!thumbnail)
@@ -606,6 +781,11 @@ void D2DOverlayWindow::render(ID2D1DeviceContext5* d2d_dc)
         return;
     }
 
+    if (show_tasklist_buttons)
+    {
+        tasklist.get_buttons(tasklist_buttons, tasklist_version);
+    }
+
     d2d_dc->Clear();
     int x_offset = 0, y_offset = 0, dimension = 0;
     auto current_anim_value = (float)animation.value(Animation::AnimFunctions::LINEAR);
@@ -733,8 +913,8 @@ void D2DOverlayWindow::render(ID2D1DeviceContext5* d2d_dc)
         }
     }
     // Finalize the overlay - dimm the buttons if no thumbnail is present and show "No active window"
-    use_overlay->toggle_window_group(miniature_shown || window_state == MINIMIZED);
-    if (!miniature_shown && window_state != MINIMIZED)
+    const bool window_group_active = miniature_shown || window_state == MINIMIZED;
+    if (!window_group_active)
     {
         no_active.render(d2d_dc);
         window_state = UNKNOWN;
@@ -770,100 +950,37 @@ void D2DOverlayWindow::render(ID2D1DeviceContext5* d2d_dc)
         }
         ++id;
     }
-    // Finally: render the overlay...
-    use_overlay->render(d2d_dc);
-    // ... window arrows texts ...
-    std::wstring left, right, up, down;
-    bool left_disabled = false;
-    bool right_disabled = false;
-    bool up_disabled = false;
-    bool down_disabled = false;
-    switch (window_state)
+    // Finally: render the overlay and the window arrows texts, from the atlas if possible...
+    const bool labels_enabled = active_window_snappable && window_group_active;
+    const OverlayAtlas* atlas = get_overlay_atlas(window_state, window_group_active, labels_enabled);
+    if (atlas)
     {
-    case MINIMIZED:
-        left = GET_RESOURCE_STRING(IDS_NO_ACTION);
-        left_disabled = true;
-        right = GET_RESOURCE_STRING(IDS_NO_ACTION);
-        right_disabled = true;
-        up = GET_RESOURCE_STRING(IDS_RESTORE);
-        down = GET_RESOURCE_STRING(IDS_NO_ACTION);
-        down_disabled = true;
-        break;
-    case MAXIMIZED:
-        left = GET_RESOURCE_STRING(IDS_SNAP_LEFT);
-        right = GET_RESOURCE_STRING(IDS_SNAP_RIGHT);
-        up = GET_RESOURCE_STRING(IDS_NO_ACTION);
-        up_disabled = true;
-        down = GET_RESOURCE_STRING(IDS_RESTORE);
-        break;
-    case SNAPPED_TOP_LEFT:
-        left = GET_RESOURCE_STRING(IDS_SNAP_UPPER_RIGHT);
-        right = GET_RESOURCE_STRING(IDS_SNAP_UPPER_RIGHT);
-        up = GET_RESOURCE_STRING(IDS_MAXIMIZE);
-        down = GET_RESOURCE_STRING(IDS_SNAP_LEFT);
-        break;
-    case SNAPPED_LEFT:
-        left = GET_RESOURCE_STRING(IDS_SNAP_RIGHT);
-        right = GET_RESOURCE_STRING(IDS_RESTORE);
-        up = GET_RESOURCE_STRING(IDS_SNAP_UPPER_LEFT);
-        down = GET_RESOURCE_STRING(IDS_SNAP_LOWER_LEFT);
-        break;
-    case SNAPPED_BOTTOM_LEFT:
-        left = GET_RESOURCE_STRING(IDS_SNAP_LOWER_RIGHT);
-        right = GET_RESOURCE_STRING(IDS_SNAP_LOWER_RIGHT);
-        up = GET_RESOURCE_STRING(IDS_SNAP_LEFT);
-        down = GET_RESOURCE_STRING(IDS_MINIMIZE);
-        break;
-    case SNAPPED_TOP_RIGHT:
-        left = GET_RESOURCE_STRING(IDS_SNAP_UPPER_LEFT);
-        right = GET_RESOURCE_STRING(IDS_SNAP_UPPER_LEFT);
-        up = GET_RESOURCE_STRING(IDS_MAXIMIZE);
-        down = GET_RESOURCE_STRING(IDS_SNAP_RIGHT);
-        break;
-    case SNAPPED_RIGHT:
-        left = GET_RESOURCE_STRING(IDS_RESTORE);
-        right = GET_RESOURCE_STRING(IDS_SNAP_LEFT);
-        up = GET_RESOURCE_STRING(IDS_SNAP_UPPER_RIGHT);
-        down = GET_RESOURCE_STRING(IDS_SNAP_LOWER_RIGHT);
-        break;
-    case SNAPPED_BOTTOM_RIGHT:
-        left = GET_RESOURCE_STRING(IDS_SNAP_LOWER_LEFT);
-        right = GET_RESOURCE_STRING(IDS_SNAP_LOWER_LEFT);
-        up = GET_RESOURCE_STRING(IDS_SNAP_RIGHT);
-        down = GET_RESOURCE_STRING(IDS_MINIMIZE);
-        break;
-    case RESTORED:
-        left = GET_RESOURCE_STRING(IDS_SNAP_LEFT);
-        right = GET_RESOURCE_STRING(IDS_SNAP_RIGHT);
-        up = GET_RESOURCE_STRING(IDS_MAXIMIZE);
-        down = GET_RESOURCE_STRING(IDS_MINIMIZE);
-        break;
-    default:
-        left = GET_RESOURCE_STRING(IDS_NO_ACTION);
-        left_disabled = true;
-        right = GET_RESOURCE_STRING(IDS_NO_ACTION);
-        right_disabled = true;
-        up = GET_RESOURCE_STRING(IDS_NO_ACTION);
-        up_disabled = true;
-        down = GET_RESOURCE_STRING(IDS_NO_ACTION);
-        down_disabled = true;
+        d2d_dc->DrawBitmap(atlas->bitmap.get(), atlas->bounds);
+    }
+    else
+    {
+        render_overlay_layer(*use_overlay, text, light_mode, window_state, window_group_active, labels_enabled, d2d_dc);
     }
-    auto text_color = D2D1::ColorF(light_mode ? 0x222222 : 0xDDDDDD, active_window_snappable && (miniature_shown || window_state == MINIMIZED) ? 1.0f : 0.3f);
-    use_overlay->find_element(L"KeyUpGroup")->SetAttributeValue(L"fill-opacity", up_disabled ? 0.3f : 1.0f);
-    text.set_alignment_center().write(d2d_dc, text_color, use_overlay->get_maximize_label(), up);
-    use_overlay->find_element(L"KeyDownGroup")->SetAttributeValue(L"fill-opacity", down_disabled ? 0.3f : 1.0f);
-    text.write(d2d_dc, text_color, use_overlay->get_minimize_label(), down);
-    use_overlay->find_element(L"KeyLeftGroup")->SetAttributeValue(L"fill-opacity", left_disabled ? 0.3f : 1.0f);
-    text.set_alignment_right().write(d2d_dc, text_color, use_overlay->get_snap_left(), left);
-    use_overlay->find_element(L"KeyRightGroup")->SetAttributeValue(L"fill-opacity", right_disabled ? 0.3f : 1.0f);
-    text.set_alignment_left().write(d2d_dc, text_color, use_overlay->get_snap_right(), right);
     // ... and the arrows with numbers
     for (auto&& button : tasklist_buttons)
     {
-        if ((size_t)(button.keynum) - 1 >= arrows.size())
+        if ((size_t)(button.keynum) - 1 >= current_theme->arrows.size())
         {
             continue;
         }
-        render_arrow(arrows[(size_t)(button.keynum) - 1], button, window_rect, use_overlay->get_scale(), d2d_dc);
+        render_arrow(current_theme->arrows[(size_t)(button.keynum) - 1], button, window_rect, use_overlay->get_scale(), d2d_dc);
+    }
+
+    if (first_frame_pending)
+    {
+        auto latency = microseconds_between(show_requested_time, std::chrono::steady_clock::now());
+        Logger::trace(L"First frame rendered {} us after show", latency);
+        first_frame_pending = false;
+    }
+    if (first_buttons_frame_pending && !tasklist_buttons.empty())
+    {
+        auto latency = microseconds_between(show_requested_time, std::chrono::steady_clock::now());
+        Logger::trace(L"Taskbar buttons rendered {} us after show", latency);
+        first_buttons_frame_pending = false;
     }
 }
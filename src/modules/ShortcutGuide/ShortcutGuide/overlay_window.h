@@ -36,6 +36,28 @@ private:
     winrt::com_ptr<ID2D1SvgElement> window_group;
 };
 
+// The overlay and the arrows recolored for one theme. Each theme is built once and kept, so a theme change only swaps them
+struct OverlayThemeSVGs
+{
+    uint32_t background_color;
+    bool light_mode;
+    D2DOverlaySVG landscape, portrait;
+    std::vector<D2DSVG> arrows;
+};
+
+// The overlay and its labels rasterized for a window size, DPI, theme, orientation and state of the labels
+struct OverlayAtlas
+{
+    UINT window_width, window_height;
+    float dpi;
+    const OverlayThemeSVGs* theme;
+    const D2DOverlaySVG* overlay;
+    int window_state;
+    bool window_group_active, labels_enabled;
+    D2D1_RECT_F bounds;
+    winrt::com_ptr<ID2D1Bitmap> bitmap;
+};
+
 struct AnimateKeys
 {
     Animation animation;
@@ -49,7 +71,6 @@ class D2DOverlayWindow : public D2DWindow
 public:
     D2DOverlayWindow();
     void show(HWND active_window, bool snappable);
-    ~D2DOverlayWindow();
     void apply_overlay_opacity(float opacity);
     void set_theme(const std::wstring& theme);
     void quick_hide();
@@ -69,31 +90,45 @@ private:
     virtual void render(ID2D1DeviceContext5* d2d_dc) override;
     virtual void on_show() override;
     virtual void on_hide() override;
+    virtual void on_display_change() override;
     float get_overlay_opacity();
+    OverlayThemeSVGs& get_theme_svgs(uint32_t background_color, bool light_mode);
+    const OverlayAtlas* get_overlay_atlas(int window_state, bool window_group_active, bool labels_enabled);
+    void update_monitors();
 
-    bool running = true;
     std::vector<AnimateKeys> key_animations;
     std::vector<MonitorInfo> monitors;
     ScreenSize total_screen;
+    ScreenSize primary_screen;
     int monitor_dx = 0, monitor_dy = 0;
+    // The monitors are only queried again after WM_DISPLAYCHANGE
+    bool monitors_valid = false;
     D2DText text;
     WindowsColors colors;
     Animation animation;
     RECT window_rect = {};
     Tasklist tasklist;
     std::vector<TasklistButton> tasklist_buttons;
-    std::thread tasklist_thread;
-    bool tasklist_update = false;
-    std::mutex tasklist_cv_mutex;
-    std::condition_variable tasklist_cv;
+    uint64_t tasklist_version = 0;
+    // Cleared by on_hide, which can run on another thread than render
+    std::atomic<bool> show_tasklist_buttons = false;
+
+    // Time of the last show, to measure how long it takes until the first frame and until the taskbar buttons are shown
+    std::chrono::steady_clock::time_point show_requested_time;
+    bool first_frame_pending = false;
+    bool first_buttons_frame_pending = false;
 
     HTHUMBNAIL thumbnail;
     HWND active_window = nullptr;
     bool active_window_snappable = false;
-    D2DOverlaySVG landscape, portrait;
+    std::vector<std::unique_ptr<OverlayThemeSVGs>> themes;
+    OverlayThemeSVGs* current_theme = nullptr;
     D2DOverlaySVG* use_overlay = nullptr;
     D2DSVG no_active;
-    std::vector<D2DSVG> arrows;
+    // Draw the overlay from bitmaps rasterized once instead of drawing the SVG and the labels every frame.
+    // Turned off when rasterizing fails, the SVG is then drawn as before
+    bool atlas_rendering = true;
+    std::vector<OverlayAtlas> overlay_atlases;
     std::chrono::steady_clock::time_point shown_start_time;
     float overlay_opacity = 0.9f;
     enum
@@ -1,42 +1,283 @@
 #include "pch.h"
 #include "tasklist_positions.h"
 
-void Tasklist::update()
+namespace
 {
-    // Get HWND of the tasklist
-    auto tasklist_hwnd = FindWindowA("Shell_TrayWnd", nullptr);
-    if (!tasklist_hwnd)
-        return;
-    tasklist_hwnd = FindWindowExA(tasklist_hwnd, 0, "ReBarWindow32", nullptr);
-    if (!tasklist_hwnd)
-        return;
-    tasklist_hwnd = FindWindowExA(tasklist_hwnd, 0, "MSTaskSwWClass", nullptr);
-    if (!tasklist_hwnd)
-        return;
-    tasklist_hwnd = FindWindowExA(tasklist_hwnd, 0, "MSTaskListWClass", nullptr);
-    if (!tasklist_hwnd)
+    // Adding or removing a button moves the other ones, so the events are coalesced for this time before the buttons are read again
+    constexpr auto RefreshDelay = std::chrono::milliseconds(50);
+
+    // Interval at which the thread checks that the taskbar still exists, since explorer can restart, or tries to bind again if it failed
+    constexpr auto BindCheckInterval = std::chrono::seconds(2);
+
+    std::vector<int> get_runtime_id(IUIAutomationElement* element)
+    {
+        std::vector<int> result;
+        SAFEARRAY* runtime_id = nullptr;
+        if (element->GetRuntimeId(&runtime_id) >= 0 && runtime_id)
+        {
+            int* data = nullptr;
+            if (SafeArrayAccessData(runtime_id, reinterpret_cast<void**>(&data)) >= 0)
+            {
+                result.assign(data, data + runtime_id->rgsabound[0].cElements);
+                SafeArrayUnaccessData(runtime_id);
+            }
+            SafeArrayDestroy(runtime_id);
+        }
+        return result;
+    }
+
+    HWND find_tasklist_window()
+    {
+        auto tasklist_hwnd = FindWindowA("Shell_TrayWnd", nullptr);
+        if (!tasklist_hwnd)
+            return nullptr;
+        tasklist_hwnd = FindWindowExA(tasklist_hwnd, 0, "ReBarWindow32", nullptr);
+        if (!tasklist_hwnd)
+            return nullptr;
+        tasklist_hwnd = FindWindowExA(tasklist_hwnd, 0, "MSTaskSwWClass", nullptr);
+        if (!tasklist_hwnd)
+            return nullptr;
+        return FindWindowExA(tasklist_hwnd, 0, "MSTaskListWClass", nullptr);
+    }
+}
+
+// Receives the UI Automation events on the threads of UI Automation. The owner is detached before the handlers are removed,
+// and a callback which is still running keeps owner_mutex until it's done with the owner
+class Tasklist::EventHandler : public IUIAutomationStructureChangedEventHandler, public IUIAutomationPropertyChangedEventHandler
+{
+public:
+    explicit EventHandler(Tasklist* owner) :
+        owner(owner)
+    {
+    }
+
+    void detach()
+    {
+        std::unique_lock lock(owner_mutex);
+        owner = nullptr;
+    }
+
+    IFACEMETHODIMP QueryInterface(_In_ REFIID riid, _Outptr_ void** ppv) override
+    {
+        static const QITAB qit[] = {
+            QITABENT(EventHandler, IUIAutomationStructureChangedEventHandler),
+            QITABENT(EventHandler, IUIAutomationPropertyChangedEventHandler),
+            { 0 },
+        };
+        return QISearch(this, qit, riid, ppv);
+    }
+
+    IFACEMETHODIMP_(ULONG) AddRef() override
+    {
+        return InterlockedIncrement(&ref_count);
+    }
+
+    IFACEMETHODIMP_(ULONG) Release() override
+    {
+        const ULONG count = InterlockedDecrement(&ref_count);
+        if (count == 0)
+        {
+            delete this;
+        }
+        return count;
+    }
+
+    // Buttons were added, removed or reordered
+    IFACEMETHODIMP HandleStructureChangedEvent(IUIAutomationElement*, StructureChangeType, SAFEARRAY*) override
+    {
+        std::unique_lock lock(owner_mutex);
+        if (owner)
+        {
+            owner->request_refresh();
+        }
+        return S_OK;
+    }
+
+    IFACEMETHODIMP HandlePropertyChangedEvent(IUIAutomationElement* sender, PROPERTYID property_id, VARIANT new_value) override
+    {
+        std::unique_lock lock(owner_mutex);
+        if (owner && sender && property_id == UIA_BoundingRectanglePropertyId)
+        {
+            owner->on_button_moved(sender, new_value);
+        }
+        return S_OK;
+    }
+
+private:
+    ULONG ref_count = 1;
+    std::mutex owner_mutex;
+    Tasklist* owner;
+};
+
+Tasklist::Tasklist()
+{
+    worker = std::thread([this] { run(); });
+}
+
+Tasklist::~Tasklist()
+{
+    {
+        std::unique_lock lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+bool Tasklist::get_buttons(std::vector<TasklistButton>& result, uint64_t& version)
+{
+    std::unique_lock lock(mutex);
+    if (version == buttons_version)
+    {
+        return false;
+    }
+    result = buttons;
+    version = buttons_version;
+    return true;
+}
+
+void Tasklist::request_refresh()
+{
+    {
+        std::unique_lock lock(mutex);
+        refresh_requested = true;
+    }
+    wake.notify_one();
+}
+
+void Tasklist::run()
+{
+    // The UI Automation event handlers are added and removed from this thread, which has no windows, as UI Automation requires
+    if (CoInitializeEx(nullptr, COINIT_MULTITHREADED) < 0)
+    {
+        Logger::error("Failed to initialize COM for the taskbar buttons thread");
         return;
-    if (!automation)
+    }
+
+    std::unique_lock lock(mutex);
+    while (!stopping)
     {
-        winrt::check_hresult(CoCreateInstance(CLSID_CUIAutomation,
-                                              nullptr,
-                                              CLSCTX_INPROC_SERVER,
-                                              IID_IUIAutomation,
-                                              automation.put_void()));
-        winrt::check_hresult(automation->CreateTrueCondition(true_condition.put()));
+        if (!refresh_requested)
+        {
+            if (!wake.wait_for(lock, BindCheckInterval, [this] { return stopping || refresh_requested; }))
+            {
+                refresh_requested = !tasklist_hwnd || !IsWindow(tasklist_hwnd);
+            }
+            continue;
+        }
+
+        // The first read after binding isn't delayed, since it's not caused by an event
+        if (element && wake.wait_for(lock, RefreshDelay, [this] { return stopping; }))
+        {
+            break;
+        }
+
+        refresh_requested = false;
+        lock.unlock();
+        if (tasklist_hwnd && !IsWindow(tasklist_hwnd))
+        {
+            unbind();
+        }
+
+        if (!element)
+        {
+            bind();
+        }
+
+        // The element can be stale if explorer restarted in the meantime
+        if (element && !read_buttons())
+        {
+            unbind();
+            if (bind())
+            {
+                read_buttons();
+            }
+        }
+        lock.lock();
     }
-    element = nullptr;
-    winrt::check_hresult(automation->ElementFromHandle(tasklist_hwnd, element.put()));
+    lock.unlock();
+
+    unbind();
+    cache_request = nullptr;
+    true_condition = nullptr;
+    automation = nullptr;
+    CoUninitialize();
 }
 
-bool Tasklist::update_buttons(std::vector<TasklistButton>& buttons)
+bool Tasklist::bind()
 {
-    if (!automation || !element)
+    auto hwnd = find_tasklist_window();
+    if (!hwnd)
     {
         return false;
     }
+
+    try
+    {
+        if (!automation)
+        {
+            winrt::check_hresult(CoCreateInstance(CLSID_CUIAutomation,
+                                                  nullptr,
+                                                  CLSCTX_INPROC_SERVER,
+                                                  IID_IUIAutomation,
+                                                  automation.put_void()));
+            winrt::check_hresult(automation->CreateTrueCondition(true_condition.put()));
+
+            // The rects and ids of all the buttons are read in a single call to explorer
+            winrt::check_hresult(automation->CreateCacheRequest(cache_request.put()));
+            winrt::check_hresult(cache_request->AddProperty(UIA_BoundingRectanglePropertyId));
+            winrt::check_hresult(cache_request->AddProperty(UIA_AutomationIdPropertyId));
+        }
+
+        winrt::check_hresult(automation->ElementFromHandle(hwnd, element.put()));
+        event_handler = new EventHandler(this);
+        winrt::check_hresult(automation->AddStructureChangedEventHandler(element.get(), TreeScope_Element | TreeScope_Children, nullptr, event_handler));
+        PROPERTYID properties[] = { UIA_BoundingRectanglePropertyId };
+        winrt::check_hresult(automation->AddPropertyChangedEventHandlerNativeArray(element.get(), TreeScope_Children, nullptr, event_handler, properties, ARRAYSIZE(properties)));
+        tasklist_hwnd = hwnd;
+        return true;
+    }
+    catch (const winrt::hresult_error& e)
+    {
+        Logger::warn(L"Failed to subscribe to the taskbar buttons events. {}", e.message());
+        unbind();
+        return false;
+    }
+}
+
+void Tasklist::unbind()
+{
+    if (event_handler)
+    {
+        event_handler->detach();
+    }
+
+    if (automation && element)
+    {
+        automation->RemoveAllEventHandlers();
+    }
+
+    if (event_handler)
+    {
+        event_handler->Release();
+        event_handler = nullptr;
+    }
+
+    element = nullptr;
+    tasklist_hwnd = nullptr;
+
+    std::unique_lock lock(mutex);
+    if (!entries.empty())
+    {
+        entries.clear();
+        publish();
+    }
+}
+
+bool Tasklist::read_buttons()
+{
     winrt::com_ptr<IUIAutomationElementArray> elements;
-    if (element->FindAll(TreeScope_Children, true_condition.get(), elements.put()) < 0)
+    if (element->FindAllBuildCache(TreeScope_Children, true_condition.get(), cache_request.get(), elements.put()) < 0)
         return false;
     if (!elements)
         return false;
@@ -44,50 +285,83 @@ bool Tasklist::update_buttons(std::vector<TasklistButton>& buttons)
     if (elements->get_Length(&count) < 0)
         return false;
     winrt::com_ptr<IUIAutomationElement> child;
-    std::vector<TasklistButton> found_buttons;
-    found_buttons.reserve(count);
+    std::vector<Entry> found_entries;
+    found_entries.reserve(count);
     for (int i = 0; i < count; ++i)
     {
         child = nullptr;
         if (elements->GetElement(i, child.put()) < 0)
             return false;
-        TasklistButton button;
-        if (VARIANT var_rect; child->GetCurrentPropertyValue(UIA_BoundingRectanglePropertyId, &var_rect) >= 0)
-        {
-            if (var_rect.vt == (VT_R8 | VT_ARRAY))
-            {
-                LONG pos;
-                double value;
-                pos = 0;
-                SafeArrayGetElement(var_rect.parray, &pos, &value);
-                button.x = (long)value;
-                pos = 1;
-                SafeArrayGetElement(var_rect.parray, &pos, &value);
-                button.y = (long)value;
-                pos = 2;
-                SafeArrayGetElement(var_rect.parray, &pos, &value);
-                button.width = (long)value;
-                pos = 3;
-                SafeArrayGetElement(var_rect.parray, &pos, &value);
-                button.height = (long)value;
-            }
-            VariantClear(&var_rect);
-        }
-        else
-        {
+        RECT rect;
+        if (child->get_CachedBoundingRectangle(&rect) < 0)
             return false;
-        }
-        if (BSTR automation_id; child->get_CurrentAutomationId(&automation_id) >= 0)
+        Entry entry;
+        entry.runtime_id = get_runtime_id(child.get());
+        entry.button.x = rect.left;
+        entry.button.y = rect.top;
+        entry.button.width = rect.right - rect.left;
+        entry.button.height = rect.bottom - rect.top;
+        entry.button.keynum = 0;
+        if (BSTR automation_id; child->get_CachedAutomationId(&automation_id) >= 0 && automation_id)
         {
-            button.name = automation_id;
+            entry.button.name = automation_id;
             SysFreeString(automation_id);
         }
-        found_buttons.push_back(button);
+        found_entries.push_back(std::move(entry));
     }
-    // assign keynums
+
+    std::unique_lock lock(mutex);
+    entries = std::move(found_entries);
+    publish();
+    return true;
+}
+
+void Tasklist::on_button_moved(IUIAutomationElement* sender, const VARIANT& rect)
+{
+    if (rect.vt != (VT_R8 | VT_ARRAY) || !rect.parray || rect.parray->rgsabound[0].cElements < 4)
+    {
+        request_refresh();
+        return;
+    }
+
+    double* values = nullptr;
+    if (SafeArrayAccessData(rect.parray, reinterpret_cast<void**>(&values)) < 0)
+    {
+        request_refresh();
+        return;
+    }
+    const long x = (long)values[0];
+    const long y = (long)values[1];
+    const long width = (long)values[2];
+    const long height = (long)values[3];
+    SafeArrayUnaccessData(rect.parray);
+
+    const auto runtime_id = get_runtime_id(sender);
+    {
+        std::unique_lock lock(mutex);
+        auto entry = std::find_if(entries.begin(), entries.end(), [&runtime_id](const Entry& entry) { return entry.runtime_id == runtime_id; });
+        if (entry != entries.end())
+        {
+            entry->button.x = x;
+            entry->button.y = y;
+            entry->button.width = width;
+            entry->button.height = height;
+            publish();
+            return;
+        }
+    }
+
+    // A button which wasn't read yet
+    request_refresh();
+}
+
+// Function to number the buttons and publish them as the new snapshot. Called with the mutex held
+void Tasklist::publish()
+{
     buttons.clear();
-    for (auto& button : found_buttons)
+    for (const auto& entry : entries)
     {
+        auto button = entry.button;
         if (buttons.empty())
         {
             button.keynum = 1;
@@ -105,12 +379,5 @@ bool Tasklist::update_buttons(std::vector<TasklistButton>& buttons)
                 break; // no more than 10 buttons
         }
     }
-    return true;
+    buttons_version++;
 }
-
-std::vector<TasklistButton> Tasklist::get_buttons()
-{
-    std::vector<TasklistButton> buttons;
-    update_buttons(buttons);
-    return buttons;
-}
\ No newline at end of file
@@ -2,6 +2,10 @@
 #include <vector>
 #include <unordered_set>
 #include <string>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <Windows.h>
 #include <UIAutomationClient.h>
 
@@ -11,15 +15,57 @@ struct TasklistButton
     long x, y, width, height, keynum;
 };
 
+// Keeps the positions of the taskbar buttons up to date on a background thread, so that showing the overlay only copies the last snapshot.
+// The buttons are read again when UI Automation reports a structure change of the taskbar, and the rect of a button is updated in place
+// when UI Automation reports that it moved
 class Tasklist
 {
 public:
-    void update();
-    std::vector<TasklistButton> get_buttons();
-    bool update_buttons(std::vector<TasklistButton>& buttons);
+    Tasklist();
+    ~Tasklist();
+
+    Tasklist(const Tasklist&) = delete;
+    Tasklist& operator=(const Tasklist&) = delete;
+
+    // Function to copy the buttons if they changed since the version passed in. Returns false if they didn't change
+    bool get_buttons(std::vector<TasklistButton>& buttons, uint64_t& version);
+
+    // Function to ask the background thread to read the buttons again, binding to the taskbar first if it isn't bound yet
+    void request_refresh();
 
 private:
+    struct Entry
+    {
+        std::vector<int> runtime_id;
+        TasklistButton button;
+    };
+
+    class EventHandler;
+    friend class EventHandler;
+
+    void run();
+    bool bind();
+    void unbind();
+    bool read_buttons();
+    void publish();
+    void on_button_moved(IUIAutomationElement* sender, const VARIANT& rect);
+
+    // Only used on the background thread
+    HWND tasklist_hwnd = nullptr;
     winrt::com_ptr<IUIAutomation> automation;
     winrt::com_ptr<IUIAutomationElement> element;
     winrt::com_ptr<IUIAutomationCondition> true_condition;
+    winrt::com_ptr<IUIAutomationCacheRequest> cache_request;
+    EventHandler* event_handler = nullptr;
+
+    // Protects the entries, the snapshot and the requests
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<Entry> entries;
+    std::vector<TasklistButton> buttons;
+    uint64_t buttons_version = 0;
+    bool refresh_requested = true;
+    bool stopping = false;
+
+    std::thread worker;
 };
@@ -8,6 +8,7 @@
 #include <FancyZonesLib/Generated Files/resource.h>
 
 #include <common/utils/logger_helper.h>
+#include <common/utils/profiler.h>
 #include <common/hooks/LowlevelKeyboardEvent.h>
 #include <common/utils/resources.h>
 
@@ -61,6 +62,8 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
     }
 
     Trace::RegisterProvider();
+    Profiler::ExportListener profilerExportListener(moduleName);
+    Profiler::RegisterCurrentThread();
 
     FancyZonesApp app(GET_RESOURCE_STRING(IDS_FANCYZONES), NonLocalizable::FancyZonesStr);
     app.Run();
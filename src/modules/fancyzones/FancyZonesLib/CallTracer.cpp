@@ -40,14 +40,20 @@ namespace
 }
 
 CallTracer::CallTracer(const char* functionName) :
-    functionName(functionName)
+    functionName(functionName), enabled(Logger::should_log(spdlog::level::trace))
 {
-    Logger::trace((GetIndentation() + functionName + entering).c_str());
-    Indent();
+    if (enabled)
+    {
+        Logger::trace((GetIndentation() + functionName + entering).c_str());
+        Indent();
+    }
 }
 
 CallTracer::~CallTracer()
 {
-    Unindent();
-    Logger::trace((GetIndentation() + functionName + exiting).c_str());
+    if (enabled)
+    {
+        Unindent();
+        Logger::trace((GetIndentation() + functionName + exiting).c_str());
+    }
 }
@@ -1,12 +1,21 @@
 #pragma once
 
 #include "common/logger/logger.h"
+#include "common/utils/profiler.h"
 
-#define _TRACER_ CallTracer callTracer(__FUNCTION__)
+// The traced functions are also timed by the profiler. The tracer is removed when trace messages are compiled out (see POWERTOYS_LOG_ACTIVE_LEVEL)
+#if POWERTOYS_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+#define _TRACER_ POWERTOYS_PROFILE_SCOPE(__FUNCTION__); CallTracer callTracer(__FUNCTION__)
+#else
+#define _TRACER_ POWERTOYS_PROFILE_SCOPE(__FUNCTION__)
+#endif
 
 class CallTracer
 {
-    std::string functionName;
+    const char* functionName;
+
+    // The messages are only built when trace messages are written
+    bool enabled;
 public:
     CallTracer(const char* functionName);
     ~CallTracer();
@@ -85,6 +85,7 @@ public:
 
     void MoveSizeUpdate(HMONITOR monitor, POINT const& ptScreen) noexcept
     {
+        POWERTOYS_PROFILE_SCOPE("FancyZones.MoveSizeUpdate");
         if (m_settings->GetSettings()->spanZonesAcrossMonitors)
         {
             monitor = NULL;
@@ -161,6 +162,7 @@ private:
 
     void OnEditorExitEvent() noexcept;
     void UpdateZoneSets() noexcept;
+    void UpdateZoneSets(const std::unordered_set<std::wstring>& changedDevices) noexcept;
     bool ShouldProcessSnapHotkey(DWORD vkCode) noexcept;
     void ApplyQuickLayout(int key) noexcept;
     void FlashZones() noexcept;
@@ -685,8 +687,7 @@ LRESULT FancyZones::WndProc(HWND window, UINT message, WPARAM wparam, LPARAM lpa
         }
         else if (message == WM_PRIV_FILE_UPDATE)
         {
-            FancyZonesDataInstance().LoadFancyZonesData();
-            UpdateZoneSets();
+            UpdateZoneSets(FancyZonesDataInstance().ReloadFancyZonesData());
         }
         else if (message == WM_PRIV_QUICK_LAYOUT_KEY)
         {
@@ -1128,8 +1129,7 @@ void FancyZones::OnSettingsChanged() noexcept
 void FancyZones::OnEditorExitEvent() noexcept
 {
     // Collect information about changes in zone layout after editor exited.
-    FancyZonesDataInstance().LoadFancyZonesData();
-    UpdateZoneSets();
+    UpdateZoneSets(FancyZonesDataInstance().ReloadFancyZonesData());
 }
 
 void FancyZones::UpdateZoneSets() noexcept
@@ -1144,6 +1144,19 @@ void FancyZones::UpdateZoneSets() noexcept
     }
 }
 
+void FancyZones::UpdateZoneSets(const std::unordered_set<std::wstring>& changedDevices) noexcept
+{
+    if (m_workAreaHandler.UpdateWorkAreas(changedDevices) == 0)
+    {
+        return;
+    }
+
+    if (m_settings->GetSettings()->zoneSetChange_moveWindows)
+    {
+        UpdateWindowsPositions();
+    }
+}
+
 bool FancyZones::ShouldProcessSnapHotkey(DWORD vkCode) noexcept
 {
     auto window = GetForegroundWindow();
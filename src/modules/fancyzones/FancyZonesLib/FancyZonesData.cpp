@@ -565,6 +565,29 @@ void FancyZonesData::LoadFancyZonesData()
     }
 }
 
+std::unordered_set<std::wstring> FancyZonesData::ReloadFancyZonesData()
+{
+    _TRACER_;
+    if (!std::filesystem::exists(zonesSettingsFileName))
+    {
+        return {};
+    }
+
+    json::JsonObject fancyZonesDataJSON = GetPersistFancyZonesJSON();
+    auto newDeviceInfoMap = JSONHelpers::ParseDeviceInfos(fancyZonesDataJSON);
+    auto newCustomZoneSetsMap = JSONHelpers::ParseCustomZoneSets(fancyZonesDataJSON);
+
+    std::scoped_lock lock{ dataLock };
+    auto changedDevices = JSONHelpers::GetChangedDevices(deviceInfoMap, newDeviceInfoMap, customZoneSetsMap, newCustomZoneSetsMap);
+
+    appZoneHistoryMap = JSONHelpers::ParseAppZoneHistory(fancyZonesDataJSON);
+    deviceInfoMap = std::move(newDeviceInfoMap);
+    customZoneSetsMap = std::move(newCustomZoneSetsMap);
+    quickKeysMap = JSONHelpers::ParseQuickKeys(fancyZonesDataJSON);
+
+    return changedDevices;
+}
+
 void FancyZonesData::SaveAppZoneHistoryAndZoneSettings() const
 {
     SaveZoneSettings();
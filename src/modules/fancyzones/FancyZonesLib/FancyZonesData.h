@@ -8,6 +8,7 @@
 
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <optional>
 #include <vector>
 #include <winnt.h>
@@ -36,6 +37,7 @@ namespace FancyZonesUnitTests
     class ZoneSetCalculateZonesUnitTests;
     class WorkAreaUnitTests;
     class WorkAreaCreationUnitTests;
+    class WorkAreaReloadUnitTests;
 }
 #endif
 
@@ -86,6 +88,7 @@ public:
     json::JsonObject GetPersistFancyZonesJSON();
 
     void LoadFancyZonesData();
+    std::unordered_set<std::wstring> ReloadFancyZonesData();
     void SaveAppZoneHistoryAndZoneSettings() const;
     void SaveZoneSettings() const;
     void SaveAppZoneHistory() const;
@@ -98,6 +101,7 @@ private:
     friend class FancyZonesUnitTests::FancyZonesIFancyZonesCallbackUnitTests;
     friend class FancyZonesUnitTests::WorkAreaUnitTests;
     friend class FancyZonesUnitTests::WorkAreaCreationUnitTests;
+    friend class FancyZonesUnitTests::WorkAreaReloadUnitTests;
     friend class FancyZonesUnitTests::ZoneSetCalculateZonesUnitTests;
 
     inline void SetDeviceInfo(const std::wstring& deviceId, FancyZonesDataTypes::DeviceInfoData data)
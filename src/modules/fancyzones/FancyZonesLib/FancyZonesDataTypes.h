@@ -43,9 +43,13 @@ namespace FancyZonesDataTypes
             int y;
             int width;
             int height;
+
+            bool operator==(const Rect&) const = default;
         };
         std::vector<CanvasLayoutInfo::Rect> zones;
         int sensitivityRadius;
+
+        bool operator==(const CanvasLayoutInfo&) const = default;
     };
 
     struct GridLayoutInfo
@@ -88,6 +92,8 @@ namespace FancyZonesDataTypes
 
         int zoneCount() const;
 
+        bool operator==(const GridLayoutInfo&) const = default;
+
         int m_rows;
         int m_columns;
         std::vector<int> m_rowsPercents;
@@ -103,12 +109,16 @@ namespace FancyZonesDataTypes
         std::wstring name;
         CustomLayoutType type;
         std::variant<CanvasLayoutInfo, GridLayoutInfo> info;
+
+        bool operator==(const CustomZoneSetData&) const = default;
     };
 
     struct ZoneSetData
     {
         std::wstring uuid;
         ZoneSetLayoutType type;
+
+        bool operator==(const ZoneSetData&) const = default;
     };
 
     struct AppZoneHistoryData
@@ -136,5 +146,7 @@ namespace FancyZonesDataTypes
         int spacing;
         int zoneCount;
         int sensitivityRadius;
+
+        bool operator==(const DeviceInfoData&) const = default;
     };
 }
@@ -751,4 +751,40 @@ namespace JSONHelpers
 
         return quickKeysJSON;
     }
-}
\ No newline at end of file
+
+    std::unordered_set<std::wstring> GetChangedDevices(const TDeviceInfoMap& oldDeviceInfoMap,
+                                                       const TDeviceInfoMap& newDeviceInfoMap,
+                                                       const TCustomZoneSetsMap& oldCustomZoneSetsMap,
+                                                       const TCustomZoneSetsMap& newCustomZoneSetsMap)
+    {
+        auto customZoneSetChanged = [&](const std::wstring& uuid) {
+            auto oldIt = oldCustomZoneSetsMap.find(uuid);
+            auto newIt = newCustomZoneSetsMap.find(uuid);
+            const bool oldFound = oldIt != oldCustomZoneSetsMap.end();
+            const bool newFound = newIt != newCustomZoneSetsMap.end();
+            if (!oldFound || !newFound)
+            {
+                return oldFound != newFound;
+            }
+
+            return !(oldIt->second == newIt->second);
+        };
+
+        std::unordered_set<std::wstring> changedDevices{};
+        for (const auto& [deviceId, data] : newDeviceInfoMap)
+        {
+            auto oldIt = oldDeviceInfoMap.find(deviceId);
+            if (oldIt == oldDeviceInfoMap.end() || !(oldIt->second == data))
+            {
+                changedDevices.insert(deviceId);
+            }
+            else if (data.activeZoneSet.type == FancyZonesDataTypes::ZoneSetLayoutType::Custom && customZoneSetChanged(data.activeZoneSet.uuid))
+            {
+                changedDevices.insert(deviceId);
+            }
+        }
+
+        // Devices removed from the file keep their current zone set, so they don't need recalculation.
+        return changedDevices;
+    }
+}
@@ -7,6 +7,7 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace JSONHelpers
 {
@@ -107,4 +108,11 @@ namespace JSONHelpers
 
     TLayoutQuickKeysMap ParseQuickKeys(const json::JsonObject& fancyZonesDataJSON);
     json::JsonArray SerializeQuickKeys(const TLayoutQuickKeysMap& quickKeysMap);
+
+    // Returns ids of devices whose effective layout differs between the two snapshots, either because
+    // the device entry itself changed or because the custom layout it uses was edited.
+    std::unordered_set<std::wstring> GetChangedDevices(const TDeviceInfoMap& oldDeviceInfoMap,
+                                                       const TDeviceInfoMap& newDeviceInfoMap,
+                                                       const TCustomZoneSetsMap& oldCustomZoneSetsMap,
+                                                       const TCustomZoneSetsMap& newCustomZoneSetsMap);
 }
@@ -77,6 +77,23 @@ std::vector<winrt::com_ptr<IWorkArea>> MonitorWorkAreaHandler::GetAllWorkAreas()
     return workAreas;
 }
 
+size_t MonitorWorkAreaHandler::UpdateWorkAreas(const std::unordered_set<std::wstring>& changedDevices)
+{
+    size_t updated = 0;
+    for (const auto& [desktopId, perDesktopData] : workAreaMap)
+    {
+        for (const auto& [monitor, workArea] : perDesktopData)
+        {
+            if (changedDevices.contains(workArea->UniqueId()))
+            {
+                workArea->UpdateActiveZoneSet();
+                updated++;
+            }
+        }
+    }
+    return updated;
+}
+
 void MonitorWorkAreaHandler::AddWorkArea(const GUID& desktopId, HMONITOR monitor, winrt::com_ptr<IWorkArea>& workArea)
 {
     if (!workAreaMap.contains(desktopId))
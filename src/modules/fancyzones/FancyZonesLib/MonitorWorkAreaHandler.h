@@ -67,6 +67,15 @@ public:
      */
     std::vector<winrt::com_ptr<IWorkArea>> GetAllWorkAreas();
 
+    /**
+     * Recalculate the active zone set of the work areas whose device changed.
+     *
+     * @param[in]  changedDevices Unique ids of the work areas to recalculate.
+     *
+     * @returns    Number of recalculated work areas.
+     */
+    size_t UpdateWorkAreas(const std::unordered_set<std::wstring>& changedDevices);
+
     /**
      * Register new work area.
      *
@@ -2056,4 +2056,110 @@ namespace FancyZonesUnitTests
             compareJsonObjects(expected, actual);
         }
     };
-}
\ No newline at end of file
+
+    TEST_CLASS (ChangedDevicesUnitTests)
+    {
+        const std::wstring m_device1 = L"AOC2460#4&fe3a015&0&UID65793_1920_1200_{39B25DD2-130D-4B5D-8851-4791D66B1539}";
+        const std::wstring m_device2 = L"AOC2460#4&fe3a015&0&UID65794_1920_1080_{39B25DD2-130D-4B5D-8851-4791D66B1539}";
+        const std::wstring m_device3 = L"AOC2460#4&fe3a015&0&UID65795_2560_1440_{39B25DD2-130D-4B5D-8851-4791D66B1539}";
+        const std::wstring m_customUuid = L"{33A2B101-06E0-437B-A61E-CDBECF502906}";
+
+        TDeviceInfoMap m_devices;
+        TCustomZoneSetsMap m_customZoneSets;
+
+        TEST_METHOD_INITIALIZE(Init)
+        {
+            m_devices = {
+                { m_device1, DeviceInfoData{ ZoneSetData{ L"{2DA4E2E6-5E1C-4CD1-8A2D-7C3C6A0D6D60}", ZoneSetLayoutType::Grid }, true, 16, 3, 20 } },
+                { m_device2, DeviceInfoData{ ZoneSetData{ m_customUuid, ZoneSetLayoutType::Custom }, true, 16, 3, 20 } },
+                { m_device3, DeviceInfoData{ ZoneSetData{ m_customUuid, ZoneSetLayoutType::Custom }, true, 16, 3, 20 } },
+            };
+
+            CanvasLayoutInfo canvas{ 1920, 1080, { CanvasLayoutInfo::Rect{ 0, 0, 960, 1080 }, CanvasLayoutInfo::Rect{ 960, 0, 960, 1080 } }, 20 };
+            m_customZoneSets = {
+                { m_customUuid, CustomZoneSetData{ L"custom", CustomLayoutType::Canvas, canvas } },
+            };
+        }
+
+        TEST_METHOD (NoChanges)
+        {
+            auto actual = GetChangedDevices(m_devices, m_devices, m_customZoneSets, m_customZoneSets);
+            Assert::AreEqual((size_t)0, actual.size());
+        }
+
+        TEST_METHOD (ActiveLayoutChangedOnSingleDevice)
+        {
+            auto newDevices = m_devices;
+            newDevices[m_device1].activeZoneSet.type = ZoneSetLayoutType::Columns;
+
+            auto actual = GetChangedDevices(m_devices, newDevices, m_customZoneSets, m_customZoneSets);
+            Assert::AreEqual((size_t)1, actual.size());
+            Assert::IsTrue(actual.contains(m_device1));
+        }
+
+        TEST_METHOD (SpacingChangedOnSingleDevice)
+        {
+            auto newDevices = m_devices;
+            newDevices[m_device2].spacing = 0;
+
+            auto actual = GetChangedDevices(m_devices, newDevices, m_customZoneSets, m_customZoneSets);
+            Assert::AreEqual((size_t)1, actual.size());
+            Assert::IsTrue(actual.contains(m_device2));
+        }
+
+        TEST_METHOD (CustomLayoutEdited)
+        {
+            auto newCustomZoneSets = m_customZoneSets;
+            std::get<CanvasLayoutInfo>(newCustomZoneSets[m_customUuid].info).zones[0].width = 900;
+
+            auto actual = GetChangedDevices(m_devices, m_devices, m_customZoneSets, newCustomZoneSets);
+            Assert::AreEqual((size_t)2, actual.size());
+            Assert::IsTrue(actual.contains(m_device2));
+            Assert::IsTrue(actual.contains(m_device3));
+        }
+
+        TEST_METHOD (CustomLayoutRenamed)
+        {
+            auto newCustomZoneSets = m_customZoneSets;
+            newCustomZoneSets[m_customUuid].name = L"renamed";
+
+            auto actual = GetChangedDevices(m_devices, m_devices, m_customZoneSets, newCustomZoneSets);
+            Assert::AreEqual((size_t)2, actual.size());
+        }
+
+        TEST_METHOD (UnusedCustomLayoutAdded)
+        {
+            auto newCustomZoneSets = m_customZoneSets;
+            newCustomZoneSets[L"{8E2B5D4C-9D47-4B8F-9F2A-3E1B8C6E7A51}"] = m_customZoneSets[m_customUuid];
+
+            auto actual = GetChangedDevices(m_devices, m_devices, m_customZoneSets, newCustomZoneSets);
+            Assert::AreEqual((size_t)0, actual.size());
+        }
+
+        TEST_METHOD (CustomLayoutDeleted)
+        {
+            auto actual = GetChangedDevices(m_devices, m_devices, m_customZoneSets, {});
+            Assert::AreEqual((size_t)2, actual.size());
+        }
+
+        TEST_METHOD (DeviceAdded)
+        {
+            const std::wstring newDevice = L"AOC2460#4&fe3a015&0&UID65796_1920_1080_{39B25DD2-130D-4B5D-8851-4791D66B1539}";
+            auto newDevices = m_devices;
+            newDevices[newDevice] = m_devices[m_device1];
+
+            auto actual = GetChangedDevices(m_devices, newDevices, m_customZoneSets, m_customZoneSets);
+            Assert::AreEqual((size_t)1, actual.size());
+            Assert::IsTrue(actual.contains(newDevice));
+        }
+
+        TEST_METHOD (DeviceRemoved)
+        {
+            auto newDevices = m_devices;
+            newDevices.erase(m_device1);
+
+            auto actual = GetChangedDevices(m_devices, newDevices, m_customZoneSets, m_customZoneSets);
+            Assert::AreEqual((size_t)0, actual.size());
+        }
+    };
+}
@@ -10,6 +10,7 @@
 #include <FancyZonesLib/FancyZonesDataTypes.h>
 #include <FancyZonesLib/JsonHelpers.h>
 #include <FancyZonesLib/ZoneColors.h>
+#include <FancyZonesLib/MonitorWorkAreaHandler.h>
 #include "Util.h"
 
 #include <common/utils/process_path.h>
@@ -480,4 +481,97 @@ namespace FancyZonesUnitTests
                 Assert::AreEqual(originalHeight, (int)inZoneRect.bottom - (int)inZoneRect.top);
             }
     };
+
+    TEST_CLASS (WorkAreaReloadUnitTests)
+    {
+        HMONITOR m_monitor{};
+        std::wstring m_uniqueId1;
+        std::wstring m_uniqueId2;
+        ZoneColors m_zoneColors{};
+        OverlappingZonesAlgorithm m_overlappingAlgorithm = OverlappingZonesAlgorithm::Positional;
+        std::optional<json::JsonObject> m_savedJson;
+
+        FancyZonesData& m_fancyZonesData = FancyZonesDataInstance();
+        MonitorWorkAreaHandler m_workAreaHandler;
+
+        void AddWorkArea(const std::wstring& uniqueId, const std::wstring& virtualDesktopId)
+        {
+            auto workArea = MakeWorkArea({}, m_monitor, uniqueId, {}, m_zoneColors, m_overlappingAlgorithm);
+            Assert::IsNotNull(workArea.get());
+            m_workAreaHandler.AddWorkArea(*Helpers::StringToGuid(virtualDesktopId), m_monitor, workArea);
+        }
+
+        IZoneSet* ActiveZoneSet(const std::wstring& uniqueId)
+        {
+            for (const auto& workArea : m_workAreaHandler.GetAllWorkAreas())
+            {
+                if (workArea->UniqueId() == uniqueId)
+                {
+                    return workArea->ActiveZoneSet();
+                }
+            }
+            return nullptr;
+        }
+
+        TEST_METHOD_INITIALIZE(Init)
+        {
+            m_monitor = MonitorFromPoint(POINT{ 0, 0 }, MONITOR_DEFAULTTOPRIMARY);
+            MONITORINFOEX monitorInfo{};
+            monitorInfo.cbSize = sizeof(monitorInfo);
+            Assert::AreNotEqual(0, GetMonitorInfoW(m_monitor, &monitorInfo));
+
+            const std::wstring resolution = std::to_wstring(monitorInfo.rcMonitor.right) + L"_" + std::to_wstring(monitorInfo.rcMonitor.bottom);
+            m_uniqueId1 = L"DELA026#5&10a58c63&0&UID16777488_" + resolution + L"_{39B25DD2-130D-4B5D-8851-4791D66B1539}";
+            m_uniqueId2 = L"DELA026#5&10a58c63&0&UID16777488_" + resolution + L"_{61FA9FC0-26A6-4B37-A834-491C148DFC57}";
+
+            m_fancyZonesData.SetSettingsModulePath(L"FancyZonesUnitTests");
+            m_savedJson = json::from_file(m_fancyZonesData.zonesSettingsFileName);
+            m_fancyZonesData.clear_data();
+
+            AddWorkArea(m_uniqueId1, L"{39B25DD2-130D-4B5D-8851-4791D66B1539}");
+            AddWorkArea(m_uniqueId2, L"{61FA9FC0-26A6-4B37-A834-491C148DFC57}");
+            m_fancyZonesData.SaveZoneSettings();
+        }
+
+        TEST_METHOD_CLEANUP(Cleanup)
+        {
+            if (m_savedJson)
+            {
+                json::to_file(m_fancyZonesData.zonesSettingsFileName, *m_savedJson);
+            }
+            else
+            {
+                std::filesystem::remove(m_fancyZonesData.zonesSettingsFileName);
+            }
+            m_fancyZonesData.clear_data();
+        }
+
+        TEST_METHOD (ReloadUnchangedFileDoesntRecalculateWorkAreas)
+        {
+            auto* zoneSet1 = ActiveZoneSet(m_uniqueId1);
+            auto* zoneSet2 = ActiveZoneSet(m_uniqueId2);
+
+            const auto changedDevices = m_fancyZonesData.ReloadFancyZonesData();
+
+            Assert::AreEqual<size_t>(0, m_workAreaHandler.UpdateWorkAreas(changedDevices));
+            Assert::IsTrue(zoneSet1 == ActiveZoneSet(m_uniqueId1));
+            Assert::IsTrue(zoneSet2 == ActiveZoneSet(m_uniqueId2));
+        }
+
+        TEST_METHOD (ReloadRecalculatesOnlyTheWorkAreaWithTheChangedLayout)
+        {
+            auto* zoneSet2 = ActiveZoneSet(m_uniqueId2);
+
+            // The editor applied the columns layout on the first work area only
+            auto deviceInfoMap = m_fancyZonesData.GetDeviceInfoMap();
+            deviceInfoMap[m_uniqueId1].activeZoneSet = FancyZonesDataTypes::ZoneSetData{ L"{8E2B5D4C-9D47-4B8F-9F2A-3E1B8C6E7A51}", FancyZonesDataTypes::ZoneSetLayoutType::Columns };
+            JSONHelpers::SaveZoneSettings(m_fancyZonesData.zonesSettingsFileName, deviceInfoMap, m_fancyZonesData.GetCustomZoneSetsMap(), m_fancyZonesData.GetLayoutQuickKeys());
+
+            const auto changedDevices = m_fancyZonesData.ReloadFancyZonesData();
+
+            Assert::AreEqual<size_t>(1, m_workAreaHandler.UpdateWorkAreas(changedDevices));
+            Assert::AreEqual(static_cast<int>(FancyZonesDataTypes::ZoneSetLayoutType::Columns), static_cast<int>(ActiveZoneSet(m_uniqueId1)->LayoutType()));
+            Assert::IsTrue(zoneSet2 == ActiveZoneSet(m_uniqueId2));
+        }
+    };
 }
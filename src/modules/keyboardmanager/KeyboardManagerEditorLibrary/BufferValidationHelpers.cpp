@@ -9,11 +9,12 @@
 #include "UIHelpers.h"
 #include "EditorHelpers.h"
 #include "EditorConstants.h"
+#include "RemapConflictIndex.h"
 
 namespace BufferValidationHelpers
 {
     // Function to validate and update an element of the key remap buffer when the selection has changed
-    ShortcutErrorType ValidateAndUpdateKeyBufferElement(int rowIndex, int colIndex, int selectedKeyCode, RemapBuffer& remapBuffer)
+    ShortcutErrorType ValidateAndUpdateKeyBufferElement(int rowIndex, int colIndex, int selectedKeyCode, RemapBuffer& remapBuffer, RemapConflictIndex& conflictIndex)
     {
         ShortcutErrorType errorType = ShortcutErrorType::NoError;
 
@@ -34,23 +35,7 @@ namespace BufferValidationHelpers
             if (errorType == ShortcutErrorType::NoError && colIndex == 0)
             {
                 // Check if the key is already remapped to something else
-                for (int i = 0; i < remapBuffer.size(); i++)
-                {
-                    if (i != rowIndex)
-                    {
-                        if (remapBuffer[i].first[colIndex].index() == 0)
-                        {
-                            ShortcutErrorType result = EditorHelpers::DoKeysOverlap(std::get<DWORD>(remapBuffer[i].first[colIndex]), selectedKeyCode);
-                            if (result != ShortcutErrorType::NoError)
-                            {
-                                errorType = result;
-                                break;
-                            }
-                        }
-
-                        // If one column is shortcut and other is key no warning required
-                    }
-                }
+                errorType = conflictIndex.FindKeyConflict(rowIndex, selectedKeyCode, nullptr, false);
             }
 
             // If there is no error, set the buffer
@@ -69,11 +54,12 @@ namespace BufferValidationHelpers
             remapBuffer[rowIndex].first[colIndex] = (DWORD)0;
         }
 
+        conflictIndex.OnRowChanged(remapBuffer, rowIndex);
         return errorType;
     }
 
     // Function to validate an element of the shortcut remap buffer when the selection has changed
-    std::pair<ShortcutErrorType, DropDownAction> ValidateShortcutBufferElement(int rowIndex, int colIndex, uint32_t dropDownIndex, const std::vector<int32_t>& selectedCodes, std::wstring appName, bool isHybridControl, const RemapBuffer& remapBuffer, bool dropDownFound)
+    std::pair<ShortcutErrorType, DropDownAction> ValidateShortcutBufferElement(int rowIndex, int colIndex, uint32_t dropDownIndex, const std::vector<int32_t>& selectedCodes, std::wstring appName, bool isHybridControl, const RemapBuffer& remapBuffer, bool dropDownFound, const RemapConflictIndex& conflictIndex)
     {
         BufferValidationHelpers::DropDownAction dropDownAction = BufferValidationHelpers::DropDownAction::NoAction;
         ShortcutErrorType errorType = ShortcutErrorType::NoError;
@@ -263,43 +249,13 @@ namespace BufferValidationHelpers
             if (errorType == ShortcutErrorType::NoError && colIndex == 0)
             {
                 // Check if the key is already remapped to something else for the same target app
-                for (int i = 0; i < remapBuffer.size(); i++)
+                if (tempShortcut.index() == 1)
                 {
-                    std::wstring currAppName = remapBuffer[i].second;
-                    std::transform(currAppName.begin(), currAppName.end(), currAppName.begin(), towlower);
-
-                    if (i != rowIndex && currAppName == appName)
-                    {
-                        ShortcutErrorType result = ShortcutErrorType::NoError;
-                        if (!isHybridControl)
-                        {
-                            result = EditorHelpers::DoShortcutsOverlap(std::get<Shortcut>(remapBuffer[i].first[colIndex]), std::get<Shortcut>(tempShortcut));
-                        }
-                        else
-                        {
-                            if (tempShortcut.index() == 0 && remapBuffer[i].first[colIndex].index() == 0)
-                            {
-                                if (std::get<DWORD>(tempShortcut) != NULL && std::get<DWORD>(remapBuffer[i].first[colIndex]) != NULL)
-                                {
-                                    result = EditorHelpers::DoKeysOverlap(std::get<DWORD>(remapBuffer[i].first[colIndex]), std::get<DWORD>(tempShortcut));
-                                }
-                            }
-                            else if (tempShortcut.index() == 1 && remapBuffer[i].first[colIndex].index() == 1)
-                            {
-                                auto& shortcut = std::get<Shortcut>(remapBuffer[i].first[colIndex]);
-                                if (EditorHelpers::IsValidShortcut(std::get<Shortcut>(tempShortcut)) && EditorHelpers::IsValidShortcut(shortcut))
-                                {
-                                    result = EditorHelpers::DoShortcutsOverlap(std::get<Shortcut>(remapBuffer[i].first[colIndex]), std::get<Shortcut>(tempShortcut));
-                                }
-                            }
-                            // Other scenarios not possible since key to shortcut is with key to key, and shortcut to key is with shortcut to shortcut
-                        }
-                        if (result != ShortcutErrorType::NoError)
-                        {
-                            errorType = result;
-                            break;
-                        }
-                    }
+                    errorType = conflictIndex.FindShortcutConflict(rowIndex, std::get<Shortcut>(tempShortcut), appName);
+                }
+                else if (isHybridControl)
+                {
+                    errorType = conflictIndex.FindKeyConflict(rowIndex, std::get<DWORD>(tempShortcut), &appName, true);
                 }
             }
 
@@ -311,4 +267,29 @@ namespace BufferValidationHelpers
 
         return std::make_pair(errorType, dropDownAction);
     }
+
+    // Function to get the conflict of the original key or shortcut of each row with the other rows, in a single pass over the buffer. Rows without a valid original key have no conflict
+    std::vector<ShortcutErrorType> FindOriginalKeyConflicts(const RemapBuffer& remapBuffer, bool isSingleKeyWindow)
+    {
+        RemapConflictIndex conflictIndex(remapBuffer);
+
+        std::vector<ShortcutErrorType> conflicts(remapBuffer.size(), ShortcutErrorType::NoError);
+        for (int i = 0; i < remapBuffer.size(); i++)
+        {
+            const KeyShortcutUnion& originalKey = remapBuffer[i].first[0];
+            std::wstring appName = remapBuffer[i].second;
+            std::transform(appName.begin(), appName.end(), appName.begin(), towlower);
+            if (originalKey.index() == 0)
+            {
+                // Single key remaps are not app specific
+                conflicts[i] = conflictIndex.FindKeyConflict(i, std::get<DWORD>(originalKey), isSingleKeyWindow ? nullptr : &appName, true);
+            }
+            else
+            {
+                conflicts[i] = conflictIndex.FindShortcutConflict(i, std::get<Shortcut>(originalKey), appName);
+            }
+        }
+
+        return conflicts;
+    }
 }
@@ -4,6 +4,8 @@
 
 #include "ShortcutErrorType.h"
 
+class RemapConflictIndex;
+
 namespace BufferValidationHelpers
 {
     enum class DropDownAction
@@ -14,9 +16,12 @@ namespace BufferValidationHelpers
         ClearUnusedDropDowns
     };
 
-    // Function to validate and update an element of the key remap buffer when the selection has changed
-    ShortcutErrorType ValidateAndUpdateKeyBufferElement(int rowIndex, int colIndex, int selectedKeyCode, RemapBuffer& remapBuffer);
+    // Function to validate and update an element of the key remap buffer when the selection has changed. The conflict index must be in sync with the buffer, and it is updated with the row
+    ShortcutErrorType ValidateAndUpdateKeyBufferElement(int rowIndex, int colIndex, int selectedKeyCode, RemapBuffer& remapBuffer, RemapConflictIndex& conflictIndex);
+
+    // Function to validate an element of the shortcut remap buffer when the selection has changed. The conflict index must be in sync with the buffer
+    std::pair<ShortcutErrorType, DropDownAction> ValidateShortcutBufferElement(int rowIndex, int colIndex, uint32_t dropDownIndex, const std::vector<int32_t>& selectedCodes, std::wstring appName, bool isHybridControl, const RemapBuffer& remapBuffer, bool dropDownFound, const RemapConflictIndex& conflictIndex);
 
-    // Function to validate an element of the shortcut remap buffer when the selection has changed
-    std::pair<ShortcutErrorType, DropDownAction> ValidateShortcutBufferElement(int rowIndex, int colIndex, uint32_t dropDownIndex, const std::vector<int32_t>& selectedCodes, std::wstring appName, bool isHybridControl, const RemapBuffer& remapBuffer, bool dropDownFound);
+    // Function to get the conflict of the original key or shortcut of each row with the other rows, in a single pass over the buffer. Rows without a valid original key have no conflict
+    std::vector<ShortcutErrorType> FindOriginalKeyConflicts(const RemapBuffer& remapBuffer, bool isSingleKeyWindow);
 }
@@ -17,6 +17,9 @@ namespace EditorHelpers
     // Function to check if the two shortcuts are equal or cover the same set of keys. Return value depends on type of overlap
     ShortcutErrorType DoShortcutsOverlap(const Shortcut& first, const Shortcut& second);
 
+    // Function to check if the two valid shortcuts are equal or cover the same set of keys, with their masks already compiled. Same result as DoShortcutsOverlap
+    ShortcutErrorType DoShortcutsOverlap(const Shortcut& first, const KeyboardManagerCore::CompiledChord& firstCompiled, const Shortcut& second, const KeyboardManagerCore::CompiledChord& secondCompiled);
+
     // Function to return a vector of hstring for each key in the display order
     std::vector<winrt::hstring> GetKeyVector(Shortcut shortcut, LayoutMap& keyboardMap);
 
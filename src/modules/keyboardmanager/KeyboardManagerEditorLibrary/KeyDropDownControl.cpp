@@ -12,6 +12,8 @@
 #include "EditorHelpers.h"
 #include "ShortcutErrorType.h"
 #include "EditorConstants.h"
+#include "ShortcutControl.h"
+#include "SingleKeyRemapControl.h"
 
 // Initialized to null
 KBMEditor::KeyboardManagerState* KeyDropDownControl::keyboardManagerState = nullptr;
@@ -36,15 +38,10 @@ void KeyDropDownControl::SetSelectedValue(std::wstring value)
 }
 
 // Get keys name list depending if Disable is in dropdown
-std::vector<std::pair<DWORD, std::wstring>> KeyDropDownControl::GetKeyList(bool isShortcut, bool renderDisable)
+const std::vector<std::pair<DWORD, std::wstring>>& KeyDropDownControl::GetKeyList(bool isShortcut, bool renderDisable)
 {
-    auto list = keyboardManagerState->keyboardMap.GetKeyNameList(isShortcut);
-    if (renderDisable)
-    {
-        list.insert(list.begin(), { CommonSharedConstants::VK_DISABLED, keyboardManagerState->keyboardMap.GetKeyName(CommonSharedConstants::VK_DISABLED) });
-    }
-
-    return list;
+    // The lists with and without Disable are cached by the layout map, so the list isn't copied for each drop down
+    return keyboardManagerState->keyboardMap.GetKeyNameList(isShortcut, renderDisable);
 }
 
 // Function to set properties apart from the SelectionChanged event handler
@@ -126,7 +123,7 @@ void KeyDropDownControl::SetSelectionHandler(StackPanel& table, StackPanel row,
         int selectedKeyCode = GetSelectedValue(currentDropDown);
         
         // Validate current remap selection
-        ShortcutErrorType errorType = BufferValidationHelpers::ValidateAndUpdateKeyBufferElement(rowIndex, colIndex, selectedKeyCode, singleKeyRemapBuffer);
+        ShortcutErrorType errorType = BufferValidationHelpers::ValidateAndUpdateKeyBufferElement(rowIndex, colIndex, selectedKeyCode, singleKeyRemapBuffer, SingleKeyRemapControl::singleKeyConflictIndex);
 
         // If there is an error set the warning flyout
         if (errorType != ShortcutErrorType::NoError)
@@ -170,7 +167,7 @@ std::pair<ShortcutErrorType, int> KeyDropDownControl::ValidateShortcutSelection(
         }
 
         // Validate shortcut element
-        validationResult = BufferValidationHelpers::ValidateShortcutBufferElement(rowIndex, colIndex, dropDownIndex, selectedCodes, appName, isHybridControl, shortcutRemapBuffer, dropDownFound);
+        validationResult = BufferValidationHelpers::ValidateShortcutBufferElement(rowIndex, colIndex, dropDownIndex, selectedCodes, appName, isHybridControl, shortcutRemapBuffer, dropDownFound, isSingleKeyWindow ? SingleKeyRemapControl::singleKeyConflictIndex : ShortcutControl::shortcutConflictIndex);
 
         // Add or clear unused drop downs
         if (validationResult.second == BufferValidationHelpers::DropDownAction::AddDropDown)
@@ -281,6 +278,10 @@ void KeyDropDownControl::SetSelectionHandler(StackPanel& table, StackPanel row,
                     shortcutRemapBuffer[validationResult.second].second = targetApp.Text().c_str();
                 }
             }
+
+            // Update the conflict index with the row
+            RemapConflictIndex& conflictIndex = isSingleKeyWindow ? SingleKeyRemapControl::singleKeyConflictIndex : ShortcutControl::shortcutConflictIndex;
+            conflictIndex.OnRowChanged(shortcutRemapBuffer, validationResult.second);
         }
 
         // If the user searches for a key the selection handler gets invoked however if they click away it reverts back to the previous state. This can result in dangling references to added drop downs which were then reset.
@@ -7,6 +7,7 @@
 
 #include "KeyboardManagerState.h"
 #include "keyboardmanager/KeyboardManagerEditorLibrary/trace.h"
+#include "BufferValidationHelpers.h"
 #include "EditorHelpers.h"
 #include "ShortcutErrorType.h"
 
@@ -16,34 +17,24 @@ namespace LoadingAndSavingRemappingHelper
     ShortcutErrorType CheckIfRemappingsAreValid(const RemapBuffer& remappings)
     {
         ShortcutErrorType isSuccess = ShortcutErrorType::NoError;
-        std::map<std::wstring, std::set<KeyShortcutUnion>> ogKeys;
         for (int i = 0; i < remappings.size(); i++)
         {
             KeyShortcutUnion ogKey = remappings[i].first[0];
             KeyShortcutUnion newKey = remappings[i].first[1];
-            std::wstring appName = remappings[i].second;
 
             bool ogKeyValidity = (ogKey.index() == 0 && std::get<DWORD>(ogKey) != NULL) || (ogKey.index() == 1 && EditorHelpers::IsValidShortcut(std::get<Shortcut>(ogKey)));
             bool newKeyValidity = (newKey.index() == 0 && std::get<DWORD>(newKey) != NULL) || (newKey.index() == 1 && EditorHelpers::IsValidShortcut(std::get<Shortcut>(newKey)));
-
-            // Add new set for a new target app name
-            if (ogKeys.find(appName) == ogKeys.end())
+            if (!ogKeyValidity || !newKeyValidity)
             {
-                ogKeys[appName] = std::set<KeyShortcutUnion>();
+                return ShortcutErrorType::RemapUnsuccessful;
             }
+        }
 
-            if (ogKeyValidity && newKeyValidity && ogKeys[appName].find(ogKey) == ogKeys[appName].end())
-            {
-                ogKeys[appName].insert(ogKey);
-            }
-            else if (ogKeyValidity && newKeyValidity && ogKeys[appName].find(ogKey) != ogKeys[appName].end())
-            {
-                isSuccess = ShortcutErrorType::RemapUnsuccessful;
-            }
-            else
-            {
-                isSuccess = ShortcutErrorType::RemapUnsuccessful;
-            }
+        // Original keys or shortcuts which are remapped twice for the same target app, or which overlap like Ctrl+A and LCtrl+A, are found with one pass over a conflict index
+        std::vector<ShortcutErrorType> conflicts = BufferValidationHelpers::FindOriginalKeyConflicts(remappings, false);
+        if (std::any_of(conflicts.begin(), conflicts.end(), [](ShortcutErrorType conflict) { return conflict != ShortcutErrorType::NoError; }))
+        {
+            isSuccess = ShortcutErrorType::RemapUnsuccessful;
         }
 
         return isSuccess;
@@ -0,0 +1,280 @@
+#include "pch.h"
+#include "RemapConflictIndex.h"
+
+#include <common/interop/shared_constants.h>
+
+#include "EditorHelpers.h"
+
+namespace
+{
+    // Key codes of each modifier type. A key can only overlap with a key of its own type, or with itself
+    const std::vector<std::vector<DWORD>> modifierKeyFamilies = {
+        { VK_LWIN, VK_RWIN, CommonSharedConstants::VK_WIN_BOTH },
+        { VK_LCONTROL, VK_RCONTROL, VK_CONTROL },
+        { VK_LMENU, VK_RMENU, VK_MENU },
+        { VK_LSHIFT, VK_RSHIFT, VK_SHIFT }
+    };
+
+    std::wstring ToLower(std::wstring text)
+    {
+        std::transform(text.begin(), text.end(), text.begin(), towlower);
+        return text;
+    }
+
+    // Function to get the first row in the set other than the excluded row, or -1 if there is none
+    int GetFirstRow(const std::set<int>& rowIndices, int excludedRow)
+    {
+        for (int row : rowIndices)
+        {
+            if (row != excludedRow)
+            {
+                return row;
+            }
+        }
+
+        return -1;
+    }
+}
+
+RemapConflictIndex::ShortcutSignature RemapConflictIndex::GetSignature(const Shortcut& shortcut)
+{
+    ShortcutSignature modifierTypes = (shortcut.winKey != ModifierKey::Disabled ? 1 : 0) |
+                                      (shortcut.ctrlKey != ModifierKey::Disabled ? 2 : 0) |
+                                      (shortcut.altKey != ModifierKey::Disabled ? 4 : 0) |
+                                      (shortcut.shiftKey != ModifierKey::Disabled ? 8 : 0);
+    return (static_cast<ShortcutSignature>(shortcut.actionKey) << 4) | modifierTypes;
+}
+
+RemapConflictIndex::RemapConflictIndex(const RemapBuffer& remapBuffer)
+{
+    Reset(remapBuffer);
+}
+
+// Function to index all the rows of the buffer, replacing the indexed rows
+void RemapConflictIndex::Reset(const RemapBuffer& remapBuffer)
+{
+    rows.clear();
+    rowsByKey.clear();
+    rowsByShortcut.clear();
+    rows.reserve(remapBuffer.size());
+    for (const auto& row : remapBuffer)
+    {
+        AppendRow(row);
+    }
+}
+
+// Function to index the row which was added at the end of the buffer
+void RemapConflictIndex::OnRowAppended(const RemapBuffer& remapBuffer)
+{
+    AppendRow(remapBuffer.back());
+}
+
+// Function to remove a row which was erased from the buffer and renumber the rows after it. Renumbering keeps the order of the rows in each bucket, so the nodes are moved in place without reallocating
+void RemapConflictIndex::OnRowRemoved(int rowIndex)
+{
+    RemoveFromBuckets(rowIndex);
+    rows.erase(rows.begin() + rowIndex);
+
+    for (auto& [lowercaseAppName, keys] : rowsByKey)
+    {
+        for (auto& [key, rowIndices] : keys)
+        {
+            for (auto it = rowIndices.upper_bound(rowIndex); it != rowIndices.end();)
+            {
+                auto next = std::next(it);
+                auto node = rowIndices.extract(it);
+                node.value()--;
+                rowIndices.insert(next, std::move(node));
+                it = next;
+            }
+        }
+    }
+
+    for (auto& [lowercaseAppName, signatures] : rowsByShortcut)
+    {
+        for (auto& [signature, shortcuts] : signatures)
+        {
+            for (auto it = shortcuts.upper_bound(rowIndex); it != shortcuts.end();)
+            {
+                auto next = std::next(it);
+                auto node = shortcuts.extract(it);
+                node.key()--;
+                shortcuts.insert(next, std::move(node));
+                it = next;
+            }
+        }
+    }
+}
+
+// Function to re-index a row of the buffer. Only the original key and the target app are indexed, so changes to the new key don't update the buckets
+void RemapConflictIndex::OnRowChanged(const RemapBuffer& remapBuffer, int rowIndex)
+{
+    const auto& [items, appName] = remapBuffer[rowIndex];
+    IndexedRow& row = rows[rowIndex];
+    if (items[0] == row.originalKey && appName == row.appName)
+    {
+        return;
+    }
+
+    RemoveFromBuckets(rowIndex);
+    if (appName != row.appName)
+    {
+        row.appName = appName;
+        row.lowercaseAppName = ToLower(appName);
+    }
+
+    row.originalKey = items[0];
+    AddToBuckets(rowIndex);
+}
+
+void RemapConflictIndex::AppendRow(const RemapBufferRow& bufferRow)
+{
+    rows.push_back({ bufferRow.first[0], bufferRow.second, ToLower(bufferRow.second) });
+    AddToBuckets(static_cast<int>(rows.size()) - 1);
+}
+
+void RemapConflictIndex::AddToBuckets(int rowIndex)
+{
+    const IndexedRow& row = rows[rowIndex];
+    if (row.originalKey.index() == 0)
+    {
+        rowsByKey[row.lowercaseAppName][std::get<DWORD>(row.originalKey)].insert(rowIndex);
+    }
+    else
+    {
+        const Shortcut& shortcut = std::get<Shortcut>(row.originalKey);
+        if (EditorHelpers::IsValidShortcut(shortcut))
+        {
+            rowsByShortcut[row.lowercaseAppName][GetSignature(shortcut)].emplace(rowIndex, IndexedShortcut{ shortcut, KeyboardManagerCore::CompiledChord(shortcut.ToChord()) });
+        }
+    }
+}
+
+void RemapConflictIndex::RemoveFromBuckets(int rowIndex)
+{
+    const IndexedRow& row = rows[rowIndex];
+    if (row.originalKey.index() == 0)
+    {
+        auto app = rowsByKey.find(row.lowercaseAppName);
+        if (app != rowsByKey.end())
+        {
+            auto key = app->second.find(std::get<DWORD>(row.originalKey));
+            if (key != app->second.end())
+            {
+                key->second.erase(rowIndex);
+                if (key->second.empty())
+                {
+                    app->second.erase(key);
+                }
+            }
+        }
+    }
+    else
+    {
+        auto app = rowsByShortcut.find(row.lowercaseAppName);
+        if (app != rowsByShortcut.end())
+        {
+            auto signature = app->second.find(GetSignature(std::get<Shortcut>(row.originalKey)));
+            if (signature != app->second.end())
+            {
+                signature->second.erase(rowIndex);
+                if (signature->second.empty())
+                {
+                    app->second.erase(signature);
+                }
+            }
+        }
+    }
+}
+
+// Function to get the conflict of a key with the original keys of the other rows for the target app, or for all apps if appName is null
+ShortcutErrorType RemapConflictIndex::FindKeyConflict(int rowIndex, DWORD key, const std::wstring* appName, bool ignoreNullKeys) const
+{
+    if (ignoreNullKeys && key == NULL)
+    {
+        return ShortcutErrorType::NoError;
+    }
+
+    // Keys which overlap with the key: the key itself, and the keys of the same modifier type except the opposite left or right key
+    std::vector<DWORD> candidateKeys = { key };
+    for (const auto& family : modifierKeyFamilies)
+    {
+        if (std::find(family.begin(), family.end(), key) != family.end())
+        {
+            for (DWORD familyKey : family)
+            {
+                if (familyKey != key && EditorHelpers::DoKeysOverlap(familyKey, key) != ShortcutErrorType::NoError)
+                {
+                    candidateKeys.push_back(familyKey);
+                }
+            }
+        }
+    }
+
+    // The first conflicting row decides the error, same as a scan of the buffer
+    int firstRow = -1;
+    DWORD firstRowKey = 0;
+    for (const auto& [lowercaseAppName, keys] : rowsByKey)
+    {
+        if (appName != nullptr && lowercaseAppName != *appName)
+        {
+            continue;
+        }
+
+        for (DWORD candidateKey : candidateKeys)
+        {
+            auto it = keys.find(candidateKey);
+            if (it == keys.end())
+            {
+                continue;
+            }
+
+            const int row = GetFirstRow(it->second, rowIndex);
+            if (row != -1 && (firstRow == -1 || row < firstRow))
+            {
+                firstRow = row;
+                firstRowKey = candidateKey;
+            }
+        }
+    }
+
+    return firstRow == -1 ? ShortcutErrorType::NoError : EditorHelpers::DoKeysOverlap(firstRowKey, key);
+}
+
+// Function to get the conflict of a shortcut with the original shortcuts of the other rows for the same target app
+ShortcutErrorType RemapConflictIndex::FindShortcutConflict(int rowIndex, const Shortcut& shortcut, const std::wstring& appName) const
+{
+    if (!EditorHelpers::IsValidShortcut(shortcut))
+    {
+        return ShortcutErrorType::NoError;
+    }
+
+    auto app = rowsByShortcut.find(appName);
+    if (app == rowsByShortcut.end())
+    {
+        return ShortcutErrorType::NoError;
+    }
+
+    auto signature = app->second.find(GetSignature(shortcut));
+    if (signature == app->second.end())
+    {
+        return ShortcutErrorType::NoError;
+    }
+
+    const KeyboardManagerCore::CompiledChord compiled(shortcut.ToChord());
+    for (const auto& [row, rowShortcut] : signature->second)
+    {
+        if (row == rowIndex)
+        {
+            continue;
+        }
+
+        ShortcutErrorType result = EditorHelpers::DoShortcutsOverlap(rowShortcut.shortcut, rowShortcut.compiled, shortcut, compiled);
+        if (result != ShortcutErrorType::NoError)
+        {
+            return result;
+        }
+    }
+
+    return ShortcutErrorType::NoError;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <unordered_map>
+
+#include <keyboardmanager/common/Helpers.h>
+
+#include "ShortcutErrorType.h"
+
+// Index of the original keys and shortcuts of a remap buffer by target app, so that a row can be checked for conflicts with the other rows without comparing it with every row
+class RemapConflictIndex
+{
+public:
+    RemapConflictIndex() = default;
+    explicit RemapConflictIndex(const RemapBuffer& remapBuffer);
+
+    // Function to index all the rows of the buffer, replacing the indexed rows. Called when the buffer is loaded or cleared
+    void Reset(const RemapBuffer& remapBuffer);
+
+    // Functions called by the editor whenever it changes the buffer, with the row which changed, so that the index is kept in sync without comparing it with the buffer
+    void OnRowAppended(const RemapBuffer& remapBuffer);
+    void OnRowRemoved(int rowIndex);
+    void OnRowChanged(const RemapBuffer& remapBuffer, int rowIndex);
+
+    // Function to get the conflict of a key with the original keys of the other rows for the target app, or for all apps if appName is null. Same result as calling EditorHelpers::DoKeysOverlap on each row in order and returning the first error.
+    // If ignoreNullKeys is true, rows without a key don't conflict
+    ShortcutErrorType FindKeyConflict(int rowIndex, DWORD key, const std::wstring* appName, bool ignoreNullKeys) const;
+
+    // Function to get the conflict of a shortcut with the original shortcuts of the other rows for the same target app. Same result as calling EditorHelpers::DoShortcutsOverlap on each row in order and returning the first error
+    ShortcutErrorType FindShortcutConflict(int rowIndex, const Shortcut& shortcut, const std::wstring& appName) const;
+
+    size_t Size() const
+    {
+        return rows.size();
+    }
+
+private:
+    struct IndexedRow
+    {
+        KeyShortcutUnion originalKey;
+        std::wstring appName;
+        std::wstring lowercaseAppName;
+    };
+
+    // Original shortcut of a row, with its masks compiled once when the row is indexed
+    struct IndexedShortcut
+    {
+        Shortcut shortcut;
+        KeyboardManagerCore::CompiledChord compiled;
+    };
+
+    // Shortcuts can only overlap if they have the same action key and the same types of modifiers
+    using ShortcutSignature = uint64_t;
+    static ShortcutSignature GetSignature(const Shortcut& shortcut);
+
+    void AppendRow(const RemapBufferRow& bufferRow);
+
+    // Functions to add or remove a row in the buckets, without changing the rows
+    void AddToBuckets(int rowIndex);
+    void RemoveFromBuckets(int rowIndex);
+
+    std::vector<IndexedRow> rows;
+
+    // Rows of each original key by lowercase app name
+    std::unordered_map<std::wstring, std::unordered_map<DWORD, std::set<int>>> rowsByKey;
+
+    // Rows of each valid original shortcut by lowercase app name and signature, in row order
+    std::unordered_map<std::wstring, std::unordered_map<ShortcutSignature, std::map<int, IndexedShortcut>>> rowsByShortcut;
+};
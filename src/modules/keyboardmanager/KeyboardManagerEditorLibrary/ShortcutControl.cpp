@@ -15,6 +15,7 @@ HWND ShortcutControl::editShortcutsWindowHandle = nullptr;
 KBMEditor::KeyboardManagerState* ShortcutControl::keyboardManagerState = nullptr;
 // Initialized as new vector
 RemapBuffer ShortcutControl::shortcutRemapBuffer;
+RemapConflictIndex ShortcutControl::shortcutConflictIndex;
 
 ShortcutControl::ShortcutControl(StackPanel table, StackPanel row, const int colIndex, TextBox targetApp)
 {
@@ -170,6 +171,8 @@ void ShortcutControl::AddNewShortcutControlRow(StackPanel& parent, std::vector<s
             shortcutRemapBuffer[rowIndex].second = targetAppTextBox.Text().c_str();
         }
 
+        shortcutConflictIndex.OnRowChanged(shortcutRemapBuffer, rowIndex);
+
         // To set the accessibile name of the target app text box when focus is lost
         ShortcutControl::SetAccessibleNameForTextBox(targetAppTextBox, rowIndex + 1);
     });
@@ -218,6 +221,7 @@ void ShortcutControl::AddNewShortcutControlRow(StackPanel& parent, std::vector<s
         children.RemoveAt(rowIndex);
         parent.UpdateLayout();
         shortcutRemapBuffer.erase(shortcutRemapBuffer.begin() + rowIndex);
+        shortcutConflictIndex.OnRowRemoved(rowIndex);
         // delete the SingleKeyRemapControl objects so that they get destructed
         keyboardRemapControlObjects.erase(keyboardRemapControlObjects.begin() + rowIndex);
     });
@@ -245,6 +249,7 @@ void ShortcutControl::AddNewShortcutControlRow(StackPanel& parent, std::vector<s
     {
         // change to load app name
         shortcutRemapBuffer.push_back(std::make_pair<RemapBufferItem, std::wstring>(RemapBufferItem{ Shortcut(), Shortcut() }, std::wstring(targetAppName)));
+        shortcutConflictIndex.OnRowAppended(shortcutRemapBuffer);
         KeyDropDownControl::AddShortcutToControl(originalKeys, parent, keyboardRemapControlObjects[keyboardRemapControlObjects.size() - 1][0]->shortcutDropDownStackPanel.as<StackPanel>(), *keyboardManagerState, 0, keyboardRemapControlObjects[keyboardRemapControlObjects.size() - 1][0]->keyDropDownControlObjects, shortcutRemapBuffer, row, targetAppTextBox, false, false);
 
         if (newKeys.index() == 0)
@@ -260,6 +265,7 @@ void ShortcutControl::AddNewShortcutControlRow(StackPanel& parent, std::vector<s
     {
         // Initialize both shortcuts as empty shortcuts
         shortcutRemapBuffer.push_back(std::make_pair<RemapBufferItem, std::wstring>(RemapBufferItem{ Shortcut(), Shortcut() }, std::wstring(targetAppName)));
+        shortcutConflictIndex.OnRowAppended(shortcutRemapBuffer);
     }
 }
 
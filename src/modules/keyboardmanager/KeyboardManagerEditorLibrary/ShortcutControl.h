@@ -2,6 +2,8 @@
 
 #include <keyboardmanager/common/Shortcut.h>
 
+#include "RemapConflictIndex.h"
+
 namespace KBMEditor
 {
     class KeyboardManagerState;
@@ -47,6 +49,9 @@ public:
     // Stores the current list of remappings
     static RemapBuffer shortcutRemapBuffer;
 
+    // Index of the original keys of the remappings, updated whenever a row of the buffer is added, changed or deleted. Used to validate a selection without comparing it with every row
+    static RemapConflictIndex shortcutConflictIndex;
+
     // Vector to store dynamically allocated KeyDropDownControl objects to avoid early destruction
     std::vector<std::unique_ptr<KeyDropDownControl>> keyDropDownControlObjects;
 
@@ -12,6 +12,7 @@ HWND SingleKeyRemapControl::EditKeyboardWindowHandle = nullptr;
 KBMEditor::KeyboardManagerState* SingleKeyRemapControl::keyboardManagerState = nullptr;
 // Initialized as new vector
 RemapBuffer SingleKeyRemapControl::singleKeyRemapBuffer;
+RemapConflictIndex SingleKeyRemapControl::singleKeyConflictIndex;
 
 SingleKeyRemapControl::SingleKeyRemapControl(StackPanel table, StackPanel row, const int colIndex)
 {
@@ -111,6 +112,7 @@ void SingleKeyRemapControl::AddNewControlKeyRemapRow(StackPanel& parent, std::ve
     if (originalKey != NULL && !(newKey.index() == 0 && std::get<DWORD>(newKey) == NULL) && !(newKey.index() == 1 && !EditorHelpers::IsValidShortcut(std::get<Shortcut>(newKey))))
     {
         singleKeyRemapBuffer.push_back(std::make_pair<RemapBufferItem, std::wstring>(RemapBufferItem{ originalKey, newKey }, L""));
+        singleKeyConflictIndex.OnRowAppended(singleKeyRemapBuffer);
         keyboardRemapControlObjects[keyboardRemapControlObjects.size() - 1][0]->keyDropDownControlObjects[0]->SetSelectedValue(std::to_wstring(originalKey));
         if (newKey.index() == 0)
         {
@@ -125,6 +127,7 @@ void SingleKeyRemapControl::AddNewControlKeyRemapRow(StackPanel& parent, std::ve
     {
         // Initialize both keys to NULL
         singleKeyRemapBuffer.push_back(std::make_pair<RemapBufferItem, std::wstring>(RemapBufferItem{ (DWORD)0, (DWORD)0 }, L""));
+        singleKeyConflictIndex.OnRowAppended(singleKeyRemapBuffer);
     }
 
     // Delete row button
@@ -161,6 +164,7 @@ void SingleKeyRemapControl::AddNewControlKeyRemapRow(StackPanel& parent, std::ve
         children.RemoveAt(rowIndex);
         parent.UpdateLayout();
         singleKeyRemapBuffer.erase(singleKeyRemapBuffer.begin() + rowIndex);
+        singleKeyConflictIndex.OnRowRemoved(rowIndex);
     
         // delete the SingleKeyRemapControl objects so that they get destructed
         keyboardRemapControlObjects.erase(keyboardRemapControlObjects.begin() + rowIndex);
@@ -214,8 +218,6 @@ void SingleKeyRemapControl::createDetectKeyWindow(winrt::Windows::Foundation::II
 
         if (detectedKey != NULL)
         {
-            std::vector<DWORD> keyCodeList = keyboardManagerState.keyboardMap.GetKeyCodeList();
-
             // Update the drop down list with the new language to ensure that the correct key is displayed
             linkedRemapDropDown.ItemsSource(UIHelpers::ToBoxValue(keyboardManagerState.keyboardMap.GetKeyNameList()));
             linkedRemapDropDown.SelectedValue(winrt::box_value(std::to_wstring(detectedKey)));
@@ -2,6 +2,8 @@
 
 #include <keyboardmanager/common/Shortcut.h>
 
+#include "RemapConflictIndex.h"
+
 #include <KeyDropDownControl.h>
 
 namespace KBMEditor
@@ -48,6 +50,9 @@ public:
     // Stores the current list of remappings
     static RemapBuffer singleKeyRemapBuffer;
 
+    // Index of the original keys of the remappings, updated whenever a row of the buffer is added, changed or deleted. Used to validate a selection without comparing it with every row
+    static RemapConflictIndex singleKeyConflictIndex;
+
     // constructor
     SingleKeyRemapControl(StackPanel table, StackPanel row, const int colIndex);
 
@@ -1,9 +1,13 @@
 #include "pch.h"
 #include "CppUnitTest.h"
 #include <keyboardmanager/KeyboardManagerEditorLibrary/BufferValidationHelpers.h>
+#include <keyboardmanager/KeyboardManagerEditorLibrary/EditorHelpers.h>
+#include <keyboardmanager/KeyboardManagerEditorLibrary/RemapConflictIndex.h>
 #include <common/interop/keyboard_layout.h>
 #include <common/interop/shared_constants.h>
+#include <chrono>
 #include <functional>
+#include <random>
 #include <keyboardmanager/KeyboardManagerEditorLibrary/ShortcutErrorType.h>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
@@ -35,6 +39,86 @@ namespace RemappingUITests
             RemapBufferRow bufferRow;
         };
 
+        // Function to create random shortcuts with up to 3 modifiers and one of 5 action keys, so that many of them conflict
+        static std::vector<int32_t> CreateRandomShortcutCodes(std::mt19937& random)
+        {
+            const std::vector<std::vector<int32_t>> modifierKeys = {
+                { VK_LWIN, VK_RWIN, CommonSharedConstants::VK_WIN_BOTH },
+                { VK_LCONTROL, VK_RCONTROL, VK_CONTROL },
+                { VK_LMENU, VK_RMENU, VK_MENU },
+                { VK_LSHIFT, VK_RSHIFT, VK_SHIFT }
+            };
+
+            std::vector<int32_t> codes;
+            for (const auto& keys : modifierKeys)
+            {
+                if (random() % 3 == 0 && codes.size() < 3)
+                {
+                    codes.push_back(keys[random() % keys.size()]);
+                }
+            }
+
+            if (codes.empty())
+            {
+                codes.push_back(VK_LCONTROL);
+            }
+
+            codes.push_back(0x41 + random() % 5);
+            return codes;
+        }
+
+        // Function to create a shortcut remap buffer with random original shortcuts for a few apps
+        RemapBuffer CreateRandomShortcutBuffer(std::mt19937& random, size_t rowCount)
+        {
+            const std::wstring appNames[] = { L"", testApp1, testApp2, L"TestProcess1.exe" };
+            RemapBuffer remapBuffer;
+            for (size_t i = 0; i < rowCount; i++)
+            {
+                remapBuffer.push_back(std::make_pair(RemapBufferItem{ Shortcut(CreateRandomShortcutCodes(random)), Shortcut() }, appNames[random() % 4]));
+            }
+
+            return remapBuffer;
+        }
+
+        // Function to get the conflict of a key with the original keys of the other rows by comparing it with every row. Used as the reference for the conflict index
+        static ShortcutErrorType ScanKeyConflict(const RemapBuffer& remapBuffer, int rowIndex, DWORD key)
+        {
+            for (int i = 0; i < remapBuffer.size(); i++)
+            {
+                if (i != rowIndex && remapBuffer[i].first[0].index() == 0)
+                {
+                    ShortcutErrorType result = EditorHelpers::DoKeysOverlap(std::get<DWORD>(remapBuffer[i].first[0]), key);
+                    if (result != ShortcutErrorType::NoError)
+                    {
+                        return result;
+                    }
+                }
+            }
+
+            return ShortcutErrorType::NoError;
+        }
+
+        // Function to get the conflict of a shortcut with the original shortcuts of the other rows for the same target app by comparing it with every row. Used as the reference for the conflict index
+        static ShortcutErrorType ScanShortcutConflict(const RemapBuffer& remapBuffer, int rowIndex, const Shortcut& shortcut, std::wstring appName)
+        {
+            std::transform(appName.begin(), appName.end(), appName.begin(), towlower);
+            for (int i = 0; i < remapBuffer.size(); i++)
+            {
+                std::wstring currAppName = remapBuffer[i].second;
+                std::transform(currAppName.begin(), currAppName.end(), currAppName.begin(), towlower);
+                if (i != rowIndex && currAppName == appName && remapBuffer[i].first[0].index() == 1)
+                {
+                    ShortcutErrorType result = EditorHelpers::DoShortcutsOverlap(std::get<Shortcut>(remapBuffer[i].first[0]), shortcut);
+                    if (result != ShortcutErrorType::NoError)
+                    {
+                        return result;
+                    }
+                }
+            }
+
+            return ShortcutErrorType::NoError;
+        }
+
         void RunTestCases(const std::vector<ValidateShortcutBufferElementArgs>& testCases, std::function<void(const ValidateShortcutBufferElementArgs&)> testMethod)
         {
             for (int i = 0; i < testCases.size(); i++)
@@ -59,7 +143,8 @@ namespace RemappingUITests
 
             // Validate and update the element when -1 i.e. null selection is made on an empty row.
             ValidateAndUpdateKeyBufferElementArgs args = { 0, 0, -1 };
-            ShortcutErrorType error = BufferValidationHelpers::ValidateAndUpdateKeyBufferElement(args.elementRowIndex, args.elementColIndex, args.selectedCodeFromDropDown, remapBuffer);
+            RemapConflictIndex conflictIndex(remapBuffer);
+            ShortcutErrorType error = BufferValidationHelpers::ValidateAndUpdateKeyBufferElement(args.elementRowIndex, args.elementColIndex, args.selectedCodeFromDropDown, remapBuffer, conflictIndex);
 
             // Assert that the element is validated and buffer is updated
             Assert::AreEqual(true, error == ShortcutErrorType::NoError);
@@ -79,7 +164,8 @@ namespace RemappingUITests
 
             // Validate and update the element when selecting B on an empty row
             ValidateAndUpdateKeyBufferElementArgs args = { 0, 0, 0x42 };
-            ShortcutErrorType error = BufferValidationHelpers::ValidateAndUpdateKeyBufferElement(args.elementRowIndex, args.elementColIndex, args.selectedCodeFromDropDown, remapBuffer);
+            RemapConflictIndex conflictIndex(remapBuffer);
+            ShortcutErrorType error = BufferValidationHelpers::ValidateAndUpdateKeyBufferElement(args.elementRowIndex, args.elementColIndex, args.selectedCodeFromDropDown, remapBuffer, conflictIndex);
 
             // Assert that the element is validated and buffer is updated
             Assert::AreEqual(true, error == ShortcutErrorType::NoError);
@@ -97,7 +183,8 @@ namespace RemappingUITests
 
             // Validate and update the element when selecting B on a row
             ValidateAndUpdateKeyBufferElementArgs args = { 0, 0, 0x42 };
-            ShortcutErrorType error = BufferValidationHelpers::ValidateAndUpdateKeyBufferElement(args.elementRowIndex, args.elementColIndex, args.selectedCodeFromDropDown, remapBuffer);
+            RemapConflictIndex conflictIndex(remapBuffer);
+            ShortcutErrorType error = BufferValidationHelpers::ValidateAndUpdateKeyBufferElement(args.elementRowIndex, args.elementColIndex, args.selectedCodeFromDropDown, remapBuffer, conflictIndex);
 
             // Assert that the element is validated and buffer is updated
             Assert::AreEqual(true, error == ShortcutErrorType::NoError);
@@ -115,7 +202,8 @@ namespace RemappingUITests
 
             // Validate and update the element when selecting B on a row
             ValidateAndUpdateKeyBufferElementArgs args = { 0, 0, 0x42 };
-            ShortcutErrorType error = BufferValidationHelpers::ValidateAndUpdateKeyBufferElement(args.elementRowIndex, args.elementColIndex, args.selectedCodeFromDropDown, remapBuffer);
+            RemapConflictIndex conflictIndex(remapBuffer);
+            ShortcutErrorType error = BufferValidationHelpers::ValidateAndUpdateKeyBufferElement(args.elementRowIndex, args.elementColIndex, args.selectedCodeFromDropDown, remapBuffer, conflictIndex);
 
             // Assert that the element is validated and buffer is updated
             Assert::AreEqual(true, error == ShortcutErrorType::NoError);
@@ -133,7 +221,8 @@ namespace RemappingUITests
 
             // Validate and update the element when selecting A on a row
             ValidateAndUpdateKeyBufferElementArgs args = { 0, 0, 0x41 };
-            ShortcutErrorType error = BufferValidationHelpers::ValidateAndUpdateKeyBufferElement(args.elementRowIndex, args.elementColIndex, args.selectedCodeFromDropDown, remapBuffer);
+            RemapConflictIndex conflictIndex(remapBuffer);
+            ShortcutErrorType error = BufferValidationHelpers::ValidateAndUpdateKeyBufferElement(args.elementRowIndex, args.elementColIndex, args.selectedCodeFromDropDown, remapBuffer, conflictIndex);
 
             // Assert that the element is invalid and buffer is not updated
             Assert::AreEqual(true, error == ShortcutErrorType::MapToSameKey);
@@ -152,7 +241,8 @@ namespace RemappingUITests
 
             // Validate and update the element when selecting A on second row
             ValidateAndUpdateKeyBufferElementArgs args = { 1, 0, 0x41 };
-            ShortcutErrorType error = BufferValidationHelpers::ValidateAndUpdateKeyBufferElement(args.elementRowIndex, args.elementColIndex, args.selectedCodeFromDropDown, remapBuffer);
+            RemapConflictIndex conflictIndex(remapBuffer);
+            ShortcutErrorType error = BufferValidationHelpers::ValidateAndUpdateKeyBufferElement(args.elementRowIndex, args.elementColIndex, args.selectedCodeFromDropDown, remapBuffer, conflictIndex);
 
             // Assert that the element is invalid and buffer is not updated
             Assert::AreEqual(true, error == ShortcutErrorType::SameKeyPreviouslyMapped);
@@ -171,7 +261,8 @@ namespace RemappingUITests
 
             // Validate and update the element when selecting A on second row
             ValidateAndUpdateKeyBufferElementArgs args = { 1, 0, 0x41 };
-            ShortcutErrorType error = BufferValidationHelpers::ValidateAndUpdateKeyBufferElement(args.elementRowIndex, args.elementColIndex, args.selectedCodeFromDropDown, remapBuffer);
+            RemapConflictIndex conflictIndex(remapBuffer);
+            ShortcutErrorType error = BufferValidationHelpers::ValidateAndUpdateKeyBufferElement(args.elementRowIndex, args.elementColIndex, args.selectedCodeFromDropDown, remapBuffer, conflictIndex);
 
             // Assert that the element is invalid and buffer is not updated
             Assert::AreEqual(true, error == ShortcutErrorType::SameKeyPreviouslyMapped);
@@ -190,7 +281,8 @@ namespace RemappingUITests
 
             // Validate and update the element when selecting LCtrl on second row
             ValidateAndUpdateKeyBufferElementArgs args = { 1, 0, VK_LCONTROL };
-            ShortcutErrorType error = BufferValidationHelpers::ValidateAndUpdateKeyBufferElement(args.elementRowIndex, args.elementColIndex, args.selectedCodeFromDropDown, remapBuffer);
+            RemapConflictIndex conflictIndex(remapBuffer);
+            ShortcutErrorType error = BufferValidationHelpers::ValidateAndUpdateKeyBufferElement(args.elementRowIndex, args.elementColIndex, args.selectedCodeFromDropDown, remapBuffer, conflictIndex);
 
             // Assert that the element is invalid and buffer is not updated
             Assert::AreEqual(true, error == ShortcutErrorType::ConflictingModifierKey);
@@ -209,7 +301,8 @@ namespace RemappingUITests
 
             // Validate and update the element when selecting LCtrl on second row
             ValidateAndUpdateKeyBufferElementArgs args = { 1, 0, VK_LCONTROL };
-            ShortcutErrorType error = BufferValidationHelpers::ValidateAndUpdateKeyBufferElement(args.elementRowIndex, args.elementColIndex, args.selectedCodeFromDropDown, remapBuffer);
+            RemapConflictIndex conflictIndex(remapBuffer);
+            ShortcutErrorType error = BufferValidationHelpers::ValidateAndUpdateKeyBufferElement(args.elementRowIndex, args.elementColIndex, args.selectedCodeFromDropDown, remapBuffer, conflictIndex);
 
             // Assert that the element is invalid and buffer is not updated
             Assert::AreEqual(true, error == ShortcutErrorType::ConflictingModifierKey);
@@ -266,7 +359,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is valid and no drop down action is required
                 Assert::AreEqual(true, result.first == ShortcutErrorType::NoError);
@@ -293,7 +386,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is invalid and no drop down action is required
                 Assert::AreEqual(true, result.first == ShortcutErrorType::ShortcutStartWithModifier);
@@ -316,7 +409,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is valid and no drop down action is required
                 Assert::AreEqual(true, result.first == ShortcutErrorType::NoError);
@@ -339,7 +432,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is invalid and no drop down action is required
                 Assert::AreEqual(true, result.first == ShortcutErrorType::ShortcutNotMoreThanOneActionKey);
@@ -362,7 +455,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is invalid and no drop down action is required
                 Assert::AreEqual(true, result.first == ShortcutErrorType::ShortcutNotMoreThanOneActionKey);
@@ -393,7 +486,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is valid and no drop down action is required
                 Assert::AreEqual(true, result.first == ShortcutErrorType::NoError);
@@ -424,7 +517,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is valid and ClearUnusedDropDowns action is required
                 Assert::AreEqual(true, result.first == ShortcutErrorType::NoError);
@@ -445,7 +538,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is valid and ClearUnusedDropDowns action is required
                 Assert::AreEqual(true, result.first == ShortcutErrorType::NoError);
@@ -480,7 +573,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is valid and AddDropDown action is required
                 Assert::AreEqual(true, result.first == ShortcutErrorType::NoError);
@@ -507,7 +600,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is invalid and no action is required
                 Assert::AreEqual(true, result.first == ShortcutErrorType::ShortcutCannotHaveRepeatedModifier);
@@ -544,7 +637,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is invalid and no action is required
                 Assert::AreEqual(true, result.first == ShortcutErrorType::ShortcutMaxShortcutSizeOneActionKey);
@@ -575,7 +668,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is invalid and no action is required
                 Assert::AreEqual(true, result.first == ShortcutErrorType::ShortcutMaxShortcutSizeOneActionKey);
@@ -612,7 +705,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is valid and no action is required
                 Assert::AreEqual(true, result.first == ShortcutErrorType::NoError);
@@ -649,7 +742,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is invalid and no action is required
                 Assert::AreEqual(true, result.first == ShortcutErrorType::ShortcutCannotHaveRepeatedModifier);
@@ -672,7 +765,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is invalid and no action is required
                 Assert::AreEqual(true, result.first == ShortcutErrorType::ShortcutStartWithModifier);
@@ -693,7 +786,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is invalid and no action is required
                 Assert::AreEqual(true, result.first == ShortcutErrorType::ShortcutOneActionKey);
@@ -720,7 +813,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is invalid and no action is required
                 Assert::AreEqual(true, result.first == ShortcutErrorType::ShortcutAtleast2Keys);
@@ -747,7 +840,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is invalid and no action is required
                 Assert::AreEqual(true, result.first == ShortcutErrorType::ShortcutOneActionKey);
@@ -774,7 +867,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is valid and DeleteDropDown action is required
                 Assert::AreEqual(true, result.first == ShortcutErrorType::NoError);
@@ -817,7 +910,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is valid and DeleteDropDown action is required
                 Assert::AreEqual(true, result.first == ShortcutErrorType::NoError);
@@ -848,7 +941,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is invalid and no action is required
                 Assert::AreEqual(true, result.first == ShortcutErrorType::ShortcutOneActionKey);
@@ -887,7 +980,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is invalid
                 Assert::AreEqual(true, result.first == ShortcutErrorType::WinL);
@@ -919,7 +1012,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is invalid
                 Assert::AreEqual(true, result.first == ShortcutErrorType::WinL);
@@ -951,7 +1044,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is invalid
                 Assert::AreEqual(true, result.first == ShortcutErrorType::CtrlAltDel);
@@ -985,7 +1078,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is invalid
                 Assert::AreEqual(true, result.first == ShortcutErrorType::MapToSameKey);
@@ -1023,7 +1116,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is invalid
                 Assert::AreEqual(true, result.first == ShortcutErrorType::MapToSameShortcut);
@@ -1101,7 +1194,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is invalid
                 Assert::AreEqual(true, result.first == ShortcutErrorType::MapToSameShortcut);
@@ -1127,7 +1220,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is invalid
                 Assert::AreEqual(true, result.first == ShortcutErrorType::SameShortcutPreviouslyMapped);
@@ -1155,7 +1248,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is valid
                 Assert::AreEqual(true, result.first == ShortcutErrorType::NoError);
@@ -1181,7 +1274,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is invalid
                 Assert::AreEqual(true, result.first == ShortcutErrorType::ConflictingModifierShortcut);
@@ -1207,7 +1300,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is valid
                 Assert::AreEqual(true, result.first == ShortcutErrorType::NoError);
@@ -1247,7 +1340,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is invalid
                 Assert::AreEqual(true, result.first == ShortcutErrorType::SameShortcutPreviouslyMapped);
@@ -1287,7 +1380,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is valid
                 Assert::AreEqual(true, result.first == ShortcutErrorType::NoError);
@@ -1327,7 +1420,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is invalid
                 Assert::AreEqual(true, result.first == ShortcutErrorType::ConflictingModifierShortcut);
@@ -1367,7 +1460,7 @@ namespace RemappingUITests
                 remapBuffer.push_back(testCase.bufferRow);
 
                 // Act
-                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true);
+                std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(testCase.elementRowIndex, testCase.elementColIndex, testCase.indexOfDropDownLastModified, testCase.selectedCodesOnDropDowns, testCase.targetAppNameInTextBox, testCase.isHybridColumn, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
                 // Assert that the element is valid
                 Assert::AreEqual(true, result.first == ShortcutErrorType::NoError);
@@ -1386,11 +1479,119 @@ namespace RemappingUITests
             };
 
             // Act
-            std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(0, 1, 1, selectedCodes, testApp1, true, remapBuffer, true);
+            std::pair<ShortcutErrorType, BufferValidationHelpers::DropDownAction> result = BufferValidationHelpers::ValidateShortcutBufferElement(0, 1, 1, selectedCodes, testApp1, true, remapBuffer, true, RemapConflictIndex(remapBuffer));
 
             // Assert
             Assert::AreEqual(true, result.first == ShortcutErrorType::ShortcutDisableAsActionKey);
             Assert::AreEqual(true, result.second == BufferValidationHelpers::DropDownAction::NoAction);
         }
+        // Test if the ValidateAndUpdateKeyBufferElement method returns the same errors as comparing the key with every row on a buffer with random keys, while the conflict index follows the updates of the buffer
+        TEST_METHOD (ValidateAndUpdateKeyBufferElement_ShouldReturnSameErrorAsScan_OnUsingConflictIndex)
+        {
+            const std::vector<int> keys = { 0, 0x41, 0x42, 0x43, VK_LCONTROL, VK_RCONTROL, VK_CONTROL, VK_LMENU, VK_RMENU, VK_MENU, VK_LSHIFT, VK_SHIFT, VK_LWIN, CommonSharedConstants::VK_WIN_BOTH };
+            std::mt19937 random(37);
+            for (int iteration = 0; iteration < 50; iteration++)
+            {
+                RemapBuffer remapBuffer;
+                const size_t rowCount = 1 + random() % 8;
+                for (size_t i = 0; i < rowCount; i++)
+                {
+                    remapBuffer.push_back(std::make_pair(RemapBufferItem{ (DWORD)keys[random() % keys.size()], (DWORD)0x44 }, std::wstring()));
+                }
+
+                RemapConflictIndex conflictIndex(remapBuffer);
+                for (int rowIndex = 0; rowIndex < rowCount; rowIndex++)
+                {
+                    for (int key : keys)
+                    {
+                        ShortcutErrorType expected = ScanKeyConflict(remapBuffer, rowIndex, key);
+                        ShortcutErrorType result = BufferValidationHelpers::ValidateAndUpdateKeyBufferElement(rowIndex, 0, key, remapBuffer, conflictIndex);
+
+                        Assert::AreEqual(true, expected == result);
+                        Assert::AreEqual(result == ShortcutErrorType::NoError ? (DWORD)key : (DWORD)0, std::get<DWORD>(remapBuffer[rowIndex].first[0]));
+                    }
+                }
+            }
+        }
+
+        // Test if the ValidateShortcutBufferElement method returns the same errors as comparing the shortcut with every row on a buffer with random shortcuts, while the rows change and the conflict index is notified
+        TEST_METHOD (ValidateShortcutBufferElement_ShouldReturnSameErrorAsScan_OnUsingConflictIndex)
+        {
+            std::mt19937 random(37);
+            RemapBuffer remapBuffer = CreateRandomShortcutBuffer(random, 40);
+            RemapConflictIndex conflictIndex(remapBuffer);
+            const std::wstring appNames[] = { L"", testApp1, testApp2, L"TESTPROCESS2.EXE" };
+            for (int iteration = 0; iteration < 500; iteration++)
+            {
+                const int rowIndex = random() % remapBuffer.size();
+                const std::vector<int32_t> selectedCodes = CreateRandomShortcutCodes(random);
+                const std::wstring& appName = appNames[random() % 4];
+
+                ShortcutErrorType expected = ScanShortcutConflict(remapBuffer, rowIndex, Shortcut(selectedCodes), appName);
+                if (expected == ShortcutErrorType::NoError)
+                {
+                    expected = EditorHelpers::IsShortcutIllegal(Shortcut(selectedCodes));
+                }
+
+                auto result = BufferValidationHelpers::ValidateShortcutBufferElement(rowIndex, 0, (uint32_t)selectedCodes.size() - 1, selectedCodes, appName, false, remapBuffer, true, conflictIndex);
+                Assert::AreEqual(true, expected == result.first);
+
+                // Apply the selection, or change the target app or the number of rows, and notify the index like the editor does
+                switch (random() % 4)
+                {
+                case 0:
+                    remapBuffer[rowIndex].first[0] = Shortcut(selectedCodes);
+                    conflictIndex.OnRowChanged(remapBuffer, rowIndex);
+                    break;
+                case 1:
+                    remapBuffer[rowIndex].second = appName;
+                    conflictIndex.OnRowChanged(remapBuffer, rowIndex);
+                    break;
+                case 2:
+                    remapBuffer.erase(remapBuffer.begin() + rowIndex);
+                    conflictIndex.OnRowRemoved(rowIndex);
+                    break;
+                default:
+                    remapBuffer.push_back(std::make_pair(RemapBufferItem{ Shortcut(selectedCodes), Shortcut() }, appName));
+                    conflictIndex.OnRowAppended(remapBuffer);
+                    break;
+                }
+
+                if (remapBuffer.empty())
+                {
+                    remapBuffer = CreateRandomShortcutBuffer(random, 40);
+                    conflictIndex.Reset(remapBuffer);
+                }
+            }
+        }
+
+        // Test if the FindOriginalKeyConflicts method returns the conflict of each row with the first conflicting other row, on a benchmark with 2000 rows
+        TEST_METHOD (FindOriginalKeyConflicts_ShouldReturnSameErrorsAsScan_OnBufferWith2000Rows)
+        {
+            std::mt19937 random(37);
+            RemapBuffer remapBuffer = CreateRandomShortcutBuffer(random, 2000);
+
+            auto start = std::chrono::high_resolution_clock::now();
+            std::vector<ShortcutErrorType> scanned;
+            for (int i = 0; i < remapBuffer.size(); i++)
+            {
+                scanned.push_back(ScanShortcutConflict(remapBuffer, i, std::get<Shortcut>(remapBuffer[i].first[0]), remapBuffer[i].second));
+            }
+            auto scanDuration = std::chrono::high_resolution_clock::now() - start;
+
+            start = std::chrono::high_resolution_clock::now();
+            std::vector<ShortcutErrorType> indexed = BufferValidationHelpers::FindOriginalKeyConflicts(remapBuffer, false);
+            auto indexDuration = std::chrono::high_resolution_clock::now() - start;
+
+            Assert::AreEqual(scanned.size(), indexed.size());
+            for (size_t i = 0; i < scanned.size(); i++)
+            {
+                Assert::AreEqual(true, scanned[i] == indexed[i]);
+            }
+
+            std::wstring message = L"Validating 2000 rows: scan " + std::to_wstring(std::chrono::duration_cast<std::chrono::milliseconds>(scanDuration).count()) +
+                                   L" ms, conflict index " + std::to_wstring(std::chrono::duration_cast<std::chrono::milliseconds>(indexDuration).count()) + L" ms\n";
+            Logger::WriteMessage(message.c_str());
+        }
     };
 }
@@ -0,0 +1,101 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <common/interop/keyboard_layout.h>
+#include <common/interop/shared_constants.h>
+#include <algorithm>
+#include <chrono>
+#include <set>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace RemappingUITests
+{
+    // Tests for the key name and key code lists of the keyboard layout
+    TEST_CLASS (KeyboardLayoutTests)
+    {
+    public:
+        // Test if the lists of a layout are shared by all the LayoutMap instances instead of being rebuilt
+        TEST_METHOD (KeyLists_ShouldBeShared_AcrossLayoutMapInstances)
+        {
+            LayoutMap first;
+            LayoutMap second;
+
+            Assert::IsTrue(&first.GetKeyCodeList() == &second.GetKeyCodeList());
+            Assert::IsTrue(&first.GetKeyNameList(true) == &second.GetKeyNameList(true));
+            Assert::IsTrue(&first.GetKeyNameList() == &first.GetKeyNameList());
+        }
+
+        // Test if the key name lists match the key code lists and the key names, with a None key at the start of the shortcut lists
+        TEST_METHOD (KeyNameList_ShouldMatchKeyCodeListAndKeyNames)
+        {
+            LayoutMap keyboardLayout;
+            const auto& keyCodes = keyboardLayout.GetKeyCodeList();
+            const auto& keyNames = keyboardLayout.GetKeyNameList();
+            const auto& shortcutKeyCodes = keyboardLayout.GetKeyCodeList(true);
+            const auto& shortcutKeyNames = keyboardLayout.GetKeyNameList(true);
+
+            Assert::AreEqual(keyCodes.size(), keyNames.size());
+            Assert::AreEqual(keyCodes.size() + 1, shortcutKeyCodes.size());
+            Assert::AreEqual(shortcutKeyCodes.size(), shortcutKeyNames.size());
+            Assert::AreEqual(DWORD(0), shortcutKeyCodes[0]);
+            Assert::AreEqual(std::wstring(L"None"), shortcutKeyNames[0].second);
+
+            for (size_t i = 0; i < keyCodes.size(); i++)
+            {
+                Assert::AreEqual(keyCodes[i], keyNames[i].first);
+                Assert::AreEqual(keyboardLayout.GetKeyName(keyCodes[i]), keyNames[i].second);
+                Assert::AreEqual(keyCodes[i], shortcutKeyCodes[i + 1]);
+            }
+
+            // Each key from 1 to 255 and the Win key appear exactly once
+            std::set<DWORD> uniqueKeys(keyCodes.begin(), keyCodes.end());
+            Assert::AreEqual(keyCodes.size(), uniqueKeys.size());
+            Assert::AreEqual(size_t(256), keyCodes.size());
+            Assert::IsTrue(uniqueKeys.count(CommonSharedConstants::VK_WIN_BOTH) == 1);
+            Assert::AreEqual(std::wstring(L"Undefined"), keyboardLayout.GetKeyName(0));
+        }
+
+        // Test if the lists with the Disable key are cached and start with Disable followed by the list without it
+        TEST_METHOD (KeyNameListWithDisable_ShouldStartWithDisable_AndBeCached)
+        {
+            LayoutMap keyboardLayout;
+            for (bool isShortcut : { false, true })
+            {
+                const auto& keyNames = keyboardLayout.GetKeyNameList(isShortcut);
+                const auto& keyNamesWithDisable = keyboardLayout.GetKeyNameList(isShortcut, true);
+
+                Assert::IsTrue(&keyNamesWithDisable == &keyboardLayout.GetKeyNameList(isShortcut, true));
+                Assert::AreEqual(keyNames.size() + 1, keyNamesWithDisable.size());
+                Assert::AreEqual(DWORD(CommonSharedConstants::VK_DISABLED), keyNamesWithDisable[0].first);
+                Assert::AreEqual(keyboardLayout.GetKeyName(CommonSharedConstants::VK_DISABLED), keyNamesWithDisable[0].second);
+                Assert::IsTrue(std::equal(keyNames.begin(), keyNames.end(), keyNamesWithDisable.begin() + 1));
+            }
+        }
+
+        // Benchmark of looking up the key name lists for the drop downs of the remap tables, for a new LayoutMap and for an existing one.
+        // Filling the ItemsSource of a drop down creates XAML items, which needs a XAML thread, so only the lookup of the lists is measured
+        TEST_METHOD (KeyNameListLookup_ShouldReturnCachedLists_WhenCalledForEachDropDown)
+        {
+            const int dropDownCount = 1000;
+            auto start = std::chrono::steady_clock::now();
+            LayoutMap keyboardLayout;
+            const auto constructionTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+            const auto* firstList = &keyboardLayout.GetKeyNameList(false, true);
+            size_t itemCount = 0;
+            start = std::chrono::steady_clock::now();
+            for (int i = 0; i < dropDownCount; i++)
+            {
+                const auto& list = keyboardLayout.GetKeyNameList(i % 2 == 0, i % 4 < 2);
+                Assert::IsTrue(i % 4 != 1 || &list == firstList);
+                itemCount += list.size();
+            }
+
+            const auto listTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / dropDownCount;
+
+            std::wstring message = L"LayoutMap construction " + std::to_wstring(constructionTime) + L" us, key name list lookup per drop down " + std::to_wstring(listTime) + L" us (" + std::to_wstring(itemCount / dropDownCount) + L" items)\n";
+            Logger::WriteMessage(message.c_str());
+            Assert::IsTrue(itemCount > 0);
+        }
+    };
+}
@@ -243,6 +243,29 @@ namespace RemappingUITests
             Assert::AreEqual(true, isSuccess);
         }
 
+        // Test if the CheckIfRemappingsAreValid method is unsuccessful when remaps with overlapping shortcuts are passed
+        TEST_METHOD (CheckIfRemappingsAreValid_ShouldReturnRemapUnsuccessful_OnPassingRemapsWithOverlappingShortcuts)
+        {
+            RemapBuffer remapBuffer;
+
+            // Remap Ctrl+A to B and LCtrl+A to Ctrl+V
+            Shortcut src1;
+            src1.SetKey(VK_CONTROL);
+            src1.SetKey(0x41);
+            Shortcut src2;
+            src2.SetKey(VK_LCONTROL);
+            src2.SetKey(0x41);
+            Shortcut dest2;
+            dest2.SetKey(VK_CONTROL);
+            dest2.SetKey(0x56);
+            remapBuffer.push_back(std::make_pair(RemapBufferItem({ src1, (DWORD)0x42 }), std::wstring()));
+            remapBuffer.push_back(std::make_pair(RemapBufferItem({ src2, dest2 }), std::wstring()));
+
+            // Assert that remapping set is invalid
+            bool isSuccess = (LoadingAndSavingRemappingHelper::CheckIfRemappingsAreValid(remapBuffer) == ShortcutErrorType::RemapUnsuccessful);
+            Assert::AreEqual(true, isSuccess);
+        }
+
         // Test if the GetOrphanedKeys method return an empty vector on passing no remaps
         TEST_METHOD (GetOrphanedKeys_ShouldReturnEmptyVector_OnPassingNoRemaps)
         {
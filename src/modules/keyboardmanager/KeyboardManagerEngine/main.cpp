@@ -3,6 +3,7 @@
 #include <common/utils/ProcessWaiter.h>
 #include <common/utils/winapi_error.h>
 #include <common/utils/logger_helper.h>
+#include <common/utils/profiler.h>
 #include <common/utils/UnhandledExceptionHandler_x64.h>
 #include <keyboardmanager/common/KeyboardManagerConstants.h>
 #include <keyboardmanager/KeyboardManagerEngineLibrary/KeyboardManager.h>
@@ -50,6 +51,8 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
         });
     }
 
+    Profiler::ExportListener profilerExportListener(L"KeyboardManagerEngine");
+
     auto kbm = KeyboardManager();
     kbm.StartLowlevelKeyboardHook();
     
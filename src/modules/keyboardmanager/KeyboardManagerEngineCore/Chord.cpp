@@ -0,0 +1,534 @@
+#include "Chord.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+
+namespace KeyboardManagerCore
+{
+    namespace
+    {
+        // Function to get the key code of a modifier with the given side. generic is the key code used for both sides
+        KeyCode GetModifierKey(ModifierSide side, KeyCode left, KeyCode right, KeyCode generic)
+        {
+            switch (side)
+            {
+            case ModifierSide::Left:
+                return left;
+            case ModifierSide::Right:
+                return right;
+            case ModifierSide::Both:
+                return generic;
+            default:
+                return KeyCodes::None;
+            }
+        }
+
+        // Function to check if the key matches a modifier with the given side. generic is None for the win key since there is no common win key code
+        bool CheckModifier(ModifierSide side, KeyCode key, KeyCode left, KeyCode right, KeyCode generic)
+        {
+            switch (side)
+            {
+            case ModifierSide::Left:
+                return key == left;
+            case ModifierSide::Right:
+                return key == right;
+            case ModifierSide::Both:
+                return key == left || key == right || (generic != KeyCodes::None && key == generic);
+            default:
+                return false;
+            }
+        }
+
+        // Function to check if a modifier with the given side is pressed down
+        bool IsModifierPressed(Platform& platform, ModifierSide side, KeyCode left, KeyCode right, KeyCode generic)
+        {
+            switch (side)
+            {
+            case ModifierSide::Left:
+                return platform.IsKeyPressed(left);
+            case ModifierSide::Right:
+                return platform.IsKeyPressed(right);
+            case ModifierSide::Both:
+                // Since there is no common win key code, check both the left and right keys
+                return generic == KeyCodes::None ? (platform.IsKeyPressed(left) || platform.IsKeyPressed(right)) : platform.IsKeyPressed(generic);
+            default:
+                return true;
+            }
+        }
+
+        // Function to check if the key code should be ignored when checking if the keyboard state is clear. Same key codes as IgnoreKeyCode in Shortcut.cpp
+        bool IgnoreKeyCode(KeyCode key)
+        {
+            auto inRange = [key](KeyCode a, KeyCode b) { return key >= a && key <= b; };
+
+            // Mouse buttons
+            if (inRange(0x01, 0x02) || inRange(0x04, 0x06))
+            {
+                return true;
+            }
+
+            bool isUndefined = key == 0x07 || inRange(0x0E, 0x0F) || inRange(0x3A, 0x40);
+            bool isReserved = inRange(0x0A, 0x0B) || key == 0x5E || inRange(0xB8, 0xB9) || inRange(0xC1, 0xD7) || key == 0xE0 || key == 0xFC;
+            bool isUnassigned = inRange(0x88, 0x8F) || inRange(0x97, 0x9F) || inRange(0xD8, 0xDA) || key == 0xE8;
+            bool isOEMSpecific = inRange(0x92, 0x96) || key == 0xE1 || inRange(0xE3, 0xE4) || key == 0xE6 || inRange(0xE9, 0xF5);
+            bool isIME = inRange(0x15, 0x1A) || inRange(0x1C, 0x1F) || key == 0xE5;
+
+            return isUndefined || isReserved || isUnassigned || isOEMSpecific || isIME;
+        }
+
+        // Keys which are checked by Chord::IsKeyboardStateClearExceptChord. DummyKey is excluded because of the Num Lock
+        KeyStateBitset CreateCheckedKeys()
+        {
+            KeyStateBitset checkedKeys;
+            for (KeyCode key = 1; key < KeyCodes::DummyKey; key++)
+            {
+                if (!IgnoreKeyCode(key))
+                {
+                    checkedKeys.Set(key);
+                }
+            }
+
+            return checkedKeys;
+        }
+
+        const KeyStateBitset& GetCheckedKeys()
+        {
+            static const KeyStateBitset checkedKeys = CreateCheckedKeys();
+            return checkedKeys;
+        }
+
+        // Function to add the keys of a modifier to the required and allowed keys. The win keys have no generic key code, so AnyWinKey is used for it
+        void AddModifier(ModifierSide side, KeyCode left, KeyCode right, KeyCode generic, KeyStateBitset& requiredKeys, KeyStateBitset& allowedKeys)
+        {
+            switch (side)
+            {
+            case ModifierSide::Left:
+                requiredKeys.Set(left);
+                allowedKeys.Set(left);
+                break;
+            case ModifierSide::Right:
+                requiredKeys.Set(right);
+                allowedKeys.Set(right);
+                break;
+            case ModifierSide::Both:
+                requiredKeys.Set(generic);
+                allowedKeys.Set(left);
+                allowedKeys.Set(right);
+                break;
+            default:
+                return;
+            }
+
+            allowedKeys.Set(generic);
+        }
+
+        struct KeyName
+        {
+            std::string_view name;
+            KeyCode key;
+        };
+
+        // Names of the keys which can't be written as a single character. The first name of each key is used by ToString
+        constexpr KeyName keyNames[] = {
+            { "Win", KeyCodes::WinBoth },
+            { "LWin", KeyCodes::LeftWin },
+            { "RWin", KeyCodes::RightWin },
+            { "Ctrl", KeyCodes::Control },
+            { "LCtrl", KeyCodes::LeftControl },
+            { "RCtrl", KeyCodes::RightControl },
+            { "Alt", KeyCodes::Menu },
+            { "LAlt", KeyCodes::LeftMenu },
+            { "RAlt", KeyCodes::RightMenu },
+            { "Shift", KeyCodes::Shift },
+            { "LShift", KeyCodes::LeftShift },
+            { "RShift", KeyCodes::RightShift },
+            { "Disable", KeyCodes::Disabled },
+            { "Backspace", 0x08 },
+            { "Tab", 0x09 },
+            { "Enter", 0x0D },
+            { "CapsLock", KeyCodes::CapsLock },
+            { "Esc", 0x1B },
+            { "Space", 0x20 },
+            { "Left", 0x25 },
+            { "Up", 0x26 },
+            { "Right", 0x27 },
+            { "Down", 0x28 },
+            { "Delete", 0x2E },
+        };
+    }
+
+    // Function to parse the name of a single key
+    std::optional<KeyCode> ParseKeyName(std::string_view text)
+    {
+        for (const auto& keyName : keyNames)
+        {
+            if (keyName.name.size() == text.size() && std::equal(text.begin(), text.end(), keyName.name.begin(), [](char a, char b) { return std::tolower(a) == std::tolower(b); }))
+            {
+                return keyName.key;
+            }
+        }
+
+        // Letters and digits use their ASCII code as the key code
+        if (text.size() == 1 && std::isalnum(static_cast<unsigned char>(text[0])))
+        {
+            return static_cast<KeyCode>(std::toupper(static_cast<unsigned char>(text[0])));
+        }
+
+        // Function keys
+        if (text.size() >= 2 && text.size() <= 3 && (text[0] == 'F' || text[0] == 'f'))
+        {
+            int number = 0;
+            for (size_t i = 1; i < text.size(); i++)
+            {
+                if (!std::isdigit(static_cast<unsigned char>(text[i])))
+                {
+                    return std::nullopt;
+                }
+                number = number * 10 + (text[i] - '0');
+            }
+
+            if (number >= 1 && number <= 24)
+            {
+                return static_cast<KeyCode>(0x70 + number - 1);
+            }
+            return std::nullopt;
+        }
+
+        // Any other key is written as its hexadecimal key code
+        if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X'))
+        {
+            KeyCode key = 0;
+            for (size_t i = 2; i < text.size(); i++)
+            {
+                const char c = static_cast<char>(std::tolower(static_cast<unsigned char>(text[i])));
+                if (!std::isxdigit(static_cast<unsigned char>(c)))
+                {
+                    return std::nullopt;
+                }
+                key = key * 16 + (std::isdigit(static_cast<unsigned char>(c)) ? c - '0' : c - 'a' + 10);
+            }
+
+            if (key == KeyCodes::None || key > KeyCodes::WinBoth)
+            {
+                return std::nullopt;
+            }
+            return key;
+        }
+
+        return std::nullopt;
+    }
+
+    // Function to get the name of a single key, which can be parsed back with ParseKeyName
+    std::string KeyNameToString(KeyCode key)
+    {
+        for (const auto& keyName : keyNames)
+        {
+            if (keyName.key == key)
+            {
+                return std::string(keyName.name);
+            }
+        }
+
+        if ((key >= '0' && key <= '9') || (key >= 'A' && key <= 'Z'))
+        {
+            return std::string(1, static_cast<char>(key));
+        }
+
+        char buffer[8];
+        if (key >= 0x70 && key <= 0x87)
+        {
+            std::snprintf(buffer, sizeof(buffer), "F%u", key - 0x70 + 1);
+            return buffer;
+        }
+
+        std::snprintf(buffer, sizeof(buffer), "0x%02X", key);
+        return buffer;
+    }
+
+    // Function to parse a chord written as key names separated by '+', for example "Ctrl+Shift+A" or "LWin+0x41"
+    std::optional<Chord> Chord::Parse(std::string_view text)
+    {
+        Chord chord;
+        while (!text.empty())
+        {
+            const size_t separator = text.find('+');
+            const auto key = ParseKeyName(text.substr(0, separator));
+            if (!key || *key == KeyCodes::Disabled)
+            {
+                return std::nullopt;
+            }
+
+            chord.SetKey(*key);
+            text = separator == std::string_view::npos ? std::string_view() : text.substr(separator + 1);
+        }
+
+        if (chord.actionKey == KeyCodes::None)
+        {
+            return std::nullopt;
+        }
+
+        return chord;
+    }
+
+    // Function to return the text representation of the chord, which can be parsed back with Parse
+    std::string Chord::ToString() const
+    {
+        std::string result;
+        auto append = [&result](KeyCode key) {
+            if (key != KeyCodes::None)
+            {
+                if (!result.empty())
+                {
+                    result += '+';
+                }
+                result += KeyNameToString(key);
+            }
+        };
+
+        append(GetWinKey(ModifierSide::Both));
+        append(GetCtrlKey());
+        append(GetAltKey());
+        append(GetShiftKey());
+        append(actionKey);
+        return result;
+    }
+
+    // Function to set a key in the chord. Modifier keys set the corresponding modifier and any other key is the action key
+    void Chord::SetKey(KeyCode key)
+    {
+        switch (key)
+        {
+        case KeyCodes::WinBoth:
+            win = ModifierSide::Both;
+            break;
+        case KeyCodes::LeftWin:
+            win = ModifierSide::Left;
+            break;
+        case KeyCodes::RightWin:
+            win = ModifierSide::Right;
+            break;
+        case KeyCodes::Control:
+            ctrl = ModifierSide::Both;
+            break;
+        case KeyCodes::LeftControl:
+            ctrl = ModifierSide::Left;
+            break;
+        case KeyCodes::RightControl:
+            ctrl = ModifierSide::Right;
+            break;
+        case KeyCodes::Menu:
+            alt = ModifierSide::Both;
+            break;
+        case KeyCodes::LeftMenu:
+            alt = ModifierSide::Left;
+            break;
+        case KeyCodes::RightMenu:
+            alt = ModifierSide::Right;
+            break;
+        case KeyCodes::Shift:
+            shift = ModifierSide::Both;
+            break;
+        case KeyCodes::LeftShift:
+            shift = ModifierSide::Left;
+            break;
+        case KeyCodes::RightShift:
+            shift = ModifierSide::Right;
+            break;
+        default:
+            actionKey = key;
+            break;
+        }
+    }
+
+    // Function to return the number of keys in the chord
+    int Chord::Size() const
+    {
+        int size = actionKey != KeyCodes::None ? 1 : 0;
+        for (auto side : { win, ctrl, alt, shift })
+        {
+            if (side != ModifierSide::None)
+            {
+                size++;
+            }
+        }
+
+        return size;
+    }
+
+    // Function to return the key code of the win key in the chord. winKeyInvoked decides which win key to return if the chord uses both
+    KeyCode Chord::GetWinKey(ModifierSide winKeyInvoked) const
+    {
+        if (win == ModifierSide::Both)
+        {
+            // Since there is no common win key code, the right win key is returned only if it was the one pressed to invoke the remap
+            switch (winKeyInvoked)
+            {
+            case ModifierSide::Right:
+                return KeyCodes::RightWin;
+            case ModifierSide::Both:
+                return KeyCodes::WinBoth;
+            default:
+                return KeyCodes::LeftWin;
+            }
+        }
+
+        return GetModifierKey(win, KeyCodes::LeftWin, KeyCodes::RightWin, KeyCodes::None);
+    }
+
+    KeyCode Chord::GetCtrlKey() const
+    {
+        return GetModifierKey(ctrl, KeyCodes::LeftControl, KeyCodes::RightControl, KeyCodes::Control);
+    }
+
+    KeyCode Chord::GetAltKey() const
+    {
+        return GetModifierKey(alt, KeyCodes::LeftMenu, KeyCodes::RightMenu, KeyCodes::Menu);
+    }
+
+    KeyCode Chord::GetShiftKey() const
+    {
+        return GetModifierKey(shift, KeyCodes::LeftShift, KeyCodes::RightShift, KeyCodes::Shift);
+    }
+
+    bool Chord::CheckWinKey(KeyCode key) const
+    {
+        return CheckModifier(win, key, KeyCodes::LeftWin, KeyCodes::RightWin, KeyCodes::None);
+    }
+
+    bool Chord::CheckCtrlKey(KeyCode key) const
+    {
+        return CheckModifier(ctrl, key, KeyCodes::LeftControl, KeyCodes::RightControl, KeyCodes::Control);
+    }
+
+    bool Chord::CheckAltKey(KeyCode key) const
+    {
+        return CheckModifier(alt, key, KeyCodes::LeftMenu, KeyCodes::RightMenu, KeyCodes::Menu);
+    }
+
+    bool Chord::CheckShiftKey(KeyCode key) const
+    {
+        return CheckModifier(shift, key, KeyCodes::LeftShift, KeyCodes::RightShift, KeyCodes::Shift);
+    }
+
+    // Function to check if the key matches any of the modifiers expected in the chord
+    bool Chord::CheckModifierKey(KeyCode key) const
+    {
+        return CheckWinKey(key) || CheckCtrlKey(key) || CheckAltKey(key) || CheckShiftKey(key);
+    }
+
+    // Function to check if all the modifiers in the chord are pressed down
+    bool Chord::CheckModifiersKeyboardState(Platform& platform) const
+    {
+        return IsModifierPressed(platform, win, KeyCodes::LeftWin, KeyCodes::RightWin, KeyCodes::None) &&
+               IsModifierPressed(platform, ctrl, KeyCodes::LeftControl, KeyCodes::RightControl, KeyCodes::Control) &&
+               IsModifierPressed(platform, alt, KeyCodes::LeftMenu, KeyCodes::RightMenu, KeyCodes::Menu) &&
+               IsModifierPressed(platform, shift, KeyCodes::LeftShift, KeyCodes::RightShift, KeyCodes::Shift);
+    }
+
+    // Function to check if any keys are pressed down except those in the chord
+    bool Chord::IsKeyboardStateClearExceptChord(Platform& platform) const
+    {
+        // Iterate through all the key codes - 0xFF is skipped since it is set to key down because of the Num Lock
+        for (KeyCode key = 1; key < KeyCodes::DummyKey; key++)
+        {
+            if (IgnoreKeyCode(key) || !platform.IsKeyPressed(key))
+            {
+                continue;
+            }
+
+            bool isPartOfChord;
+            switch (key)
+            {
+            case KeyCodes::Control:
+                isPartOfChord = ctrl != ModifierSide::None;
+                break;
+            case KeyCodes::Menu:
+                isPartOfChord = alt != ModifierSide::None;
+                break;
+            case KeyCodes::Shift:
+                isPartOfChord = shift != ModifierSide::None;
+                break;
+            default:
+                isPartOfChord = CheckModifierKey(key) || key == actionKey;
+                break;
+            }
+
+            if (!isPartOfChord)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Function to get the number of modifiers that are common between the two chords
+    int Chord::GetCommonModifiersCount(const Chord& other) const
+    {
+        int count = 0;
+        count += (win == other.win && win != ModifierSide::None) ? 1 : 0;
+        count += (ctrl == other.ctrl && ctrl != ModifierSide::None) ? 1 : 0;
+        count += (alt == other.alt && alt != ModifierSide::None) ? 1 : 0;
+        count += (shift == other.shift && shift != ModifierSide::None) ? 1 : 0;
+        return count;
+    }
+
+    CompiledChord::CompiledChord(const Chord& chord) :
+        actionKey(chord.actionKey)
+    {
+        AddModifier(chord.win, KeyCodes::LeftWin, KeyCodes::RightWin, KeyStateBitset::AnyWinKey, requiredKeys, allowedKeys);
+        AddModifier(chord.ctrl, KeyCodes::LeftControl, KeyCodes::RightControl, KeyCodes::Control, requiredKeys, allowedKeys);
+        AddModifier(chord.alt, KeyCodes::LeftMenu, KeyCodes::RightMenu, KeyCodes::Menu, requiredKeys, allowedKeys);
+        AddModifier(chord.shift, KeyCodes::LeftShift, KeyCodes::RightShift, KeyCodes::Shift, requiredKeys, allowedKeys);
+
+        if (actionKey != KeyCodes::None)
+        {
+            allowedKeys.Set(actionKey);
+        }
+
+        forbiddenKeys = ~allowedKeys & GetCheckedKeys();
+    }
+
+    // Function to check if there is a key state in which both chords would be pressed and the keyboard state would be clear except each of them, e.g. Ctrl+A and LCtrl+A
+    bool CompiledChord::Overlaps(const CompiledChord& other) const
+    {
+        if (actionKey != other.actionKey)
+        {
+            return false;
+        }
+
+        // The smallest state which presses both chords has the required keys of both. Every required generic key is allowed together with its left and right keys, so they don't have to be added
+        return (allowedKeys & other.allowedKeys).Contains(requiredKeys | other.requiredKeys);
+    }
+
+    // Function to check if the key is a Win, Ctrl, Alt or Shift key
+    bool IsModifierKey(KeyCode key)
+    {
+        switch (key)
+        {
+        case KeyCodes::WinBoth:
+        case KeyCodes::LeftWin:
+        case KeyCodes::RightWin:
+        case KeyCodes::Control:
+        case KeyCodes::LeftControl:
+        case KeyCodes::RightControl:
+        case KeyCodes::Menu:
+        case KeyCodes::LeftMenu:
+        case KeyCodes::RightMenu:
+        case KeyCodes::Shift:
+        case KeyCodes::LeftShift:
+        case KeyCodes::RightShift:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // Function to replace the key codes defined by Keyboard Manager with the key which is sent for them
+    KeyCode FilterArtificialKeys(KeyCode key)
+    {
+        // If a key is remapped to the common win key, the left win key is sent instead
+        return key == KeyCodes::WinBoth ? KeyCodes::LeftWin : key;
+    }
+}
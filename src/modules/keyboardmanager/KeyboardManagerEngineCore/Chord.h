@@ -0,0 +1,125 @@
+#pragma once
+#include "KeyEvent.h"
+#include "KeyStateBitset.h"
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+
+namespace KeyboardManagerCore
+{
+    // Which of the left/right versions of a modifier is part of a chord
+    enum class ModifierSide : uint8_t
+    {
+        None,
+        Left,
+        Right,
+        Both
+    };
+
+    // Platform independent equivalent of Shortcut: up to four modifiers and an action key
+    struct Chord
+    {
+        ModifierSide win = ModifierSide::None;
+        ModifierSide ctrl = ModifierSide::None;
+        ModifierSide alt = ModifierSide::None;
+        ModifierSide shift = ModifierSide::None;
+        KeyCode actionKey = KeyCodes::None;
+
+        bool operator==(const Chord&) const = default;
+
+        // Function to parse a chord written as key names separated by '+', for example "Ctrl+Shift+A" or "LWin+0x41"
+        static std::optional<Chord> Parse(std::string_view text);
+
+        // Function to return the text representation of the chord, which can be parsed back with Parse
+        std::string ToString() const;
+
+        // Function to set a key in the chord. Modifier keys set the corresponding modifier and any other key is the action key
+        void SetKey(KeyCode key);
+
+        // Function to return the number of keys in the chord
+        int Size() const;
+
+        // Function to return the key code of the win key in the chord. winKeyInvoked decides which win key to return if the chord uses both
+        KeyCode GetWinKey(ModifierSide winKeyInvoked) const;
+        KeyCode GetCtrlKey() const;
+        KeyCode GetAltKey() const;
+        KeyCode GetShiftKey() const;
+
+        // Functions to check if the key matches the modifier expected in the chord
+        bool CheckWinKey(KeyCode key) const;
+        bool CheckCtrlKey(KeyCode key) const;
+        bool CheckAltKey(KeyCode key) const;
+        bool CheckShiftKey(KeyCode key) const;
+
+        // Function to check if the key matches any of the modifiers expected in the chord
+        bool CheckModifierKey(KeyCode key) const;
+
+        // Function to check if all the modifiers in the chord are pressed down
+        bool CheckModifiersKeyboardState(Platform& platform) const;
+
+        // Function to check if any keys are pressed down except those in the chord
+        bool IsKeyboardStateClearExceptChord(Platform& platform) const;
+
+        // Function to get the number of modifiers that are common between the two chords
+        int GetCommonModifiersCount(const Chord& other) const;
+    };
+
+    // Chord compiled into key masks, so that it can be matched against a tracked key state without querying the state of each key. Compiled once per remap when the remaps are loaded
+    class CompiledChord
+    {
+    public:
+        CompiledChord() = default;
+
+        explicit CompiledChord(const Chord& chord);
+
+        // Keys which all have to be pressed for the modifiers of the chord. Win (Both) uses the AnyWinKey bit
+        const KeyStateBitset& GetRequiredKeys() const
+        {
+            return requiredKeys;
+        }
+
+        // Keys which must not be pressed for the keyboard state to be clear except the chord
+        const KeyStateBitset& GetForbiddenKeys() const
+        {
+            return forbiddenKeys;
+        }
+
+        // Function to check if all the modifiers in the chord are pressed in the key state. Same result as Chord::CheckModifiersKeyboardState
+        bool CheckModifiersKeyboardState(const KeyStateBitset& keyState) const
+        {
+            return keyState.Contains(requiredKeys);
+        }
+
+        // Function to check if no keys are pressed in the key state except those in the chord. Same result as Chord::IsKeyboardStateClearExceptChord
+        bool IsKeyboardStateClearExceptChord(const KeyStateBitset& keyState) const
+        {
+            return (keyState & forbiddenKeys).None();
+        }
+
+        // Function to check if there is a key state in which both chords would be pressed and the keyboard state would be clear except each of them, e.g. Ctrl+A and LCtrl+A
+        bool Overlaps(const CompiledChord& other) const;
+
+    private:
+        KeyCode actionKey = KeyCodes::None;
+        KeyStateBitset requiredKeys;
+        KeyStateBitset allowedKeys;
+        KeyStateBitset forbiddenKeys;
+    };
+
+    // Remap target - a key (which can be KeyCodes::Disabled) or a chord
+    using RemapTarget = std::variant<KeyCode, Chord>;
+
+    // Function to parse the name of a single key, for example "A", "LCtrl", "F5" or "0x41"
+    std::optional<KeyCode> ParseKeyName(std::string_view text);
+
+    // Function to get the name of a single key, which can be parsed back with ParseKeyName
+    std::string KeyNameToString(KeyCode key);
+
+    // Function to check if the key is a Win, Ctrl, Alt or Shift key
+    bool IsModifierKey(KeyCode key);
+
+    // Function to replace the key codes defined by Keyboard Manager with the key which is sent for them
+    KeyCode FilterArtificialKeys(KeyCode key);
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Platform independent types used by the remap engine core. They don't depend on any Windows headers so the core can be built and replayed on other platforms
+namespace KeyboardManagerCore
+{
+    // Virtual key code. The values are the same as the Windows virtual key codes so that the remap settings can be used as is
+    using KeyCode = uint32_t;
+
+    namespace KeyCodes
+    {
+        constexpr KeyCode None = 0x00;
+        constexpr KeyCode Shift = 0x10;
+        constexpr KeyCode Control = 0x11;
+        constexpr KeyCode Menu = 0x12;
+        constexpr KeyCode CapsLock = 0x14;
+        constexpr KeyCode LeftWin = 0x5B;
+        constexpr KeyCode RightWin = 0x5C;
+        constexpr KeyCode LeftShift = 0xA0;
+        constexpr KeyCode RightShift = 0xA1;
+        constexpr KeyCode LeftControl = 0xA2;
+        constexpr KeyCode RightControl = 0xA3;
+        constexpr KeyCode LeftMenu = 0xA4;
+        constexpr KeyCode RightMenu = 0xA5;
+
+        // Key code which is sent around modifier releases so that they don't trigger their own action (for example Win->Start Menu)
+        constexpr KeyCode DummyKey = 0xFF;
+
+        // Key codes defined by Keyboard Manager, same as CommonSharedConstants::VK_DISABLED and VK_WIN_BOTH
+        constexpr KeyCode Disabled = 0x100;
+        constexpr KeyCode WinBoth = 0x104;
+
+        // Key events received from the platform always have key codes below this value
+        constexpr KeyCode Count = 0x100;
+    }
+
+    // Part of the engine which generated a key event. Events from the platform are Physical. Events injected with the Physical source are processed by the remaps again
+    enum class EventSource : uint8_t
+    {
+        Physical,
+        SingleKeyRemap,
+        ShortcutRemap,
+
+        // Events which must be suppressed, used to reset the modifier state for lower level key handlers
+        Suppressed
+    };
+
+    struct KeyEvent
+    {
+        KeyCode key = KeyCodes::None;
+        bool keyUp = false;
+        EventSource source = EventSource::Physical;
+    };
+
+    class KeyStateBitset;
+
+    // Interface used by the engine to inject key events and to query the platform state
+    class Platform
+    {
+    public:
+        virtual ~Platform() = default;
+
+        // Function to inject key events. The platform delivers them back to the engine in the same way as physical events, with their source set
+        virtual void InjectEvents(const KeyEvent* events, size_t count) = 0;
+
+        // Function to get the state of a key as seen by the applications - true if it is pressed down
+        virtual bool IsKeyPressed(KeyCode key) = 0;
+
+        // Function to get the key state tracked from the key events, or nullptr if the platform doesn't track it. Chords are matched against it with their compiled masks, and only the keys
+        // which are pressed in it are confirmed with IsKeyPressed, since a key up could have been missed
+        virtual const KeyStateBitset* GetTrackedKeyState() { return nullptr; }
+
+        // Function to replace the tracked state of the modifier keys with their current state. Called when no remap matched the tracked modifiers, since a modifier key down
+        // could have been missed. Returns true if the tracked state changed
+        virtual bool ResyncTrackedModifiers() { return false; }
+
+        // Functions called when a remap is invoked, used by the platform for telemetry
+        virtual void OnSingleKeyRemapInvoked(bool /*remapToKey*/) {}
+        virtual void OnShortcutRemapInvoked(bool /*remapToChord*/, bool /*isAppSpecific*/) {}
+    };
+}
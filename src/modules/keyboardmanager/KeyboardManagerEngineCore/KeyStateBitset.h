@@ -0,0 +1,153 @@
+#pragma once
+#include "KeyEvent.h"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+namespace KeyboardManagerCore
+{
+    // Pressed state of the 256 key codes, one bit per key, so that chords can be matched against it with a few word-wide operations.
+    // The generic modifier codes (Control, Menu, Shift) are kept pressed while either of their left/right keys is pressed, same as the system key state.
+    // Key code 0 is not a key, so its bit is used for AnyWinKey, which is pressed while either win key is pressed
+    class KeyStateBitset
+    {
+    public:
+        static constexpr KeyCode AnyWinKey = KeyCodes::None;
+        static constexpr size_t WordCount = KeyCodes::Count / 64;
+
+        bool Test(KeyCode key) const
+        {
+            return key < KeyCodes::Count && (words[key >> 6] & (1ULL << (key & 63))) != 0;
+        }
+
+        void Set(KeyCode key, bool pressed = true)
+        {
+            if (key >= KeyCodes::Count)
+            {
+                return;
+            }
+
+            if (pressed)
+            {
+                words[key >> 6] |= 1ULL << (key & 63);
+            }
+            else
+            {
+                words[key >> 6] &= ~(1ULL << (key & 63));
+            }
+        }
+
+        void Reset()
+        {
+            words.fill(0);
+        }
+
+        // Function to update the state with a key event which reached the system
+        void Update(KeyCode key, bool keyUp)
+        {
+            switch (key)
+            {
+            // Injected events can use the generic modifier codes, the system treats them as the left key
+            case KeyCodes::Control:
+                Set(KeyCodes::LeftControl, !keyUp);
+                Set(KeyCodes::RightControl, keyUp ? false : Test(KeyCodes::RightControl));
+                break;
+            case KeyCodes::Menu:
+                Set(KeyCodes::LeftMenu, !keyUp);
+                Set(KeyCodes::RightMenu, keyUp ? false : Test(KeyCodes::RightMenu));
+                break;
+            case KeyCodes::Shift:
+                Set(KeyCodes::LeftShift, !keyUp);
+                Set(KeyCodes::RightShift, keyUp ? false : Test(KeyCodes::RightShift));
+                break;
+            default:
+                Set(key, !keyUp);
+                break;
+            }
+
+            UpdateGenericModifiers();
+        }
+
+        // Function to set the generic modifier codes and AnyWinKey from their left and right keys
+        void UpdateGenericModifiers()
+        {
+            Set(KeyCodes::Control, Test(KeyCodes::LeftControl) || Test(KeyCodes::RightControl));
+            Set(KeyCodes::Menu, Test(KeyCodes::LeftMenu) || Test(KeyCodes::RightMenu));
+            Set(KeyCodes::Shift, Test(KeyCodes::LeftShift) || Test(KeyCodes::RightShift));
+            Set(AnyWinKey, Test(KeyCodes::LeftWin) || Test(KeyCodes::RightWin));
+        }
+
+        // Function to call the callback with each pressed key code, in increasing order
+        template<typename Callback>
+        void ForEachKey(Callback&& callback) const
+        {
+            for (size_t i = 0; i < WordCount; i++)
+            {
+                uint64_t word = words[i];
+                while (word != 0)
+                {
+                    callback(static_cast<KeyCode>(i * 64 + std::countr_zero(word)));
+                    word &= word - 1;
+                }
+            }
+        }
+
+        bool None() const
+        {
+            return (words[0] | words[1] | words[2] | words[3]) == 0;
+        }
+
+        KeyStateBitset operator&(const KeyStateBitset& other) const
+        {
+            KeyStateBitset result;
+            for (size_t i = 0; i < WordCount; i++)
+            {
+                result.words[i] = words[i] & other.words[i];
+            }
+
+            return result;
+        }
+
+        KeyStateBitset operator|(const KeyStateBitset& other) const
+        {
+            KeyStateBitset result;
+            for (size_t i = 0; i < WordCount; i++)
+            {
+                result.words[i] = words[i] | other.words[i];
+            }
+
+            return result;
+        }
+
+        KeyStateBitset operator~() const
+        {
+            KeyStateBitset result;
+            for (size_t i = 0; i < WordCount; i++)
+            {
+                result.words[i] = ~words[i];
+            }
+
+            return result;
+        }
+
+        // Function to check if all the keys set in other are set in this state
+        bool Contains(const KeyStateBitset& other) const
+        {
+            for (size_t i = 0; i < WordCount; i++)
+            {
+                if ((words[i] & other.words[i]) != other.words[i])
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        bool operator==(const KeyStateBitset& other) const = default;
+
+    private:
+        std::array<uint64_t, WordCount> words = {};
+    };
+}
@@ -0,0 +1,737 @@
+#include "RemapEngine.h"
+
+#include <algorithm>
+#include <cwctype>
+
+namespace KeyboardManagerCore
+{
+    namespace
+    {
+        // Fixed capacity list of key events stored on the stack, the equivalent of InputBatch
+        class EventBatch
+        {
+        public:
+            // The largest batch releases a chord, presses another one and sends a dummy key event
+            static constexpr size_t Capacity = 16;
+
+            void Add(KeyCode key, bool keyUp, EventSource source)
+            {
+                events[count++] = KeyEvent{ key, keyUp, source };
+            }
+
+            // Function to add the dummy key events used to ensure releasing a modifier doesn't trigger another action (for example Win->Start Menu or Alt->Menu bar)
+            void AddDummyKeyEvent(EventSource source)
+            {
+                Add(KeyCodes::DummyKey, false, source);
+                Add(KeyCodes::DummyKey, true, source);
+            }
+
+            // Function to add the modifier key events of a chord, same as Helpers::SetModifierKeyEvents. If chordToCompare is non-empty, the event for a modifier is added only if both chords don't have the same modifier. If keyToBeReleased is set, the event is added if the modifier matches it, and key down events are never added for it
+            void AddModifierKeyEvents(const Chord& chordToBeSent, ModifierSide winKeyInvoked, bool isKeyDown, EventSource source, const Chord& chordToCompare = Chord(), KeyCode keyToBeReleased = KeyCodes::None)
+            {
+                const bool compare = chordToCompare.Size() != 0;
+                const KeyCode win = chordToBeSent.GetWinKey(winKeyInvoked);
+                const KeyCode ctrl = chordToBeSent.GetCtrlKey();
+                const KeyCode alt = chordToBeSent.GetAltKey();
+                const KeyCode shift = chordToBeSent.GetShiftKey();
+
+                // Key down events are sent in the order Win, Ctrl, Alt, Shift
+                if (isKeyDown)
+                {
+                    if (win != KeyCodes::None && (!compare || win != chordToCompare.GetWinKey(winKeyInvoked)) && (keyToBeReleased == KeyCodes::None || !chordToBeSent.CheckWinKey(keyToBeReleased)))
+                    {
+                        Add(win, false, source);
+                    }
+                    if (ctrl != KeyCodes::None && (!compare || ctrl != chordToCompare.GetCtrlKey()) && (keyToBeReleased == KeyCodes::None || !chordToBeSent.CheckCtrlKey(keyToBeReleased)))
+                    {
+                        Add(ctrl, false, source);
+                    }
+                    if (alt != KeyCodes::None && (!compare || alt != chordToCompare.GetAltKey()) && (keyToBeReleased == KeyCodes::None || !chordToBeSent.CheckAltKey(keyToBeReleased)))
+                    {
+                        Add(alt, false, source);
+                    }
+                    if (shift != KeyCodes::None && (!compare || shift != chordToCompare.GetShiftKey()) && (keyToBeReleased == KeyCodes::None || !chordToBeSent.CheckShiftKey(keyToBeReleased)))
+                    {
+                        Add(shift, false, source);
+                    }
+                }
+                // Key up events are sent in the order Shift, Alt, Ctrl, Win
+                else
+                {
+                    if (shift != KeyCodes::None && (!compare || shift != chordToCompare.GetShiftKey() || chordToBeSent.CheckShiftKey(keyToBeReleased)))
+                    {
+                        Add(shift, true, source);
+                    }
+                    if (alt != KeyCodes::None && (!compare || alt != chordToCompare.GetAltKey() || chordToBeSent.CheckAltKey(keyToBeReleased)))
+                    {
+                        Add(alt, true, source);
+                    }
+                    if (ctrl != KeyCodes::None && (!compare || ctrl != chordToCompare.GetCtrlKey() || chordToBeSent.CheckCtrlKey(keyToBeReleased)))
+                    {
+                        Add(ctrl, true, source);
+                    }
+                    if (win != KeyCodes::None && (!compare || win != chordToCompare.GetWinKey(winKeyInvoked) || chordToBeSent.CheckWinKey(keyToBeReleased)))
+                    {
+                        Add(win, true, source);
+                    }
+                }
+            }
+
+            void Send(Platform& platform) const
+            {
+                if (count > 0)
+                {
+                    platform.InjectEvents(events.data(), count);
+                }
+            }
+
+        private:
+            std::array<KeyEvent, Capacity> events = {};
+            size_t count = 0;
+        };
+
+        // Function to check if a chord has no Ctrl, Alt or Shift modifier
+        bool HasNoCtrlAltShift(const Chord& chord)
+        {
+            return chord.ctrl == ModifierSide::None && chord.alt == ModifierSide::None && chord.shift == ModifierSide::None;
+        }
+
+        // Function to ensure the Ctrl/Alt/Shift modifier state is not detected as pressed down by applications which detect keys at a lower level than hooks when it is remapped to Caps Lock. Same as ResetIfModifierKeyForLowerLevelKeyHandlers
+        void ResetIfModifierKeyForLowerLevelKeyHandlers(Platform& platform, KeyCode key, KeyCode target)
+        {
+            if (target == KeyCodes::CapsLock && IsModifierKey(key) && !(key == KeyCodes::LeftWin || key == KeyCodes::RightWin || key == KeyCodes::WinBoth))
+            {
+                KeyEvent event{ key, true, EventSource::Suppressed };
+                platform.InjectEvents(&event, 1);
+            }
+        }
+
+        // Function to call the callback with each key code of the chord in the display order
+        template<typename Callback>
+        void ForEachKeyCode(const Chord& chord, Callback&& callback)
+        {
+            for (KeyCode key : { chord.GetWinKey(ModifierSide::Both), chord.GetCtrlKey(), chord.GetAltKey(), chord.GetShiftKey(), chord.actionKey })
+            {
+                if (key != KeyCodes::None)
+                {
+                    callback(key);
+                }
+            }
+        }
+
+        // Function to check if all the modifiers in the chord are pressed down. With a tracked key state most chords are rejected by their masks without querying the platform,
+        // and a match is confirmed since a key up could have been missed
+        bool CheckModifiersKeyboardState(Platform& platform, const Chord& chord, const CompiledChord& compiledChord)
+        {
+            if (const KeyStateBitset* keyState = platform.GetTrackedKeyState(); keyState && !compiledChord.CheckModifiersKeyboardState(*keyState))
+            {
+                return false;
+            }
+
+            return chord.CheckModifiersKeyboardState(platform);
+        }
+
+        // Function to check if any keys are pressed down except those in the chord. With a tracked key state only the keys outside of the chord which are pressed in it are queried
+        bool IsKeyboardStateClearExceptChord(Platform& platform, const Chord& chord, const CompiledChord& compiledChord)
+        {
+            const KeyStateBitset* keyState = platform.GetTrackedKeyState();
+            if (!keyState)
+            {
+                return chord.IsKeyboardStateClearExceptChord(platform);
+            }
+
+            bool isClear = true;
+            (*keyState & compiledChord.GetForbiddenKeys()).ForEachKey([&](KeyCode key) {
+                if (isClear && platform.IsKeyPressed(key))
+                {
+                    isClear = false;
+                }
+            });
+
+            return isClear;
+        }
+
+        std::wstring ToLower(std::wstring_view text)
+        {
+            std::wstring result(text);
+            std::transform(result.begin(), result.end(), result.begin(), [](wchar_t c) { return static_cast<wchar_t>(std::towlower(c)); });
+            return result;
+        }
+    }
+
+    RemapEngine::RemapEngine(const RemapConfig& config)
+    {
+        for (const auto& [originalKey, target] : config.singleKeyRemaps)
+        {
+            // Key events are only received for key codes below Count
+            if (originalKey >= KeyCodes::Count)
+            {
+                continue;
+            }
+
+            SingleKeyRemap remap;
+            remap.target = target;
+            if (const KeyCode* targetKey = std::get_if<KeyCode>(&target))
+            {
+                remap.isDisabled = (*targetKey == KeyCodes::Disabled);
+                remap.targetKey = FilterArtificialKeys(*targetKey);
+                remap.keyDownEvents[0] = KeyEvent{ remap.targetKey, false, EventSource::SingleKeyRemap };
+                remap.keyUpEvents[0] = KeyEvent{ remap.targetKey, true, EventSource::SingleKeyRemap };
+                remap.keyDownEventCount = 1;
+                remap.keyUpEventCount = 1;
+            }
+            else
+            {
+                const Chord& targetChord = std::get<Chord>(target);
+                remap.targetKey = FilterArtificialKeys(targetChord.actionKey);
+
+                // Dummy key events are not required since only modifier key down events are sent before the action key down, and only modifier key up events after the action key up
+                size_t i = 0;
+                ForEachKeyCode(targetChord, [&](KeyCode key) {
+                    if (key != targetChord.actionKey)
+                    {
+                        remap.keyDownEvents[i++] = KeyEvent{ key == KeyCodes::WinBoth ? KeyCodes::LeftWin : key, false, EventSource::SingleKeyRemap };
+                    }
+                });
+                remap.keyDownEvents[i++] = KeyEvent{ targetChord.actionKey, false, EventSource::SingleKeyRemap };
+                remap.keyDownEventCount = i;
+
+                // Key up events are sent in the reverse order
+                for (size_t j = 0; j < i; j++)
+                {
+                    remap.keyUpEvents[j] = KeyEvent{ remap.keyDownEvents[i - 1 - j].key, true, EventSource::SingleKeyRemap };
+                }
+                remap.keyUpEventCount = i;
+            }
+
+            singleKeyRemaps.push_back(remap);
+            singleKeyRemapIndices[originalKey] = static_cast<uint16_t>(singleKeyRemaps.size());
+        }
+
+        CompileShortcutTable(config.osLevelShortcutRemaps, osLevelTable);
+        for (const auto& [appName, remaps] : config.appSpecificShortcutRemaps)
+        {
+            const auto it = appSpecificTables.try_emplace(ToLower(appName)).first;
+            CompileShortcutTable(remaps, it->second);
+            it->second.appName = it->first;
+        }
+    }
+
+    void RemapEngine::CompileShortcutTable(const ChordRemapList& remaps, ShortcutTable& table)
+    {
+        for (const auto& [source, target] : remaps)
+        {
+            Chord targetChord;
+            if (const Chord* chord = std::get_if<Chord>(&target))
+            {
+                targetChord = *chord;
+            }
+            else if (std::get<KeyCode>(target) != KeyCodes::Disabled)
+            {
+                targetChord.SetKey(FilterArtificialKeys(std::get<KeyCode>(target)));
+            }
+
+            table.remaps.push_back(ShortcutRemap{ source, target, CompiledChord(source), CompiledChord(targetChord) });
+        }
+
+        // Chords with more modifiers are checked first so that Ctrl+Shift+A is matched before Ctrl+A
+        std::stable_sort(table.remaps.begin(), table.remaps.end(), [](const ShortcutRemap& first, const ShortcutRemap& second) {
+            return first.source.Size() > second.source.Size();
+        });
+
+        for (size_t i = 0; i < table.remaps.size(); i++)
+        {
+            const KeyCode actionKey = table.remaps[i].source.actionKey;
+            if (actionKey < KeyCodes::Count)
+            {
+                table.remapsByActionKey[actionKey].push_back(i);
+            }
+        }
+    }
+
+    // Function to handle a key event. Returns true if the event should be suppressed
+    bool RemapEngine::HandleKeyEvent(Platform& platform, const KeyEvent& event)
+    {
+        if (event.source == EventSource::Suppressed)
+        {
+            return true;
+        }
+
+        if (HandleSingleKeyRemapEvent(platform, event))
+        {
+            return true;
+        }
+
+        if (HandleAppSpecificShortcutRemapEvent(platform, event))
+        {
+            return true;
+        }
+
+        return HandleOSLevelShortcutRemapEvent(platform, event);
+    }
+
+    // Function to set the process name of the app in the foreground. The app-specific remaps are looked up here, so that the key events don't have to
+    void RemapEngine::SetForegroundApp(std::wstring_view appName)
+    {
+        foregroundAppTable = nullptr;
+        if (appName.empty() || appSpecificTables.empty())
+        {
+            return;
+        }
+
+        const std::wstring lowercaseName = ToLower(appName);
+        auto it = appSpecificTables.find(lowercaseName);
+        if (it == appSpecificTables.end())
+        {
+            // Remaps can also be set for the app name without its extension
+            const size_t extension = lowercaseName.rfind(L'.');
+            if (extension != std::wstring::npos)
+            {
+                it = appSpecificTables.find(std::wstring_view(lowercaseName).substr(0, extension));
+            }
+        }
+
+        if (it != appSpecificTables.end())
+        {
+            foregroundAppTable = &it->second;
+        }
+    }
+
+    // Function to check if any shortcut remap is currently invoked
+    bool RemapEngine::IsShortcutRemapInvoked() const
+    {
+        return osLevelTable.invokedRemap.has_value() || activatedAppTable != nullptr;
+    }
+
+    // Function to get the index of the os level remap with the given source chord
+    std::optional<size_t> RemapEngine::FindOSLevelShortcutRemap(const Chord& source) const
+    {
+        for (size_t i = 0; i < osLevelTable.remaps.size(); i++)
+        {
+            if (osLevelTable.remaps[i].source == source)
+            {
+                return i;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    // Functions to get the state of the os level shortcut remap with the given source chord
+    bool RemapEngine::IsShortcutRemapInvoked(const Chord& source) const
+    {
+        const auto remapIndex = FindOSLevelShortcutRemap(source);
+        return remapIndex && osLevelTable.invokedRemap == remapIndex;
+    }
+
+    bool RemapEngine::IsOriginalActionKeyPressed(const Chord& source) const
+    {
+        const auto remapIndex = FindOSLevelShortcutRemap(source);
+        return remapIndex && osLevelTable.remaps[*remapIndex].isOriginalActionKeyPressed;
+    }
+
+    // Function to get the app whose shortcut remap is currently invoked, empty if there is none
+    std::wstring_view RemapEngine::GetActivatedApp() const
+    {
+        return activatedAppTable ? activatedAppTable->appName : std::wstring_view();
+    }
+
+    bool RemapEngine::HandleSingleKeyRemapEvent(Platform& platform, const KeyEvent& event)
+    {
+        // Events injected by the engine are not remapped again by the single key remaps
+        if (event.source != EventSource::Physical || event.key >= KeyCodes::Count || singleKeyRemapIndices[event.key] == 0)
+        {
+            return false;
+        }
+
+        const SingleKeyRemap& remap = singleKeyRemaps[singleKeyRemapIndices[event.key] - 1];
+        if (remap.isDisabled)
+        {
+            return true;
+        }
+
+        // If Ctrl/Alt/Shift is being remapped to Caps Lock, then reset the modifier key state to fix issues in certain IME keyboards
+        if (!event.keyUp)
+        {
+            ResetIfModifierKeyForLowerLevelKeyHandlers(platform, event.key, remap.targetKey);
+        }
+
+        if (event.keyUp)
+        {
+            platform.InjectEvents(remap.keyUpEvents.data(), remap.keyUpEventCount);
+        }
+        else
+        {
+            platform.InjectEvents(remap.keyDownEvents.data(), remap.keyDownEventCount);
+
+            platform.OnSingleKeyRemapInvoked(std::holds_alternative<KeyCode>(remap.target));
+
+            // If Caps Lock is being remapped to Ctrl/Alt/Shift, then reset the modifier key state to fix issues in certain IME keyboards
+            if (const Chord* targetChord = std::get_if<Chord>(&remap.target))
+            {
+                ForEachKeyCode(*targetChord, [&](KeyCode key) {
+                    ResetIfModifierKeyForLowerLevelKeyHandlers(platform, key, event.key);
+                });
+            }
+            else
+            {
+                ResetIfModifierKeyForLowerLevelKeyHandlers(platform, remap.targetKey, event.key);
+            }
+        }
+
+        return true;
+    }
+
+    bool RemapEngine::HandleAppSpecificShortcutRemapEvent(Platform& platform, const KeyEvent& event)
+    {
+        // Events injected by the shortcut remaps are not remapped again
+        if (event.source == EventSource::ShortcutRemap)
+        {
+            return false;
+        }
+
+        // The app of an invoked remap keeps handling the events even if another app is in the foreground
+        ShortcutTable* table = activatedAppTable ? activatedAppTable : foregroundAppTable;
+        if (table == nullptr)
+        {
+            return false;
+        }
+
+        return HandleShortcutRemapEvent(platform, event, *table);
+    }
+
+    bool RemapEngine::HandleOSLevelShortcutRemapEvent(Platform& platform, const KeyEvent& event)
+    {
+        // Events injected by the shortcut remaps are not remapped again
+        if (event.source == EventSource::ShortcutRemap)
+        {
+            return false;
+        }
+
+        return HandleShortcutRemapEvent(platform, event, osLevelTable);
+    }
+
+    bool RemapEngine::HandleShortcutRemapEvent(Platform& platform, const KeyEvent& event, ShortcutTable& table)
+    {
+        // If a shortcut is currently in the invoked state then only that shortcut can handle the event
+        if (table.invokedRemap)
+        {
+            return HandleInvokedShortcutRemap(platform, event, table);
+        }
+
+        // A shortcut can only be invoked by a key down of its action key
+        if (event.keyUp || event.key >= KeyCodes::Count)
+        {
+            return false;
+        }
+
+        const auto& remapIndices = table.remapsByActionKey[event.key];
+        if (remapIndices.empty())
+        {
+            return false;
+        }
+
+        bool isModifierStateMatched = false;
+        for (size_t remapIndex : remapIndices)
+        {
+            const ShortcutRemap& remap = table.remaps[remapIndex];
+            if (CheckModifiersKeyboardState(platform, remap.source, remap.compiledSource))
+            {
+                isModifierStateMatched = true;
+                if (InvokeShortcutRemap(platform, event, table, remapIndex))
+                {
+                    return true;
+                }
+            }
+        }
+
+        // If no remap matched the tracked modifiers, a modifier key down could have been missed, e.g. while the secure desktop was active. The modifiers are resynced and checked again only then
+        if (!isModifierStateMatched && platform.ResyncTrackedModifiers())
+        {
+            for (size_t remapIndex : remapIndices)
+            {
+                const ShortcutRemap& remap = table.remaps[remapIndex];
+                if (CheckModifiersKeyboardState(platform, remap.source, remap.compiledSource) && InvokeShortcutRemap(platform, event, table, remapIndex))
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    void RemapEngine::ResetInvokedRemap(ShortcutTable& table)
+    {
+        ShortcutRemap& remap = table.remaps[*table.invokedRemap];
+        remap.winKeyInvoked = ModifierSide::None;
+        remap.isOriginalActionKeyPressed = false;
+        table.invokedRemap = std::nullopt;
+
+        if (activatedAppTable == &table)
+        {
+            activatedAppTable = nullptr;
+        }
+    }
+
+    // Function to invoke a shortcut remap whose modifiers are pressed when its action key is pressed down. Returns false if the remap should not be invoked because other keys are pressed
+    bool RemapEngine::InvokeShortcutRemap(Platform& platform, const KeyEvent& event, ShortcutTable& table, size_t remapIndex)
+    {
+        ShortcutRemap& remap = table.remaps[remapIndex];
+        const Chord& source = remap.source;
+        const Chord* targetChord = std::get_if<Chord>(&remap.target);
+        const KeyCode targetKey = targetChord ? KeyCodes::None : std::get<KeyCode>(remap.target);
+
+        // Check if any other keys have been pressed apart from the shortcut. This is to be done only for shortcut to shortcut remaps and remaps to Disabled
+        if ((targetChord || targetKey == KeyCodes::Disabled) && !IsKeyboardStateClearExceptChord(platform, source, remap.compiledSource))
+        {
+            return false;
+        }
+
+        // Remember which win key was pressed initially
+        if (platform.IsKeyPressed(KeyCodes::RightWin))
+        {
+            remap.winKeyInvoked = ModifierSide::Right;
+        }
+        else if (platform.IsKeyPressed(KeyCodes::LeftWin))
+        {
+            remap.winKeyInvoked = ModifierSide::Left;
+        }
+
+        EventBatch batch;
+        if (targetChord)
+        {
+            // If the original chord modifiers are a subset of the new chord, only the new modifiers and the action key are pressed
+            const int commonKeys = source.GetCommonModifiersCount(*targetChord);
+            if (commonKeys == source.Size() - 1)
+            {
+                batch.AddModifierKeyEvents(*targetChord, remap.winKeyInvoked, true, EventSource::ShortcutRemap, source);
+                batch.Add(targetChord->actionKey, false, EventSource::ShortcutRemap);
+            }
+            else
+            {
+                // The dummy key prevents the released modifiers from triggering their own action. Example: Win+A->Ctrl+V, since Win is released here
+                batch.AddDummyKeyEvent(EventSource::ShortcutRemap);
+                batch.AddModifierKeyEvents(source, remap.winKeyInvoked, false, EventSource::ShortcutRemap, *targetChord);
+                batch.AddModifierKeyEvents(*targetChord, remap.winKeyInvoked, true, EventSource::ShortcutRemap, source);
+                batch.Add(targetChord->actionKey, false, EventSource::ShortcutRemap);
+            }
+
+            // Modifier state reset might be required for this key depending on the shortcut's action and target modifiers - ex: Win+Caps -> Ctrl+A
+            if (HasNoCtrlAltShift(source))
+            {
+                ForEachKeyCode(*targetChord, [&](KeyCode key) {
+                    ResetIfModifierKeyForLowerLevelKeyHandlers(platform, key, event.key);
+                });
+            }
+        }
+        else
+        {
+            // Since the original action key is pressed, remember it for remaps to Disabled
+            if (targetKey == KeyCodes::Disabled)
+            {
+                remap.isOriginalActionKeyPressed = true;
+            }
+
+            batch.AddDummyKeyEvent(EventSource::ShortcutRemap);
+            batch.AddModifierKeyEvents(source, remap.winKeyInvoked, false, EventSource::ShortcutRemap);
+            if (targetKey != KeyCodes::Disabled)
+            {
+                batch.Add(FilterArtificialKeys(targetKey), false, EventSource::ShortcutRemap);
+            }
+
+            // Modifier state reset might be required for this key depending on the shortcut's action and target modifier - ex: Win+Caps -> Ctrl
+            if (HasNoCtrlAltShift(source))
+            {
+                ResetIfModifierKeyForLowerLevelKeyHandlers(platform, FilterArtificialKeys(targetKey), event.key);
+            }
+        }
+
+        table.invokedRemap = remapIndex;
+        if (&table != &osLevelTable)
+        {
+            activatedAppTable = &table;
+        }
+
+        batch.Send(platform);
+        platform.OnShortcutRemapInvoked(targetChord != nullptr, &table != &osLevelTable);
+        return true;
+    }
+
+    // Function to handle a key event while a shortcut remap is in the invoked state. The cases are the same as in KeyboardEventHandlers::HandleShortcutRemapEvent
+    bool RemapEngine::HandleInvokedShortcutRemap(Platform& platform, const KeyEvent& event, ShortcutTable& table)
+    {
+        ShortcutRemap& remap = table.remaps[*table.invokedRemap];
+        const Chord& source = remap.source;
+        const Chord* targetChord = std::get_if<Chord>(&remap.target);
+        const KeyCode targetKey = targetChord ? KeyCodes::None : std::get<KeyCode>(remap.target);
+        const KeyCode filteredTargetKey = FilterArtificialKeys(targetKey);
+        const int commonKeys = targetChord ? source.GetCommonModifiersCount(*targetChord) : 0;
+        const ModifierSide winKeyInvoked = remap.winKeyInvoked;
+
+        // Case 1: If any of the modifier keys of the original shortcut are released before the action key, release the new shortcut and restore the original modifiers except the released one
+        if (source.CheckModifierKey(event.key) && event.keyUp)
+        {
+            EventBatch batch;
+            if (targetChord)
+            {
+                if (platform.IsKeyPressed(targetChord->actionKey))
+                {
+                    batch.Add(targetChord->actionKey, true, EventSource::ShortcutRemap);
+                }
+
+                batch.AddModifierKeyEvents(*targetChord, winKeyInvoked, false, EventSource::ShortcutRemap, source, event.key);
+                batch.AddModifierKeyEvents(source, winKeyInvoked, true, EventSource::ShortcutRemap, *targetChord, event.key);
+            }
+            else
+            {
+                if (targetKey != KeyCodes::Disabled && platform.IsKeyPressed(filteredTargetKey))
+                {
+                    batch.Add(filteredTargetKey, true, EventSource::ShortcutRemap);
+                }
+
+                batch.AddModifierKeyEvents(source, winKeyInvoked, true, EventSource::ShortcutRemap, Chord(), event.key);
+            }
+
+            // The dummy key prevents the restored modifiers from triggering their own action. Example: Win+Ctrl+A->Ctrl+V, press Win+Ctrl+A and release A then Ctrl
+            batch.AddDummyKeyEvent(EventSource::ShortcutRemap);
+
+            ResetInvokedRemap(table);
+            batch.Send(platform);
+            return true;
+        }
+
+        // The system will see the modifiers of the new shortcut as being held down because of the shortcut remap
+        if (targetChord && !CheckModifiersKeyboardState(platform, *targetChord, remap.compiledTarget))
+        {
+            return false;
+        }
+
+        // Case 2: If the original shortcut is still held down, the action key repeats
+        if (event.key == source.actionKey && !event.keyUp)
+        {
+            if (!targetChord && targetKey == KeyCodes::Disabled)
+            {
+                remap.isOriginalActionKeyPressed = true;
+                return true;
+            }
+
+            EventBatch batch;
+            batch.Add(targetChord ? targetChord->actionKey : filteredTargetKey, false, EventSource::ShortcutRemap);
+            batch.Send(platform);
+            return true;
+        }
+
+        // Case 3: If the action key of the original shortcut is released, keep the modifiers of the new shortcut until some other key event which doesn't apply to the original shortcut
+        if (event.key == source.actionKey && event.keyUp)
+        {
+            EventBatch batch;
+            if (targetChord)
+            {
+                batch.Add(targetChord->actionKey, true, EventSource::ShortcutRemap);
+            }
+            else if (targetKey == KeyCodes::Disabled)
+            {
+                remap.isOriginalActionKeyPressed = false;
+                return true;
+            }
+            else
+            {
+                batch.Add(filteredTargetKey, true, EventSource::ShortcutRemap);
+
+                // If any other key is pressed, then the keyboard state must be reverted back to the physical keys. Example: Ctrl+A->D remap and the user presses B+Ctrl+A and releases A
+                Chord targetKeyChord;
+                targetKeyChord.SetKey(filteredTargetKey);
+                if (!IsKeyboardStateClearExceptChord(platform, targetKeyChord, remap.compiledTarget))
+                {
+                    batch.AddModifierKeyEvents(source, winKeyInvoked, true, EventSource::ShortcutRemap);
+                    batch.AddDummyKeyEvent(EventSource::ShortcutRemap);
+                    ResetInvokedRemap(table);
+                }
+            }
+
+            batch.Send(platform);
+            return true;
+        }
+
+        // Case 4: If a modifier key in the original shortcut is pressed then suppress it since the original shortcut is already held down physically
+        if (source.CheckModifierKey(event.key) && !event.keyUp)
+        {
+            if (targetChord)
+            {
+                if (HasNoCtrlAltShift(*targetChord))
+                {
+                    ResetIfModifierKeyForLowerLevelKeyHandlers(platform, event.key, targetChord->actionKey);
+                }
+            }
+            else if (targetKey != KeyCodes::Disabled)
+            {
+                ResetIfModifierKeyForLowerLevelKeyHandlers(platform, event.key, filteredTargetKey);
+            }
+
+            return true;
+        }
+
+        // Case 5: If any other key is pressed then revert the keyboard state to just the original modifiers being held down along with the current key press
+        if (!event.keyUp)
+        {
+            if (targetChord)
+            {
+                if (HasNoCtrlAltShift(*targetChord))
+                {
+                    ResetIfModifierKeyForLowerLevelKeyHandlers(platform, event.key, targetChord->actionKey);
+                }
+
+                EventBatch batch;
+                const bool isActionKeyPressed = platform.IsKeyPressed(targetChord->actionKey);
+                if (isActionKeyPressed)
+                {
+                    batch.Add(targetChord->actionKey, true, EventSource::ShortcutRemap);
+                }
+
+                batch.AddModifierKeyEvents(*targetChord, winKeyInvoked, false, EventSource::ShortcutRemap, source);
+                if (commonKeys != source.Size() - 1)
+                {
+                    batch.AddModifierKeyEvents(source, winKeyInvoked, true, EventSource::ShortcutRemap, *targetChord);
+                }
+
+                // The original action key is pressed with the shortcut source so that the same remap isn't invoked again
+                if (isActionKeyPressed)
+                {
+                    batch.Add(source.actionKey, false, EventSource::ShortcutRemap);
+                }
+
+                // The current key is sent as a physical event so that it can be reprocessed in case the physical keys pressed are a different remapped shortcut. No dummy key is sent so that it keeps its press+release behavior
+                batch.Add(event.key, false, EventSource::Physical);
+
+                ResetInvokedRemap(table);
+                batch.Send(platform);
+                return true;
+            }
+
+            ResetIfModifierKeyForLowerLevelKeyHandlers(platform, event.key, filteredTargetKey);
+
+            // For remaps to a key, the event isn't suppressed while the target key is pressed so that it can be used with other keys. Example: Alt+D->Win allows Alt+D+A to perform Win+A
+            const bool isRemapToDisable = (targetKey == KeyCodes::Disabled);
+            const bool isOriginalActionKeyPressed = isRemapToDisable ? remap.isOriginalActionKeyPressed : platform.IsKeyPressed(filteredTargetKey);
+            if (isRemapToDisable || !isOriginalActionKeyPressed)
+            {
+                EventBatch batch;
+                batch.AddModifierKeyEvents(source, winKeyInvoked, true, EventSource::ShortcutRemap);
+                if (isRemapToDisable && isOriginalActionKeyPressed)
+                {
+                    batch.Add(source.actionKey, false, EventSource::ShortcutRemap);
+                }
+
+                batch.Add(event.key, false, EventSource::Physical);
+
+                ResetInvokedRemap(table);
+                batch.Send(platform);
+                return true;
+            }
+        }
+
+        // Case 6: Key up of any other key - can only happen for key events generated by code, so they are not suppressed
+        return false;
+    }
+}
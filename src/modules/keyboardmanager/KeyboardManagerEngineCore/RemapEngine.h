@@ -0,0 +1,128 @@
+#pragma once
+#include "Chord.h"
+
+#include <array>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace KeyboardManagerCore
+{
+    using ChordRemapList = std::vector<std::pair<Chord, RemapTarget>>;
+
+    // Remaps applied by the engine. App names are matched case insensitively, with or without their extension
+    struct RemapConfig
+    {
+        std::map<KeyCode, RemapTarget> singleKeyRemaps;
+        ChordRemapList osLevelShortcutRemaps;
+        std::map<std::wstring, ChordRemapList> appSpecificShortcutRemaps;
+    };
+
+    // Platform independent implementation of the single key and shortcut remap logic of the keyboard hook. Events are processed in the same order as the hook: single key remaps, then app-specific shortcut remaps, then os level shortcut remaps
+    class RemapEngine
+    {
+    public:
+        explicit RemapEngine(const RemapConfig& config);
+        RemapEngine(const RemapEngine&) = delete;
+        RemapEngine& operator=(const RemapEngine&) = delete;
+
+        // Function to handle a key event. Returns true if the event should be suppressed
+        bool HandleKeyEvent(Platform& platform, const KeyEvent& event);
+
+        // Functions to handle a key event with one stage of HandleKeyEvent, for hooks which run the stages separately. Events from the engine's own stage are ignored by each of them
+        bool HandleSingleKeyRemapEvent(Platform& platform, const KeyEvent& event);
+        bool HandleAppSpecificShortcutRemapEvent(Platform& platform, const KeyEvent& event);
+        bool HandleOSLevelShortcutRemapEvent(Platform& platform, const KeyEvent& event);
+
+        // Function to set the process name of the app in the foreground. The app-specific remaps are looked up here, so that the key events don't have to. Should be called whenever the foreground app changes
+        void SetForegroundApp(std::wstring_view appName);
+
+        // Function to check if any shortcut remap is currently invoked
+        bool IsShortcutRemapInvoked() const;
+
+        // Functions to get the state of the os level shortcut remap with the given source chord
+        bool IsShortcutRemapInvoked(const Chord& source) const;
+        bool IsOriginalActionKeyPressed(const Chord& source) const;
+
+        // Function to get the app whose shortcut remap is currently invoked, empty if there is none
+        std::wstring_view GetActivatedApp() const;
+
+    private:
+        // Single key remap with the key events which are sent for it precomputed
+        struct SingleKeyRemap
+        {
+            static constexpr size_t MaxKeyEvents = 5;
+
+            RemapTarget target;
+            bool isDisabled = false;
+
+            // Target key, or the action key of the target chord, with artificial keys filtered
+            KeyCode targetKey = KeyCodes::None;
+
+            size_t keyDownEventCount = 0;
+            std::array<KeyEvent, MaxKeyEvents> keyDownEvents = {};
+            size_t keyUpEventCount = 0;
+            std::array<KeyEvent, MaxKeyEvents> keyUpEvents = {};
+        };
+
+        struct ShortcutRemap
+        {
+            Chord source;
+            RemapTarget target;
+
+            // Masks of the source chord, and of the target chord or the chord of the target key, compiled when the table is compiled
+            CompiledChord compiledSource;
+            CompiledChord compiledTarget;
+
+            // Win key which was pressed when the remap was invoked
+            ModifierSide winKeyInvoked = ModifierSide::None;
+
+            // Used by remaps to Disabled to track whether the original action key is held down
+            bool isOriginalActionKeyPressed = false;
+        };
+
+        struct ShortcutTable
+        {
+            // Remaps sorted so that chords with more modifiers are checked first
+            std::vector<ShortcutRemap> remaps;
+
+            // Indices of the remaps for each action key, in priority order
+            std::array<std::vector<size_t>, KeyCodes::Count> remapsByActionKey;
+
+            // Index of the remap which is currently invoked
+            std::optional<size_t> invokedRemap;
+
+            // Lowercase name of the app, empty for the os level table
+            std::wstring_view appName;
+        };
+
+        // Index + 1 of the single key remap for each key code, 0 if the key isn't remapped
+        std::array<uint16_t, KeyCodes::Count> singleKeyRemapIndices = {};
+        std::vector<SingleKeyRemap> singleKeyRemaps;
+
+        ShortcutTable osLevelTable;
+        std::map<std::wstring, ShortcutTable, std::less<>> appSpecificTables;
+
+        // Table of the app whose shortcut remap is currently invoked. It handles the events until the remap is released, even if the foreground app changes
+        ShortcutTable* activatedAppTable = nullptr;
+
+        // Table of the app in the foreground, nullptr if it doesn't have any remaps
+        ShortcutTable* foregroundAppTable = nullptr;
+
+        static void CompileShortcutTable(const ChordRemapList& remaps, ShortcutTable& table);
+
+        // Function to get the index of the os level remap with the given source chord
+        std::optional<size_t> FindOSLevelShortcutRemap(const Chord& source) const;
+
+        bool HandleShortcutRemapEvent(Platform& platform, const KeyEvent& event, ShortcutTable& table);
+        bool InvokeShortcutRemap(Platform& platform, const KeyEvent& event, ShortcutTable& table, size_t remapIndex);
+        bool HandleInvokedShortcutRemap(Platform& platform, const KeyEvent& event, ShortcutTable& table);
+
+        // Function to reset the invoked remap of the table
+        void ResetInvokedRemap(ShortcutTable& table);
+    };
+}
@@ -0,0 +1,705 @@
+#include "Replay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <istream>
+#include <ostream>
+#include <sstream>
+
+namespace KeyboardManagerCore
+{
+    namespace
+    {
+        // Deterministic random number generator (xorshift64*). The standard distributions aren't used since their output differs between standard library implementations
+        class Random
+        {
+        public:
+            explicit Random(uint32_t seed) :
+                state(seed * 0x9E3779B97F4A7C15ull + 1)
+            {
+            }
+
+            size_t Next(size_t bound)
+            {
+                state ^= state >> 12;
+                state ^= state << 25;
+                state ^= state >> 27;
+                return static_cast<size_t>((state * 0x2545F4914F6CDD1Dull) >> 32) % bound;
+            }
+
+        private:
+            uint64_t state;
+        };
+
+        // App names are converted between UTF-8 and UTF-16/32 so that the text formats are the same on every platform
+        std::string ToUtf8(const std::wstring& text)
+        {
+            std::string result;
+            for (wchar_t c : text)
+            {
+                const uint32_t codePoint = static_cast<uint32_t>(c);
+                if (codePoint < 0x80)
+                {
+                    result += static_cast<char>(codePoint);
+                }
+                else if (codePoint < 0x800)
+                {
+                    result += static_cast<char>(0xC0 | (codePoint >> 6));
+                    result += static_cast<char>(0x80 | (codePoint & 0x3F));
+                }
+                else
+                {
+                    result += static_cast<char>(0xE0 | ((codePoint >> 12) & 0x0F));
+                    result += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                    result += static_cast<char>(0x80 | (codePoint & 0x3F));
+                }
+            }
+
+            return result;
+        }
+
+        std::wstring FromUtf8(const std::string& text)
+        {
+            std::wstring result;
+            for (size_t i = 0; i < text.size();)
+            {
+                const auto c = static_cast<unsigned char>(text[i]);
+                if (c < 0x80)
+                {
+                    result += static_cast<wchar_t>(c);
+                    i += 1;
+                }
+                else if ((c & 0xE0) == 0xC0 && i + 1 < text.size())
+                {
+                    result += static_cast<wchar_t>(((c & 0x1F) << 6) | (text[i + 1] & 0x3F));
+                    i += 2;
+                }
+                else if ((c & 0xF0) == 0xE0 && i + 2 < text.size())
+                {
+                    result += static_cast<wchar_t>(((c & 0x0F) << 12) | ((text[i + 1] & 0x3F) << 6) | (text[i + 2] & 0x3F));
+                    i += 3;
+                }
+                else
+                {
+                    // Characters outside of the basic multilingual plane aren't used in process names
+                    result += L'?';
+                    i += 1;
+                }
+            }
+
+            return result;
+        }
+
+        // Function to parse a remap target - a key, a chord or Disable
+        std::optional<RemapTarget> ParseTarget(const std::string& text)
+        {
+            if (text.find('+') == std::string::npos)
+            {
+                const auto key = ParseKeyName(text);
+                return key ? std::optional<RemapTarget>(*key) : std::nullopt;
+            }
+
+            const auto chord = Chord::Parse(text);
+            return chord ? std::optional<RemapTarget>(*chord) : std::nullopt;
+        }
+
+        std::string TargetToString(const RemapTarget& target)
+        {
+            if (const KeyCode* key = std::get_if<KeyCode>(&target))
+            {
+                return KeyNameToString(*key);
+            }
+
+            return std::get<Chord>(target).ToString();
+        }
+
+        // Function to get the key code of a modifier as it is received from the keyboard, where Both is pressed with the left key
+        KeyCode GetPhysicalModifierKey(ModifierSide side, KeyCode left, KeyCode right)
+        {
+            return side == ModifierSide::Right ? right : left;
+        }
+
+        // Function to add the key events for pressing and releasing a chord
+        void AddChordPress(Trace& trace, uint64_t& timestampUs, uint64_t intervalUs, const Chord& chord)
+        {
+            KeyCode keys[5];
+            size_t count = 0;
+            if (chord.win != ModifierSide::None)
+            {
+                keys[count++] = GetPhysicalModifierKey(chord.win, KeyCodes::LeftWin, KeyCodes::RightWin);
+            }
+            if (chord.ctrl != ModifierSide::None)
+            {
+                keys[count++] = GetPhysicalModifierKey(chord.ctrl, KeyCodes::LeftControl, KeyCodes::RightControl);
+            }
+            if (chord.alt != ModifierSide::None)
+            {
+                keys[count++] = GetPhysicalModifierKey(chord.alt, KeyCodes::LeftMenu, KeyCodes::RightMenu);
+            }
+            if (chord.shift != ModifierSide::None)
+            {
+                keys[count++] = GetPhysicalModifierKey(chord.shift, KeyCodes::LeftShift, KeyCodes::RightShift);
+            }
+            keys[count++] = chord.actionKey;
+
+            auto addEvent = [&](KeyCode key, bool keyUp) {
+                TraceEntry entry;
+                entry.timestampUs = timestampUs;
+                entry.event = KeyEvent{ key, keyUp };
+                trace.push_back(entry);
+                timestampUs += intervalUs;
+            };
+
+            for (size_t i = 0; i < count; i++)
+            {
+                addEvent(keys[i], false);
+            }
+
+            // Release the action key first, then the modifiers in the reverse order
+            for (size_t i = count; i > 0; i--)
+            {
+                addEvent(keys[i - 1], true);
+            }
+        }
+
+        // Modifier combinations and action keys used for the generated shortcut remaps
+        const char* const generatedModifiers[] = { "Ctrl", "Alt", "Shift", "Ctrl+Shift", "Ctrl+Alt", "Alt+Shift", "Ctrl+Alt+Shift" };
+        constexpr size_t generatedModifierCount = sizeof(generatedModifiers) / sizeof(generatedModifiers[0]);
+        constexpr char generatedActionKeys[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+        constexpr size_t generatedActionKeyCount = sizeof(generatedActionKeys) - 1;
+
+        Chord GenerateChord(size_t modifierIndex, size_t actionKeyIndex)
+        {
+            std::string text = generatedModifiers[modifierIndex % generatedModifierCount];
+            text += '+';
+            text += generatedActionKeys[actionKeyIndex % generatedActionKeyCount];
+            return *Chord::Parse(text);
+        }
+    }
+
+    std::optional<Trace> ParseTrace(std::istream& input, std::string& error)
+    {
+        Trace trace;
+        std::string line;
+        for (size_t lineNumber = 1; std::getline(input, line); lineNumber++)
+        {
+            // Files written on Windows have CRLF line endings
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+
+            if (line.empty() || line[0] == '#')
+            {
+                continue;
+            }
+
+            std::istringstream fields(line);
+            TraceEntry entry;
+            std::string type;
+            std::string value;
+            if (!(fields >> entry.timestampUs >> type) || !std::getline(fields >> std::ws, value) || value.empty())
+            {
+                error = "Invalid trace entry at line " + std::to_string(lineNumber);
+                return std::nullopt;
+            }
+
+            if (type == "app")
+            {
+                entry.type = TraceEntry::Type::ForegroundApp;
+                entry.appName = FromUtf8(value);
+            }
+            else if (type == "down" || type == "up")
+            {
+                const auto key = ParseKeyName(value);
+                if (!key || *key >= KeyCodes::Count)
+                {
+                    error = "Invalid key at line " + std::to_string(lineNumber);
+                    return std::nullopt;
+                }
+
+                entry.event = KeyEvent{ *key, type == "up" };
+            }
+            else
+            {
+                error = "Invalid trace entry type at line " + std::to_string(lineNumber);
+                return std::nullopt;
+            }
+
+            trace.push_back(entry);
+        }
+
+        return trace;
+    }
+
+    void WriteTrace(std::ostream& output, const Trace& trace)
+    {
+        for (const auto& entry : trace)
+        {
+            output << entry.timestampUs;
+            if (entry.type == TraceEntry::Type::ForegroundApp)
+            {
+                output << " app " << ToUtf8(entry.appName) << '\n';
+            }
+            else
+            {
+                output << (entry.event.keyUp ? " up " : " down ") << KeyNameToString(entry.event.key) << '\n';
+            }
+        }
+    }
+
+    std::optional<RemapConfig> ParseRemapConfig(std::istream& input, std::string& error)
+    {
+        RemapConfig config;
+        std::string line;
+        for (size_t lineNumber = 1; std::getline(input, line); lineNumber++)
+        {
+            // Files written on Windows have CRLF line endings
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+
+            if (line.empty() || line[0] == '#')
+            {
+                continue;
+            }
+
+            std::istringstream fields(line);
+            std::string type;
+            std::string source;
+            std::string targetText;
+            std::string appName;
+            if (!(fields >> type >> source >> targetText))
+            {
+                error = "Invalid remap at line " + std::to_string(lineNumber);
+                return std::nullopt;
+            }
+
+            // The process name is the rest of the line since it can contain spaces
+            std::getline(fields >> std::ws, appName);
+
+            const auto target = ParseTarget(targetText);
+            if (type == "key" && appName.empty())
+            {
+                const auto sourceKey = ParseKeyName(source);
+                if (!sourceKey || *sourceKey >= KeyCodes::Count || !target)
+                {
+                    error = "Invalid key at line " + std::to_string(lineNumber);
+                    return std::nullopt;
+                }
+
+                config.singleKeyRemaps[*sourceKey] = *target;
+            }
+            else if (type == "shortcut")
+            {
+                const auto sourceChord = Chord::Parse(source);
+                if (!sourceChord || sourceChord->Size() < 2 || !target)
+                {
+                    error = "Invalid shortcut at line " + std::to_string(lineNumber);
+                    return std::nullopt;
+                }
+
+                auto& remaps = appName.empty() ? config.osLevelShortcutRemaps : config.appSpecificShortcutRemaps[FromUtf8(appName)];
+                remaps.emplace_back(*sourceChord, *target);
+            }
+            else
+            {
+                error = "Invalid remap at line " + std::to_string(lineNumber);
+                return std::nullopt;
+            }
+        }
+
+        return config;
+    }
+
+    void WriteRemapConfig(std::ostream& output, const RemapConfig& config)
+    {
+        for (const auto& [key, target] : config.singleKeyRemaps)
+        {
+            output << "key " << KeyNameToString(key) << ' ' << TargetToString(target) << '\n';
+        }
+
+        for (const auto& [source, target] : config.osLevelShortcutRemaps)
+        {
+            output << "shortcut " << source.ToString() << ' ' << TargetToString(target) << '\n';
+        }
+
+        for (const auto& [appName, remaps] : config.appSpecificShortcutRemaps)
+        {
+            for (const auto& [source, target] : remaps)
+            {
+                output << "shortcut " << source.ToString() << ' ' << TargetToString(target) << ' ' << ToUtf8(appName) << '\n';
+            }
+        }
+    }
+
+    RemapConfig GenerateRemapConfig(const SyntheticWorkloadOptions& options)
+    {
+        RemapConfig config;
+
+        // Single key remaps use keys which aren't part of the generated shortcuts (F13-F24 and the numpad keys), and are remapped to letters or Ctrl+letter
+        std::vector<KeyCode> singleKeySources;
+        for (KeyCode key = 0x7C; key <= 0x87; key++)
+        {
+            singleKeySources.push_back(key);
+        }
+        for (KeyCode key = 0x60; key <= 0x69; key++)
+        {
+            singleKeySources.push_back(key);
+        }
+
+        for (size_t i = 0; i < options.singleKeyRemapCount && i < singleKeySources.size(); i++)
+        {
+            const KeyCode letter = static_cast<KeyCode>('A' + i % 26);
+            if (i % 3 == 0)
+            {
+                Chord target;
+                target.ctrl = ModifierSide::Both;
+                target.actionKey = letter;
+                config.singleKeyRemaps[singleKeySources[i]] = target;
+            }
+            else
+            {
+                config.singleKeyRemaps[singleKeySources[i]] = letter;
+            }
+        }
+
+        // Shortcut remaps are unique for the first 252 remaps, after which they repeat and only the first remap of each shortcut is used
+        for (size_t i = 0; i < options.osLevelShortcutRemapCount; i++)
+        {
+            const Chord source = GenerateChord(i, i / generatedModifierCount);
+            if (i % 4 == 0)
+            {
+                config.osLevelShortcutRemaps.emplace_back(source, static_cast<KeyCode>('A' + i % 26));
+            }
+            else
+            {
+                config.osLevelShortcutRemaps.emplace_back(source, GenerateChord(i + 1, i + 7));
+            }
+        }
+
+        for (size_t app = 0; app < options.appCount; app++)
+        {
+            auto& remaps = config.appSpecificShortcutRemaps[L"app" + std::to_wstring(app) + L".exe"];
+            for (size_t i = 0; i < options.appSpecificShortcutRemapCount; i++)
+            {
+                remaps.emplace_back(GenerateChord(i * 3 + app, i + app * 5), GenerateChord(i + app, i * 2 + 1));
+            }
+        }
+
+        return config;
+    }
+
+    Trace GenerateTrace(const RemapConfig& config, const SyntheticWorkloadOptions& options)
+    {
+        Random random(options.seed);
+        Trace trace;
+        trace.reserve(options.eventCount + options.eventCount / 4);
+
+        const uint64_t intervalUs = std::max<uint64_t>(1, 1000000 / std::max<uint32_t>(1, options.eventsPerSecond));
+        uint64_t timestampUs = 0;
+
+        std::vector<std::wstring> apps;
+        for (const auto& [appName, remaps] : config.appSpecificShortcutRemaps)
+        {
+            apps.push_back(appName);
+        }
+        apps.push_back(L"explorer.exe");
+
+        std::vector<KeyCode> singleKeySources;
+        for (const auto& [key, target] : config.singleKeyRemaps)
+        {
+            singleKeySources.push_back(key);
+        }
+
+        const ChordRemapList* appRemaps = nullptr;
+        size_t keyEventCount = 0;
+        size_t nextAppSwitch = 0;
+        while (keyEventCount < options.eventCount)
+        {
+            if (keyEventCount >= nextAppSwitch)
+            {
+                const std::wstring& app = apps[random.Next(apps.size())];
+                const auto it = config.appSpecificShortcutRemaps.find(app);
+                appRemaps = it != config.appSpecificShortcutRemaps.end() ? &it->second : nullptr;
+
+                TraceEntry entry;
+                entry.timestampUs = timestampUs;
+                entry.type = TraceEntry::Type::ForegroundApp;
+                entry.appName = app;
+                trace.push_back(entry);
+                nextAppSwitch = keyEventCount + std::max<size_t>(1, options.appSwitchInterval);
+            }
+
+            const size_t previousSize = trace.size();
+            const size_t action = random.Next(10);
+            if (action < 5 || (action < 7 && singleKeySources.empty()))
+            {
+                // Type a letter which isn't remapped
+                Chord chord;
+                chord.actionKey = static_cast<KeyCode>('A' + random.Next(26));
+                AddChordPress(trace, timestampUs, intervalUs, chord);
+            }
+            else if (action < 7)
+            {
+                Chord chord;
+                chord.actionKey = singleKeySources[random.Next(singleKeySources.size())];
+                AddChordPress(trace, timestampUs, intervalUs, chord);
+            }
+            else
+            {
+                // Press a remapped shortcut of the foreground app or an os level one
+                const ChordRemapList* remaps = (appRemaps && !appRemaps->empty() && random.Next(2) == 0) ? appRemaps : &config.osLevelShortcutRemaps;
+                if (remaps->empty())
+                {
+                    continue;
+                }
+
+                AddChordPress(trace, timestampUs, intervalUs, (*remaps)[random.Next(remaps->size())].first);
+            }
+
+            keyEventCount += trace.size() - previousSize;
+        }
+
+        return trace;
+    }
+
+    void LatencyHistogram::Add(uint64_t latencyNs)
+    {
+        size_t bucket = 0;
+        while (bucket + 1 < BucketCount && (latencyNs >> bucket) != 0)
+        {
+            bucket++;
+        }
+
+        buckets[bucket]++;
+        samples.push_back(latencyNs);
+        sorted = false;
+    }
+
+    size_t LatencyHistogram::Count() const
+    {
+        return samples.size();
+    }
+
+    uint64_t LatencyHistogram::Percentile(double percentile) const
+    {
+        if (samples.empty())
+        {
+            return 0;
+        }
+
+        if (!sorted)
+        {
+            std::sort(samples.begin(), samples.end());
+            sorted = true;
+        }
+
+        const size_t index = static_cast<size_t>(samples.size() * percentile / 100);
+        return samples[std::min(index, samples.size() - 1)];
+    }
+
+    uint64_t LatencyHistogram::Max() const
+    {
+        return Percentile(100);
+    }
+
+    const std::array<uint64_t, LatencyHistogram::BucketCount>& LatencyHistogram::Buckets() const
+    {
+        return buckets;
+    }
+
+    ReplayPlatform::ReplayPlatform(RemapEngine& engine) :
+        engine(engine)
+    {
+    }
+
+    void ReplayPlatform::InjectEvents(const KeyEvent* events, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            injectedEventCount++;
+            SendKeyEvent(events[i]);
+        }
+    }
+
+    bool ReplayPlatform::IsKeyPressed(KeyCode key)
+    {
+        return key < keyState.size() && keyState[key];
+    }
+
+    const KeyStateBitset* ReplayPlatform::GetTrackedKeyState()
+    {
+        return &trackedKeyState;
+    }
+
+    void ReplayPlatform::SetForegroundApp(const std::wstring& appName)
+    {
+        engine.SetForegroundApp(appName);
+    }
+
+    // Function to send a key event through the engine. Returns true if it was suppressed
+    bool ReplayPlatform::SendKeyEvent(const KeyEvent& event)
+    {
+        const bool suppressed = engine.HandleKeyEvent(*this, event);
+        if (!suppressed)
+        {
+            SetKeyState(event);
+        }
+
+        return suppressed;
+    }
+
+    uint64_t ReplayPlatform::InjectedEventCount() const
+    {
+        return injectedEventCount;
+    }
+
+    // Function to update the key state in the same way as MockedInput, where the common modifier key codes follow the left and right keys
+    void ReplayPlatform::SetKeyState(const KeyEvent& event)
+    {
+        if (event.key >= keyState.size())
+        {
+            return;
+        }
+
+        const bool pressed = !event.keyUp;
+        keyState[event.key] = pressed;
+        trackedKeyState.Update(event.key, event.keyUp);
+
+        switch (event.key)
+        {
+        case KeyCodes::Control:
+            if (!pressed)
+            {
+                keyState[KeyCodes::LeftControl] = false;
+                keyState[KeyCodes::RightControl] = false;
+            }
+            break;
+        case KeyCodes::LeftControl:
+        case KeyCodes::RightControl:
+            keyState[KeyCodes::Control] = pressed;
+            break;
+        case KeyCodes::Menu:
+            if (!pressed)
+            {
+                keyState[KeyCodes::LeftMenu] = false;
+                keyState[KeyCodes::RightMenu] = false;
+            }
+            break;
+        case KeyCodes::LeftMenu:
+        case KeyCodes::RightMenu:
+            keyState[KeyCodes::Menu] = pressed;
+            break;
+        case KeyCodes::Shift:
+            if (!pressed)
+            {
+                keyState[KeyCodes::LeftShift] = false;
+                keyState[KeyCodes::RightShift] = false;
+            }
+            break;
+        case KeyCodes::LeftShift:
+        case KeyCodes::RightShift:
+            keyState[KeyCodes::Shift] = pressed;
+            break;
+        }
+    }
+
+    ReplayResult ReplayTrace(RemapEngine& engine, const Trace& trace)
+    {
+        ReplayResult result;
+        ReplayPlatform platform(engine);
+
+        const auto replayStart = std::chrono::steady_clock::now();
+        for (const auto& entry : trace)
+        {
+            if (entry.type == TraceEntry::Type::ForegroundApp)
+            {
+                platform.SetForegroundApp(entry.appName);
+                result.appSwitchCount++;
+                continue;
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            const bool suppressed = platform.SendKeyEvent(entry.event);
+            const auto end = std::chrono::steady_clock::now();
+
+            result.latency.Add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+            result.keyEventCount++;
+            if (suppressed)
+            {
+                result.suppressedEventCount++;
+            }
+        }
+        const auto replayEnd = std::chrono::steady_clock::now();
+
+        result.injectedEventCount = platform.InjectedEventCount();
+        result.replayDurationSeconds = std::chrono::duration<double>(replayEnd - replayStart).count();
+        if (!trace.empty())
+        {
+            result.traceDurationSeconds = (trace.back().timestampUs - trace.front().timestampUs) / 1000000.0;
+        }
+
+        // The dummy key is ignored since it is always released right after it is pressed
+        for (KeyCode key = 1; key < KeyCodes::DummyKey; key++)
+        {
+            if (platform.IsKeyPressed(key))
+            {
+                result.pressedKeys.push_back(key);
+            }
+        }
+
+        return result;
+    }
+
+    void WriteReplayReport(std::ostream& output, const ReplayResult& result)
+    {
+        char line[160];
+        const double injectedPerEvent = result.keyEventCount ? static_cast<double>(result.injectedEventCount) / result.keyEventCount : 0;
+        std::snprintf(line, sizeof(line), "Key events: %llu (%llu suppressed), injected events: %llu (%.2f per key event), app switches: %llu\n", static_cast<unsigned long long>(result.keyEventCount), static_cast<unsigned long long>(result.suppressedEventCount), static_cast<unsigned long long>(result.injectedEventCount), injectedPerEvent, static_cast<unsigned long long>(result.appSwitchCount));
+        output << line;
+
+        const double traceRate = result.traceDurationSeconds > 0 ? result.keyEventCount / result.traceDurationSeconds : 0;
+        const double replayRate = result.replayDurationSeconds > 0 ? result.keyEventCount / result.replayDurationSeconds : 0;
+        std::snprintf(line, sizeof(line), "Trace duration: %.2f s (%.0f events/s), replay duration: %.3f s (%.0f events/s)\n", result.traceDurationSeconds, traceRate, result.replayDurationSeconds, replayRate);
+        output << line;
+
+        const auto& latency = result.latency;
+        std::snprintf(line, sizeof(line), "Latency: p50 %llu ns, p90 %llu ns, p99 %llu ns, p99.9 %llu ns, max %llu ns\n", static_cast<unsigned long long>(latency.Percentile(50)), static_cast<unsigned long long>(latency.Percentile(90)), static_cast<unsigned long long>(latency.Percentile(99)), static_cast<unsigned long long>(latency.Percentile(99.9)), static_cast<unsigned long long>(latency.Max()));
+        output << line;
+
+        uint64_t largestBucket = 0;
+        for (uint64_t count : latency.Buckets())
+        {
+            largestBucket = std::max(largestBucket, count);
+        }
+
+        for (size_t bucket = 0; bucket < LatencyHistogram::BucketCount; bucket++)
+        {
+            const uint64_t count = latency.Buckets()[bucket];
+            if (count == 0)
+            {
+                continue;
+            }
+
+            const unsigned long long lower = bucket == 0 ? 0 : 1ull << (bucket - 1);
+            const unsigned long long upper = 1ull << bucket;
+            const size_t barLength = static_cast<size_t>(count * 50 / largestBucket);
+            std::snprintf(line, sizeof(line), "  [%10llu, %10llu) ns %10llu %s\n", lower, upper, static_cast<unsigned long long>(count), std::string(std::max<size_t>(barLength, 1), '#').c_str());
+            output << line;
+        }
+
+        if (!result.pressedKeys.empty())
+        {
+            output << "Keys still pressed at the end of the replay:";
+            for (KeyCode key : result.pressedKeys)
+            {
+                std::snprintf(line, sizeof(line), " 0x%02X", key);
+                output << line;
+            }
+            output << '\n';
+        }
+    }
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include "RemapEngine.h"
+
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Replay of recorded key streams through the remap engine, used to benchmark the engine outside of the keyboard hook
+namespace KeyboardManagerCore
+{
+    // Entry of a recorded key stream - a key event, or a switch of the foreground app
+    struct TraceEntry
+    {
+        enum class Type : uint8_t
+        {
+            Key,
+            ForegroundApp
+        };
+
+        // Time of the entry relative to the start of the recording
+        uint64_t timestampUs = 0;
+        Type type = Type::Key;
+        KeyEvent event;
+        std::wstring appName;
+    };
+
+    using Trace = std::vector<TraceEntry>;
+
+    // Functions to read and write a trace. Each line has a timestamp in microseconds followed by "down <key>", "up <key>" or "app <process name>". Empty lines and lines starting with '#' are ignored
+    std::optional<Trace> ParseTrace(std::istream& input, std::string& error);
+    void WriteTrace(std::ostream& output, const Trace& trace);
+
+    // Functions to read and write a remap configuration. Each line is "key <key> <target>" or "shortcut <chord> <target> [process name]", where the target is a key, a chord or Disable
+    std::optional<RemapConfig> ParseRemapConfig(std::istream& input, std::string& error);
+    void WriteRemapConfig(std::ostream& output, const RemapConfig& config);
+
+    // Parameters of a generated workload
+    struct SyntheticWorkloadOptions
+    {
+        size_t singleKeyRemapCount = 20;
+        size_t osLevelShortcutRemapCount = 200;
+        size_t appCount = 10;
+        size_t appSpecificShortcutRemapCount = 20;
+        size_t eventCount = 100000;
+        uint32_t eventsPerSecond = 5000;
+
+        // Number of key events between foreground app switches
+        size_t appSwitchInterval = 500;
+        uint32_t seed = 1;
+    };
+
+    // Functions to generate remaps and a key stream which uses them. The output only depends on the options, so the same workload can be generated on every platform
+    RemapConfig GenerateRemapConfig(const SyntheticWorkloadOptions& options);
+    Trace GenerateTrace(const RemapConfig& config, const SyntheticWorkloadOptions& options);
+
+    // Histogram of latencies in power of two nanosecond buckets, along with the exact percentiles
+    class LatencyHistogram
+    {
+    public:
+        static constexpr size_t BucketCount = 40;
+
+        void Add(uint64_t latencyNs);
+
+        size_t Count() const;
+        uint64_t Percentile(double percentile) const;
+        uint64_t Max() const;
+
+        // Number of latencies in [2^(bucket - 1), 2^bucket) ns. The first bucket counts latencies below 1 ns
+        const std::array<uint64_t, BucketCount>& Buckets() const;
+
+    private:
+        std::array<uint64_t, BucketCount> buckets = {};
+        mutable std::vector<uint64_t> samples;
+        mutable bool sorted = true;
+    };
+
+    struct ReplayResult
+    {
+        // Time spent in the engine for each key event of the trace, including the handling of the events it injects
+        LatencyHistogram latency;
+
+        uint64_t keyEventCount = 0;
+        uint64_t suppressedEventCount = 0;
+        uint64_t injectedEventCount = 0;
+        uint64_t appSwitchCount = 0;
+
+        // Keys which are still pressed at the end of the replay, which indicates that a remap got stuck
+        std::vector<KeyCode> pressedKeys;
+
+        double traceDurationSeconds = 0;
+        double replayDurationSeconds = 0;
+    };
+
+    // Platform used for the replay. Injected events are sent back to the engine synchronously, in the same way as MockedInput, and the key state is tracked from the events which aren't suppressed.
+    // The tracked key state is also provided to the engine, so that the replay covers the compiled chord masks
+    class ReplayPlatform : public Platform
+    {
+    public:
+        explicit ReplayPlatform(RemapEngine& engine);
+
+        void InjectEvents(const KeyEvent* events, size_t count) override;
+        bool IsKeyPressed(KeyCode key) override;
+        const KeyStateBitset* GetTrackedKeyState() override;
+
+        void SetForegroundApp(const std::wstring& appName);
+
+        // Function to send a key event through the engine. Returns true if it was suppressed
+        bool SendKeyEvent(const KeyEvent& event);
+
+        uint64_t InjectedEventCount() const;
+
+    private:
+        RemapEngine& engine;
+        std::array<bool, KeyCodes::Count> keyState = {};
+        KeyStateBitset trackedKeyState;
+        uint64_t injectedEventCount = 0;
+
+        void SetKeyState(const KeyEvent& event);
+    };
+
+    // Function to replay the key events of the trace through the engine as fast as possible
+    ReplayResult ReplayTrace(RemapEngine& engine, const Trace& trace);
+
+    // Function to write the latency histogram and the event counts of a replay
+    void WriteReplayReport(std::ostream& output, const ReplayResult& result);
+}
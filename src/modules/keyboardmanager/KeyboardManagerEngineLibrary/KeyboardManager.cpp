@@ -4,6 +4,7 @@
 #include <common/SettingsAPI/settings_objects.h>
 #include <common/interop/shared_constants.h>
 #include <common/debug_control.h>
+#include <common/utils/profiler.h>
 #include <common/utils/winapi_error.h>
 #include <common/logger/logger_settings.h>
 
@@ -19,13 +20,15 @@
 
 HHOOK KeyboardManager::hookHandleCopy;
 HHOOK KeyboardManager::hookHandle;
+HWINEVENTHOOK KeyboardManager::foregroundEventHookHandle;
+HWINEVENTHOOK KeyboardManager::desktopSwitchEventHookHandle;
+HWND KeyboardManager::hookThreadWindow;
 KeyboardManager* KeyboardManager::keyboardManagerObjectPtr;
 
-KeyboardManager::KeyboardManager()
-{
+KeyboardManager::KeyboardManager() :
     // Load the initial settings.
-    LoadSettings();
-
+    stateSnapshot(LoadSettings())
+{
     // Set the static pointer to the newest object of the class
     keyboardManagerObjectPtr = this;
 
@@ -37,33 +40,47 @@ KeyboardManager::KeyboardManager()
             Logger::error(L"Failed to watch settings changes. {}", get_last_error_or_default(err));
         }
 
-        loadingSettings = true;
+        // The hook keeps using the current state until the new one is loaded and published
         try
         {
-            LoadSettings();
+            stateSnapshot.ReclaimRetiredState();
+            stateSnapshot.Publish(LoadSettings());
         }
         catch (...)
         {
             Logger::error("Failed to load settings");
         }
-
-        loadingSettings = false;
     };
 
+    hookTelemetry = std::make_unique<HookTelemetry::Recorder>(CommonSharedConstants::KEYBOARD_MANAGER_HOOK_STATS_SHARED_MEMORY, [](const HookTelemetry::IntervalStats& stats) {
+        if (stats.timeoutRiskEventCount > 0)
+        {
+            Logger::warn(L"{} hook events took more than half of the {} ms hook timeout", stats.timeoutRiskEventCount, stats.hookTimeoutMs);
+        }
+
+        Logger::trace(L"Hook time over the last {} events ({} suppressed): p50 {:.1f} us, p99 {:.1f} us, max {:.1f} us, {} slow events, {} dropped records", stats.eventCount, stats.suppressedEventCount, stats.p50Us, stats.p99Us, stats.maxUs, stats.slowEventCount, stats.droppedRecordCount);
+    });
+
     editorIsRunningEvent = CreateEvent(nullptr, true, false, KeyboardManagerConstants::EditorWindowEventName.c_str());
     settingsEventWaiter = EventWaiter(KeyboardManagerConstants::SettingsEventName, changeSettingsCallback);
 }
 
-void KeyboardManager::LoadSettings()
+std::unique_ptr<State> KeyboardManager::LoadSettings()
 {
-    bool loadedSuccessful = state.LoadSettings();
+    auto state = std::make_unique<State>();
+    bool loadedSuccessful = state->LoadSettings();
     if (!loadedSuccessful)
     {
         std::this_thread::sleep_for(std::chrono::milliseconds(500));
 
         // retry once
-        state.LoadSettings();
+        state = std::make_unique<State>();
+        state->LoadSettings();
     }
+
+    // Compile the remaps here so that it doesn't happen on the first key event
+    state->UpdateDispatchTables();
+    return state;
 }
 
 LRESULT CALLBACK KeyboardManager::HookProc(int nCode, WPARAM wParam, LPARAM lParam)
@@ -71,9 +88,23 @@ LRESULT CALLBACK KeyboardManager::HookProc(int nCode, WPARAM wParam, LPARAM lPar
     LowlevelKeyboardEvent event;
     if (nCode == HC_ACTION)
     {
+        POWERTOYS_PROFILE_SCOPE("KeyboardManager.HookProc");
         event.lParam = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
         event.wParam = wParam;
-        if (keyboardManagerObjectPtr->HandleKeyboardHookEvent(&event) == 1)
+
+        LARGE_INTEGER start, end;
+        QueryPerformanceCounter(&start);
+        intptr_t result = keyboardManagerObjectPtr->HandleKeyboardHookEvent(&event);
+        QueryPerformanceCounter(&end);
+        keyboardManagerObjectPtr->hookTelemetry->Record(end.QuadPart - start.QuadPart, wParam, event.lParam->vkCode, result == 1 ? HookTelemetry::Decision::Suppressed : HookTelemetry::Decision::PassThrough);
+
+        // The tracked key state is updated after the event is handled, so that the handlers see the state from before the event, same as GetAsyncKeyState in the hook
+        if (result != 1)
+        {
+            keyboardManagerObjectPtr->inputHandler.TrackKeyEvent(event.lParam->vkCode, wParam == WM_KEYUP || wParam == WM_SYSKEYUP);
+        }
+
+        if (result == 1)
         {
             // Reset Num Lock whenever a NumLock key down event is suppressed since Num Lock key state change occurs before it is intercepted by low level hooks
             if (event.lParam->vkCode == VK_NUMLOCK && (event.wParam == WM_KEYDOWN || event.wParam == WM_SYSKEYDOWN) && event.lParam->dwExtraInfo != KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG)
@@ -87,6 +118,60 @@ LRESULT CALLBACK KeyboardManager::HookProc(int nCode, WPARAM wParam, LPARAM lPar
     return CallNextHookEx(hookHandleCopy, nCode, wParam, lParam);
 }
 
+void CALLBACK KeyboardManager::ForegroundEventProc(HWINEVENTHOOK hWinEventHook, DWORD event, HWND hwnd, LONG idObject, LONG idChild, DWORD idEventThread, DWORD dwmsEventTime)
+{
+    // The event is delivered through the message loop of the hook thread, so it can't race with the keyboard hook
+
+    // Key events can be missed while another desktop or an elevated window has the input, so the tracked key state is resynced
+    keyboardManagerObjectPtr->inputHandler.ResyncKeyState();
+    if (event == EVENT_SYSTEM_DESKTOPSWITCH)
+    {
+        return;
+    }
+
+    keyboardManagerObjectPtr->RefreshForegroundState();
+}
+
+LRESULT CALLBACK KeyboardManager::HookThreadWindowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
+{
+    // Handled by the message loop of the hook thread, so the state isn't modified while the hook uses it
+    if (keyboardManagerObjectPtr)
+    {
+        switch (msg)
+        {
+        case WM_INPUTLANGCHANGE:
+            keyboardManagerObjectPtr->stateSnapshot.GetCurrentState().UpdateKeyboardLayout(State::GetForegroundKeyboardLayout());
+            break;
+        case RefreshForegroundStateMessage:
+            keyboardManagerObjectPtr->RefreshForegroundState();
+            return 0;
+        case WM_TIMER:
+            if (wParam == ForegroundRetryTimerId)
+            {
+                KillTimer(hwnd, ForegroundRetryTimerId);
+                keyboardManagerObjectPtr->stateSnapshot.GetCurrentState().UpdateForegroundApp(keyboardManagerObjectPtr->inputHandler);
+                return 0;
+            }
+            break;
+        }
+    }
+
+    return DefWindowProc(hwnd, msg, wParam, lParam);
+}
+
+// Function to resolve the foreground app and keyboard layout of the state used by the hook. Runs on the hook thread, outside of the hook procedure
+void KeyboardManager::RefreshForegroundState()
+{
+    State& state = stateSnapshot.GetCurrentState();
+    if (!state.UpdateForegroundApp(inputHandler) && hookThreadWindow)
+    {
+        SetTimer(hookThreadWindow, ForegroundRetryTimerId, ForegroundRetryDelayMs, nullptr);
+    }
+
+    // With per-app input methods the new foreground window can use another layout
+    state.UpdateKeyboardLayout(State::GetForegroundKeyboardLayout());
+}
+
 void KeyboardManager::StartLowlevelKeyboardHook()
 {
 #if defined(DISABLE_LOWLEVEL_HOOKS_WHEN_DEBUGGED)
@@ -98,6 +183,9 @@ void KeyboardManager::StartLowlevelKeyboardHook()
 
     if (!hookHandle)
     {
+        inputHandler.StartKeyStateTracking();
+        // HookProc runs on this thread, and must not allocate the span buffer itself
+        Profiler::RegisterCurrentThread();
         hookHandle = SetWindowsHookEx(WH_KEYBOARD_LL, HookProc, GetModuleHandle(NULL), NULL);
         hookHandleCopy = hookHandle;
         if (!hookHandle)
@@ -108,6 +196,42 @@ void KeyboardManager::StartLowlevelKeyboardHook()
             Trace::Error(errorCode, errorMessage.has_value() ? errorMessage.value() : L"", L"StartLowlevelKeyboardHook::SetWindowsHookEx");
         }
     }
+
+    if (!foregroundEventHookHandle)
+    {
+        foregroundEventHookHandle = SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND, nullptr, ForegroundEventProc, 0, 0, WINEVENT_OUTOFCONTEXT);
+        if (!foregroundEventHookHandle)
+        {
+            Logger::error(L"Failed to set foreground event hook. {}", get_last_error_or_default(GetLastError()));
+        }
+    }
+
+    if (!desktopSwitchEventHookHandle)
+    {
+        desktopSwitchEventHookHandle = SetWinEventHook(EVENT_SYSTEM_DESKTOPSWITCH, EVENT_SYSTEM_DESKTOPSWITCH, nullptr, ForegroundEventProc, 0, 0, WINEVENT_OUTOFCONTEXT);
+        if (!desktopSwitchEventHookHandle)
+        {
+            Logger::error(L"Failed to set desktop switch event hook. {}", get_last_error_or_default(GetLastError()));
+        }
+    }
+
+    if (!hookThreadWindow)
+    {
+        // A hidden top-level window, since message-only windows don't receive WM_INPUTLANGCHANGE
+        WNDCLASSW wc{};
+        wc.lpfnWndProc = HookThreadWindowProc;
+        wc.hInstance = GetModuleHandle(nullptr);
+        wc.lpszClassName = L"PowerToys_KBM_HookThreadWindow";
+        RegisterClassW(&wc);
+        hookThreadWindow = CreateWindowExW(WS_EX_TOOLWINDOW, wc.lpszClassName, L"", WS_POPUP, 0, 0, 0, 0, nullptr, nullptr, wc.hInstance, nullptr);
+        if (!hookThreadWindow)
+        {
+            Logger::error(L"Failed to create the hook thread window. {}", get_last_error_or_default(GetLastError()));
+        }
+    }
+
+    hookState = &stateSnapshot.GetCurrentState();
+    RefreshForegroundState();
 }
 
 void KeyboardManager::StopLowlevelKeyboardHook()
@@ -116,16 +240,30 @@ void KeyboardManager::StopLowlevelKeyboardHook()
     {
         UnhookWindowsHookEx(hookHandle);
         hookHandle = nullptr;
+        inputHandler.StopKeyStateTracking();
     }
-}
 
-intptr_t KeyboardManager::HandleKeyboardHookEvent(LowlevelKeyboardEvent* data) noexcept
-{
-    if (loadingSettings)
+    if (foregroundEventHookHandle)
     {
-        return 0;
+        UnhookWinEvent(foregroundEventHookHandle);
+        foregroundEventHookHandle = nullptr;
+    }
+
+    if (desktopSwitchEventHookHandle)
+    {
+        UnhookWinEvent(desktopSwitchEventHookHandle);
+        desktopSwitchEventHookHandle = nullptr;
+    }
+
+    if (hookThreadWindow)
+    {
+        DestroyWindow(hookThreadWindow);
+        hookThreadWindow = nullptr;
     }
+}
 
+intptr_t KeyboardManager::HandleKeyboardHookEvent(LowlevelKeyboardEvent* data) noexcept
+{
     // Suspend remapping if remap key/shortcut window is opened
     if (editorIsRunningEvent != nullptr && WaitForSingleObject(editorIsRunningEvent, 0) == WAIT_OBJECT_0)
     {
@@ -138,12 +276,27 @@ intptr_t KeyboardManager::HandleKeyboardHookEvent(LowlevelKeyboardEvent* data) n
         return 1;
     }
 
+    // A reloaded state is adopted here, between key events. Its foreground app is resolved by the message loop, since the hook procedure only reads it
+    StateSnapshot::EventScope eventScope(stateSnapshot);
+    State& state = eventScope.GetState();
+    if (&state != hookState)
+    {
+        hookState = &state;
+        PostMessage(hookThreadWindow, RefreshForegroundStateMessage, 0, 0);
+    }
+
     // Remap a key
     intptr_t SingleKeyRemapResult = KeyboardEventHandlers::HandleSingleKeyRemapEvent(inputHandler, data, state);
 
     // Single key remaps have priority. If a key is remapped, only the remapped version should be visible to the shortcuts and hence the event should be suppressed here.
     if (SingleKeyRemapResult == 1)
     {
+        // The keyboard layout can be switched inside the foreground app without a foreground event, so the hook asks the message loop to recompile the scan codes for it
+        if (state.TakeKeyboardLayoutUpdateRequest())
+        {
+            PostMessage(hookThreadWindow, RefreshForegroundStateMessage, 0, 0);
+        }
+
         return 1;
     }
 
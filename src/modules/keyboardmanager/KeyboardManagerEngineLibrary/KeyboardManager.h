@@ -1,8 +1,9 @@
 #pragma once
+#include <common/hooks/HookTelemetry.h>
 #include <common/hooks/LowlevelKeyboardEvent.h>
 #include <common/utils/EventWaiter.h>
 #include <keyboardmanager/common/Input.h>
-#include "State.h"
+#include "StateSnapshot.h"
 
 class KeyboardManager
 {
@@ -31,12 +32,32 @@ private:
     // Required for Unhook in old versions of Windows
     static HHOOK hookHandleCopy;
 
+    // Event hook handle for foreground window changes
+    static HWINEVENTHOOK foregroundEventHookHandle;
+
+    // Event hook handle for desktop switches, e.g. to and from the secure desktop
+    static HWINEVENTHOOK desktopSwitchEventHookHandle;
+
+    // Hidden window of the hook thread which receives WM_INPUTLANGCHANGE and the messages to refresh the foreground app
+    static HWND hookThreadWindow;
+
+    // Posted to the hook thread window when the hook adopts a reloaded state or finds the single key remaps compiled for another keyboard layout than the foreground window's,
+    // so that the foreground app and keyboard layout are resolved outside of the hook procedure
+    static constexpr UINT RefreshForegroundStateMessage = WM_APP + 1;
+
+    // Timer to resolve the foreground app again when the foreground window is the frame of a UWP app which isn't hosted yet
+    static constexpr UINT_PTR ForegroundRetryTimerId = 1;
+    static constexpr UINT ForegroundRetryDelayMs = 250;
+
     // Static pointer to the current KeyboardManager object required for accessing the HandleKeyboardHookEvent function in the hook procedure
     // Only global or static variables can be accessed in a hook procedure CALLBACK
     static KeyboardManager* keyboardManagerObjectPtr;
 
-    // Variable which stores all the state information to be shared between the UI and back-end
-    State state;
+    // Stores the state used by the hook. Reloaded states are built on the settings thread and swapped in by the hook
+    StateSnapshot stateSnapshot;
+
+    // State used by the last hook event, to detect when the hook adopted a reloaded state. Only accessed from the hook thread
+    State* hookState = nullptr;
 
     // Object of class which implements InputInterface. Required for calling library functions while enabling testing
     KeyboardManagerInput::Input inputHandler;
@@ -44,15 +65,25 @@ private:
     // Auto reset event for waiting for settings changes. The event is signaled when settings are changed
     EventWaiter settingsEventWaiter;
 
-    std::atomic_bool loadingSettings = false;
-
     HANDLE editorIsRunningEvent = nullptr;
 
+    // Records the processing time of the hook events, which is logged and published to shared memory periodically
+    std::unique_ptr<HookTelemetry::Recorder> hookTelemetry;
+
     // Hook procedure definition
     static LRESULT CALLBACK HookProc(int nCode, WPARAM wParam, LPARAM lParam);
 
-    // Load settings from the file.
-    void LoadSettings();
+    // Event hook procedure for foreground window changes and desktop switches, which resyncs the tracked key state and resolves the foreground app
+    static void CALLBACK ForegroundEventProc(HWINEVENTHOOK hWinEventHook, DWORD event, HWND hwnd, LONG idObject, LONG idChild, DWORD idEventThread, DWORD dwmsEventTime);
+
+    // Window procedure of the hook thread window, which recompiles the single key remaps for a new keyboard layout and refreshes the foreground app
+    static LRESULT CALLBACK HookThreadWindowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
+
+    // Function to resolve the foreground app and keyboard layout of the state used by the hook. Runs on the hook thread, outside of the hook procedure
+    void RefreshForegroundState();
+
+    // Load settings from the file into a new state.
+    static std::unique_ptr<State> LoadSettings();
 
     // Function called by the hook procedure to handle the events. This is the starting point function for remapping
     intptr_t HandleKeyboardHookEvent(LowlevelKeyboardEvent* data) noexcept;
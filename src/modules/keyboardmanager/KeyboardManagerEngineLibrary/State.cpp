@@ -2,31 +2,100 @@
 #include "State.h"
 #include <optional>
 
-// Function to get the iterator of a single key remap given the source key. Returns nullopt if it isn't remapped
-std::optional<SingleKeyRemapTable::iterator> State::GetSingleKeyRemap(const DWORD& originalKey)
+#include <keyboardmanager/common/InputInterface.h>
+#include <keyboardmanager/KeyboardManagerEngineLibrary/Win32EngineAdapter.h>
+
+State::State() :
+    remapEngine(std::make_unique<KeyboardManagerCore::RemapEngine>(KeyboardManagerCore::RemapConfig()))
+{
+}
+
+// Function to get the remap engine used by the hook
+KeyboardManagerCore::RemapEngine& State::GetRemapEngine()
+{
+    return *remapEngine;
+}
+
+// Function to get the scan codes for the layout of the foreground window, as compiled by the last layout update
+const ScanCodeTable* State::GetScanCodeTable() const
+{
+    // Only the published table is read here, the layout is tracked outside of the hook
+    return scanCodeTable.load(std::memory_order_acquire);
+}
+
+// Function to recompile the scan codes if they were computed for another keyboard layout. Must not be called from the hook procedure
+void State::UpdateKeyboardLayout(HKL layout)
 {
-    auto it = singleKeyReMap.find(originalKey);
-    if (it != singleKeyReMap.end())
+    const ScanCodeTable* table = scanCodeTable.load(std::memory_order_acquire);
+    if (table && table->layout != layout)
     {
-        return it;
+        CompileScanCodes(layout);
     }
+}
 
-    return std::nullopt;
+// Function to get the keyboard layout of the foreground window, which receives the remapped keys
+HKL State::GetForegroundKeyboardLayout()
+{
+    // Thread id 0 is the calling thread, if there is no foreground window
+    return GetKeyboardLayout(GetWindowThreadProcessId(GetForegroundWindow(), nullptr));
 }
 
-bool State::CheckShortcutRemapInvoked(const std::optional<std::wstring>& appName)
+// Function called by the hook with the layout of the foreground window. Returns true if the scan codes were compiled for another layout, in which case a recompile is requested once for the layout
+bool State::CheckKeyboardLayout(HKL layout)
 {
-    // Assumes appName exists in the app-specific remap table
-    ShortcutRemapTable& currentRemapTable = appName ? appSpecificShortcutReMap[*appName] : osLevelShortcutReMap;
-    for (auto& it : currentRemapTable)
+    const ScanCodeTable* table = scanCodeTable.load(std::memory_order_acquire);
+    if (!table || table->layout == layout)
     {
-        if (it.second.isShortcutInvoked)
-        {
-            return true;
-        }
+        return false;
+    }
+
+    if (layout != mismatchedLayout)
+    {
+        mismatchedLayout = layout;
+        isLayoutUpdateRequested = true;
+    }
+
+    return true;
+}
+
+// Function to check and clear if the hook found the scan codes to be compiled for another layout than the foreground window's since the last call
+bool State::TakeKeyboardLayoutUpdateRequest()
+{
+    return std::exchange(isLayoutUpdateRequested, false);
+}
+
+void State::CompileScanCodes(HKL layout)
+{
+    auto table = std::make_unique<ScanCodeTable>();
+    table->layout = layout;
+    mismatchedLayout = nullptr;
+    isLayoutUpdateRequested = false;
+
+    for (UINT key = 0; key < table->scanCodes.size(); key++)
+    {
+        table->scanCodes[key] = static_cast<WORD>(MapVirtualKeyEx(key, MAPVK_VK_TO_VSC, layout));
     }
 
-    return false;
+    // The previous table can be freed right away, since it isn't compiled from within the hook procedure
+    scanCodeTable.store(table.get(), std::memory_order_release);
+    scanCodeTableOwner = std::move(table);
+}
+
+// Function to check if any os level or app-specific shortcut remap is currently invoked
+bool State::CheckShortcutRemapInvoked() const
+{
+    return remapEngine->IsShortcutRemapInvoked();
+}
+
+// Functions to get the state of the os level shortcut remap with the given original shortcut
+bool State::IsShortcutRemapInvoked(const Shortcut& originalShortcut) const
+{
+    return remapEngine->IsShortcutRemapInvoked(originalShortcut.ToChord());
+}
+
+bool State::IsOriginalActionKeyPressed(const Shortcut& originalShortcut) const
+{
+    return remapEngine->IsOriginalActionKeyPressed(originalShortcut.ToChord());
 }
 
 // Function to get the source and target of a shortcut remap given the source shortcut. Returns nullopt if it isn't remapped
@@ -50,14 +119,44 @@ std::vector<Shortcut>& State::GetSortedShortcutRemapVector(const std::optional<s
     return appName ? appSpecificShortcutReMapSortedKeys[*appName] : osLevelShortcutReMapSortedKeys;
 }
 
-// Sets the activated target application in app-specific shortcut
-void State::SetActivatedApp(const std::wstring& appName)
+// Function to rebuild the remap engine and the scan codes from the remap tables. Should be called after the remaps are loaded so that it doesn't run on the hook path
+void State::UpdateDispatchTables()
+{
+    CompileScanCodes(GetForegroundKeyboardLayout());
+    remapEngine = std::make_unique<KeyboardManagerCore::RemapEngine>(Win32EngineAdapter::CreateRemapConfig(*this));
+
+    // The app-specific remaps of the foreground app are looked up again in the new engine
+    remapEngine->SetForegroundApp(foregroundProcess);
+    dispatchTablesVersion = remapTablesVersion;
+}
+
+// Function to check if the compiled engine matches the current remap tables
+bool State::AreDispatchTablesUpToDate() const
+{
+    return dispatchTablesVersion == remapTablesVersion;
+}
+
+// Function to resolve the app in the foreground. Should be called whenever the foreground window changes, and not from the hook procedure
+bool State::UpdateForegroundApp(KeyboardManagerInput::InputInterface& ii)
 {
-    activatedAppSpecificShortcutTarget = appName;
+    // Allocate MAX_PATH amount of memory
+    foregroundProcess.resize(MAX_PATH);
+    ii.GetForegroundProcess(foregroundProcess);
+
+    // Remove elements after null character
+    foregroundProcess.erase(std::find(foregroundProcess.begin(), foregroundProcess.end(), L'\0'), foregroundProcess.end());
+
+    // Convert process name to lower case
+    std::transform(foregroundProcess.begin(), foregroundProcess.end(), foregroundProcess.begin(), towlower);
+
+    remapEngine->SetForegroundApp(foregroundProcess);
+
+    // The foreground event for a UWP app can arrive before the app's window is hosted in the frame
+    return foregroundProcess != L"applicationframehost.exe";
 }
 
 // Gets the activated target application in app-specific shortcut
-std::wstring State::GetActivatedApp()
+std::wstring State::GetActivatedApp() const
 {
-    return activatedAppSpecificShortcutTarget;
+    return std::wstring(remapEngine->GetActivatedApp());
 }
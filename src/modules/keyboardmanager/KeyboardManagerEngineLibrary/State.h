@@ -1,26 +1,89 @@
 #pragma once
 #include <keyboardmanager/common/MappingConfiguration.h>
+#include <keyboardmanager/KeyboardManagerEngineCore/RemapEngine.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+
+namespace KeyboardManagerInput
+{
+    class InputInterface;
+}
+
+// Scan codes of the virtual key codes for one keyboard layout. A published table is never modified, a layout change or reload publishes a new one
+struct ScanCodeTable
+{
+    HKL layout = nullptr;
+    std::array<WORD, 256> scanCodes = {};
+};
 
 class State : public MappingConfiguration
 {
 private:
-    // Stores the activated target application in app-specific shortcut
-    std::wstring activatedAppSpecificShortcutTarget;
+    // Remap engine compiled from the remap tables, which handles the key events of the hook
+    std::unique_ptr<KeyboardManagerCore::RemapEngine> remapEngine;
+    std::optional<uint64_t> dispatchTablesVersion;
+
+    // Scan code table read by the hook, and the table which owns it. Tables are only compiled outside of the hook procedure: by UpdateDispatchTables when the remaps are loaded,
+    // and when the keyboard layout changes, which is handled by the message loop of the hook thread, so a table is never replaced while a hook event uses it
+    std::atomic<ScanCodeTable*> scanCodeTable = nullptr;
+    std::unique_ptr<ScanCodeTable> scanCodeTableOwner;
+
+    void CompileScanCodes(HKL layout);
+
+    // Layout of the foreground window which the hook found to differ from the scan code table, and whether the message loop still has to be asked to recompile for it.
+    // Only accessed from the hook thread, and reset when the table is compiled
+    HKL mismatchedLayout = nullptr;
+    bool isLayoutUpdateRequested = false;
+
+    // Lowercase process name of the foreground app. Updated from the foreground event hook, so the hook procedure never queries it
+    std::wstring foregroundProcess;
 
 public:
-    // Function to get the iterator of a single key remap given the source key. Returns nullopt if it isn't remapped
-    std::optional<SingleKeyRemapTable::iterator> GetSingleKeyRemap(const DWORD& originalKey);
+    State();
 
-    bool CheckShortcutRemapInvoked(const std::optional<std::wstring>& appName);
+    // Function to get the remap engine used by the hook
+    KeyboardManagerCore::RemapEngine& GetRemapEngine();
+
+    // Function to get the scan codes for the layout of the foreground window, as compiled by the last layout update
+    const ScanCodeTable* GetScanCodeTable() const;
+
+    // Function to check if any os level or app-specific shortcut remap is currently invoked
+    bool CheckShortcutRemapInvoked() const;
+
+    // Functions to get the state of the os level shortcut remap with the given original shortcut
+    bool IsShortcutRemapInvoked(const Shortcut& originalShortcut) const;
+    bool IsOriginalActionKeyPressed(const Shortcut& originalShortcut) const;
 
     // Function to get the source and target of a shortcut remap given the source shortcut. Returns nullopt if it isn't remapped
     ShortcutRemapTable& GetShortcutRemapTable(const std::optional<std::wstring>& appName);
 
     std::vector<Shortcut>& GetSortedShortcutRemapVector(const std::optional<std::wstring>& appName);
 
-    // Sets the activated target application in app-specific shortcut
-    void SetActivatedApp(const std::wstring& appName);
+    // Function to rebuild the remap engine and the scan codes from the remap tables. Must be called after the remaps are loaded, since the hook only uses the compiled engine
+    void UpdateDispatchTables();
+
+    // Function to check if the compiled engine matches the current remap tables
+    bool AreDispatchTablesUpToDate() const;
+
+    // Function to recompile the scan codes if they were computed for another keyboard layout. Must not be called from the hook procedure
+    void UpdateKeyboardLayout(HKL layout);
+
+    // Function to get the keyboard layout of the foreground window, which receives the remapped keys
+    static HKL GetForegroundKeyboardLayout();
+
+    // Function called by the hook with the layout of the foreground window, which can be switched inside an app without a foreground change.
+    // Returns true if the scan codes were compiled for another layout, in which case a recompile is requested once for the layout
+    bool CheckKeyboardLayout(HKL layout);
+
+    // Function to check and clear if the hook found the scan codes to be compiled for another layout than the foreground window's since the last call
+    bool TakeKeyboardLayoutUpdateRequest();
+
+    // Function to resolve the app in the foreground. Should be called whenever the foreground window changes, and not from the hook procedure.
+    // Returns false if the foreground window is the frame of a UWP app which isn't hosted yet, in which case it should be resolved again later
+    bool UpdateForegroundApp(KeyboardManagerInput::InputInterface& ii);
 
     // Gets the activated target application in app-specific shortcut
-    std::wstring GetActivatedApp();
-};
\ No newline at end of file
+    std::wstring GetActivatedApp() const;
+};
@@ -0,0 +1,79 @@
+#include "pch.h"
+#include "StateSnapshot.h"
+
+StateSnapshot::EventScope::EventScope(StateSnapshot& snapshot) :
+    snapshot(snapshot)
+{
+    // The state can only be swapped before the outermost event, since the handlers of an event keep references into the state
+    if (snapshot.eventDepth == 0)
+    {
+        snapshot.AdoptPublishedState();
+    }
+
+    snapshot.eventDepth++;
+}
+
+StateSnapshot::EventScope::~EventScope()
+{
+    snapshot.eventDepth--;
+}
+
+State& StateSnapshot::EventScope::GetState() const
+{
+    return *snapshot.current;
+}
+
+StateSnapshot::StateSnapshot(std::unique_ptr<State> initialState) :
+    current(std::move(initialState))
+{
+}
+
+StateSnapshot::~StateSnapshot()
+{
+    delete published.exchange(nullptr);
+    delete retired.exchange(nullptr);
+}
+
+// Function to publish a new state to be adopted by the hook. Can be called from any thread. The state must not be modified by the caller afterwards
+void StateSnapshot::Publish(std::unique_ptr<State> newState)
+{
+    // If the previously published state wasn't adopted yet, the hook never accessed it and it can be freed here
+    delete published.exchange(newState.release(), std::memory_order_acq_rel);
+}
+
+// Function to free the state replaced by the last adoption. Called from the loading thread so that freeing the remap tables doesn't happen in the hook
+void StateSnapshot::ReclaimRetiredState()
+{
+    delete retired.exchange(nullptr, std::memory_order_acq_rel);
+}
+
+// Function to get the state currently used by the hook. Must only be called from the hook thread
+State& StateSnapshot::GetCurrentState()
+{
+    return *current;
+}
+
+// Function to adopt the published state if there is one and no shortcut remap is invoked in the current state
+void StateSnapshot::AdoptPublishedState()
+{
+    if (published.load(std::memory_order_relaxed) == nullptr)
+    {
+        return;
+    }
+
+    // Swapping the state while a shortcut is held down would lose track of the keys injected for it
+    if (current->CheckShortcutRemapInvoked())
+    {
+        return;
+    }
+
+    std::unique_ptr<State> newState(published.exchange(nullptr, std::memory_order_acq_rel));
+    if (!newState)
+    {
+        return;
+    }
+
+    // No event references the replaced state anymore. It is normally freed by the loading thread on the next reload, unless the previously retired state wasn't reclaimed yet
+    delete retired.exchange(current.release(), std::memory_order_acq_rel);
+    current = std::move(newState);
+}
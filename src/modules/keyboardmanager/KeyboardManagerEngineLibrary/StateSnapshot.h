@@ -0,0 +1,53 @@
+#pragma once
+#include "State.h"
+
+#include <atomic>
+#include <memory>
+
+// Hands over states which are loaded on another thread to the keyboard hook. A published state is immutable for the loading thread, and the hook adopts it with a single atomic pointer swap
+// between key events once no shortcut remap is invoked, so that remaps keep working while the settings are reloaded and no shortcut is left half pressed by the swap
+class StateSnapshot
+{
+public:
+    // Keeps the state used by a hook event alive while the event is handled. Nested events for the input injected by the handlers use the same state
+    class EventScope
+    {
+    public:
+        EventScope(StateSnapshot& snapshot);
+        ~EventScope();
+
+        EventScope(const EventScope&) = delete;
+        EventScope& operator=(const EventScope&) = delete;
+
+        State& GetState() const;
+
+    private:
+        StateSnapshot& snapshot;
+    };
+
+    StateSnapshot(std::unique_ptr<State> initialState);
+    ~StateSnapshot();
+
+    StateSnapshot(const StateSnapshot&) = delete;
+    StateSnapshot& operator=(const StateSnapshot&) = delete;
+
+    // Function to publish a new state to be adopted by the hook. Can be called from any thread. The state must not be modified by the caller afterwards
+    void Publish(std::unique_ptr<State> newState);
+
+    // Function to free the state replaced by the last adoption. Called from the loading thread so that freeing the remap tables doesn't happen in the hook
+    void ReclaimRetiredState();
+
+    // Function to get the state currently used by the hook. Must only be called from the hook thread
+    State& GetCurrentState();
+
+private:
+    // Function to adopt the published state if there is one and no shortcut remap is invoked in the current state
+    void AdoptPublishedState();
+
+    // Only accessed from the hook thread
+    std::unique_ptr<State> current;
+    int eventDepth = 0;
+
+    std::atomic<State*> published = nullptr;
+    std::atomic<State*> retired = nullptr;
+};
@@ -0,0 +1,185 @@
+#include "pch.h"
+#include "Win32EngineAdapter.h"
+
+#include <common/interop/shared_constants.h>
+
+#include <keyboardmanager/common/Helpers.h>
+#include <keyboardmanager/common/InputBatch.h>
+#include <keyboardmanager/common/InputInterface.h>
+#include <keyboardmanager/common/MappingConfiguration.h>
+#include <keyboardmanager/KeyboardManagerEngineLibrary/State.h>
+#include <keyboardmanager/KeyboardManagerEngineLibrary/trace.h>
+
+using namespace KeyboardManagerCore;
+
+namespace
+{
+    RemapTarget ToRemapTarget(const KeyShortcutUnion& target)
+    {
+        if (target.index() == 0)
+        {
+            return RemapTarget(std::get<DWORD>(target));
+        }
+
+        return RemapTarget(std::get<Shortcut>(target).ToChord());
+    }
+
+    // The remaps are added in the sorted order so that remaps with the same number of keys keep the same priority as in the hook
+    ChordRemapList ToChordRemapList(const ShortcutRemapTable& remapTable, const std::vector<Shortcut>& sortedKeys)
+    {
+        ChordRemapList remaps;
+        remaps.reserve(sortedKeys.size());
+        for (const auto& shortcut : sortedKeys)
+        {
+            const auto it = remapTable.find(shortcut);
+            if (it != remapTable.end())
+            {
+                remaps.emplace_back(it->first.ToChord(), ToRemapTarget(it->second.targetShortcut));
+            }
+        }
+
+        return remaps;
+    }
+
+    ULONG_PTR ToExtraInfo(EventSource source)
+    {
+        switch (source)
+        {
+        case EventSource::SingleKeyRemap:
+            return KeyboardManagerConstants::KEYBOARDMANAGER_SINGLEKEY_FLAG;
+        case EventSource::ShortcutRemap:
+            return KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG;
+        case EventSource::Suppressed:
+            return KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG;
+        default:
+            return 0;
+        }
+    }
+}
+
+namespace Win32EngineAdapter
+{
+    // Function to convert the remaps loaded from the settings to the engine core configuration
+    RemapConfig CreateRemapConfig(const MappingConfiguration& mappingConfiguration)
+    {
+        RemapConfig config;
+        for (const auto& [originalKey, target] : mappingConfiguration.singleKeyReMap)
+        {
+            config.singleKeyRemaps[originalKey] = ToRemapTarget(target);
+        }
+
+        config.osLevelShortcutRemaps = ToChordRemapList(mappingConfiguration.osLevelShortcutReMap, mappingConfiguration.osLevelShortcutReMapSortedKeys);
+        for (const auto& [appName, remapTable] : mappingConfiguration.appSpecificShortcutReMap)
+        {
+            const auto sortedKeys = mappingConfiguration.appSpecificShortcutReMapSortedKeys.find(appName);
+            if (sortedKeys != mappingConfiguration.appSpecificShortcutReMapSortedKeys.end())
+            {
+                config.appSpecificShortcutRemaps[appName] = ToChordRemapList(remapTable, sortedKeys->second);
+            }
+        }
+
+        return config;
+    }
+
+    // Function to convert a low level keyboard hook event to an engine core event. The source is decided from the Keyboard Manager flags in dwExtraInfo
+    KeyEvent ToKeyEvent(const LowlevelKeyboardEvent& data)
+    {
+        KeyEvent event;
+        event.key = data.lParam->vkCode;
+        event.keyUp = (data.wParam == WM_KEYUP || data.wParam == WM_SYSKEYUP);
+
+        const ULONG_PTR extraInfo = data.lParam->dwExtraInfo;
+        if (extraInfo == KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG)
+        {
+            event.source = EventSource::Suppressed;
+        }
+        else if (extraInfo == KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG)
+        {
+            event.source = EventSource::ShortcutRemap;
+        }
+        else if (extraInfo & CommonSharedConstants::KEYBOARDMANAGER_INJECTED_FLAG)
+        {
+            // Events injected by single key remaps, or by other modules with the injected flag, are only remapped by the shortcut remaps
+            event.source = EventSource::SingleKeyRemap;
+        }
+        else
+        {
+            event.source = EventSource::Physical;
+        }
+
+        return event;
+    }
+
+    Win32Platform::Win32Platform(KeyboardManagerInput::InputInterface& ii, State& state) :
+        ii(ii), state(state)
+    {
+    }
+
+    void Win32Platform::InjectEvents(const KeyEvent* events, size_t count)
+    {
+        // Helpers::SetKeyEvent maps the scan codes with the layout of the hook thread, so the single key remaps use the scan codes compiled for the foreground layout instead.
+        // If the layout was switched inside the foreground app, the events are mapped for the current layout until the message loop recompiles the scan codes
+        const ScanCodeTable* scanCodes = nullptr;
+        HKL layout = nullptr;
+        if (count > 0 && events[0].source == EventSource::SingleKeyRemap)
+        {
+            layout = State::GetForegroundKeyboardLayout();
+            if (!state.CheckKeyboardLayout(layout))
+            {
+                scanCodes = state.GetScanCodeTable();
+            }
+        }
+
+        // The engine sends at most one batch worth of events at a time, larger lists are split to be safe
+        while (count > 0)
+        {
+            const size_t batchSize = count < InputBatch::Capacity ? count : InputBatch::Capacity;
+            InputBatch keyEventList;
+            for (size_t i = 0; i < batchSize; i++)
+            {
+                Helpers::SetKeyEvent(keyEventList, (int)i, INPUT_KEYBOARD, (WORD)events[i].key, events[i].keyUp ? KEYEVENTF_KEYUP : 0, ToExtraInfo(events[i].source));
+                if (layout && events[i].source == EventSource::SingleKeyRemap)
+                {
+                    keyEventList[i].ki.wScan = scanCodes ? scanCodes->scanCodes[events[i].key & 0xFF] : static_cast<WORD>(MapVirtualKeyEx(events[i].key, MAPVK_VK_TO_VSC, layout));
+                }
+            }
+
+            UINT res = ii.SendVirtualInput((UINT)batchSize, keyEventList, sizeof(INPUT));
+            events += batchSize;
+            count -= batchSize;
+        }
+    }
+
+    bool Win32Platform::IsKeyPressed(KeyCode key)
+    {
+        return ii.GetVirtualKeyState((int)key);
+    }
+
+    const KeyStateBitset* Win32Platform::GetTrackedKeyState()
+    {
+        return ii.GetTrackedKeyState();
+    }
+
+    bool Win32Platform::ResyncTrackedModifiers()
+    {
+        return ii.ResyncModifierKeyState();
+    }
+
+    void Win32Platform::OnSingleKeyRemapInvoked(bool remapToKey)
+    {
+        // Log telemetry event when the key remap is invoked
+        Trace::KeyRemapInvoked(remapToKey);
+    }
+
+    void Win32Platform::OnShortcutRemapInvoked(bool remapToChord, bool isAppSpecific)
+    {
+        // Log telemetry event when shortcut remap is invoked
+        Trace::ShortcutRemapInvoked(remapToChord, isAppSpecific);
+    }
+
+    // Function to handle a keyboard hook event with the engine core. Returns 1 if the event should be suppressed, same as the KeyboardEventHandlers functions
+    intptr_t HandleKeyboardHookEvent(RemapEngine& engine, Win32Platform& platform, LowlevelKeyboardEvent* data) noexcept
+    {
+        return engine.HandleKeyEvent(platform, ToKeyEvent(*data)) ? 1 : 0;
+    }
+}
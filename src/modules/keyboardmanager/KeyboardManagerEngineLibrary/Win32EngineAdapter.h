@@ -0,0 +1,45 @@
+#pragma once
+#include <keyboardmanager/KeyboardManagerEngineCore/RemapEngine.h>
+
+#include <common/hooks/LowlevelKeyboardEvent.h>
+
+namespace KeyboardManagerInput
+{
+    class InputInterface;
+}
+
+class MappingConfiguration;
+class State;
+
+// Adapter between the Win32 keyboard hook types and the platform independent remap engine core
+namespace Win32EngineAdapter
+{
+    // Function to convert the remaps loaded from the settings to the engine core configuration
+    KeyboardManagerCore::RemapConfig CreateRemapConfig(const MappingConfiguration& mappingConfiguration);
+
+    // Function to convert a low level keyboard hook event to an engine core event. The source is decided from the Keyboard Manager flags in dwExtraInfo
+    KeyboardManagerCore::KeyEvent ToKeyEvent(const LowlevelKeyboardEvent& data);
+
+    // Platform implementation which injects the key events with the Keyboard Manager flags through the InputInterface. It is created on the stack for each hook event
+    class Win32Platform : public KeyboardManagerCore::Platform
+    {
+    public:
+        Win32Platform(KeyboardManagerInput::InputInterface& ii, State& state);
+
+        void InjectEvents(const KeyboardManagerCore::KeyEvent* events, size_t count) override;
+        bool IsKeyPressed(KeyboardManagerCore::KeyCode key) override;
+        const KeyboardManagerCore::KeyStateBitset* GetTrackedKeyState() override;
+        bool ResyncTrackedModifiers() override;
+        void OnSingleKeyRemapInvoked(bool remapToKey) override;
+        void OnShortcutRemapInvoked(bool remapToChord, bool isAppSpecific) override;
+
+    private:
+        KeyboardManagerInput::InputInterface& ii;
+
+        // Provides the scan codes of the foreground keyboard layout for the single key remaps
+        State& state;
+    };
+
+    // Function to handle a keyboard hook event with the engine core. Returns 1 if the event should be suppressed, same as the KeyboardEventHandlers functions
+    intptr_t HandleKeyboardHookEvent(KeyboardManagerCore::RemapEngine& engine, Win32Platform& platform, LowlevelKeyboardEvent* data) noexcept;
+}
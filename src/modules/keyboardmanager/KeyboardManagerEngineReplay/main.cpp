@@ -0,0 +1,189 @@
+// Replays recorded or generated key streams through the Keyboard Manager remap engine core and reports the per event latency and the injected event counts.
+// Only depends on the engine core, so it can be built on any platform - see README.md
+#include <keyboardmanager/KeyboardManagerEngineCore/Replay.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace KeyboardManagerCore;
+
+namespace
+{
+    void PrintUsage()
+    {
+        std::cout << "Usage: KeyboardManagerEngineReplay [options]\n"
+                     "  --config <file>        Remaps to load. Generated if not set\n"
+                     "  --trace <file>         Key stream to replay. Generated if not set\n"
+                     "  --events <count>       Number of key events to generate (default 100000)\n"
+                     "  --rate <events/s>      Rate of the generated key events (default 5000)\n"
+                     "  --remaps <count>       Number of os level shortcut remaps to generate (default 200)\n"
+                     "  --apps <count>         Number of apps with app-specific remaps to generate (default 10)\n"
+                     "  --seed <value>         Seed of the generated workload (default 1)\n"
+                     "  --iterations <count>   Number of times the trace is replayed (default 1)\n"
+                     "  --write-config <file>  Write the remaps which are used\n"
+                     "  --write-trace <file>   Write the key stream which is used\n";
+    }
+
+    bool ParseCount(const char* text, size_t& value)
+    {
+        char* end = nullptr;
+        const unsigned long long parsed = std::strtoull(text, &end, 10);
+        if (end == text || *end != '\0')
+        {
+            return false;
+        }
+
+        value = static_cast<size_t>(parsed);
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    SyntheticWorkloadOptions options;
+    std::string configPath;
+    std::string tracePath;
+    std::string writeConfigPath;
+    std::string writeTracePath;
+    size_t iterations = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* option = argv[i];
+        if (std::strcmp(option, "--help") == 0)
+        {
+            PrintUsage();
+            return 0;
+        }
+
+        if (i + 1 >= argc)
+        {
+            PrintUsage();
+            return 1;
+        }
+
+        const char* value = argv[++i];
+        size_t count = 0;
+        bool valid = true;
+        if (std::strcmp(option, "--config") == 0)
+        {
+            configPath = value;
+        }
+        else if (std::strcmp(option, "--trace") == 0)
+        {
+            tracePath = value;
+        }
+        else if (std::strcmp(option, "--write-config") == 0)
+        {
+            writeConfigPath = value;
+        }
+        else if (std::strcmp(option, "--write-trace") == 0)
+        {
+            writeTracePath = value;
+        }
+        else if ((valid = ParseCount(value, count)))
+        {
+            if (std::strcmp(option, "--events") == 0)
+            {
+                options.eventCount = count;
+            }
+            else if (std::strcmp(option, "--rate") == 0)
+            {
+                options.eventsPerSecond = static_cast<uint32_t>(count);
+            }
+            else if (std::strcmp(option, "--remaps") == 0)
+            {
+                options.osLevelShortcutRemapCount = count;
+            }
+            else if (std::strcmp(option, "--apps") == 0)
+            {
+                options.appCount = count;
+            }
+            else if (std::strcmp(option, "--seed") == 0)
+            {
+                options.seed = static_cast<uint32_t>(count);
+            }
+            else if (std::strcmp(option, "--iterations") == 0)
+            {
+                iterations = count;
+            }
+            else
+            {
+                valid = false;
+            }
+        }
+
+        if (!valid)
+        {
+            std::cerr << "Invalid option " << option << " " << value << "\n";
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    std::string error;
+    RemapConfig config;
+    if (configPath.empty())
+    {
+        config = GenerateRemapConfig(options);
+    }
+    else
+    {
+        std::ifstream configFile(configPath);
+        auto parsedConfig = ParseRemapConfig(configFile, error);
+        if (!configFile.is_open() || !parsedConfig)
+        {
+            std::cerr << "Failed to load " << configPath << ": " << (configFile.is_open() ? error : "file not found") << "\n";
+            return 1;
+        }
+        config = std::move(*parsedConfig);
+    }
+
+    Trace trace;
+    if (tracePath.empty())
+    {
+        trace = GenerateTrace(config, options);
+    }
+    else
+    {
+        std::ifstream traceFile(tracePath);
+        auto parsedTrace = ParseTrace(traceFile, error);
+        if (!traceFile.is_open() || !parsedTrace)
+        {
+            std::cerr << "Failed to load " << tracePath << ": " << (traceFile.is_open() ? error : "file not found") << "\n";
+            return 1;
+        }
+        trace = std::move(*parsedTrace);
+    }
+
+    if (!writeConfigPath.empty())
+    {
+        std::ofstream configFile(writeConfigPath);
+        WriteRemapConfig(configFile, config);
+    }
+
+    if (!writeTracePath.empty())
+    {
+        std::ofstream traceFile(writeTracePath);
+        WriteTrace(traceFile, trace);
+    }
+
+    std::cout << "Remaps: " << config.singleKeyRemaps.size() << " single key, " << config.osLevelShortcutRemaps.size() << " os level shortcut, " << config.appSpecificShortcutRemaps.size() << " apps with app-specific shortcuts\n";
+
+    // Each iteration uses a new engine so that the remap state doesn't carry over between the replays
+    bool keysStuck = false;
+    for (size_t iteration = 0; iteration < iterations; iteration++)
+    {
+        RemapEngine engine(config);
+        const ReplayResult result = ReplayTrace(engine, trace);
+
+        std::cout << "\nIteration " << iteration + 1 << "\n";
+        WriteReplayReport(std::cout, result);
+        keysStuck = keysStuck || !result.pressedKeys.empty();
+    }
+
+    return keysStuck ? 2 : 0;
+}
@@ -0,0 +1,48 @@
+#include "pch.h"
+#include "AllocationCounter.h"
+
+#include <new>
+
+namespace
+{
+    // Number of allocations made on each thread. The counter is per thread so that the test framework's threads don't affect the results
+    thread_local size_t allocationCount = 0;
+}
+
+// The global allocation functions are replaced in the test binary to count the allocations made by the code under test
+void* operator new(size_t size)
+{
+    allocationCount++;
+
+    void* ptr = malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+namespace TestHelpers
+{
+    AllocationCounter::AllocationCounter() :
+        initialCount(allocationCount)
+    {
+    }
+
+    // Function to get the number of allocations made since the counter was created
+    size_t AllocationCounter::Count() const
+    {
+        return allocationCount - initialCount;
+    }
+}
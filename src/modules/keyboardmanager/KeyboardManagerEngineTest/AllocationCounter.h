@@ -0,0 +1,17 @@
+#pragma once
+
+namespace TestHelpers
+{
+    // Counts the heap allocations made through operator new on the current thread while the object is alive
+    class AllocationCounter
+    {
+    public:
+        AllocationCounter();
+
+        // Function to get the number of allocations made since the counter was created
+        size_t Count() const;
+
+    private:
+        size_t initialCount;
+    };
+}
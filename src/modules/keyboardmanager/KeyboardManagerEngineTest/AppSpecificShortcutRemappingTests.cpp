@@ -342,5 +342,97 @@ namespace RemappingLogicTests
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_CONTROL), false);
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(actionKey), false);
         }
+
+        // Test if the foreground process is only queried again after the foreground app changes
+        TEST_METHOD (ForegroundProcess_ShouldBeQueriedOnce_WhenForegroundAppDoesNotChange)
+        {
+            // Remap Ctrl+A to Alt+V
+            Shortcut src;
+            src.SetKey(VK_CONTROL);
+            src.SetKey(0x41);
+            Shortcut dest;
+            dest.SetKey(VK_MENU);
+            dest.SetKey(0x56);
+            testState.AddAppSpecificShortcut(testApp1, src, dest);
+
+            // Set the testApp as the foreground process
+            mockedInputHandler.SetForegroundProcess(testApp1);
+
+            const int nInputs = 1;
+            INPUT input[nInputs] = {};
+            input[0].type = INPUT_KEYBOARD;
+            input[0].ki.wVk = 0x42;
+
+            // Send B keydown and keyup multiple times
+            for (int i = 0; i < 10; i++)
+            {
+                input[0].ki.dwFlags = 0;
+                mockedInputHandler.SendVirtualInput(nInputs, input, sizeof(INPUT));
+                input[0].ki.dwFlags = KEYEVENTF_KEYUP;
+                mockedInputHandler.SendVirtualInput(nInputs, input, sizeof(INPUT));
+            }
+
+            Assert::AreEqual(1, mockedInputHandler.GetForegroundProcessCallCount());
+
+            // Switch to another app and back
+            mockedInputHandler.SetForegroundProcess(testApp2);
+            input[0].ki.dwFlags = 0;
+            mockedInputHandler.SendVirtualInput(nInputs, input, sizeof(INPUT));
+            mockedInputHandler.SetForegroundProcess(testApp1);
+            input[0].ki.dwFlags = KEYEVENTF_KEYUP;
+            mockedInputHandler.SendVirtualInput(nInputs, input, sizeof(INPUT));
+
+            Assert::AreEqual(3, mockedInputHandler.GetForegroundProcessCallCount());
+        }
+
+        // Test if the app specific remap follows the foreground app when it is switched between key presses
+        TEST_METHOD (AppSpecificShortcut_ShouldOnlyGetRemapped_WhileAppIsInForeground_WhenForegroundAppIsSwitched)
+        {
+            // Remap Ctrl+A to Alt+V for testApp1
+            Shortcut src;
+            src.SetKey(VK_CONTROL);
+            src.SetKey(0x41);
+            Shortcut dest;
+            dest.SetKey(VK_MENU);
+            dest.SetKey(0x56);
+            testState.AddAppSpecificShortcut(testApp1, src, dest);
+
+            const int nInputs = 2;
+            INPUT input[nInputs] = {};
+            input[0].type = INPUT_KEYBOARD;
+            input[0].ki.wVk = VK_CONTROL;
+            input[1].type = INPUT_KEYBOARD;
+            input[1].ki.wVk = 0x41;
+
+            INPUT releaseInput[nInputs] = {};
+            releaseInput[0].type = INPUT_KEYBOARD;
+            releaseInput[0].ki.wVk = 0x41;
+            releaseInput[0].ki.dwFlags = KEYEVENTF_KEYUP;
+            releaseInput[1].type = INPUT_KEYBOARD;
+            releaseInput[1].ki.wVk = VK_CONTROL;
+            releaseInput[1].ki.dwFlags = KEYEVENTF_KEYUP;
+
+            const std::vector<std::wstring> foregroundApps = { testApp1, testApp2, testApp1, L"", testApp1 };
+            for (const auto& app : foregroundApps)
+            {
+                mockedInputHandler.SetForegroundProcess(app);
+
+                // Send Ctrl+A keydown
+                mockedInputHandler.SendVirtualInput(nInputs, input, sizeof(INPUT));
+
+                // The shortcut should only be remapped if testApp1 is in the foreground
+                const bool remapped = app == testApp1;
+                Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_CONTROL), !remapped);
+                Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x41), !remapped);
+                Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_MENU), remapped);
+                Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x56), remapped);
+
+                // Release A then Ctrl
+                mockedInputHandler.SendVirtualInput(nInputs, releaseInput, sizeof(INPUT));
+                Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_CONTROL), false);
+                Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_MENU), false);
+                Assert::AreEqual(testState.GetActivatedApp(), KeyboardManagerConstants::NoActivatedApp);
+            }
+        }
     };
 }
@@ -0,0 +1,265 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "MockedInput.h"
+#include <keyboardmanager/common/Shortcut.h>
+#include <keyboardmanager/common/Helpers.h>
+#include <keyboardmanager/KeyboardManagerEngineLibrary/State.h>
+#include <keyboardmanager/KeyboardManagerEngineLibrary/KeyboardEventHandlers.h>
+#include <keyboardmanager/KeyboardManagerEngineLibrary/Win32EngineAdapter.h>
+#include "TestHelpers.h"
+
+#include <random>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using KeyboardManagerCore::CompiledChord;
+using KeyboardManagerCore::KeyStateBitset;
+
+namespace RemappingLogicTests
+{
+    // Tests for matching chords compiled into key masks against the tracked key state
+    TEST_CLASS (CompiledChordTests)
+    {
+    private:
+        KeyboardManagerInput::MockedInput mockedInputHandler;
+        State testState;
+
+        static Shortcut CreateShortcut(ModifierKey win, ModifierKey ctrl, ModifierKey alt, ModifierKey shift, DWORD actionKey)
+        {
+            Shortcut shortcut;
+            shortcut.winKey = win;
+            shortcut.ctrlKey = ctrl;
+            shortcut.altKey = alt;
+            shortcut.shiftKey = shift;
+            shortcut.actionKey = actionKey;
+            return shortcut;
+        }
+
+        // Function to press the given keys on the mocked input
+        void PressKeys(const std::vector<WORD>& keys)
+        {
+            std::vector<INPUT> inputs(keys.size());
+            for (size_t i = 0; i < keys.size(); i++)
+            {
+                Helpers::SetKeyEvent(inputs.data(), static_cast<int>(i), INPUT_KEYBOARD, keys[i], 0, 0);
+            }
+
+            mockedInputHandler.SendVirtualInput(static_cast<UINT>(inputs.size()), inputs.data(), sizeof(INPUT));
+        }
+
+        // Function to remap the shortcut with the os level shortcut remap handler as the hook
+        void AddOSLevelShortcutRemap(const Shortcut& src, const Shortcut& dest)
+        {
+            TestHelpers::ResetTestEnv(mockedInputHandler, testState);
+            std::function<intptr_t(LowlevelKeyboardEvent*)> currentHookProc = std::bind(&KeyboardEventHandlers::HandleOSLevelShortcutRemapEvent, std::ref(mockedInputHandler), std::placeholders::_1, std::ref(testState));
+            mockedInputHandler.SetHookProc([currentHookProc](LowlevelKeyboardEvent* data) {
+                if (data->lParam->dwExtraInfo != KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG)
+                {
+                    return currentHookProc(data);
+                }
+                else
+                {
+                    return (intptr_t)1;
+                }
+            });
+
+            testState.AddOSLevelShortcut(src, dest);
+            testState.UpdateDispatchTables();
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(InitializeTestEnv)
+        {
+            mockedInputHandler.SetHookProc(nullptr);
+            mockedInputHandler.ResetKeyboardState();
+            mockedInputHandler.SetKeyStateTracking(true);
+        }
+
+        // Test that the compiled chord gives the same results as the chord and the shortcut for all modifier combinations on random key states
+        TEST_METHOD (CompiledChord_ShouldMatchChord_WhenCheckingKeyboardState)
+        {
+            const std::vector<WORD> keyPool = { VK_LWIN, VK_RWIN, VK_LCONTROL, VK_RCONTROL, VK_LMENU, VK_RMENU, VK_LSHIFT, VK_RSHIFT, 0x41, 0x42, VK_LBUTTON, VK_NUMLOCK };
+            const ModifierKey modifierKeys[] = { ModifierKey::Disabled, ModifierKey::Left, ModifierKey::Right, ModifierKey::Both };
+
+            std::vector<Shortcut> shortcuts;
+            for (auto win : modifierKeys)
+            {
+                for (auto ctrl : modifierKeys)
+                {
+                    for (auto alt : modifierKeys)
+                    {
+                        for (auto shift : modifierKeys)
+                        {
+                            shortcuts.push_back(CreateShortcut(win, ctrl, alt, shift, 0x41));
+                        }
+                    }
+                }
+            }
+
+            // The chord methods query each key when the platform doesn't track the key state
+            Win32EngineAdapter::Win32Platform platform(mockedInputHandler, testState);
+            std::mt19937 random(36);
+            for (int i = 0; i < 200; i++)
+            {
+                std::vector<WORD> keys;
+                for (WORD key : keyPool)
+                {
+                    if (random() % 3 == 0)
+                    {
+                        keys.push_back(key);
+                    }
+                }
+
+                mockedInputHandler.ResetKeyboardState();
+                PressKeys(keys);
+                const KeyStateBitset keyState = *mockedInputHandler.GetTrackedKeyState();
+                mockedInputHandler.SetKeyStateTracking(false);
+                for (const auto& shortcut : shortcuts)
+                {
+                    const KeyboardManagerCore::Chord chord = shortcut.ToChord();
+                    const CompiledChord compiled(chord);
+                    const bool expectedModifiers = chord.CheckModifiersKeyboardState(platform);
+                    const bool expectedClear = chord.IsKeyboardStateClearExceptChord(platform);
+
+                    Assert::AreEqual(expectedModifiers, compiled.CheckModifiersKeyboardState(keyState));
+                    Assert::AreEqual(expectedClear, compiled.IsKeyboardStateClearExceptChord(keyState));
+                    Assert::AreEqual(expectedModifiers, shortcut.CheckModifiersKeyboardState(mockedInputHandler));
+                    Assert::AreEqual(expectedClear, shortcut.IsKeyboardStateClearExceptShortcut(mockedInputHandler));
+                }
+
+                mockedInputHandler.SetKeyStateTracking(true);
+            }
+        }
+
+        // Test that a shortcut remap is invoked when its modifier was held down without the hook seeing the key down, since the modifiers are resynced when no remap matches them
+        TEST_METHOD (ShortcutRemap_ShouldBeInvoked_WhenModifierWasPressedBeforeTrackingStarted)
+        {
+            // Remap Ctrl+A to Ctrl+V
+            Shortcut src;
+            src.SetKey(VK_CONTROL);
+            src.SetKey(0x41);
+            Shortcut dest;
+            dest.SetKey(VK_CONTROL);
+            dest.SetKey(0x56);
+            AddOSLevelShortcutRemap(src, dest);
+
+            // Ctrl is held down without a key event, then A is pressed
+            mockedInputHandler.SetUntrackedKeyState(VK_LCONTROL, true);
+            mockedInputHandler.SetUntrackedKeyState(VK_CONTROL, true);
+            Assert::IsFalse(mockedInputHandler.GetTrackedKeyState()->Test(VK_LCONTROL));
+            PressKeys({ 0x41 });
+
+            Assert::IsTrue(testState.IsShortcutRemapInvoked(src));
+            Assert::IsTrue(mockedInputHandler.GetTrackedKeyState()->Test(VK_LCONTROL));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x56));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x41));
+        }
+
+        // Test that a shortcut remap is not invoked when its modifier is pressed in the tracked key state but was released without the hook seeing the key up
+        TEST_METHOD (ShortcutRemap_ShouldNotBeInvoked_WhenModifierKeyUpWasMissed)
+        {
+            // Remap Alt+A to Ctrl+V
+            Shortcut src;
+            src.SetKey(VK_MENU);
+            src.SetKey(0x41);
+            Shortcut dest;
+            dest.SetKey(VK_CONTROL);
+            dest.SetKey(0x56);
+            AddOSLevelShortcutRemap(src, dest);
+
+            PressKeys({ VK_LMENU });
+            mockedInputHandler.SetUntrackedKeyState(VK_LMENU, false);
+            mockedInputHandler.SetUntrackedKeyState(VK_MENU, false);
+            Assert::IsTrue(mockedInputHandler.GetTrackedKeyState()->Test(VK_LMENU));
+            PressKeys({ 0x41 });
+
+            Assert::IsFalse(testState.IsShortcutRemapInvoked(src));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x41));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x56));
+        }
+
+        // Test that a shortcut remap is invoked when another key is pressed in the tracked key state but was released without the hook seeing the key up
+        TEST_METHOD (ShortcutRemap_ShouldBeInvoked_WhenKeyUpOfOtherKeyWasMissed)
+        {
+            // Remap Ctrl+A to Ctrl+V
+            Shortcut src;
+            src.SetKey(VK_CONTROL);
+            src.SetKey(0x41);
+            Shortcut dest;
+            dest.SetKey(VK_CONTROL);
+            dest.SetKey(0x56);
+            AddOSLevelShortcutRemap(src, dest);
+
+            PressKeys({ 0x42 });
+            mockedInputHandler.SetUntrackedKeyState(0x42, false);
+            Assert::IsTrue(mockedInputHandler.GetTrackedKeyState()->Test(0x42));
+            PressKeys({ VK_LCONTROL, 0x41 });
+
+            Assert::IsTrue(testState.IsShortcutRemapInvoked(src));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x56));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x41));
+        }
+
+        // Test that the generic modifier key codes are pressed while either the left or right key is pressed
+        TEST_METHOD (KeyStateBitset_ShouldKeepGenericModifierPressed_WhenOneOfLeftAndRightIsReleased)
+        {
+            KeyStateBitset keyState;
+            keyState.Update(VK_LCONTROL, false);
+            keyState.Update(VK_RCONTROL, false);
+            keyState.Update(VK_LCONTROL, true);
+            Assert::IsTrue(keyState.Test(VK_CONTROL));
+            Assert::IsTrue(keyState.Test(VK_RCONTROL));
+
+            keyState.Update(VK_RCONTROL, true);
+            Assert::IsFalse(keyState.Test(VK_CONTROL));
+
+            // Injected generic key codes are treated as the left key, and a generic key up releases both keys
+            keyState.Update(VK_SHIFT, false);
+            Assert::IsTrue(keyState.Test(VK_LSHIFT));
+            Assert::IsTrue(keyState.Test(VK_SHIFT));
+            keyState.Update(VK_RSHIFT, false);
+            keyState.Update(VK_SHIFT, true);
+            Assert::IsTrue(keyState.None());
+
+            keyState.Update(VK_RWIN, false);
+            Assert::IsTrue(keyState.Test(KeyStateBitset::AnyWinKey));
+            keyState.Update(VK_RWIN, true);
+            Assert::IsFalse(keyState.Test(KeyStateBitset::AnyWinKey));
+        }
+
+        // Test that the pressed keys are enumerated in increasing order across words
+        TEST_METHOD (KeyStateBitset_ShouldEnumeratePressedKeys_WhenForEachKeyIsCalled)
+        {
+            KeyStateBitset keyState;
+            const std::vector<KeyboardManagerCore::KeyCode> keys = { 0x08, 0x41, 0x7F, 0x80, 0xA2, 0xFE };
+            for (auto key : keys)
+            {
+                keyState.Set(key);
+            }
+
+            std::vector<KeyboardManagerCore::KeyCode> enumeratedKeys;
+            keyState.ForEachKey([&](KeyboardManagerCore::KeyCode key) { enumeratedKeys.push_back(key); });
+            Assert::IsTrue(keys == enumeratedKeys);
+        }
+
+        // Test that chords which can be pressed by the same keys overlap
+        TEST_METHOD (CompiledChord_ShouldOverlap_WhenChordsCanBePressedBySameKeys)
+        {
+            const CompiledChord ctrlA(CreateShortcut(ModifierKey::Disabled, ModifierKey::Both, ModifierKey::Disabled, ModifierKey::Disabled, 0x41).ToChord());
+            const CompiledChord leftCtrlA(CreateShortcut(ModifierKey::Disabled, ModifierKey::Left, ModifierKey::Disabled, ModifierKey::Disabled, 0x41).ToChord());
+            const CompiledChord rightCtrlA(CreateShortcut(ModifierKey::Disabled, ModifierKey::Right, ModifierKey::Disabled, ModifierKey::Disabled, 0x41).ToChord());
+            const CompiledChord ctrlShiftA(CreateShortcut(ModifierKey::Disabled, ModifierKey::Both, ModifierKey::Disabled, ModifierKey::Both, 0x41).ToChord());
+            const CompiledChord ctrlB(CreateShortcut(ModifierKey::Disabled, ModifierKey::Both, ModifierKey::Disabled, ModifierKey::Disabled, 0x42).ToChord());
+            const CompiledChord winA(CreateShortcut(ModifierKey::Both, ModifierKey::Disabled, ModifierKey::Disabled, ModifierKey::Disabled, 0x41).ToChord());
+            const CompiledChord leftWinA(CreateShortcut(ModifierKey::Left, ModifierKey::Disabled, ModifierKey::Disabled, ModifierKey::Disabled, 0x41).ToChord());
+
+            Assert::IsTrue(ctrlA.Overlaps(ctrlA));
+            Assert::IsTrue(ctrlA.Overlaps(leftCtrlA));
+            Assert::IsTrue(rightCtrlA.Overlaps(ctrlA));
+            Assert::IsTrue(winA.Overlaps(leftWinA));
+            Assert::IsFalse(leftCtrlA.Overlaps(rightCtrlA));
+            Assert::IsFalse(ctrlA.Overlaps(ctrlShiftA));
+            Assert::IsFalse(ctrlA.Overlaps(ctrlB));
+            Assert::IsFalse(ctrlA.Overlaps(winA));
+        }
+    };
+}
@@ -0,0 +1,301 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "MockedInput.h"
+#include <keyboardmanager/KeyboardManagerEngineLibrary/State.h>
+#include <keyboardmanager/KeyboardManagerEngineLibrary/KeyboardEventHandlers.h>
+#include <keyboardmanager/KeyboardManagerEngineLibrary/Win32EngineAdapter.h>
+#include <keyboardmanager/KeyboardManagerEngineCore/Replay.h>
+#include "TestHelpers.h"
+#include <common/interop/shared_constants.h>
+
+#include <algorithm>
+#include <sstream>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace RemappingLogicTests
+{
+    // Tests for the platform independent remap engine core, used through the Win32 adapter with the mocked input
+    TEST_CLASS (EngineCoreTests)
+    {
+    private:
+        KeyboardManagerInput::MockedInput mockedInputHandler;
+        State testState;
+
+        // Function to compile the engine from the remaps added to testState and set it as the hook procedure, with all the stages run by HandleKeyEvent
+        void CreateEngine()
+        {
+            testState.UpdateDispatchTables();
+            mockedInputHandler.SetHookProc([this](LowlevelKeyboardEvent* data) {
+                Win32EngineAdapter::Win32Platform platform(mockedInputHandler, testState);
+                return Win32EngineAdapter::HandleKeyboardHookEvent(testState.GetRemapEngine(), platform, data);
+            });
+        }
+
+        // Function to send a single key down or key up event
+        static void SendKey(KeyboardManagerInput::MockedInput& input, WORD key, bool keyUp)
+        {
+            INPUT keyEvent[1] = {};
+            keyEvent[0].type = INPUT_KEYBOARD;
+            keyEvent[0].ki.wVk = key;
+            keyEvent[0].ki.dwFlags = keyUp ? KEYEVENTF_KEYUP : 0;
+            input.SendVirtualInput(1, keyEvent, sizeof(INPUT));
+        }
+
+        // Function to add the remaps which are compared between HandleKeyEvent and the hook handlers
+        static void AddEquivalenceRemaps(State& state, const std::wstring& app)
+        {
+            // Remap A to B, Caps Lock to Ctrl and D to Ctrl+Shift+V
+            state.AddSingleKeyRemap(0x41, (DWORD)0x42);
+            state.AddSingleKeyRemap(VK_CAPITAL, (DWORD)VK_CONTROL);
+            Shortcut ctrlShiftV;
+            ctrlShiftV.SetKey(VK_CONTROL);
+            ctrlShiftV.SetKey(VK_SHIFT);
+            ctrlShiftV.SetKey(0x56);
+            state.AddSingleKeyRemap(0x44, ctrlShiftV);
+
+            // Remap Ctrl+C to Alt+V, Ctrl+Shift+C to Win+E and Alt+Q to the Escape key
+            Shortcut ctrlC;
+            ctrlC.SetKey(VK_CONTROL);
+            ctrlC.SetKey(0x43);
+            Shortcut altV;
+            altV.SetKey(VK_MENU);
+            altV.SetKey(0x56);
+            state.AddOSLevelShortcut(ctrlC, altV);
+
+            Shortcut ctrlShiftC;
+            ctrlShiftC.SetKey(VK_CONTROL);
+            ctrlShiftC.SetKey(VK_SHIFT);
+            ctrlShiftC.SetKey(0x43);
+            Shortcut winE;
+            winE.SetKey(VK_LWIN);
+            winE.SetKey(0x45);
+            state.AddOSLevelShortcut(ctrlShiftC, winE);
+
+            Shortcut altQ;
+            altQ.SetKey(VK_MENU);
+            altQ.SetKey(0x51);
+            state.AddOSLevelShortcut(altQ, (DWORD)VK_ESCAPE);
+
+            // Remap Ctrl+C to Ctrl+Insert only in the test app
+            Shortcut ctrlInsert;
+            ctrlInsert.SetKey(VK_CONTROL);
+            ctrlInsert.SetKey(VK_INSERT);
+            state.AddAppSpecificShortcut(app, ctrlC, ctrlInsert);
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(InitializeTestEnv)
+        {
+            // Reset test environment
+            TestHelpers::ResetTestEnv(mockedInputHandler, testState);
+        }
+
+        // Test if a key to key remap sends the target key and suppresses the original key
+        TEST_METHOD (SingleKeyRemap_ShouldSendTargetKey_WhenKeyIsRemapped)
+        {
+            // Remap A to B
+            testState.AddSingleKeyRemap(0x41, (DWORD)0x42);
+            CreateEngine();
+
+            SendKey(mockedInputHandler, 0x41, false);
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x41));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x42));
+
+            SendKey(mockedInputHandler, 0x41, true);
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x42));
+        }
+
+        // Test if a key to shortcut remap presses the modifiers and the action key, and releases them in reverse order
+        TEST_METHOD (SingleKeyRemap_ShouldSendShortcut_WhenKeyIsRemappedToShortcut)
+        {
+            // Remap A to Ctrl+V
+            Shortcut dest;
+            dest.SetKey(VK_CONTROL);
+            dest.SetKey(0x56);
+            testState.AddSingleKeyRemap(0x41, dest);
+            CreateEngine();
+
+            SendKey(mockedInputHandler, 0x41, false);
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(VK_CONTROL));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x56));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x41));
+
+            SendKey(mockedInputHandler, 0x41, true);
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_CONTROL));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x56));
+        }
+
+        // Test if a shortcut to shortcut remap replaces both the modifier and the action key
+        TEST_METHOD (ShortcutRemap_ShouldSendTargetShortcut_WhenShortcutIsPressed)
+        {
+            // Remap Ctrl+A to Alt+V
+            Shortcut src;
+            src.SetKey(VK_CONTROL);
+            src.SetKey(0x41);
+            Shortcut dest;
+            dest.SetKey(VK_MENU);
+            dest.SetKey(0x56);
+            testState.AddOSLevelShortcut(src, dest);
+            CreateEngine();
+
+            SendKey(mockedInputHandler, VK_CONTROL, false);
+            SendKey(mockedInputHandler, 0x41, false);
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_CONTROL));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x41));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(VK_MENU));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x56));
+            Assert::IsTrue(testState.CheckShortcutRemapInvoked());
+
+            SendKey(mockedInputHandler, 0x41, true);
+            SendKey(mockedInputHandler, VK_CONTROL, true);
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_MENU));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x56));
+            Assert::IsFalse(testState.CheckShortcutRemapInvoked());
+        }
+
+        // Test if a shortcut to key remap releases the modifier and sends the target key
+        TEST_METHOD (ShortcutRemap_ShouldSendTargetKey_WhenShortcutIsRemappedToKey)
+        {
+            // Remap Ctrl+A to B
+            Shortcut src;
+            src.SetKey(VK_CONTROL);
+            src.SetKey(0x41);
+            testState.AddOSLevelShortcut(src, (DWORD)0x42);
+            CreateEngine();
+
+            SendKey(mockedInputHandler, VK_CONTROL, false);
+            SendKey(mockedInputHandler, 0x41, false);
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_CONTROL));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x41));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x42));
+
+            SendKey(mockedInputHandler, 0x41, true);
+            SendKey(mockedInputHandler, VK_CONTROL, true);
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x42));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_CONTROL));
+        }
+
+        // Test if an app-specific remap is only applied when the app is in the foreground
+        TEST_METHOD (AppSpecificShortcutRemap_ShouldOnlyBeApplied_WhenAppIsInForeground)
+        {
+            // Remap Ctrl+A to Alt+V in the test app
+            Shortcut src;
+            src.SetKey(VK_CONTROL);
+            src.SetKey(0x41);
+            Shortcut dest;
+            dest.SetKey(VK_MENU);
+            dest.SetKey(0x56);
+            testState.AddAppSpecificShortcut(L"testprocess.exe", src, dest);
+            CreateEngine();
+
+            mockedInputHandler.SetForegroundProcess(L"otherprocess.exe");
+            SendKey(mockedInputHandler, VK_CONTROL, false);
+            SendKey(mockedInputHandler, 0x41, false);
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(VK_CONTROL));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x41));
+            SendKey(mockedInputHandler, 0x41, true);
+            SendKey(mockedInputHandler, VK_CONTROL, true);
+
+            // The app name is compared in lower case
+            mockedInputHandler.SetForegroundProcess(L"TestProcess.exe");
+            SendKey(mockedInputHandler, VK_CONTROL, false);
+            SendKey(mockedInputHandler, 0x41, false);
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_CONTROL));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(VK_MENU));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x56));
+        }
+
+        // Test if HandleKeyEvent leaves the same key state as the stages run separately by the keyboard hook handlers after each event of a key sequence
+        TEST_METHOD (EngineCore_ShouldMatchKeyboardEventHandlers_ForKeySequence)
+        {
+            const std::wstring testApp = L"testprocess.exe";
+            AddEquivalenceRemaps(testState, testApp);
+            CreateEngine();
+
+            KeyboardManagerInput::MockedInput referenceInputHandler;
+            State referenceState;
+            TestHelpers::ResetTestEnv(referenceInputHandler, referenceState);
+            AddEquivalenceRemaps(referenceState, testApp);
+            referenceInputHandler.SetHookProc([&referenceInputHandler, &referenceState](LowlevelKeyboardEvent* data) {
+                // Same order as KeyboardManager::HandleKeyboardHookEvent
+                if (data->lParam->dwExtraInfo == KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG)
+                {
+                    return (intptr_t)1;
+                }
+
+                if (KeyboardEventHandlers::HandleSingleKeyRemapEvent(referenceInputHandler, data, referenceState) == 1)
+                {
+                    return (intptr_t)1;
+                }
+
+                if (KeyboardEventHandlers::HandleAppSpecificShortcutRemapEvent(referenceInputHandler, data, referenceState) == 1)
+                {
+                    return (intptr_t)1;
+                }
+
+                return KeyboardEventHandlers::HandleOSLevelShortcutRemapEvent(referenceInputHandler, data, referenceState);
+            });
+
+            // Key events as (key, key up). Key 0 toggles the test app in the foreground
+            const std::vector<std::pair<WORD, bool>> sequence = {
+                { 0x41, false }, { 0x41, true },
+                { VK_CONTROL, false }, { 0x43, false }, { 0x43, true }, { 0x43, false }, { 0x43, true }, { VK_CONTROL, true },
+                { VK_CONTROL, false }, { VK_SHIFT, false }, { 0x43, false }, { 0x43, true }, { VK_SHIFT, true }, { VK_CONTROL, true },
+                { VK_CONTROL, false }, { 0x43, false }, { VK_CONTROL, true }, { 0x43, true },
+                { VK_MENU, false }, { 0x51, false }, { 0x51, true }, { VK_MENU, true },
+                { 0x44, false }, { 0x44, true },
+                { VK_CAPITAL, false }, { 0x43, false }, { 0x43, true }, { VK_CAPITAL, true },
+                { 0, false },
+                { VK_CONTROL, false }, { 0x43, false }, { 0x43, true }, { VK_CONTROL, true },
+                { VK_CONTROL, false }, { 0x43, false }, { 0, false }, { 0x43, true }, { VK_CONTROL, true },
+                { VK_MENU, false }, { 0x41, false }, { 0x41, true }, { VK_MENU, true },
+            };
+
+            bool appInForeground = false;
+            for (size_t i = 0; i < sequence.size(); i++)
+            {
+                const auto& [key, keyUp] = sequence[i];
+                if (key == 0)
+                {
+                    appInForeground = !appInForeground;
+                    mockedInputHandler.SetForegroundProcess(appInForeground ? testApp : L"");
+                    referenceInputHandler.SetForegroundProcess(appInForeground ? testApp : L"");
+                    continue;
+                }
+
+                SendKey(mockedInputHandler, key, keyUp);
+                SendKey(referenceInputHandler, key, keyUp);
+                for (int vk = 0; vk < 256; vk++)
+                {
+                    if (mockedInputHandler.GetVirtualKeyState(vk) != referenceInputHandler.GetVirtualKeyState(vk))
+                    {
+                        std::wstring message = L"Key state of " + std::to_wstring(vk) + L" differs after event " + std::to_wstring(i);
+                        Assert::Fail(message.c_str());
+                    }
+                }
+            }
+        }
+
+        // Replay a generated workload through the engine core and log the latency report
+        TEST_METHOD (EngineCore_Replay_WithGeneratedWorkload)
+        {
+            KeyboardManagerCore::SyntheticWorkloadOptions options;
+            options.eventCount = 20000;
+            const auto config = KeyboardManagerCore::GenerateRemapConfig(options);
+            const auto trace = KeyboardManagerCore::GenerateTrace(config, options);
+
+            KeyboardManagerCore::RemapEngine replayEngine(config);
+            const auto result = KeyboardManagerCore::ReplayTrace(replayEngine, trace);
+
+            std::ostringstream report;
+            KeyboardManagerCore::WriteReplayReport(report, result);
+            Logger::WriteMessage(report.str().c_str());
+
+            Assert::IsTrue(result.pressedKeys.empty());
+            Assert::IsFalse(replayEngine.IsShortcutRemapInvoked());
+            const auto traceKeyEventCount = std::count_if(trace.begin(), trace.end(), [](const KeyboardManagerCore::TraceEntry& entry) { return entry.type == KeyboardManagerCore::TraceEntry::Type::Key; });
+            Assert::AreEqual(static_cast<uint64_t>(traceKeyEventCount), result.keyEventCount);
+        }
+    };
+}
@@ -0,0 +1,159 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "MockedInput.h"
+#include <keyboardmanager/KeyboardManagerEngineLibrary/State.h>
+#include <keyboardmanager/KeyboardManagerEngineLibrary/KeyboardEventHandlers.h>
+#include "TestHelpers.h"
+#include "AllocationCounter.h"
+#include <common/interop/shared_constants.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace RemappingLogicTests
+{
+    // Tests to ensure that the remap handlers don't allocate memory in the keyboard hook
+    TEST_CLASS (HookAllocationTests)
+    {
+    private:
+        KeyboardManagerInput::MockedInput mockedInputHandler;
+        State testState;
+        std::wstring testApp = L"testprocess.exe";
+
+        // Function to send a key down or key up event for each of the keys in order
+        void SendKeys(const std::vector<WORD>& keys, bool keyUp)
+        {
+            for (const auto& key : keys)
+            {
+                INPUT input[1] = {};
+                input[0].type = INPUT_KEYBOARD;
+                input[0].ki.wVk = key;
+                input[0].ki.dwFlags = keyUp ? KEYEVENTF_KEYUP : 0;
+                mockedInputHandler.SendVirtualInput(1, input, sizeof(INPUT));
+            }
+        }
+
+        // Function to press and release the keys several times and return the number of allocations made while handling the key events. The keys are pressed once before counting to let lazily initialized state get created
+        size_t CountAllocationsForKeyPresses(const std::vector<WORD>& keys)
+        {
+            const std::vector<WORD> releasedKeys(keys.rbegin(), keys.rend());
+            SendKeys(keys, false);
+            SendKeys(releasedKeys, true);
+
+            TestHelpers::AllocationCounter counter;
+            for (int i = 0; i < 10; i++)
+            {
+                SendKeys(keys, false);
+                SendKeys(releasedKeys, true);
+            }
+
+            return counter.Count();
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(InitializeTestEnv)
+        {
+            // Reset test environment
+            TestHelpers::ResetTestEnv(mockedInputHandler, testState);
+
+            // Set the same chain of handlers as the keyboard manager hook procedure
+            mockedInputHandler.SetHookProc([this](LowlevelKeyboardEvent* data) {
+                if (data->lParam->dwExtraInfo == KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG)
+                {
+                    return (intptr_t)1;
+                }
+
+                if (KeyboardEventHandlers::HandleSingleKeyRemapEvent(mockedInputHandler, data, testState) == 1)
+                {
+                    return (intptr_t)1;
+                }
+
+                if (KeyboardEventHandlers::HandleAppSpecificShortcutRemapEvent(mockedInputHandler, data, testState) == 1)
+                {
+                    return (intptr_t)1;
+                }
+
+                return KeyboardEventHandlers::HandleOSLevelShortcutRemapEvent(mockedInputHandler, data, testState);
+            });
+        }
+
+        // Test if no memory is allocated for a single key to key remap
+        TEST_METHOD (SingleKeyToKeyRemap_ShouldNotAllocate_OnKeyEvents)
+        {
+            // Remap A to B
+            testState.AddSingleKeyRemap(0x41, (DWORD)0x42);
+
+            Assert::AreEqual(size_t(0), CountAllocationsForKeyPresses({ 0x41 }));
+        }
+
+        // Test if no memory is allocated for a single key to shortcut remap
+        TEST_METHOD (SingleKeyToShortcutRemap_ShouldNotAllocate_OnKeyEvents)
+        {
+            // Remap A to Ctrl+V
+            Shortcut dest;
+            dest.SetKey(VK_CONTROL);
+            dest.SetKey(0x56);
+            testState.AddSingleKeyRemap(0x41, dest);
+
+            Assert::AreEqual(size_t(0), CountAllocationsForKeyPresses({ 0x41 }));
+        }
+
+        // Test if no memory is allocated for a shortcut to shortcut remap
+        TEST_METHOD (ShortcutToShortcutRemap_ShouldNotAllocate_OnKeyEvents)
+        {
+            // Remap Ctrl+A to Alt+V
+            Shortcut src;
+            src.SetKey(VK_CONTROL);
+            src.SetKey(0x41);
+            Shortcut dest;
+            dest.SetKey(VK_MENU);
+            dest.SetKey(0x56);
+            testState.AddOSLevelShortcut(src, dest);
+
+            Assert::AreEqual(size_t(0), CountAllocationsForKeyPresses({ VK_CONTROL, 0x41 }));
+        }
+
+        // Test if no memory is allocated for a shortcut to key remap
+        TEST_METHOD (ShortcutToKeyRemap_ShouldNotAllocate_OnKeyEvents)
+        {
+            // Remap Ctrl+A to B
+            Shortcut src;
+            src.SetKey(VK_CONTROL);
+            src.SetKey(0x41);
+            testState.AddOSLevelShortcut(src, (DWORD)0x42);
+
+            Assert::AreEqual(size_t(0), CountAllocationsForKeyPresses({ VK_CONTROL, 0x41 }));
+        }
+
+        // Test if no memory is allocated for an app-specific shortcut remap while the app is in the foreground
+        TEST_METHOD (AppSpecificShortcutRemap_ShouldNotAllocate_OnKeyEvents)
+        {
+            // Remap Ctrl+A to Alt+V
+            Shortcut src;
+            src.SetKey(VK_CONTROL);
+            src.SetKey(0x41);
+            Shortcut dest;
+            dest.SetKey(VK_MENU);
+            dest.SetKey(0x56);
+            testState.AddAppSpecificShortcut(testApp, src, dest);
+            mockedInputHandler.SetForegroundProcess(testApp);
+
+            Assert::AreEqual(size_t(0), CountAllocationsForKeyPresses({ VK_CONTROL, 0x41 }));
+        }
+
+        // Test if no memory is allocated for key events which aren't remapped
+        TEST_METHOD (UnmappedKeys_ShouldNotAllocate_OnKeyEvents)
+        {
+            // Remap Ctrl+A to Alt+V
+            Shortcut src;
+            src.SetKey(VK_CONTROL);
+            src.SetKey(0x41);
+            Shortcut dest;
+            dest.SetKey(VK_MENU);
+            dest.SetKey(0x56);
+            testState.AddOSLevelShortcut(src, dest);
+            testState.AddAppSpecificShortcut(testApp, src, dest);
+
+            Assert::AreEqual(size_t(0), CountAllocationsForKeyPresses({ VK_SHIFT, 0x42 }));
+        }
+    };
+}
@@ -53,6 +53,11 @@ UINT MockedInput::SendVirtualInput(UINT cInputs, LPINPUT pInputs, int cbSize)
             sendVirtualInputCallCount++;
         }
 
+        if (messageLoopHandler)
+        {
+            messageLoopHandler();
+        }
+
         // Call low level hook handler
         intptr_t result = MockedKeyboardHook(&keyEvent);
 
@@ -105,6 +110,8 @@ UINT MockedInput::SendVirtualInput(UINT cInputs, LPINPUT pInputs, int cbSize)
                 keyboardState[VK_SHIFT] = (pInputs[i].ki.dwFlags & KEYEVENTF_KEYUP) ? false : true;
                 break;
             }
+
+            UpdateTrackedKeyState();
         }
     }
 
@@ -135,6 +142,60 @@ bool MockedInput::GetVirtualKeyState(int key)
 void MockedInput::ResetKeyboardState()
 {
     std::fill(keyboardState.begin(), keyboardState.end(), false);
+    trackedKeyState.Reset();
+}
+
+// Function to copy keyboardState to the tracked key state
+void MockedInput::UpdateTrackedKeyState()
+{
+    for (DWORD key = 1; key < keyboardState.size(); key++)
+    {
+        trackedKeyState.Set(key, keyboardState[key]);
+    }
+
+    trackedKeyState.Set(KeyboardManagerCore::KeyStateBitset::AnyWinKey, keyboardState[VK_LWIN] || keyboardState[VK_RWIN]);
+}
+
+// Function to get the tracked key state, or nullptr if tracking is disabled
+const KeyboardManagerCore::KeyStateBitset* MockedInput::GetTrackedKeyState()
+{
+    return isTrackingKeyState ? &trackedKeyState : nullptr;
+}
+
+// Function to copy the state of the modifier keys to the tracked key state, same as Input::ResyncModifierKeyState
+bool MockedInput::ResyncModifierKeyState()
+{
+    if (!isTrackingKeyState)
+    {
+        return false;
+    }
+
+    const KeyboardManagerCore::KeyStateBitset previousKeyState = trackedKeyState;
+    for (DWORD key : { VK_LWIN, VK_RWIN, VK_LCONTROL, VK_RCONTROL, VK_CONTROL, VK_LMENU, VK_RMENU, VK_MENU, VK_LSHIFT, VK_RSHIFT, VK_SHIFT })
+    {
+        trackedKeyState.Set(key, keyboardState[key]);
+    }
+
+    trackedKeyState.Set(KeyboardManagerCore::KeyStateBitset::AnyWinKey, keyboardState[VK_LWIN] || keyboardState[VK_RWIN]);
+    return trackedKeyState != previousKeyState;
+}
+
+// Function to enable or disable returning the tracked key state, so that the handlers query each key instead
+void MockedInput::SetKeyStateTracking(bool isTracking)
+{
+    isTrackingKeyState = isTracking;
+}
+
+// Function to change the state of a key without a key event, so that the tracked key state doesn't see it
+void MockedInput::SetUntrackedKeyState(int key, bool isPressed)
+{
+    keyboardState[key] = isPressed;
+}
+
+// Function to copy the keyboard state to the tracked key state, same as Input::ResyncKeyState
+void MockedInput::ResyncTrackedKeyState()
+{
+    UpdateTrackedKeyState();
 }
 
 // Function to set SendVirtualInput call count condition
@@ -150,14 +211,39 @@ int MockedInput::GetSendVirtualInputCallCount()
     return sendVirtualInputCallCount;
 }
 
-// Function to get the foreground process name
+// Function to set the foreground process name
 void MockedInput::SetForegroundProcess(std::wstring process)
 {
     currentProcess = process;
+    if (foregroundChangeHandler)
+    {
+        foregroundChangeHandler();
+    }
 }
 
 // Function to get the foreground process name
 void MockedInput::GetForegroundProcess(_Out_ std::wstring& foregroundProcess)
 {
+    getForegroundProcessCallCount++;
     foregroundProcess = currentProcess;
 }
+
+// Function to set the handler which is executed when the foreground process changes
+void MockedInput::SetForegroundChangeHandler(std::function<void()> handler)
+{
+    foregroundChangeHandler = handler;
+    getForegroundProcessCallCount = 0;
+}
+
+// Function to get GetForegroundProcess call count
+int MockedInput::GetForegroundProcessCallCount()
+{
+    return getForegroundProcessCallCount;
+}
+
+
+// Function to set the handler which is executed before each key event is passed to the hook
+void MockedInput::SetMessageLoopHandler(std::function<void()> handler)
+{
+    messageLoopHandler = handler;
+}
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include <keyboardmanager/common/InputInterface.h>
+#include <keyboardmanager/KeyboardManagerEngineCore/KeyStateBitset.h>
 #include <vector>
 #include <functional>
 
@@ -15,6 +16,13 @@ namespace KeyboardManagerInput
         // Stores the states for all the keys - false for key up, and true for key down
         std::vector<bool> keyboardState;
 
+        // Mirror of keyboardState, returned as the tracked key state so that the tests cover the handlers which use it
+        KeyboardManagerCore::KeyStateBitset trackedKeyState;
+        bool isTrackingKeyState = true;
+
+        // Function to copy keyboardState to the tracked key state
+        void UpdateTrackedKeyState();
+
         // Function to be executed as a low level hook. By default it is nullptr so the hook is skipped
         std::function<intptr_t(LowlevelKeyboardEvent*)> hookProc;
 
@@ -24,6 +32,15 @@ namespace KeyboardManagerInput
 
         std::wstring currentProcess;
 
+        // Function to be executed when the foreground process changes, similar to the EVENT_SYSTEM_FOREGROUND event hook
+        std::function<void()> foregroundChangeHandler;
+
+        // Function to be executed before each key event is passed to the hook, similar to the messages handled by the message loop of the hook thread between key events
+        std::function<void()> messageLoopHandler;
+
+        // Stores the count of GetForegroundProcess calls
+        int getForegroundProcessCallCount = 0;
+
     public:
         MockedInput()
         {
@@ -45,17 +62,42 @@ namespace KeyboardManagerInput
         // Function to reset the mocked keyboard state
         void ResetKeyboardState();
 
+        // Function to get the tracked key state, or nullptr if tracking is disabled
+        const KeyboardManagerCore::KeyStateBitset* GetTrackedKeyState();
+
+        // Function to copy the state of the modifier keys to the tracked key state, same as Input::ResyncModifierKeyState
+        bool ResyncModifierKeyState();
+
+        // Function to enable or disable returning the tracked key state, so that the handlers query each key instead
+        void SetKeyStateTracking(bool isTracking);
+
+        // Function to change the state of a key without a key event, like a key which was pressed before the hook was installed or while the secure desktop was active.
+        // The tracked key state isn't updated until ResyncTrackedKeyState is called
+        void SetUntrackedKeyState(int key, bool isPressed);
+
+        // Function to copy the keyboard state to the tracked key state, same as Input::ResyncKeyState
+        void ResyncTrackedKeyState();
+
         // Function to set SendVirtualInput call count condition
         void SetSendVirtualInputTestHandler(std::function<bool(LowlevelKeyboardEvent*)> condition);
 
         // Function to get SendVirtualInput call count
         int GetSendVirtualInputCallCount();
 
-        // Function to get the foreground process name
+        // Function to set the foreground process name
         void SetForegroundProcess(std::wstring process);
 
         // Function to get the foreground process name
         void GetForegroundProcess(_Out_ std::wstring& foregroundProcess);
+
+        // Function to set the handler which is executed when the foreground process changes
+        void SetForegroundChangeHandler(std::function<void()> handler);
+
+        // Function to get GetForegroundProcess call count
+        int GetForegroundProcessCallCount();
+
+        // Function to set the handler which is executed before each key event is passed to the hook
+        void SetMessageLoopHandler(std::function<void()> handler);
     };
 }
 
@@ -0,0 +1,225 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <keyboardmanager/common/MappingConfiguration.h>
+#include <keyboardmanager/common/RemapConfigurationImage.h>
+#include <keyboardmanager/common/Helpers.h>
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace RemappingLogicTests
+{
+    // Tests for the binary image of the remap tables
+    TEST_CLASS (RemapImageTests)
+    {
+    private:
+        const RemapConfigurationImage::SourceStamp testStamp = { 1234, 5678 };
+
+        static Shortcut CreateShortcut(const std::vector<DWORD>& keys)
+        {
+            Shortcut shortcut;
+            for (DWORD key : keys)
+            {
+                shortcut.SetKey(key);
+            }
+
+            return shortcut;
+        }
+
+        // Function to add the given number of shortcut remaps for each app, and a few single key and os level remaps
+        static void AddRemaps(MappingConfiguration& mappingConfiguration, int appCount, int remapsPerApp)
+        {
+            const std::vector<std::vector<DWORD>> modifierCombinations = {
+                { VK_CONTROL },
+                { VK_MENU },
+                { VK_LWIN },
+                { VK_CONTROL, VK_SHIFT },
+                { VK_CONTROL, VK_MENU },
+                { VK_MENU, VK_SHIFT },
+                { VK_CONTROL, VK_MENU, VK_SHIFT },
+                { VK_LWIN, VK_SHIFT }
+            };
+
+            mappingConfiguration.AddSingleKeyRemap(0x41, static_cast<DWORD>(0x42));
+            mappingConfiguration.AddSingleKeyRemap(VK_CAPITAL, CreateShortcut({ VK_CONTROL, VK_SHIFT, 0x43 }));
+            mappingConfiguration.AddOSLevelShortcut(CreateShortcut({ VK_CONTROL, 0x41 }), static_cast<DWORD>(VK_F1));
+            mappingConfiguration.AddOSLevelShortcut(CreateShortcut({ VK_RCONTROL, VK_SHIFT, 0x41 }), CreateShortcut({ VK_LWIN, 0x44 }));
+            mappingConfiguration.AddOSLevelShortcut(CreateShortcut({ VK_MENU, 0x41 }), CreateShortcut({ VK_CONTROL, 0x56 }));
+
+            for (int app = 0; app < appCount; app++)
+            {
+                const std::wstring appName = L"App" + std::to_wstring(app) + L".exe";
+                int added = 0;
+                for (DWORD actionKey = 0x30; actionKey <= 0x5A && added < remapsPerApp; actionKey++)
+                {
+                    for (const auto& modifiers : modifierCombinations)
+                    {
+                        if (added == remapsPerApp)
+                        {
+                            break;
+                        }
+
+                        auto keys = modifiers;
+                        keys.push_back(actionKey);
+                        mappingConfiguration.AddAppSpecificShortcut(appName, CreateShortcut(keys), CreateShortcut({ VK_CONTROL, VK_F1 + static_cast<DWORD>(added % 12) }));
+                        added++;
+                    }
+                }
+            }
+        }
+
+        // Function to check that both configurations have the same remaps. Shortcuts of the same size are only in the same order if the remaps were added in the same order
+        static void AssertSameRemaps(const MappingConfiguration& expected, const MappingConfiguration& actual, bool compareSortedKeys = true)
+        {
+            Assert::IsTrue(expected.singleKeyReMap == actual.singleKeyReMap);
+            if (compareSortedKeys)
+            {
+                Assert::IsTrue(expected.osLevelShortcutReMapSortedKeys == actual.osLevelShortcutReMapSortedKeys);
+                Assert::IsTrue(expected.appSpecificShortcutReMapSortedKeys == actual.appSpecificShortcutReMapSortedKeys);
+            }
+
+            Assert::AreEqual(expected.osLevelShortcutReMap.size(), actual.osLevelShortcutReMap.size());
+            for (const auto& [shortcut, remap] : expected.osLevelShortcutReMap)
+            {
+                Assert::IsTrue(remap.targetShortcut == actual.osLevelShortcutReMap.at(shortcut).targetShortcut);
+            }
+
+            Assert::AreEqual(expected.appSpecificShortcutReMap.size(), actual.appSpecificShortcutReMap.size());
+            for (const auto& [app, remapTable] : expected.appSpecificShortcutReMap)
+            {
+                const auto& actualRemapTable = actual.appSpecificShortcutReMap.at(app);
+                Assert::AreEqual(remapTable.size(), actualRemapTable.size());
+                for (const auto& [shortcut, remap] : remapTable)
+                {
+                    Assert::IsTrue(remap.targetShortcut == actualRemapTable.at(shortcut).targetShortcut);
+                }
+            }
+        }
+
+    public:
+        // Test if the remap tables and the priority order of the shortcuts are unchanged after a round trip through the image
+        TEST_METHOD (Image_ShouldRestoreRemapTables_WhenDeserialized)
+        {
+            MappingConfiguration original;
+            AddRemaps(original, 3, 20);
+            const auto image = RemapConfigurationImage::Serialize(original, testStamp);
+
+            MappingConfiguration loaded;
+            loaded.AddOSLevelShortcut(CreateShortcut({ VK_CONTROL, 0x5A }), static_cast<DWORD>(VK_F2));
+            const auto previousVersion = loaded.remapTablesVersion;
+            Assert::IsTrue(RemapConfigurationImage::Deserialize(image.data(), image.size(), testStamp, loaded));
+
+            AssertSameRemaps(original, loaded);
+            Assert::IsTrue(loaded.remapTablesVersion > previousVersion);
+        }
+
+        // Test if images which are corrupted, have another version or were produced from another JSON file are rejected without modifying the configuration
+        TEST_METHOD (Image_ShouldBeRejected_WhenCorruptedOrStale)
+        {
+            MappingConfiguration original;
+            AddRemaps(original, 2, 10);
+            const auto image = RemapConfigurationImage::Serialize(original, testStamp);
+
+            MappingConfiguration loaded;
+            loaded.AddSingleKeyRemap(0x44, static_cast<DWORD>(0x45));
+            const auto previousVersion = loaded.remapTablesVersion;
+
+            // Flipped byte in the records
+            auto corrupted = image;
+            corrupted[sizeof(RemapConfigurationImage::FileHeader) + 5] ^= 0x01;
+            Assert::IsFalse(RemapConfigurationImage::Deserialize(corrupted.data(), corrupted.size(), testStamp, loaded));
+
+            // Truncated image
+            Assert::IsFalse(RemapConfigurationImage::Deserialize(image.data(), image.size() - 1, testStamp, loaded));
+            Assert::IsFalse(RemapConfigurationImage::Deserialize(image.data(), sizeof(RemapConfigurationImage::FileHeader) - 1, testStamp, loaded));
+
+            // Other version
+            auto otherVersion = image;
+            otherVersion[offsetof(RemapConfigurationImage::FileHeader, version)]++;
+            Assert::IsFalse(RemapConfigurationImage::Deserialize(otherVersion.data(), otherVersion.size(), testStamp, loaded));
+
+            // JSON file changed since the image was written
+            Assert::IsFalse(RemapConfigurationImage::Deserialize(image.data(), image.size(), { testStamp.fileSize, testStamp.lastWriteTime + 1 }, loaded));
+
+            Assert::AreEqual(size_t(1), loaded.singleKeyReMap.size());
+            Assert::AreEqual(previousVersion, loaded.remapTablesVersion);
+        }
+
+        // Test if the image is loaded from a file only while the JSON file it was produced from is unchanged
+        TEST_METHOD (ImageFile_ShouldBeIgnored_WhenSourceFileChanges)
+        {
+            wchar_t tempFolder[MAX_PATH];
+            GetTempPathW(MAX_PATH, tempFolder);
+            const std::wstring sourcePath = std::wstring(tempFolder) + L"RemapImageTests.json";
+            const std::wstring imagePath = std::wstring(tempFolder) + L"RemapImageTests" + RemapConfigurationImage::FileExtension;
+            std::ofstream(sourcePath) << "{}";
+
+            MappingConfiguration original;
+            AddRemaps(original, 2, 10);
+            Assert::IsTrue(RemapConfigurationImage::WriteToFile(original, imagePath, sourcePath));
+
+            MappingConfiguration loaded;
+            Assert::IsTrue(RemapConfigurationImage::LoadFromFile(imagePath, sourcePath, loaded));
+            AssertSameRemaps(original, loaded);
+
+            std::ofstream(sourcePath) << "{ \"remapKeys\": {} }";
+            MappingConfiguration reloaded;
+            Assert::IsFalse(RemapConfigurationImage::LoadFromFile(imagePath, sourcePath, reloaded));
+
+            DeleteFileW(sourcePath.c_str());
+            DeleteFileW(imagePath.c_str());
+        }
+
+        // Test if inserting shortcuts keeps the vector sorted by size, with shortcuts of the same size in insertion order
+        TEST_METHOD (InsertShortcutSortedBySize_ShouldKeepVectorSorted_WhenShortcutsAreInserted)
+        {
+            std::vector<Shortcut> shortcuts;
+            const Shortcut ctrlA = CreateShortcut({ VK_CONTROL, 0x41 });
+            const Shortcut ctrlShiftA = CreateShortcut({ VK_CONTROL, VK_SHIFT, 0x41 });
+            const Shortcut altB = CreateShortcut({ VK_MENU, 0x42 });
+            const Shortcut ctrlAltShiftC = CreateShortcut({ VK_CONTROL, VK_MENU, VK_SHIFT, 0x43 });
+            Helpers::InsertShortcutSortedBySize(shortcuts, ctrlA);
+            Helpers::InsertShortcutSortedBySize(shortcuts, ctrlShiftA);
+            Helpers::InsertShortcutSortedBySize(shortcuts, altB);
+            Helpers::InsertShortcutSortedBySize(shortcuts, ctrlAltShiftC);
+
+            Assert::IsTrue(shortcuts == std::vector<Shortcut>{ ctrlAltShiftC, ctrlShiftA, ctrlA, altB });
+        }
+
+        // Test if loading 5000 remaps from the image reads fewer bytes than parsing the JSON of the config file. The load times are only logged, since they depend on the machine
+        TEST_METHOD (Image_ShouldBeSmallerThanJson_WhenLoadingManyRemaps)
+        {
+            MappingConfiguration original;
+            AddRemaps(original, 20, 250);
+            const auto json = original.GetRemapsJson().Stringify();
+            const auto image = RemapConfigurationImage::Serialize(original, testStamp);
+
+            const int iterations = 5;
+            MappingConfiguration fromJson;
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; i++)
+            {
+                Assert::IsTrue(fromJson.LoadRemapsFromJson(json::JsonObject::Parse(json)));
+            }
+
+            const auto jsonTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+            MappingConfiguration fromImage;
+            start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; i++)
+            {
+                Assert::IsTrue(RemapConfigurationImage::Deserialize(image.data(), image.size(), testStamp, fromImage));
+            }
+
+            const auto imageTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+            AssertSameRemaps(fromJson, fromImage, false);
+            std::wstring message = L"Loading 5000 remaps: JSON " + std::to_wstring(jsonTime) + L" ms, image " + std::to_wstring(imageTime) + L" ms (" + std::to_wstring(image.size()) + L" bytes)\n";
+            Logger::WriteMessage(message.c_str());
+            Assert::IsTrue(image.size() < json.size());
+        }
+    };
+}
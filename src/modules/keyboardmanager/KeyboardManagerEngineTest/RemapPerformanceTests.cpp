@@ -0,0 +1,382 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "MockedInput.h"
+#include <keyboardmanager/KeyboardManagerEngineLibrary/State.h>
+#include <keyboardmanager/KeyboardManagerEngineLibrary/KeyboardEventHandlers.h>
+#include "TestHelpers.h"
+#include <common/interop/shared_constants.h>
+
+#include <algorithm>
+#include <chrono>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace RemappingLogicTests
+{
+    // Tests for the compiled remap engine and the latency of the remap hook
+    TEST_CLASS (RemapPerformanceTests)
+    {
+    private:
+        KeyboardManagerInput::MockedInput mockedInputHandler;
+        State testState;
+
+        // Function to send a single key down or key up event
+        void SendKey(WORD key, bool keyUp)
+        {
+            INPUT input[1] = {};
+            input[0].type = INPUT_KEYBOARD;
+            input[0].ki.wVk = key;
+            input[0].ki.dwFlags = keyUp ? KEYEVENTF_KEYUP : 0;
+            mockedInputHandler.SendVirtualInput(1, input, sizeof(INPUT));
+        }
+
+        // Function to add a large number of shortcut remaps, with all the modifier combinations on letter and digit action keys
+        void AddShortcutRemaps(size_t count)
+        {
+            const std::vector<std::vector<DWORD>> modifierCombinations = {
+                { VK_CONTROL },
+                { VK_MENU },
+                { VK_LWIN },
+                { VK_CONTROL, VK_SHIFT },
+                { VK_CONTROL, VK_MENU },
+                { VK_MENU, VK_SHIFT },
+                { VK_CONTROL, VK_MENU, VK_SHIFT },
+                { VK_LWIN, VK_SHIFT }
+            };
+
+            size_t added = 0;
+            for (DWORD actionKey = 0x30; actionKey <= 0x5A && added < count; actionKey++)
+            {
+                if (actionKey > 0x39 && actionKey < 0x41)
+                {
+                    continue;
+                }
+
+                for (const auto& modifiers : modifierCombinations)
+                {
+                    if (added == count)
+                    {
+                        break;
+                    }
+
+                    Shortcut src;
+                    for (const auto& modifier : modifiers)
+                    {
+                        src.SetKey(modifier);
+                    }
+
+                    src.SetKey(actionKey);
+
+                    Shortcut dest;
+                    dest.SetKey(VK_CONTROL);
+                    dest.SetKey(VK_F1 + static_cast<DWORD>(added % 12));
+                    testState.AddOSLevelShortcut(src, dest);
+                    added++;
+                }
+            }
+        }
+
+        // Function to log the median, 99th percentile and max of the measured latencies
+        static void LogLatencies(const wchar_t* name, std::vector<double>& latencies)
+        {
+            std::sort(latencies.begin(), latencies.end());
+            std::wstring message = std::wstring(name) +
+                                   L": p50 " + std::to_wstring(latencies[latencies.size() / 2]) +
+                                   L" us, p99 " + std::to_wstring(latencies[latencies.size() * 99 / 100]) +
+                                   L" us, max " + std::to_wstring(latencies.back()) + L" us\n";
+            Logger::WriteMessage(message.c_str());
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(InitializeTestEnv)
+        {
+            // Reset test environment
+            TestHelpers::ResetTestEnv(mockedInputHandler, testState);
+
+            // Set HandleOSLevelShortcutRemapEvent as the hook procedure
+            std::function<intptr_t(LowlevelKeyboardEvent*)> currentHookProc = std::bind(&KeyboardEventHandlers::HandleOSLevelShortcutRemapEvent, std::ref(mockedInputHandler), std::placeholders::_1, std::ref(testState));
+            mockedInputHandler.SetHookProc([currentHookProc](LowlevelKeyboardEvent* data) {
+                if (data->lParam->dwExtraInfo != KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG)
+                {
+                    return currentHookProc(data);
+                }
+                else
+                {
+                    return (intptr_t)1;
+                }
+            });
+        }
+
+        // Test if the shortcut with fewer modifiers is invoked when the other modifiers of a larger shortcut with the same action key aren't pressed
+        TEST_METHOD (ShortcutWithFewerModifiers_ShouldBeInvoked_WhenOnlyItsModifiersArePressed)
+        {
+            // Remap Ctrl+A to Ctrl+V and Ctrl+Shift+A to Ctrl+C
+            Shortcut src1;
+            src1.SetKey(VK_CONTROL);
+            src1.SetKey(0x41);
+            Shortcut dest1;
+            dest1.SetKey(VK_CONTROL);
+            dest1.SetKey(0x56);
+            testState.AddOSLevelShortcut(src1, dest1);
+
+            Shortcut src2;
+            src2.SetKey(VK_CONTROL);
+            src2.SetKey(VK_SHIFT);
+            src2.SetKey(0x41);
+            Shortcut dest2;
+            dest2.SetKey(VK_CONTROL);
+            dest2.SetKey(0x43);
+            testState.AddOSLevelShortcut(src2, dest2);
+
+            // Send Ctrl+A keydown
+            SendKey(VK_CONTROL, false);
+            SendKey(0x41, false);
+
+            Assert::IsTrue(testState.IsShortcutRemapInvoked(src1));
+            Assert::IsFalse(testState.IsShortcutRemapInvoked(src2));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x56));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x43));
+
+            // Release the shortcut
+            SendKey(0x41, true);
+            SendKey(VK_CONTROL, true);
+            Assert::IsFalse(testState.CheckShortcutRemapInvoked());
+        }
+
+        // Test if the three key shortcut is invoked over the two key shortcut with the same action key
+        TEST_METHOD (ShortcutWithMoreModifiers_ShouldBeInvoked_WhenAllItsModifiersArePressed)
+        {
+            // Remap Ctrl+A to Ctrl+V and Ctrl+Shift+A to Ctrl+C
+            Shortcut src1;
+            src1.SetKey(VK_CONTROL);
+            src1.SetKey(0x41);
+            Shortcut dest1;
+            dest1.SetKey(VK_CONTROL);
+            dest1.SetKey(0x56);
+            testState.AddOSLevelShortcut(src1, dest1);
+
+            Shortcut src2;
+            src2.SetKey(VK_CONTROL);
+            src2.SetKey(VK_SHIFT);
+            src2.SetKey(0x41);
+            Shortcut dest2;
+            dest2.SetKey(VK_CONTROL);
+            dest2.SetKey(0x43);
+            testState.AddOSLevelShortcut(src2, dest2);
+
+            // Send Ctrl+Shift+A keydown
+            SendKey(VK_CONTROL, false);
+            SendKey(VK_SHIFT, false);
+            SendKey(0x41, false);
+
+            Assert::IsTrue(testState.IsShortcutRemapInvoked(src2));
+            Assert::IsFalse(testState.IsShortcutRemapInvoked(src1));
+            Assert::IsTrue(testState.CheckShortcutRemapInvoked());
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x43));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x56));
+
+            // Release the shortcut
+            SendKey(0x41, true);
+            SendKey(VK_SHIFT, true);
+            SendKey(VK_CONTROL, true);
+
+            Assert::IsFalse(testState.IsShortcutRemapInvoked(src2));
+            Assert::IsFalse(testState.CheckShortcutRemapInvoked());
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_CONTROL));
+        }
+
+        // Test if a remap added after the remap engine was compiled is picked up by the hook once the engine is compiled again, which the test environment does before the next key event
+        TEST_METHOD (RemapEngine_ShouldBeRebuilt_WhenRemapIsAdded)
+        {
+            testState.UpdateDispatchTables();
+
+            // Remap Ctrl+A to Ctrl+V
+            Shortcut src;
+            src.SetKey(VK_CONTROL);
+            src.SetKey(0x41);
+            Shortcut dest;
+            dest.SetKey(VK_CONTROL);
+            dest.SetKey(0x56);
+            testState.AddOSLevelShortcut(src, dest);
+
+            // Send Ctrl+A keydown
+            SendKey(VK_CONTROL, false);
+            SendKey(0x41, false);
+
+            Assert::IsTrue(testState.IsShortcutRemapInvoked(src));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x56));
+        }
+
+        // Test if the scan codes of the single key remaps are only recompiled by a keyboard layout change, and never when the hook reads them
+        TEST_METHOD (ScanCodeTable_ShouldBeRecompiled_OnlyWhenKeyboardLayoutChanges)
+        {
+            // Remap A to Q, which has another scan code on the German layout than on the French one
+            testState.AddSingleKeyRemap(0x41, 0x51);
+            testState.UpdateDispatchTables();
+
+            const HKL germanLayout = LoadKeyboardLayoutW(L"00000407", KLF_NOTELLSHELL);
+            const HKL frenchLayout = LoadKeyboardLayoutW(L"0000040C", KLF_NOTELLSHELL);
+            Assert::IsNotNull(germanLayout);
+            Assert::IsNotNull(frenchLayout);
+
+            testState.UpdateKeyboardLayout(germanLayout);
+            const ScanCodeTable* germanTable = testState.GetScanCodeTable();
+            Assert::IsNotNull(germanTable);
+            Assert::AreEqual((WORD)MapVirtualKeyExW(0x51, MAPVK_VK_TO_VSC, germanLayout), germanTable->scanCodes[0x51]);
+
+            // Reading the table again, or updating with the same layout, keeps the published table
+            Assert::IsTrue(germanTable == testState.GetScanCodeTable());
+            testState.UpdateKeyboardLayout(germanLayout);
+            Assert::IsTrue(germanTable == testState.GetScanCodeTable());
+
+            testState.UpdateKeyboardLayout(frenchLayout);
+            const ScanCodeTable* frenchTable = testState.GetScanCodeTable();
+            Assert::IsNotNull(frenchTable);
+            Assert::AreEqual((WORD)MapVirtualKeyExW(0x51, MAPVK_VK_TO_VSC, frenchLayout), frenchTable->scanCodes[0x51]);
+
+            // The hook sends the remapped key with the published table
+            std::function<intptr_t(LowlevelKeyboardEvent*)> currentHookProc = std::bind(&KeyboardEventHandlers::HandleSingleKeyRemapEvent, std::ref(mockedInputHandler), std::placeholders::_1, std::ref(testState));
+            mockedInputHandler.SetHookProc(currentHookProc);
+            SendKey(0x41, false);
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x51));
+            Assert::IsTrue(frenchTable == testState.GetScanCodeTable());
+            SendKey(0x41, true);
+        }
+
+        // Test if the hook requests a recompile once when the foreground window uses another layout than the scan codes, like after a layout switch inside the same app
+        TEST_METHOD (ScanCodeTable_ShouldRequestRecompileOnce_WhenForegroundLayoutDiffers)
+        {
+            testState.AddSingleKeyRemap(0x41, 0x51);
+            testState.UpdateDispatchTables();
+            std::function<intptr_t(LowlevelKeyboardEvent*)> currentHookProc = std::bind(&KeyboardEventHandlers::HandleSingleKeyRemapEvent, std::ref(mockedInputHandler), std::placeholders::_1, std::ref(testState));
+            mockedInputHandler.SetHookProc(currentHookProc);
+
+            // The scan codes are compiled for the foreground layout, so no recompile is requested
+            SendKey(0x41, false);
+            SendKey(0x41, true);
+            Assert::IsFalse(testState.TakeKeyboardLayoutUpdateRequest());
+
+            // Compile the scan codes for a layout which the foreground window doesn't use
+            const HKL germanLayout = LoadKeyboardLayoutW(L"00000407", KLF_NOTELLSHELL);
+            const HKL frenchLayout = LoadKeyboardLayoutW(L"0000040C", KLF_NOTELLSHELL);
+            testState.UpdateKeyboardLayout(State::GetForegroundKeyboardLayout() == germanLayout ? frenchLayout : germanLayout);
+
+            // The remapped key is still sent, and the recompile is only requested by the first event
+            SendKey(0x41, false);
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x51));
+            SendKey(0x41, true);
+            Assert::IsTrue(testState.TakeKeyboardLayoutUpdateRequest());
+            SendKey(0x41, false);
+            SendKey(0x41, true);
+            Assert::IsFalse(testState.TakeKeyboardLayoutUpdateRequest());
+
+            // Recompiling for the foreground layout clears the mismatch
+            testState.UpdateKeyboardLayout(State::GetForegroundKeyboardLayout());
+            SendKey(0x41, false);
+            SendKey(0x41, true);
+            Assert::IsFalse(testState.TakeKeyboardLayoutUpdateRequest());
+        }
+
+        // Measure the hook latency for unmapped and remapped key events with a large number of shortcut remaps
+        TEST_METHOD (ShortcutRemapHook_Latency_WithManyRemaps)
+        {
+            const size_t remapCount = 200;
+            const int iterations = 2000;
+            AddShortcutRemaps(remapCount);
+            testState.UpdateDispatchTables();
+
+            std::vector<double> unmappedLatencies;
+            std::vector<double> remappedLatencies;
+            unmappedLatencies.reserve(iterations);
+            remappedLatencies.reserve(iterations);
+
+            for (int i = 0; i < iterations; i++)
+            {
+                // Typing an unmapped key should not be affected by the number of remaps
+                auto start = std::chrono::high_resolution_clock::now();
+                SendKey(0x42, false);
+                SendKey(0x42, true);
+                auto end = std::chrono::high_resolution_clock::now();
+                unmappedLatencies.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+
+                SendKey(VK_CONTROL, false);
+                SendKey(VK_MENU, false);
+                SendKey(VK_SHIFT, false);
+                start = std::chrono::high_resolution_clock::now();
+                SendKey(0x35, false);
+                SendKey(0x35, true);
+                end = std::chrono::high_resolution_clock::now();
+                remappedLatencies.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+                SendKey(VK_SHIFT, true);
+                SendKey(VK_MENU, true);
+                SendKey(VK_CONTROL, true);
+
+                Assert::IsFalse(testState.CheckShortcutRemapInvoked());
+            }
+
+            Assert::AreEqual(remapCount, testState.osLevelShortcutReMap.size());
+            LogLatencies(L"Unmapped key down+up", unmappedLatencies);
+            LogLatencies(L"Remapped shortcut action key down+up", remappedLatencies);
+        }
+
+        // Measure the hook latency for single key remaps with all the letter keys remapped
+        TEST_METHOD (SingleKeyRemapHook_Latency_WithManyRemaps)
+        {
+            std::function<intptr_t(LowlevelKeyboardEvent*)> currentHookProc = std::bind(&KeyboardEventHandlers::HandleSingleKeyRemapEvent, std::ref(mockedInputHandler), std::placeholders::_1, std::ref(testState));
+            mockedInputHandler.SetHookProc(currentHookProc);
+
+            // Remap A-Y to the next letter, and Z to Ctrl+V
+            for (DWORD key = 0x41; key < 0x5A; key++)
+            {
+                testState.AddSingleKeyRemap(key, key + 1);
+            }
+
+            Shortcut dest;
+            dest.SetKey(VK_CONTROL);
+            dest.SetKey(0x56);
+            testState.AddSingleKeyRemap(0x5A, dest);
+            testState.UpdateDispatchTables();
+
+            const int iterations = 5000;
+            std::vector<double> remappedLatencies;
+            std::vector<double> shortcutLatencies;
+            std::vector<double> unmappedLatencies;
+            remappedLatencies.reserve(iterations);
+            shortcutLatencies.reserve(iterations);
+            unmappedLatencies.reserve(iterations);
+
+            auto measureKeyPress = [this](WORD key, std::vector<double>& latencies) {
+                auto start = std::chrono::high_resolution_clock::now();
+                SendKey(key, false);
+                SendKey(key, true);
+                auto end = std::chrono::high_resolution_clock::now();
+                latencies.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+            };
+
+            for (int i = 0; i < iterations; i++)
+            {
+                measureKeyPress(0x41, remappedLatencies);
+                Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x42));
+
+                measureKeyPress(0x5A, shortcutLatencies);
+                Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_CONTROL));
+
+                measureKeyPress(0x31, unmappedLatencies);
+            }
+
+            // Check that the remaps are applied
+            SendKey(0x41, false);
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x42));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x41));
+            SendKey(0x41, true);
+            SendKey(0x5A, false);
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(VK_CONTROL));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x56));
+            SendKey(0x5A, true);
+
+            LogLatencies(L"Single key remap to key down+up", remappedLatencies);
+            LogLatencies(L"Single key remap to shortcut down+up", shortcutLatencies);
+            LogLatencies(L"Unmapped key down+up", unmappedLatencies);
+        }
+    };
+}
@@ -0,0 +1,188 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "MockedInput.h"
+#include <keyboardmanager/KeyboardManagerEngineLibrary/StateSnapshot.h>
+#include <keyboardmanager/KeyboardManagerEngineLibrary/KeyboardEventHandlers.h>
+#include "TestHelpers.h"
+#include <common/interop/shared_constants.h>
+
+#include <atomic>
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace RemappingLogicTests
+{
+    // Tests for swapping the state used by the hook when the settings are reloaded
+    TEST_CLASS (StateSnapshotTests)
+    {
+    private:
+        KeyboardManagerInput::MockedInput mockedInputHandler;
+        std::unique_ptr<StateSnapshot> snapshot;
+
+        // Function to create a state with Ctrl+A remapped to Alt+<targetKey>, along with up to 10 other shortcut remaps
+        static std::unique_ptr<State> CreateState(DWORD targetKey, int otherRemapCount = 0)
+        {
+            auto state = std::make_unique<State>();
+
+            Shortcut src;
+            src.SetKey(VK_CONTROL);
+            src.SetKey(0x41);
+            Shortcut dest;
+            dest.SetKey(VK_MENU);
+            dest.SetKey(targetKey);
+            state->AddOSLevelShortcut(src, dest);
+
+            for (int i = 0; i < otherRemapCount; i++)
+            {
+                // Remap Shift+<key> to Ctrl+<key>
+                Shortcut otherSrc;
+                otherSrc.SetKey(VK_SHIFT);
+                otherSrc.SetKey(0x30 + i);
+                Shortcut otherDest;
+                otherDest.SetKey(VK_CONTROL);
+                otherDest.SetKey(0x30 + i);
+                state->AddOSLevelShortcut(otherSrc, otherDest);
+            }
+
+            state->UpdateDispatchTables();
+            return state;
+        }
+
+        // Function to send a key down or key up event
+        void SendKey(WORD key, bool keyUp)
+        {
+            INPUT input[1] = {};
+            input[0].type = INPUT_KEYBOARD;
+            input[0].ki.wVk = key;
+            input[0].ki.dwFlags = keyUp ? KEYEVENTF_KEYUP : 0;
+            mockedInputHandler.SendVirtualInput(1, input, sizeof(INPUT));
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(InitializeTestEnv)
+        {
+            mockedInputHandler.ResetKeyboardState();
+            mockedInputHandler.SetSendVirtualInputTestHandler(nullptr);
+            snapshot = std::make_unique<StateSnapshot>(std::make_unique<State>());
+
+            // Use the state snapshot the same way as the keyboard manager hook procedure
+            mockedInputHandler.SetHookProc([this](LowlevelKeyboardEvent* data) {
+                StateSnapshot::EventScope eventScope(*snapshot);
+                if (data->lParam->dwExtraInfo == KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG)
+                {
+                    return (intptr_t)1;
+                }
+
+                return KeyboardEventHandlers::HandleOSLevelShortcutRemapEvent(mockedInputHandler, data, eventScope.GetState());
+            });
+        }
+
+        TEST_METHOD_CLEANUP(CleanupTestEnv)
+        {
+            mockedInputHandler.SetHookProc(nullptr);
+            snapshot.reset();
+        }
+
+        // Test if a published state is used for the next key event
+        TEST_METHOD (PublishedState_ShouldBeAdopted_OnNextKeyEvent)
+        {
+            snapshot->Publish(CreateState(0x56));
+
+            // Send Ctrl+A keydown
+            SendKey(VK_CONTROL, false);
+            SendKey(0x41, false);
+
+            // Ctrl and A key states should be unchanged, Alt and V key states should be true
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_CONTROL));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x41));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(VK_MENU));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x56));
+        }
+
+        // Test if a published state is only adopted after the invoked shortcut is released
+        TEST_METHOD (PublishedState_ShouldNotBeAdopted_WhileShortcutIsInvoked)
+        {
+            snapshot->Publish(CreateState(0x56));
+
+            // Send Ctrl+A keydown
+            SendKey(VK_CONTROL, false);
+            SendKey(0x41, false);
+            State* invokedState = &snapshot->GetCurrentState();
+
+            // Reload the settings with Ctrl+A remapped to Alt+B
+            snapshot->Publish(CreateState(0x42));
+
+            // Release A then Ctrl. The original state should handle the release so that Alt+V is released
+            SendKey(0x41, true);
+            Assert::IsTrue(invokedState == &snapshot->GetCurrentState());
+            SendKey(VK_CONTROL, true);
+
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_CONTROL));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(VK_MENU));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x56));
+
+            // Send Ctrl+A keydown, the reloaded state should be used
+            SendKey(VK_CONTROL, false);
+            SendKey(0x41, false);
+
+            Assert::IsTrue(invokedState != &snapshot->GetCurrentState());
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(VK_MENU));
+            Assert::AreEqual(true, mockedInputHandler.GetVirtualKeyState(0x42));
+            Assert::AreEqual(false, mockedInputHandler.GetVirtualKeyState(0x56));
+        }
+
+        // Test if remaps keep working while states are continuously reloaded on another thread
+        TEST_METHOD (Remaps_ShouldKeepWorking_WhileSettingsAreReloaded)
+        {
+            snapshot->Publish(CreateState(0x56));
+
+            std::atomic_bool stop = false;
+            std::atomic_int publishedCount = 0;
+            std::thread loader([&]() {
+                for (int i = 0; !stop; i++)
+                {
+                    snapshot->ReclaimRetiredState();
+                    snapshot->Publish(CreateState(0x56, i % 10));
+                    publishedCount++;
+                }
+            });
+
+            int adoptedCount = 0;
+            State* previousState = nullptr;
+            for (int i = 0; i < 5000 || publishedCount < 100; i++)
+            {
+                // Send Ctrl+A keydown
+                SendKey(VK_CONTROL, false);
+                SendKey(0x41, false);
+
+                bool remapped = !mockedInputHandler.GetVirtualKeyState(VK_CONTROL) && !mockedInputHandler.GetVirtualKeyState(0x41) && mockedInputHandler.GetVirtualKeyState(VK_MENU) && mockedInputHandler.GetVirtualKeyState(0x56);
+
+                // Release A then Ctrl
+                SendKey(0x41, true);
+                SendKey(VK_CONTROL, true);
+
+                bool released = !mockedInputHandler.GetVirtualKeyState(VK_CONTROL) && !mockedInputHandler.GetVirtualKeyState(0x41) && !mockedInputHandler.GetVirtualKeyState(VK_MENU) && !mockedInputHandler.GetVirtualKeyState(0x56);
+
+                if (!remapped || !released)
+                {
+                    stop = true;
+                    loader.join();
+                    Assert::Fail((L"Remap failed during reload at iteration " + std::to_wstring(i)).c_str());
+                }
+
+                if (&snapshot->GetCurrentState() != previousState)
+                {
+                    previousState = &snapshot->GetCurrentState();
+                    adoptedCount++;
+                }
+            }
+
+            stop = true;
+            loader.join();
+
+            Logger::WriteMessage((L"Published states: " + std::to_wstring(publishedCount) + L", adopted states: " + std::to_wstring(adoptedCount) + L"\n").c_str());
+            Assert::IsTrue(adoptedCount > 1);
+        }
+    };
+}
@@ -11,15 +11,21 @@ namespace TestHelpers
         input.ResetKeyboardState();
         input.SetHookProc(nullptr);
         input.SetSendVirtualInputTestHandler(nullptr);
+        input.SetForegroundChangeHandler([&input, &state]() { state.UpdateForegroundApp(input); });
+
+        // The keyboard manager compiles the remaps when the settings are loaded. The tests change the remaps directly, so they are compiled before the next key event reaches the hook
+        input.SetMessageLoopHandler([&state]() {
+            if (!state.AreDispatchTablesUpToDate())
+            {
+                state.UpdateDispatchTables();
+            }
+        });
         input.SetForegroundProcess(L"");
         state.ClearSingleKeyRemaps();
         state.ClearOSLevelShortcuts();
         state.ClearAppSpecificShortcuts();
 
-        // Allocate memory for the keyboardManagerState activatedApp member to avoid CRT assert errors
-        std::wstring maxLengthString;
-        maxLengthString.resize(MAX_PATH);
-        state.SetActivatedApp(maxLengthString);
-        state.SetActivatedApp(KeyboardManagerConstants::NoActivatedApp);
+        // Compile the cleared remaps so that no invoked remap is carried over from the previous test
+        state.UpdateDispatchTables();
     }
 }
@@ -230,4 +230,13 @@ namespace Helpers
             return first.Size() > second.Size();
         });
     }
+
+    // Function to insert a shortcut into a vector of shortcuts which is sorted based on size, after the shortcuts of the same size
+    void InsertShortcutSortedBySize(std::vector<Shortcut>& shortcutVector, const Shortcut& shortcut)
+    {
+        auto position = std::upper_bound(shortcutVector.begin(), shortcutVector.end(), shortcut, [](const Shortcut& first, const Shortcut& second) {
+            return first.Size() > second.Size();
+        });
+        shortcutVector.insert(position, shortcut);
+    }
 }
@@ -41,4 +41,7 @@ namespace Helpers
 
     // Function to sort a vector of shortcuts based on it's size
     void SortShortcutVectorBasedOnSize(std::vector<Shortcut>& shortcutVector);
+
+    // Function to insert a shortcut into a vector of shortcuts which is sorted based on size, after the shortcuts of the same size
+    void InsertShortcutSortedBySize(std::vector<Shortcut>& shortcutVector, const Shortcut& shortcut);
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <keyboardmanager/common/InputInterface.h>
 #include <keyboardmanager/common/Helpers.h>
+#include <keyboardmanager/KeyboardManagerEngineCore/KeyStateBitset.h>
 
 namespace KeyboardManagerInput
 {
@@ -26,5 +27,66 @@ namespace KeyboardManagerInput
         {
             foregroundProcess = Helpers::GetCurrentApplication(false);
         }
+
+        // Function to start tracking the key state from the key events. Keys which are already pressed are not seen by the hook, so the state is seeded from the keyboard
+        void StartKeyStateTracking()
+        {
+            ResyncKeyState();
+            isTrackingKeyState = true;
+        }
+
+        // Function to replace the tracked key state with the keyboard state. Used when the hook may have missed key events, e.g. while the secure desktop was active
+        void ResyncKeyState()
+        {
+            trackedKeyState.Reset();
+            for (DWORD key = 1; key < 0xFF; key++)
+            {
+                if (GetVirtualKeyState(key))
+                {
+                    trackedKeyState.Set(key);
+                }
+            }
+
+            trackedKeyState.UpdateGenericModifiers();
+        }
+
+        // Function to replace the tracked state of the modifier keys with the keyboard state. Used by the hook when no remap matched the tracked modifiers, since a modifier key down could have been missed
+        bool ResyncModifierKeyState()
+        {
+            if (!isTrackingKeyState)
+            {
+                return false;
+            }
+
+            const KeyboardManagerCore::KeyStateBitset previousKeyState = trackedKeyState;
+            for (DWORD key : { VK_LWIN, VK_RWIN, VK_LCONTROL, VK_RCONTROL, VK_LMENU, VK_RMENU, VK_LSHIFT, VK_RSHIFT })
+            {
+                trackedKeyState.Set(key, GetVirtualKeyState(key));
+            }
+
+            trackedKeyState.UpdateGenericModifiers();
+            return trackedKeyState != previousKeyState;
+        }
+
+        void StopKeyStateTracking()
+        {
+            isTrackingKeyState = false;
+        }
+
+        // Function to update the tracked key state with a key event which was not suppressed by the hook
+        void TrackKeyEvent(DWORD key, bool keyUp)
+        {
+            trackedKeyState.Update(key, keyUp);
+        }
+
+        // Function to get the key state tracked from the key events, or nullptr if it isn't tracked
+        const KeyboardManagerCore::KeyStateBitset* GetTrackedKeyState()
+        {
+            return isTrackingKeyState ? &trackedKeyState : nullptr;
+        }
+
+    private:
+        KeyboardManagerCore::KeyStateBitset trackedKeyState;
+        bool isTrackingKeyState = false;
     };
 }
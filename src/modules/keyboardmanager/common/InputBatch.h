@@ -0,0 +1,22 @@
+#pragma once
+
+// Fixed capacity array of input events stored on the stack. Used to build the key events which are sent from the keyboard hook without allocating memory
+class InputBatch
+{
+public:
+    // The largest batch sent by the remap handlers releases a shortcut, presses another one and sends a dummy key event, and a shortcut has at most 5 keys
+    static constexpr size_t Capacity = 16;
+
+    InputBatch() = default;
+    InputBatch(const InputBatch&) = delete;
+    InputBatch& operator=(const InputBatch&) = delete;
+
+    // Allows the batch to be passed to the functions which set the key events by index and to SendInput
+    operator LPINPUT() noexcept
+    {
+        return events;
+    }
+
+private:
+    INPUT events[Capacity] = {};
+};
@@ -1,5 +1,10 @@
 #pragma once
 
+namespace KeyboardManagerCore
+{
+    class KeyStateBitset;
+}
+
 namespace KeyboardManagerInput
 {
     // Interface used to wrap keyboard input library methods
@@ -14,5 +19,18 @@ namespace KeyboardManagerInput
 
         // Function to get the foreground process name
         virtual void GetForegroundProcess(_Out_ std::wstring& foregroundProcess) = 0;
+
+        // Function to get the key state tracked from the key events, or nullptr if it isn't tracked. Keys which are not pressed in the tracked state are not pressed,
+        // but a pressed key has to be confirmed with GetVirtualKeyState since a key up could have been missed, e.g. while the secure desktop was active
+        virtual const KeyboardManagerCore::KeyStateBitset* GetTrackedKeyState()
+        {
+            return nullptr;
+        }
+
+        // Function to replace the tracked state of the modifier keys with the keyboard state. Returns true if the tracked state changed
+        virtual bool ResyncModifierKeyState()
+        {
+            return false;
+        }
     };
 }
\ No newline at end of file
@@ -9,12 +9,14 @@
 #include "Shortcut.h"
 #include "RemapShortcut.h"
 #include "Helpers.h"
+#include "RemapConfigurationImage.h"
 
 // Function to clear the OS Level shortcut remapping table
 void MappingConfiguration::ClearOSLevelShortcuts()
 {
     osLevelShortcutReMap.clear();
     osLevelShortcutReMapSortedKeys.clear();
+    remapTablesVersion++;
 }
 
 
@@ -22,6 +24,7 @@ void MappingConfiguration::ClearOSLevelShortcuts()
 void MappingConfiguration::ClearSingleKeyRemaps()
 {
     singleKeyReMap.clear();
+    remapTablesVersion++;
 }
 
 // Function to clear the App specific shortcut remapping table
@@ -29,6 +32,7 @@ void MappingConfiguration::ClearAppSpecificShortcuts()
 {
     appSpecificShortcutReMap.clear();
     appSpecificShortcutReMapSortedKeys.clear();
+    remapTablesVersion++;
 }
 
 // Function to add a new OS level shortcut remapping
@@ -42,8 +46,8 @@ bool MappingConfiguration::AddOSLevelShortcut(const Shortcut& originalSC, const
     }
 
     osLevelShortcutReMap[originalSC] = RemapShortcut(newSC);
-    osLevelShortcutReMapSortedKeys.push_back(originalSC);
-    Helpers::SortShortcutVectorBasedOnSize(osLevelShortcutReMapSortedKeys);
+    Helpers::InsertShortcutSortedBySize(osLevelShortcutReMapSortedKeys, originalSC);
+    remapTablesVersion++;
 
     return true;
 }
@@ -59,6 +63,7 @@ bool MappingConfiguration::AddSingleKeyRemap(const DWORD& originalKey, const Key
     }
 
     singleKeyReMap[originalKey] = newRemapKey;
+    remapTablesVersion++;
     return true;
 }
 
@@ -87,8 +92,8 @@ bool MappingConfiguration::AddAppSpecificShortcut(const std::wstring& app, const
     }
 
     appSpecificShortcutReMap[process_name][originalSC] = RemapShortcut(newSC);
-    appSpecificShortcutReMapSortedKeys[process_name].push_back(originalSC);
-    Helpers::SortShortcutVectorBasedOnSize(appSpecificShortcutReMapSortedKeys[process_name]);
+    Helpers::InsertShortcutSortedBySize(appSpecificShortcutReMapSortedKeys[process_name], originalSC);
+    remapTablesVersion++;
     return true;
 }
 
@@ -262,16 +267,29 @@ bool MappingConfiguration::LoadSettings()
         }
 
         currentConfig = *current_config;
+        const std::wstring configPath = PTSettingsHelper::get_module_save_folder_location(KeyboardManagerConstants::ModuleName) + L"\\" + *current_config;
+
+        // Load the remaps from the image of the config file if it is up to date, which avoids parsing the JSON
+        if (RemapConfigurationImage::LoadFromFile(configPath + RemapConfigurationImage::FileExtension, configPath + L".json", *this))
+        {
+            Logger::trace(L"Loaded the remaps from the configuration image");
+            return true;
+        }
 
         // Read the config file and load the remaps.
-        auto configFile = json::from_file(PTSettingsHelper::get_module_save_folder_location(KeyboardManagerConstants::ModuleName) + L"\\" + *current_config + L".json");
+        auto configFile = json::from_file(configPath + L".json");
         if (!configFile)
         {
             return false;
         }
 
-        bool result = LoadSingleKeyRemaps(*configFile);
-        result = result && LoadShortcutRemaps(*configFile);
+        bool result = LoadRemapsFromJson(*configFile);
+
+        // Regenerate the image so that the next load doesn't have to parse the JSON. Images are only written for configs which loaded without errors, so that the errors are logged on every load
+        if (result)
+        {
+            RemapConfigurationImage::WriteToFile(*this, configPath + RemapConfigurationImage::FileExtension, configPath + L".json");
+        }
 
         return result;
     }
@@ -283,10 +301,17 @@ bool MappingConfiguration::LoadSettings()
     return false;
 }
 
-// Save the updated configuration.
-bool MappingConfiguration::SaveSettingsToFile()
+// Function to load the remap tables from the JSON of a configuration
+bool MappingConfiguration::LoadRemapsFromJson(const json::JsonObject& configJson)
+{
+    bool result = LoadSingleKeyRemaps(configJson);
+    result = result && LoadShortcutRemaps(configJson);
+    return result;
+}
+
+// Function to get the JSON of the remap tables, in the format of the config file
+json::JsonObject MappingConfiguration::GetRemapsJson() const
 {
-    bool result = true;
     json::JsonObject configJson;
     json::JsonObject remapShortcuts;
     json::JsonObject remapKeys;
@@ -364,10 +389,18 @@ bool MappingConfiguration::SaveSettingsToFile()
     remapKeys.SetNamedValue(KeyboardManagerConstants::InProcessRemapKeysSettingName, inProcessRemapKeysArray);
     configJson.SetNamedValue(KeyboardManagerConstants::RemapKeysSettingName, remapKeys);
     configJson.SetNamedValue(KeyboardManagerConstants::RemapShortcutsSettingName, remapShortcuts);
+    return configJson;
+}
+
+// Save the updated configuration.
+bool MappingConfiguration::SaveSettingsToFile()
+{
+    bool result = true;
+    const std::wstring configPath = PTSettingsHelper::get_module_save_folder_location(KeyboardManagerConstants::ModuleName) + L"\\" + currentConfig;
 
     try
     {
-        json::to_file((PTSettingsHelper::get_module_save_folder_location(KeyboardManagerConstants::ModuleName) + L"\\" + currentConfig + L".json"), configJson);
+        json::to_file(configPath + L".json", GetRemapsJson());
     }
     catch (...)
     {
@@ -375,6 +408,12 @@ bool MappingConfiguration::SaveSettingsToFile()
         Logger::error(L"Failed to save the settings");
     }
 
+    // The image is stamped with the JSON file it was written after, so it has to be written before the engine is signaled to reload
+    if (result)
+    {
+        RemapConfigurationImage::WriteToFile(*this, configPath + RemapConfigurationImage::FileExtension, configPath + L".json");
+    }
+
     if (result)
     {
         auto hEvent = CreateEvent(nullptr, false, false, KeyboardManagerConstants::SettingsEventName.c_str());
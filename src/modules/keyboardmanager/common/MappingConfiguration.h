@@ -23,6 +23,12 @@ public:
     // Save the updated configuration.
     bool SaveSettingsToFile();
 
+    // Function to load the remap tables from the JSON of a configuration
+    bool LoadRemapsFromJson(const json::JsonObject& configJson);
+
+    // Function to get the JSON of the remap tables, in the format of the config file
+    json::JsonObject GetRemapsJson() const;
+
     // Function to clear the OS Level shortcut remapping table
     void ClearOSLevelShortcuts();
 
@@ -57,6 +63,9 @@ public:
     // Stores the current configuration name.
     std::wstring currentConfig = KeyboardManagerConstants::DefaultConfiguration;
 
+    // Incremented whenever one of the remap tables is modified. Used to detect stale compiled lookup structures
+    uint64_t remapTablesVersion = 0;
+
 
 private:
     bool LoadSingleKeyRemaps(const json::JsonObject& jsonData);
@@ -0,0 +1,354 @@
+#include "pch.h"
+#include "RemapConfigurationImage.h"
+
+#include <common/logger/logger.h>
+
+#include "MappingConfiguration.h"
+
+namespace RemapConfigurationImage
+{
+    namespace
+    {
+        uint32_t ComputeChecksum(const uint8_t* data, size_t size)
+        {
+            uint32_t hash = 2166136261u;
+            for (size_t i = 0; i < size; i++)
+            {
+                hash ^= data[i];
+                hash *= 16777619u;
+            }
+
+            return hash;
+        }
+
+        ShortcutRecord ToRecord(const Shortcut& shortcut)
+        {
+            return ShortcutRecord{
+                .winKey = static_cast<uint8_t>(shortcut.winKey),
+                .ctrlKey = static_cast<uint8_t>(shortcut.ctrlKey),
+                .altKey = static_cast<uint8_t>(shortcut.altKey),
+                .shiftKey = static_cast<uint8_t>(shortcut.shiftKey),
+                .actionKey = shortcut.actionKey
+            };
+        }
+
+        TargetRecord ToRecord(const KeyShortcutUnion& target)
+        {
+            TargetRecord record{};
+            if (target.index() == 0)
+            {
+                record.key = std::get<DWORD>(target);
+            }
+            else
+            {
+                record.isShortcut = 1;
+                record.shortcut = ToRecord(std::get<Shortcut>(target));
+            }
+
+            return record;
+        }
+
+        bool IsValidModifier(uint8_t modifier)
+        {
+            return modifier <= static_cast<uint8_t>(ModifierKey::Both);
+        }
+
+        std::optional<Shortcut> FromRecord(const ShortcutRecord& record)
+        {
+            if (!IsValidModifier(record.winKey) || !IsValidModifier(record.ctrlKey) || !IsValidModifier(record.altKey) || !IsValidModifier(record.shiftKey))
+            {
+                return std::nullopt;
+            }
+
+            Shortcut shortcut;
+            shortcut.winKey = static_cast<ModifierKey>(record.winKey);
+            shortcut.ctrlKey = static_cast<ModifierKey>(record.ctrlKey);
+            shortcut.altKey = static_cast<ModifierKey>(record.altKey);
+            shortcut.shiftKey = static_cast<ModifierKey>(record.shiftKey);
+            shortcut.actionKey = record.actionKey;
+            return shortcut;
+        }
+
+        std::optional<KeyShortcutUnion> FromRecord(const TargetRecord& record)
+        {
+            if (!record.isShortcut)
+            {
+                return KeyShortcutUnion{ static_cast<DWORD>(record.key) };
+            }
+
+            auto shortcut = FromRecord(record.shortcut);
+            if (!shortcut)
+            {
+                return std::nullopt;
+            }
+
+            return KeyShortcutUnion{ *shortcut };
+        }
+
+        template<typename T>
+        void Append(std::vector<uint8_t>& image, const T& value)
+        {
+            const auto bytes = reinterpret_cast<const uint8_t*>(&value);
+            image.insert(image.end(), bytes, bytes + sizeof(T));
+        }
+    }
+
+    // Function to get the stamp of a file, or nullopt if it can't be read
+    std::optional<SourceStamp> GetSourceStamp(const std::wstring& filePath)
+    {
+        WIN32_FILE_ATTRIBUTE_DATA attributes;
+        if (!GetFileAttributesExW(filePath.c_str(), GetFileExInfoStandard, &attributes))
+        {
+            return std::nullopt;
+        }
+
+        return SourceStamp{
+            .fileSize = (static_cast<uint64_t>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow,
+            .lastWriteTime = (static_cast<uint64_t>(attributes.ftLastWriteTime.dwHighDateTime) << 32) | attributes.ftLastWriteTime.dwLowDateTime
+        };
+    }
+
+    // Function to serialize the remap tables of the configuration into an image
+    std::vector<uint8_t> Serialize(const MappingConfiguration& mappingConfiguration, const SourceStamp& source)
+    {
+        std::vector<SingleKeyRemapRecord> singleKeyRemaps;
+        singleKeyRemaps.reserve(mappingConfiguration.singleKeyReMap.size());
+        for (const auto& [originalKey, target] : mappingConfiguration.singleKeyReMap)
+        {
+            singleKeyRemaps.push_back({ .originalKey = originalKey, .target = ToRecord(target) });
+        }
+
+        std::vector<ShortcutRemapRecord> shortcutRemaps;
+        for (const auto& shortcut : mappingConfiguration.osLevelShortcutReMapSortedKeys)
+        {
+            shortcutRemaps.push_back({ .originalShortcut = ToRecord(shortcut), .target = ToRecord(mappingConfiguration.osLevelShortcutReMap.at(shortcut).targetShortcut), .appIndex = NoApp });
+        }
+
+        std::vector<AppRecord> apps;
+        std::wstring stringTable;
+        for (const auto& [app, sortedKeys] : mappingConfiguration.appSpecificShortcutReMapSortedKeys)
+        {
+            const auto& remapTable = mappingConfiguration.appSpecificShortcutReMap.at(app);
+            const auto appIndex = static_cast<uint32_t>(apps.size());
+            apps.push_back({ .nameOffset = static_cast<uint32_t>(stringTable.size()), .nameLength = static_cast<uint32_t>(app.size()) });
+            stringTable += app;
+
+            for (const auto& shortcut : sortedKeys)
+            {
+                shortcutRemaps.push_back({ .originalShortcut = ToRecord(shortcut), .target = ToRecord(remapTable.at(shortcut).targetShortcut), .appIndex = appIndex });
+            }
+        }
+
+        FileHeader header{
+            .magic = Magic,
+            .version = CurrentVersion,
+            .headerSize = sizeof(FileHeader),
+            .checksum = 0,
+            .source = source,
+            .singleKeyRemapCount = static_cast<uint32_t>(singleKeyRemaps.size()),
+            .shortcutRemapCount = static_cast<uint32_t>(shortcutRemaps.size()),
+            .appCount = static_cast<uint32_t>(apps.size()),
+            .stringTableLength = static_cast<uint32_t>(stringTable.size())
+        };
+
+        std::vector<uint8_t> image;
+        image.reserve(sizeof(FileHeader) + singleKeyRemaps.size() * sizeof(SingleKeyRemapRecord) + shortcutRemaps.size() * sizeof(ShortcutRemapRecord) + apps.size() * sizeof(AppRecord) + stringTable.size() * sizeof(wchar_t));
+        Append(image, header);
+        for (const auto& record : singleKeyRemaps)
+        {
+            Append(image, record);
+        }
+
+        for (const auto& record : shortcutRemaps)
+        {
+            Append(image, record);
+        }
+
+        for (const auto& record : apps)
+        {
+            Append(image, record);
+        }
+
+        const auto stringBytes = reinterpret_cast<const uint8_t*>(stringTable.data());
+        image.insert(image.end(), stringBytes, stringBytes + stringTable.size() * sizeof(wchar_t));
+
+        header.checksum = ComputeChecksum(image.data() + sizeof(FileHeader), image.size() - sizeof(FileHeader));
+        memcpy(image.data(), &header, sizeof(FileHeader));
+        return image;
+    }
+
+    // Function to replace the remap tables of the configuration with the ones in the image
+    bool Deserialize(const uint8_t* data, size_t size, const SourceStamp& source, MappingConfiguration& mappingConfiguration)
+    {
+        if (size < sizeof(FileHeader))
+        {
+            return false;
+        }
+
+        FileHeader header;
+        memcpy(&header, data, sizeof(FileHeader));
+        if (header.magic != Magic || header.version != CurrentVersion || header.headerSize != sizeof(FileHeader) || header.source != source)
+        {
+            return false;
+        }
+
+        const uint64_t expectedSize = sizeof(FileHeader) +
+                                      static_cast<uint64_t>(header.singleKeyRemapCount) * sizeof(SingleKeyRemapRecord) +
+                                      static_cast<uint64_t>(header.shortcutRemapCount) * sizeof(ShortcutRemapRecord) +
+                                      static_cast<uint64_t>(header.appCount) * sizeof(AppRecord) +
+                                      static_cast<uint64_t>(header.stringTableLength) * sizeof(wchar_t);
+        if (expectedSize != size || ComputeChecksum(data + sizeof(FileHeader), size - sizeof(FileHeader)) != header.checksum)
+        {
+            return false;
+        }
+
+        // The records are copied out of the image since a mapped file isn't guaranteed to keep the alignment of the structures
+        const uint8_t* position = data + sizeof(FileHeader);
+        auto read = [&position]<typename T>(T& value) {
+            memcpy(&value, position, sizeof(T));
+            position += sizeof(T);
+        };
+
+        // The tables are built separately so that the configuration is unchanged if a record is invalid
+        SingleKeyRemapTable singleKeyReMap;
+        singleKeyReMap.reserve(header.singleKeyRemapCount);
+        for (uint32_t i = 0; i < header.singleKeyRemapCount; i++)
+        {
+            SingleKeyRemapRecord record;
+            read(record);
+            auto target = FromRecord(record.target);
+            if (!target)
+            {
+                return false;
+            }
+
+            singleKeyReMap.emplace(record.originalKey, *target);
+        }
+
+        const uint8_t* shortcutRemapRecords = position;
+        position += static_cast<size_t>(header.shortcutRemapCount) * sizeof(ShortcutRemapRecord);
+
+        std::vector<std::wstring> appNames;
+        appNames.reserve(header.appCount);
+        const auto stringTable = reinterpret_cast<const uint8_t*>(position + static_cast<size_t>(header.appCount) * sizeof(AppRecord));
+        for (uint32_t i = 0; i < header.appCount; i++)
+        {
+            AppRecord record;
+            read(record);
+            if (static_cast<uint64_t>(record.nameOffset) + record.nameLength > header.stringTableLength)
+            {
+                return false;
+            }
+
+            std::wstring appName(record.nameLength, L'\0');
+            memcpy(appName.data(), stringTable + static_cast<size_t>(record.nameOffset) * sizeof(wchar_t), record.nameLength * sizeof(wchar_t));
+            appNames.push_back(std::move(appName));
+        }
+
+        ShortcutRemapTable osLevelShortcutReMap;
+        std::vector<Shortcut> osLevelShortcutReMapSortedKeys;
+        AppSpecificShortcutRemapTable appSpecificShortcutReMap;
+        std::map<std::wstring, std::vector<Shortcut>> appSpecificShortcutReMapSortedKeys;
+        position = shortcutRemapRecords;
+        for (uint32_t i = 0; i < header.shortcutRemapCount; i++)
+        {
+            ShortcutRemapRecord record;
+            read(record);
+            auto originalShortcut = FromRecord(record.originalShortcut);
+            auto target = FromRecord(record.target);
+            if (!originalShortcut || !target || (record.appIndex != NoApp && record.appIndex >= appNames.size()))
+            {
+                return false;
+            }
+
+            // The records are already in priority order, so the sorted key vectors don't have to be sorted again
+            if (record.appIndex == NoApp)
+            {
+                osLevelShortcutReMap.emplace(*originalShortcut, RemapShortcut(*target));
+                osLevelShortcutReMapSortedKeys.push_back(*originalShortcut);
+            }
+            else
+            {
+                const auto& appName = appNames[record.appIndex];
+                appSpecificShortcutReMap[appName].emplace(*originalShortcut, RemapShortcut(*target));
+                appSpecificShortcutReMapSortedKeys[appName].push_back(*originalShortcut);
+            }
+        }
+
+        mappingConfiguration.singleKeyReMap = std::move(singleKeyReMap);
+        mappingConfiguration.osLevelShortcutReMap = std::move(osLevelShortcutReMap);
+        mappingConfiguration.osLevelShortcutReMapSortedKeys = std::move(osLevelShortcutReMapSortedKeys);
+        mappingConfiguration.appSpecificShortcutReMap = std::move(appSpecificShortcutReMap);
+        mappingConfiguration.appSpecificShortcutReMapSortedKeys = std::move(appSpecificShortcutReMapSortedKeys);
+        mappingConfiguration.remapTablesVersion++;
+        return true;
+    }
+
+    // Function to write the image of the remap tables, produced from the given JSON file
+    bool WriteToFile(const MappingConfiguration& mappingConfiguration, const std::wstring& imagePath, const std::wstring& sourcePath)
+    {
+        auto source = GetSourceStamp(sourcePath);
+        if (!source)
+        {
+            return false;
+        }
+
+        const auto image = Serialize(mappingConfiguration, *source);
+        const std::wstring temporaryPath = imagePath + L".tmp";
+        HANDLE file = CreateFileW(temporaryPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            Logger::error(L"Failed to create the remap configuration image {}", temporaryPath);
+            return false;
+        }
+
+        DWORD written = 0;
+        const bool writeResult = WriteFile(file, image.data(), static_cast<DWORD>(image.size()), &written, nullptr) && written == image.size();
+        CloseHandle(file);
+
+        if (!writeResult || !MoveFileExW(temporaryPath.c_str(), imagePath.c_str(), MOVEFILE_REPLACE_EXISTING))
+        {
+            Logger::error(L"Failed to write the remap configuration image {}", imagePath);
+            DeleteFileW(temporaryPath.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    // Function to load the remap tables from the image file by mapping it into memory
+    bool LoadFromFile(const std::wstring& imagePath, const std::wstring& sourcePath, MappingConfiguration& mappingConfiguration)
+    {
+        auto source = GetSourceStamp(sourcePath);
+        if (!source)
+        {
+            return false;
+        }
+
+        HANDLE file = CreateFileW(imagePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        bool result = false;
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart >= sizeof(FileHeader))
+        {
+            HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping)
+            {
+                if (auto view = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)))
+                {
+                    result = Deserialize(view, static_cast<size_t>(fileSize.QuadPart), *source, mappingConfiguration);
+                    UnmapViewOfFile(view);
+                }
+
+                CloseHandle(mapping);
+            }
+        }
+
+        CloseHandle(file);
+        return result;
+    }
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+class MappingConfiguration;
+
+// Binary image of the remap tables of a configuration. It is written next to the JSON configuration when the configuration is saved, and loaded by mapping it into memory,
+// so that the remap tables can be built without parsing the JSON. The image is stamped with the size and last write time of the JSON file it was produced from and is ignored when it doesn't match
+namespace RemapConfigurationImage
+{
+    inline const uint32_t Magic = 0x434D424B; // "KBMC"
+    inline const uint32_t CurrentVersion = 1;
+
+    // Extension of the image file, which is stored next to <configuration>.json
+    inline const std::wstring FileExtension = L".kbmc";
+
+    // Identifies the version of the JSON file an image was produced from
+    struct SourceStamp
+    {
+        uint64_t fileSize = 0;
+        uint64_t lastWriteTime = 0;
+
+        bool operator==(const SourceStamp&) const = default;
+    };
+
+    struct FileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t headerSize;
+
+        // FNV-1a hash of everything after the header
+        uint32_t checksum;
+
+        SourceStamp source;
+
+        uint32_t singleKeyRemapCount;
+        uint32_t shortcutRemapCount;
+        uint32_t appCount;
+
+        // Length of the app name string table in characters
+        uint32_t stringTableLength;
+    };
+
+    // Modifiers are stored as the values of ModifierKey, one byte each
+    struct ShortcutRecord
+    {
+        uint8_t winKey;
+        uint8_t ctrlKey;
+        uint8_t altKey;
+        uint8_t shiftKey;
+        uint32_t actionKey;
+    };
+
+    struct TargetRecord
+    {
+        uint32_t isShortcut;
+        uint32_t key;
+        ShortcutRecord shortcut;
+    };
+
+    struct SingleKeyRemapRecord
+    {
+        uint32_t originalKey;
+        TargetRecord target;
+    };
+
+    // Shortcut remaps are stored in the priority order of the sorted key vectors, the os level remaps first and then the remaps of each app
+    struct ShortcutRemapRecord
+    {
+        ShortcutRecord originalShortcut;
+        TargetRecord target;
+
+        // Index of the app record, or NoApp for os level remaps
+        uint32_t appIndex;
+    };
+
+    inline const uint32_t NoApp = 0xFFFFFFFF;
+
+    // App names are lower case and stored in the string table, without null terminators
+    struct AppRecord
+    {
+        uint32_t nameOffset;
+        uint32_t nameLength;
+    };
+
+    static_assert(sizeof(FileHeader) == 48);
+    static_assert(sizeof(ShortcutRecord) == 8);
+    static_assert(sizeof(TargetRecord) == 16);
+    static_assert(sizeof(SingleKeyRemapRecord) == 20);
+    static_assert(sizeof(ShortcutRemapRecord) == 28);
+    static_assert(sizeof(AppRecord) == 8);
+
+    // Function to get the stamp of a file, or nullopt if it can't be read
+    std::optional<SourceStamp> GetSourceStamp(const std::wstring& filePath);
+
+    // Function to serialize the remap tables of the configuration into an image
+    std::vector<uint8_t> Serialize(const MappingConfiguration& mappingConfiguration, const SourceStamp& source);
+
+    // Function to replace the remap tables of the configuration with the ones in the image. Returns false without modifying the configuration if the image is corrupted, has another version, or wasn't produced from the given source
+    bool Deserialize(const uint8_t* data, size_t size, const SourceStamp& source, MappingConfiguration& mappingConfiguration);
+
+    // Function to write the image of the remap tables, produced from the given JSON file. The image is written to a temporary file first so that a reader never maps a partially written image
+    bool WriteToFile(const MappingConfiguration& mappingConfiguration, const std::wstring& imagePath, const std::wstring& sourcePath);
+
+    // Function to load the remap tables from the image file by mapping it into memory. Returns false if the image doesn't exist or is stale, in which case the JSON file has to be loaded
+    bool LoadFromFile(const std::wstring& imagePath, const std::wstring& sourcePath, MappingConfiguration& mappingConfiguration);
+}
@@ -456,26 +456,7 @@ winrt::hstring Shortcut::ToHstringVK() const
 std::vector<DWORD> Shortcut::GetKeyCodes()
 {
     std::vector<DWORD> keys;
-    if (winKey != ModifierKey::Disabled)
-    {
-        keys.push_back(GetWinKey(ModifierKey::Both));
-    }
-    if (ctrlKey != ModifierKey::Disabled)
-    {
-        keys.push_back(GetCtrlKey());
-    }
-    if (altKey != ModifierKey::Disabled)
-    {
-        keys.push_back(GetAltKey());
-    }
-    if (shiftKey != ModifierKey::Disabled)
-    {
-        keys.push_back(GetShiftKey());
-    }
-    if (actionKey != NULL)
-    {
-        keys.push_back(actionKey);
-    }
+    ForEachKeyCode([&keys](DWORD key) { keys.push_back(key); });
     return keys;
 }
 
@@ -816,3 +797,33 @@ int Shortcut::GetCommonModifiersCount(const Shortcut& input) const
 
     return commonElements;
 }
+
+namespace
+{
+    KeyboardManagerCore::ModifierSide ToModifierSide(ModifierKey modifier)
+    {
+        switch (modifier)
+        {
+        case ModifierKey::Left:
+            return KeyboardManagerCore::ModifierSide::Left;
+        case ModifierKey::Right:
+            return KeyboardManagerCore::ModifierSide::Right;
+        case ModifierKey::Both:
+            return KeyboardManagerCore::ModifierSide::Both;
+        default:
+            return KeyboardManagerCore::ModifierSide::None;
+        }
+    }
+}
+
+// Function to convert the shortcut to the equivalent engine core chord
+KeyboardManagerCore::Chord Shortcut::ToChord() const
+{
+    KeyboardManagerCore::Chord chord;
+    chord.win = ToModifierSide(winKey);
+    chord.ctrl = ToModifierSide(ctrlKey);
+    chord.alt = ToModifierSide(altKey);
+    chord.shift = ToModifierSide(shiftKey);
+    chord.actionKey = actionKey;
+    return chord;
+}
@@ -2,6 +2,8 @@
 #include "ModifierKey.h"
 #include <variant>
 
+#include <keyboardmanager/KeyboardManagerEngineCore/Chord.h>
+
 namespace KeyboardManagerInput
 {
     class InputInterface;
@@ -149,6 +151,32 @@ public:
     // Function to return a vector of key codes in the display order
     std::vector<DWORD> GetKeyCodes();
 
+    // Function to call the callback with each key code in the display order. Unlike GetKeyCodes it doesn't allocate memory, so it can be used in the keyboard hook
+    template<typename Callback>
+    void ForEachKeyCode(Callback&& callback) const
+    {
+        if (winKey != ModifierKey::Disabled)
+        {
+            callback(GetWinKey(ModifierKey::Both));
+        }
+        if (ctrlKey != ModifierKey::Disabled)
+        {
+            callback(GetCtrlKey());
+        }
+        if (altKey != ModifierKey::Disabled)
+        {
+            callback(GetAltKey());
+        }
+        if (shiftKey != ModifierKey::Disabled)
+        {
+            callback(GetShiftKey());
+        }
+        if (actionKey != NULL)
+        {
+            callback(actionKey);
+        }
+    }
+
     // Function to set a shortcut from a vector of key codes
     void SetKeyCodes(const std::vector<int32_t>& keys);
 
@@ -160,6 +188,9 @@ public:
 
     // Function to get the number of modifiers that are common between the current shortcut and the shortcut in the argument
     int GetCommonModifiersCount(const Shortcut& input) const;
+
+    // Function to convert the shortcut to the equivalent engine core chord
+    KeyboardManagerCore::Chord ToChord() const;
 };
 
 using KeyShortcutUnion = std::variant<DWORD, Shortcut>;
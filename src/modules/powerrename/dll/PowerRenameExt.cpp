@@ -11,6 +11,7 @@
 
 #include <common/utils/resources.h>
 #include <common/utils/process_path.h>
+#include <common/utils/profiler.h>
 
 extern HINSTANCE g_hInst;
 
@@ -183,6 +184,10 @@ DWORD WINAPI CPowerRenameMenu::s_PowerRenameUIThreadProc(_In_ void* pData)
                         {
                             ModuleRelease();
                         }
+                        // The listener runs while the dialog is shown, so that it's never destroyed while the DLL is unloaded
+                        Profiler::ExportListener profilerExportListener(L"PowerRename");
+                        Profiler::RegisterCurrentThread();
+
                         // Call blocks until we are done
                         spsrui->Show(pInvokeData->hwndParent);
                         spsrui->Close();
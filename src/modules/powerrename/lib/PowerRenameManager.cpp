@@ -8,6 +8,7 @@
 #include <filesystem>
 #include "trace.h"
 #include <winrt/base.h>
+#include <common/utils/profiler.h>
 
 namespace fs = std::filesystem;
 
@@ -834,10 +835,12 @@ DWORD WINAPI CPowerRenameManager::s_regexWorkerThread(_In_ void* pv)
         if (pwtd)
         {
             PostMessage(pwtd->hwndManager, SRM_REGEX_STARTED, GetCurrentThreadId(), 0);
+            Profiler::RegisterCurrentThread();
 
             // Wait to be told we can begin
             if (WaitForSingleObject(pwtd->startEvent, INFINITE) == WAIT_OBJECT_0)
             {
+                POWERTOYS_PROFILE_SCOPE("PowerRename.RegExPreview");
                 CComPtr<IPowerRenameRegEx> spRenameRegEx;
 
                 winrt::check_hresult(pwtd->spsrm->GetRenameRegEx(&spRenameRegEx));
@@ -860,6 +863,8 @@ DWORD WINAPI CPowerRenameManager::s_regexWorkerThread(_In_ void* pv)
                 winrt::check_hresult(pwtd->spsrm->GetItemCount(&itemCount));
                 for (UINT u = 0; u < itemCount; u++)
                 {
+                    POWERTOYS_PROFILE_SCOPE("PowerRename.RegExPreviewItem");
+
                     // Check if cancel event is signaled
                     if (WaitForSingleObject(pwtd->cancelEvent, 0) == WAIT_OBJECT_0)
                     {
@@ -4,6 +4,7 @@
 
 #include <common/utils/resources.h>
 #include <common/display/dpi_aware.h>
+#include <common/utils/profiler.h>
 #include <commctrl.h>
 #include <Shlobj.h>
 #include <helpers.h>
@@ -185,6 +186,7 @@ IFACEMETHODIMP CPowerRenameUI::OnItemAdded(_In_ IPowerRenameItem*)
 
 IFACEMETHODIMP CPowerRenameUI::OnUpdate(_In_ IPowerRenameItem*)
 {
+    POWERTOYS_PROFILE_SCOPE("PowerRename.UpdatePreview");
     UINT visibleItemCount = 0;
     if (m_spsrm)
     {
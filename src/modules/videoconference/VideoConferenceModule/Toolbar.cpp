@@ -137,6 +137,10 @@ LRESULT Toolbar::WindowProcessMessages(HWND hwnd, UINT msg, WPARAM wparam, LPARA
         }
 
         toolbar->cameraInUse = VideoConferenceModule::getVirtualCameraInUse();
+        if (toolbar->cameraInUse)
+        {
+            instance->updateOverlayFrame();
+        }
 
         InvalidateRect(hwnd, NULL, NULL);
 
@@ -15,6 +15,7 @@
 #include <common/utils/process_path.h>
 
 #include <CameraStateUpdateChannels.h>
+#include <ImageLoading.h>
 
 #include "logging.h"
 #include "trace.h"
@@ -28,6 +29,11 @@ Toolbar VideoConferenceModule::toolbar;
 
 HHOOK VideoConferenceModule::hook_handle;
 
+namespace
+{
+    constexpr float overlayFrameJpgQuality = 0.5f;
+}
+
 IAudioEndpointVolume* endpointVolume = NULL;
 
 bool VideoConferenceModule::isKeyPressed(unsigned int keyCode)
@@ -79,6 +85,7 @@ void VideoConferenceModule::reverseVirtualCameraMuteState()
         auto settings = reinterpret_cast<CameraSettingsUpdateChannel*>(settingsMemory._data);
         settings->useOverlayImage = !settings->useOverlayImage;
         muted = settings->useOverlayImage;
+        settings->settingsVersion++;
     });
 
     if (muted)
@@ -275,6 +282,8 @@ VideoConferenceModule::VideoConferenceModule() :
     _moduleSettingsWatcher{ PTSettingsHelper::get_module_save_file_location(get_key()), [this] { toolbar.scheduleModuleSettingsUpdate(); } }
 {
     init_settings();
+    // The versions of the overlay frames differ from the ones of a previous run, which a proxy filter can still have open
+    _overlayFrameVersion = GetTickCount();
     _settingsUpdateChannel =
         SerializedSharedMemory::create(CameraSettingsUpdateChannel::endpoint(), sizeof(CameraSettingsUpdateChannel), false);
     if (_settingsUpdateChannel)
@@ -537,16 +546,16 @@ void VideoConferenceModule::sendSourceCameraNameUpdate()
         auto updatesChannel = reinterpret_cast<CameraSettingsUpdateChannel*>(memory._data);
         updatesChannel->sourceCameraName.emplace();
         std::copy(begin(settings.selectedCamera), end(settings.selectedCamera), begin(*updatesChannel->sourceCameraName));
+        updatesChannel->settingsVersion++;
     });
 }
 
-void VideoConferenceModule::sendOverlayImageUpdate()
+std::wstring VideoConferenceModule::getOverlayImagePath()
 {
-    if (!_settingsUpdateChannel.has_value())
+    if (settings.imageOverlayPath != L"")
     {
-        return;
+        return settings.imageOverlayPath;
     }
-    _imageOverlayChannel.reset();
 
     wchar_t powertoysDirectory[MAX_PATH + 1];
 
@@ -555,14 +564,102 @@ void VideoConferenceModule::sendOverlayImageUpdate()
 
     std::wstring blankImagePath(powertoysDirectory);
     blankImagePath += L"\\modules\\VideoConference\\black.bmp";
+    return blankImagePath;
+}
+
+void VideoConferenceModule::sendOverlayImageUpdate()
+{
+    if (!_settingsUpdateChannel.has_value())
+    {
+        return;
+    }
+    _imageOverlayChannel.reset();
 
-    _imageOverlayChannel = SerializedSharedMemory::create_readonly(CameraOverlayImageChannel::endpoint(),
-                                                                   settings.imageOverlayPath != L"" ? settings.imageOverlayPath : blankImagePath);
+    _imageOverlayChannel = SerializedSharedMemory::create_readonly(CameraOverlayImageChannel::endpoint(), getOverlayImagePath());
 
     const auto imageSize = static_cast<uint32_t>(_imageOverlayChannel->size());
     _settingsUpdateChannel->access([imageSize](auto memory) {
         auto updatesChannel = reinterpret_cast<CameraSettingsUpdateChannel*>(memory._data);
         updatesChannel->overlayImageSize.emplace(imageSize);
         updatesChannel->newOverlayImagePosted = true;
+        updatesChannel->overlayFrame.reset();
+        updatesChannel->settingsVersion++;
+    });
+
+    // Convert the new image for the camera which is in use, if any
+    _overlayFrameDescription.reset();
+    updateOverlayFrame();
+}
+
+// Converts the overlay image to the frame format requested by the proxy filter, and publishes it in a new shared memory slot which
+// the filter maps and copies into the camera frames as is. Called periodically while the camera is in use
+void VideoConferenceModule::updateOverlayFrame()
+{
+    if (!_settingsUpdateChannel.has_value())
+    {
+        return;
+    }
+
+    std::optional<OverlayFrameDescription> request;
+    _settingsUpdateChannel->access([&request](auto memory) {
+        auto updatesChannel = reinterpret_cast<CameraSettingsUpdateChannel*>(memory._data);
+        request = updatesChannel->overlayFrameRequest;
+    });
+
+    // Each image is converted once per format, also when the conversion failed. The filter decodes the image itself then
+    if (!request || request == _overlayFrameDescription)
+    {
+        return;
+    }
+    _overlayFrameDescription = request;
+
+    wil::com_ptr_nothrow<IStream> image;
+    if (FAILED(SHCreateStreamOnFileEx(getOverlayImagePath().c_str(), STGM_READ, FILE_ATTRIBUTE_NORMAL, FALSE, nullptr, &image)))
+    {
+        LOG("VideoConferenceModule::updateOverlayFrame FAILED to open the overlay image");
+        return;
+    }
+
+    auto mediaType = CreateOverlayFrameMediaType(*request);
+    wil::com_ptr_nothrow<IMFSample> frame;
+    if (mediaType)
+    {
+        frame = LoadImageAsSample(image, mediaType.get(), overlayFrameJpgQuality);
+    }
+
+    wil::com_ptr_nothrow<IMFMediaBuffer> frameBuffer;
+    if (!frame || FAILED(frame->ConvertToContiguousBuffer(&frameBuffer)))
+    {
+        LOG("VideoConferenceModule::updateOverlayFrame FAILED to convert the overlay image");
+        return;
+    }
+
+    BYTE* frameData = nullptr;
+    DWORD maxLength = 0, frameSize = 0;
+    if (FAILED(frameBuffer->Lock(&frameData, &maxLength, &frameSize)))
+    {
+        return;
+    }
+    auto unlockFrameBuffer = wil::scope_exit([&frameBuffer] { frameBuffer->Unlock(); });
+
+    const uint32_t version = ++_overlayFrameVersion;
+    auto frameChannel = SerializedSharedMemory::create(CameraOverlayFrameChannel::endpoint(version), frameSize, false);
+    if (!frameChannel)
+    {
+        LOG("VideoConferenceModule::updateOverlayFrame FAILED to create the overlay frame shared memory");
+        return;
+    }
+
+    frameChannel->access([frameData, frameSize](auto memory) {
+        std::copy(frameData, frameData + frameSize, memory._data);
+    });
+
+    // The filter keeps its own mapping of the previous frame until it opened this one
+    _overlayFrameChannel = std::move(frameChannel);
+    const OverlayFrameSlot slot{ *request, version, static_cast<uint32_t>(frameSize) };
+    _settingsUpdateChannel->access([&slot](auto memory) {
+        auto updatesChannel = reinterpret_cast<CameraSettingsUpdateChannel*>(memory._data);
+        updatesChannel->overlayFrame = slot;
+        updatesChannel->settingsVersion++;
     });
 }
@@ -12,6 +12,7 @@
 
 #include "Toolbar.h"
 
+#include <CameraStateUpdateChannels.h>
 #include <SerializedSharedMemory.h>
 
 extern class VideoConferenceModule* instance;
@@ -50,6 +51,7 @@ public:
 
     void sendSourceCameraNameUpdate();
     void sendOverlayImageUpdate();
+    void updateOverlayFrame();
 
     static void unmuteAll();
     static void reverseMicrophoneMute();
@@ -63,6 +65,7 @@ public:
 private:
 
     void init_settings();
+    static std::wstring getOverlayImagePath();
     void updateControlledMicrophones(const std::wstring_view new_mic);
     //  all callback methods and used by callback have to be static
     static LRESULT CALLBACK LowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam);
@@ -78,6 +81,11 @@ private:
     std::optional<SerializedSharedMemory> _imageOverlayChannel;
     std::optional<SerializedSharedMemory> _settingsUpdateChannel;
 
+    // The overlay image converted to the frame format requested by the proxy filter
+    std::optional<SerializedSharedMemory> _overlayFrameChannel;
+    std::optional<OverlayFrameDescription> _overlayFrameDescription;
+    uint32_t _overlayFrameVersion = 0;
+
     FileWatcher _generalSettingsWatcher;
     FileWatcher _moduleSettingsWatcher;
 
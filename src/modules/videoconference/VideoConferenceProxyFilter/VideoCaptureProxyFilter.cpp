@@ -1,6 +1,7 @@
 #include "VideoCaptureProxyFilter.h"
 
 #include "VideoCaptureDevice.h"
+#include <ImageLoading.h>
 #include <mfidl.h>
 #include <Shlwapi.h>
 #include <mfapi.h>
@@ -13,6 +14,12 @@ constexpr static inline wchar_t VENDOR[] = L"Microsoft Corporation";
 namespace
 {
     constexpr float initialJpgQuality = 0.5f;
+
+    // The settings are read again when the module changed them, and also at this interval, so that cameraInUse is set again
+    // in a settings channel which a restarted module created anew
+    constexpr auto settingsResyncInterval = std::chrono::seconds(1);
+    constexpr auto frameStatisticsLogInterval = std::chrono::seconds(10);
+
     constexpr std::array<unsigned char, 3> overlayColor = { 0, 0, 0 };
     // clang-format off
     unsigned char bmpPixelData[58] = {
@@ -36,11 +43,6 @@ wil::com_ptr_nothrow<IMemAllocator> VideoCaptureProxyPin::FindAllocator()
     return allocator;
 }
 
-wil::com_ptr_nothrow<IMFSample> LoadImageAsSample(wil::com_ptr_nothrow<IStream> imageStream,
-                                                  IMFMediaType* sampleMediaType,
-                                                  const float quality) noexcept;
-bool ReencodeJPGImage(BYTE* imageBuf, const DWORD imageSize, DWORD& reencodedSize);
-
 HRESULT VideoCaptureProxyPin::Connect(IPin* pReceivePin, const AM_MEDIA_TYPE*)
 {
     if (!pReceivePin)
@@ -67,7 +69,10 @@ HRESULT VideoCaptureProxyPin::Connect(IPin* pReceivePin, const AM_MEDIA_TYPE*)
         return E_POINTER;
     }
 
-    _connectedInputPin = pReceivePin;
+    {
+        std::unique_lock<std::mutex> lock{ _owningFilter->_pin_mutex };
+        _connectedInputPin = pReceivePin;
+    }
 
     auto memInput = _connectedInputPin.try_query<IMemInputPin>();
     if (!memInput)
@@ -105,7 +110,12 @@ HRESULT VideoCaptureProxyPin::Disconnect(void)
         return S_FALSE;
     }
 
-    _connectedInputPin.reset();
+    // Released outside of the lock, since the release can call into the downstream filter
+    wil::com_ptr_nothrow<IPin> disconnectedPin;
+    {
+        std::unique_lock<std::mutex> lock{ _owningFilter->_pin_mutex };
+        disconnectedPin = std::move(_connectedInputPin);
+    }
     return S_OK;
 }
 
@@ -407,13 +417,8 @@ void ReencodeFrame(IMediaSample* frame)
     frame->SetActualDataLength(reencodedSize);
 }
 
-bool OverwriteFrame(IMediaSample* frame, wil::com_ptr_nothrow<IMFSample>& image)
+bool CopyImageToFrame(IMediaSample* frame, const BYTE* imageData, const DWORD imageSize)
 {
-    if (!image)
-    {
-        return false;
-    }
-
     BYTE* frameData = nullptr;
     frame->GetPointer(&frameData);
     if (!frameData)
@@ -422,9 +427,29 @@ bool OverwriteFrame(IMediaSample* frame, wil::com_ptr_nothrow<IMFSample>& image)
         return false;
     }
 
-    wil::com_ptr_nothrow<IMFMediaBuffer> imageBuf;
     const DWORD frameSize = frame->GetSize();
+    if (imageSize > frameSize && failed(frame->SetActualDataLength(imageSize)))
+    {
+        char buf[512]{};
+        sprintf_s(buf, "VideoCaptureProxyPin::OverwriteFrame FAILED overlay image size %lu is larger than frame size %lu", imageSize, frameSize);
+        LOG(buf);
+        return false;
+    }
 
+    std::copy(imageData, imageData + imageSize, frameData);
+    frame->SetActualDataLength(imageSize);
+
+    return true;
+}
+
+bool OverwriteFrame(IMediaSample* frame, wil::com_ptr_nothrow<IMFSample>& image)
+{
+    if (!image)
+    {
+        return false;
+    }
+
+    wil::com_ptr_nothrow<IMFMediaBuffer> imageBuf;
     image->GetBufferByIndex(0, &imageBuf);
     if (!imageBuf)
     {
@@ -441,20 +466,19 @@ bool OverwriteFrame(IMediaSample* frame, wil::com_ptr_nothrow<IMFSample>& image)
         return false;
     }
 
-    if (imageSize > frameSize && failed(frame->SetActualDataLength(imageSize)))
-    {
-        char buf[512]{};
-        sprintf_s(buf, "VideoCaptureProxyPin::OverwriteFrame FAILED overlay image size %lu is larger than frame size %lu", imageSize, frameSize);
-        LOG(buf);
-        imageBuf->Unlock();
-        return false;
-    }
-
-    std::copy(imageData, imageData + imageSize, frameData);
+    const bool overwritten = CopyImageToFrame(frame, imageData, imageSize);
     imageBuf->Unlock();
-    frame->SetActualDataLength(imageSize);
+    return overwritten;
+}
 
-    return true;
+// The overlay frame published by the module is already in the frame format, it's copied straight from the mapped memory
+bool OverwriteFrame(IMediaSample* frame, SerializedSharedMemory& overlayFrame)
+{
+    bool overwritten = false;
+    overlayFrame.access([frame, &overwritten](auto frameMemory) {
+        overwritten = CopyImageToFrame(frame, frameMemory._data, static_cast<DWORD>(frameMemory._size));
+    });
+    return overwritten;
 }
 
 //#define DEBUG_FRAME_DATA
@@ -515,30 +539,50 @@ VideoCaptureProxyFilter::VideoCaptureProxyFilter() :
     _worker_thread{
         std::thread{
             [this]() {
-                using namespace std::chrono_literals;
-                const auto uninitializedSleepInterval = 15ms;
                 std::vector<float> lowerJpgQualityModes = { 0.1f, 0.25f };
+                auto statisticsLogTime = std::chrono::steady_clock::now();
                 while (!_shutdown_request)
                 {
-                    std::unique_lock<std::mutex> lock{ _worker_mutex };
-                    _worker_cv.wait(lock, [this] { return _pending_frame != nullptr || _shutdown_request; });
+                    // Woken for each frame, and at least once a second to log the statistics
+                    WaitForSingleObject(_frameReady.get(), 1000);
 
-                    if (!_outPin || !_outPin->_connectedInputPin)
+                    const auto now = std::chrono::steady_clock::now();
+                    if (now - statisticsLogTime >= frameStatisticsLogInterval)
+                    {
+                        statisticsLogTime = now;
+                        LogFrameStatistics();
+                    }
+
+                    QueuedFrame frame;
+                    if (!_frames.TryPopNewest(frame, [this](QueuedFrame& staleFrame) {
+                            staleFrame.sample->Release();
+                            _frameStatistics.droppedLate++;
+                        }))
                     {
-                        lock.unlock();
-                        std::this_thread::sleep_for(uninitializedSleepInterval);
                         continue;
                     }
 
-                    auto input = _outPin->_connectedInputPin.try_query<IMemInputPin>();
+                    IMediaSample* sample = frame.sample;
+                    auto releaseSample = wil::scope_exit([sample] { sample->Release(); });
+
+                    wil::com_ptr_nothrow<IMemInputPin> input;
+                    {
+                        std::unique_lock<std::mutex> lock{ _pin_mutex };
+                        if (_outPin && _outPin->_connectedInputPin)
+                        {
+                            input = _outPin->_connectedInputPin.try_query<IMemInputPin>();
+                        }
+                    }
+
                     if (!input)
                     {
+                        _frameStatistics.droppedUnconnected++;
                         continue;
                     }
 
-                    IMediaSample* sample = _pending_frame;
-                    if (!sample)
+                    if (!_framePacer.Admit(frame.captureTime))
                     {
+                        _frameStatistics.droppedPaced++;
                         continue;
                     }
 #if defined(DEBUG_FRAME_DATA)
@@ -549,15 +593,19 @@ VideoCaptureProxyFilter::VideoCaptureProxyFilter() :
                         realFrameSaved = true;
                     }
 #endif
-                    auto newSettings = SyncCurrentSettings();
-                    if (newSettings.webcamDisabled)
+                    SyncChangedSettings();
+                    if (_webcamDisabled)
                     {
 #if !defined(DEBUG_OVERWRITE_FRAME)
-                        bool overwritten = OverwriteFrame(_pending_frame, _overlayImage ? _overlayImage : _blankImage);
+                        bool overwritten = _overlayFrame && OverwriteFrame(sample, *_overlayFrame);
+                        if (!overwritten)
+                        {
+                            overwritten = OverwriteFrame(sample, _overlayImage ? _overlayImage : _blankImage);
+                        }
                         while (!overwritten && _overlayImage)
                         {
                             _overlayImage.reset();
-                            newSettings = SyncCurrentSettings();
+                            const auto newSettings = SyncCurrentSettings();
                             if (!lowerJpgQualityModes.empty() && newSettings.overlayImage)
                             {
                                 const float quality = lowerJpgQualityModes.back();
@@ -566,7 +614,7 @@ VideoCaptureProxyFilter::VideoCaptureProxyFilter() :
                                 sprintf_s(buf, "Reload overlay image with quality %f", quality);
                                 LOG(buf);
                                 _overlayImage = LoadImageAsSample(newSettings.overlayImage, _targetMediaType.get(), quality);
-                                overwritten = OverwriteFrame(_pending_frame, _overlayImage);
+                                overwritten = OverwriteFrame(sample, _overlayImage);
                             }
                             else
                             {
@@ -583,10 +631,10 @@ VideoCaptureProxyFilter::VideoCaptureProxyFilter() :
 #endif
                         if (!overwritten && !_overlayImage)
                         {
-                            OverwriteFrame(_pending_frame, _blankImage);
+                            OverwriteFrame(sample, _blankImage);
                         }
 #else
-                        DebugOverwriteFrame(_pending_frame, "R:\\frame.data");
+                        DebugOverwriteFrame(sample, "R:\\frame.data");
 #endif
                     }
 #if defined(DEBUG_REENCODE_JPG_DATA)
@@ -596,14 +644,13 @@ VideoCaptureProxyFilter::VideoCaptureProxyFilter() :
                         _targetMediaType->GetGUID(MF_MT_SUBTYPE, &subtype);
                         if (subtype == MFVideoFormat_MJPG)
                         {
-                            ReencodeFrame(_pending_frame);
+                            ReencodeFrame(sample);
                         }
                     }
 #endif
 
-                    _pending_frame = nullptr;
                     input->Receive(sample);
-                    sample->Release();
+                    _frameStatistics.delivered++;
                 }
             } }
     }
@@ -625,7 +672,7 @@ HRESULT VideoCaptureProxyFilter::Pause(void)
 {
     if (_state == State_Stopped)
     {
-        std::unique_lock<std::mutex> lock{ _worker_mutex };
+        std::unique_lock<std::mutex> lock{ _pin_mutex };
 
         if (!_outPin)
         {
@@ -694,6 +741,10 @@ GUID MapDShowSubtypeToMFT(const GUID& dshowSubtype)
     {
         return MFVideoFormat_RGB24;
     }
+    else if (dshowSubtype == MEDIASUBTYPE_NV12)
+    {
+        return MFVideoFormat_NV12;
+    }
     else
     {
         LOG("MapDShowSubtypeToMFT: Unsupported media type format provided!");
@@ -709,7 +760,7 @@ HRESULT VideoCaptureProxyFilter::EnumPins(IEnumPins** ppEnum)
         return E_POINTER;
     }
 
-    std::unique_lock<std::mutex> lock{ _worker_mutex };
+    std::unique_lock<std::mutex> lock{ _pin_mutex };
 
     // We cannot initialize capture device and outpin during VideoCaptureProxyFilter ctor
     // since that results in a deadlock -> initializing now.
@@ -762,12 +813,24 @@ HRESULT VideoCaptureProxyFilter::EnumPins(IEnumPins** ppEnum)
         _outPin.attach(pin.detach());
 
         auto frameCallback = [this](IMediaSample* sample) {
-            std::unique_lock<std::mutex> lock{ _worker_mutex };
+            _framesReceived++;
             sample->AddRef();
-            _pending_frame = sample;
-            _worker_cv.notify_one();
+            if (!_frames.TryPush(QueuedFrame{ sample, std::chrono::steady_clock::now() }))
+            {
+                sample->Release();
+                _framesDroppedQueueFull++;
+            }
+            SetEvent(_frameReady.get());
         };
 
+        // No pacing if the camera didn't report its frame rate
+        const auto frameInterval = webcam.bestFormat.avgFrameTime;
+        if (frameInterval > 0 && frameInterval != std::numeric_limits<REFERENCE_TIME>::max())
+        {
+            using reference_time = std::chrono::duration<REFERENCE_TIME, std::ratio<1, 10'000'000>>;
+            _framePacer.SetInterval(std::chrono::duration_cast<std::chrono::steady_clock::duration>(reference_time{ frameInterval }));
+        }
+
         _targetMediaType.reset();
         MFCreateMediaType(&_targetMediaType);
         _targetMediaType->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video);
@@ -778,6 +841,17 @@ HRESULT VideoCaptureProxyFilter::EnumPins(IEnumPins** ppEnum)
             _targetMediaType.get(), MF_MT_FRAME_SIZE, webcam.bestFormat.width, webcam.bestFormat.height);
         MFSetAttributeRatio(_targetMediaType.get(), MF_MT_PIXEL_ASPECT_RATIO, 1, 1);
 
+        // The module converts the overlay image to this format, so it doesn't have to be decoded in this process
+        _overlayFrameRequest.reset();
+        GUID targetSubtype{};
+        _targetMediaType->GetGUID(MF_MT_SUBTYPE, &targetSubtype);
+        if (const auto overlayFrameFormat = OverlayFrameFormatFromSubtype(targetSubtype))
+        {
+            _overlayFrameRequest = OverlayFrameDescription{ *overlayFrameFormat,
+                                                            static_cast<uint32_t>(webcam.bestFormat.width),
+                                                            static_cast<uint32_t>(webcam.bestFormat.height) };
+        }
+
         _captureDevice = VideoCaptureDevice::Create(std::move(webcam), std::move(frameCallback));
         if (_captureDevice)
         {
@@ -856,8 +930,64 @@ VideoCaptureProxyFilter::~VideoCaptureProxyFilter()
     VERBOSE_LOG;
     _shutdown_request = true;
 
-    _worker_cv.notify_one();
+    SetEvent(_frameReady.get());
     _worker_thread.join();
+
+    // The capture device is released first, so that no frame is queued after the ring was emptied
+    _captureDevice.reset();
+    QueuedFrame frame;
+    while (_frames.TryPop(frame))
+    {
+        frame.sample->Release();
+    }
+}
+
+// Reads the settings, which takes the lock of the settings channel, only if the module changed them since the last time
+void VideoCaptureProxyFilter::SyncChangedSettings()
+{
+    std::optional<uint32_t> settingsVersion;
+    if (_settingsUpdateChannel)
+    {
+        auto settings = reinterpret_cast<CameraSettingsUpdateChannel*>(_settingsUpdateChannel->unserialized_memory()._data);
+        settingsVersion = settings->settingsVersion.load(std::memory_order_acquire);
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (settingsVersion && settingsVersion == _syncedSettingsVersion && now - _settingsSyncTime < settingsResyncInterval)
+    {
+        return;
+    }
+
+    // The version is read before the settings, so a change made in the meantime is read again the next time
+    _syncedSettingsVersion = settingsVersion;
+    _settingsSyncTime = now;
+    _webcamDisabled = SyncCurrentSettings().webcamDisabled;
+}
+
+void VideoCaptureProxyFilter::LogFrameStatistics()
+{
+    _frameStatistics.received = _framesReceived;
+    _frameStatistics.droppedQueueFull = _framesDroppedQueueFull;
+
+    const auto& total = _frameStatistics;
+    const auto& logged = _loggedFrameStatistics;
+    if (total.received == logged.received)
+    {
+        return;
+    }
+
+    char buf[512]{};
+    sprintf_s(buf,
+              "Frames in the last %llds: received %llu, delivered %llu, dropped %llu with a full queue, %llu late, %llu above the frame rate, %llu while unconnected",
+              static_cast<long long>(frameStatisticsLogInterval.count()),
+              total.received - logged.received,
+              total.delivered - logged.delivered,
+              total.droppedQueueFull - logged.droppedQueueFull,
+              total.droppedLate - logged.droppedLate,
+              total.droppedPaced - logged.droppedPaced,
+              total.droppedUnconnected - logged.droppedUnconnected);
+    LOG(buf);
+    _loggedFrameStatistics = total;
 }
 
 VideoCaptureProxyFilter::SyncedSettings VideoCaptureProxyFilter::SyncCurrentSettings()
@@ -890,6 +1020,37 @@ VideoCaptureProxyFilter::SyncedSettings VideoCaptureProxyFilter::SyncCurrentSett
             }
         }
 
+        if (_overlayFrameRequest && settings->overlayFrameRequest != _overlayFrameRequest)
+        {
+            settings->overlayFrameRequest = _overlayFrameRequest;
+        }
+
+        // Use the overlay frame converted by the module if there is one in our format. The image is only decoded
+        // here if there is none, or if the frame couldn't be opened
+        if (settings->overlayFrame && _overlayFrameRequest && settings->overlayFrame->description == *_overlayFrameRequest)
+        {
+            if (!_overlayFrameSlot || _overlayFrameSlot->version != settings->overlayFrame->version)
+            {
+                _overlayFrameSlot = settings->overlayFrame;
+                _overlayFrame = SerializedSharedMemory::open(CameraOverlayFrameChannel::endpoint(_overlayFrameSlot->version), _overlayFrameSlot->size, true);
+                if (!_overlayFrame)
+                {
+                    LOG("VideoCaptureProxyFilter::SyncCurrentSettings FAILED to open the overlay frame");
+                }
+            }
+
+            if (_overlayFrame)
+            {
+                settings->newOverlayImagePosted = false;
+                return;
+            }
+        }
+        else
+        {
+            _overlayFrameSlot.reset();
+            _overlayFrame.reset();
+        }
+
         if (!settings->overlayImageSize.has_value())
         {
             return;
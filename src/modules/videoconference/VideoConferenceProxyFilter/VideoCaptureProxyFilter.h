@@ -11,12 +11,13 @@
 #include <wil/com.h>
 
 #include <CameraStateUpdateChannels.h>
+#include <FrameRing.h>
 #include <SerializedSharedMemory.h>
 
 #include "VideoCaptureDevice.h"
 
 #include <mutex>
-#include <condition_variable>
+#include <chrono>
 
 struct VideoCaptureProxyPin;
 struct IMFSample;
@@ -28,17 +29,54 @@ struct VideoCaptureProxyFilter : winrt::implements<VideoCaptureProxyFilter, IBas
 {
     // BLOCK START: member accessed concurrently
     wil::com_ptr_nothrow<VideoCaptureProxyPin> _outPin;
-    IMediaSample* _pending_frame = nullptr;
     std::atomic_bool _shutdown_request = false;
     std::optional<SerializedSharedMemory> _settingsUpdateChannel;
     std::optional<std::wstring> _currentSourceCameraName;
     wil::com_ptr_nothrow<IMFSample> _blankImage;
     wil::com_ptr_nothrow<IMFSample> _overlayImage;
     wil::com_ptr_nothrow<IMFMediaType> _targetMediaType;
+    std::optional<OverlayFrameDescription> _overlayFrameRequest;
+    std::optional<OverlayFrameSlot> _overlayFrameSlot;
+    std::optional<SerializedSharedMemory> _overlayFrame;
     // BLOCK END: member accessed concurrently
 
-    std::mutex _worker_mutex;
-    std::condition_variable _worker_cv;
+    // A frame of the capture device, with the time at which the capture thread received it
+    struct QueuedFrame
+    {
+        IMediaSample* sample = nullptr;
+        std::chrono::steady_clock::time_point captureTime;
+    };
+
+    // Pushed by the capture thread, which then sets _frameReady, and popped by the worker thread. The worker delivers the
+    // newest frame only, so the ring only fills up while it's blocked in the Receive of the application
+    FrameRing<QueuedFrame, 4> _frames;
+    wil::unique_event_nothrow _frameReady{ CreateEventW(nullptr, FALSE, FALSE, nullptr) };
+
+    // Written by the capture thread
+    std::atomic_uint64_t _framesReceived = 0;
+    std::atomic_uint64_t _framesDroppedQueueFull = 0;
+
+    // BLOCK START: accessed by the worker thread only, once the pin was initialized
+    struct FrameStatistics
+    {
+        uint64_t received = 0;
+        uint64_t delivered = 0;
+        uint64_t droppedQueueFull = 0;
+        uint64_t droppedLate = 0;
+        uint64_t droppedPaced = 0;
+        uint64_t droppedUnconnected = 0;
+    };
+
+    FramePacer _framePacer;
+    FrameStatistics _frameStatistics;
+    FrameStatistics _loggedFrameStatistics;
+    bool _webcamDisabled = false;
+    std::optional<uint32_t> _syncedSettingsVersion;
+    std::chrono::steady_clock::time_point _settingsSyncTime;
+    // BLOCK END: accessed by the worker thread only, once the pin was initialized
+
+    // Serializes the initialization of the pin, and guards _outPin->_connectedInputPin, which the graph changes while the worker thread reads it
+    std::mutex _pin_mutex;
 
     FILTER_STATE _state = State_Stopped;
     wil::com_ptr_nothrow<IReferenceClock> _clock;
@@ -58,6 +96,8 @@ struct VideoCaptureProxyFilter : winrt::implements<VideoCaptureProxyFilter, IBas
     };
 
     SyncedSettings SyncCurrentSettings();
+    void SyncChangedSettings();
+    void LogFrameStatistics();
 
     HRESULT STDMETHODCALLTYPE Stop(void) override;
     HRESULT STDMETHODCALLTYPE Pause(void) override;
@@ -8,6 +8,12 @@ std::wstring_view CameraOverlayImageChannel::endpoint()
     return endpoint;
 }
 
+std::wstring CameraOverlayFrameChannel::endpoint(const uint32_t version)
+{
+    static const std::wstring endpoint = ObtainStableGlobalNameForKernelObject(L"PowerToysVideoConferenceCameraOverlayFrameSharedMemory", true);
+    return endpoint + std::to_wstring(version);
+}
+
 std::wstring_view CameraSettingsUpdateChannel::endpoint()
 {
     static const std::wstring endpoint = ObtainStableGlobalNameForKernelObject(L"PowerToysVideoConferenceSettingsChannelSharedMemory", true);
@@ -1,9 +1,40 @@
 #pragma once
 
+#include <atomic>
 #include <optional>
+#include <string>
 #include <string_view>
 #include <array>
 
+// Frame formats which the module can convert the overlay image to
+enum class OverlayFrameFormat : uint32_t
+{
+    RGB24,
+    YUY2,
+    NV12,
+    MJPG,
+};
+
+struct OverlayFrameDescription
+{
+    OverlayFrameFormat format = OverlayFrameFormat::RGB24;
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    bool operator==(const OverlayFrameDescription&) const = default;
+};
+
+// An overlay frame published by the module. The frame data is in CameraOverlayFrameChannel::endpoint(version)
+// and is never modified after it was published, a new image or format gets a new version
+struct OverlayFrameSlot
+{
+    OverlayFrameDescription description;
+    uint32_t version = 0;
+    uint32_t size = 0;
+};
+
+static_assert(std::atomic_uint32_t::is_always_lock_free, "The settings version is shared between processes");
+
 struct alignas(16) CameraSettingsUpdateChannel
 {
     bool useOverlayImage = false;
@@ -14,6 +45,14 @@ struct alignas(16) CameraSettingsUpdateChannel
 
     bool newOverlayImagePosted = false;
 
+    // Frame format negotiated by the proxy filter, which the module converts the overlay image to
+    std::optional<OverlayFrameDescription> overlayFrameRequest;
+    std::optional<OverlayFrameSlot> overlayFrame;
+
+    // Incremented by the module after it changed any of the settings above, so that the proxy filter only takes the lock and reads
+    // them again when it changed. The filter reads it without the lock
+    std::atomic_uint32_t settingsVersion = 0;
+
     static std::wstring_view endpoint();
 };
 
@@ -21,3 +60,8 @@ namespace CameraOverlayImageChannel
 {
     std::wstring_view endpoint();
 }
+
+namespace CameraOverlayFrameChannel
+{
+    std::wstring endpoint(const uint32_t version);
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <utility>
+
+// Hands the camera frames from the capture thread to the worker thread of the proxy filter without locking.
+// Only one thread may push and only one thread may pop. A full ring refuses the pushed frame, which the caller then releases
+template<typename T, size_t Capacity>
+class FrameRing
+{
+    static_assert(Capacity > 1 && (Capacity & (Capacity - 1)) == 0, "The capacity must be a power of two");
+
+public:
+    // Called from the producer thread only
+    bool TryPush(T frame) noexcept
+    {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) == Capacity)
+        {
+            return false;
+        }
+
+        _frames[tail & (Capacity - 1)] = std::move(frame);
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Called from the consumer thread only
+    bool TryPop(T& frame) noexcept
+    {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        frame = std::move(_frames[head & (Capacity - 1)]);
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Pops every queued frame and keeps the newest one, so that a consumer which fell behind catches up at once.
+    // The older frames are given to discard
+    template<typename Discard>
+    bool TryPopNewest(T& frame, Discard&& discard)
+    {
+        if (!TryPop(frame))
+        {
+            return false;
+        }
+
+        T newer;
+        while (TryPop(newer))
+        {
+            discard(frame);
+            frame = std::move(newer);
+        }
+        return true;
+    }
+
+private:
+    // The indices only grow and wrap around, and are kept on separate cache lines, so that the two threads don't invalidate
+    // each other's line on every frame. Padding is used instead of alignas, which warns about the padding it adds
+    static constexpr size_t cacheLineSize = 64;
+
+    std::atomic_size_t _head = 0;
+    char _headPadding[cacheLineSize - sizeof(std::atomic_size_t)]{};
+    std::atomic_size_t _tail = 0;
+    char _tailPadding[cacheLineSize - sizeof(std::atomic_size_t)]{};
+    std::array<T, Capacity> _frames{};
+};
+
+// Limits the delivered frames to the frame rate of the negotiated format. Cameras can deliver frames in bursts, or faster than
+// the format they report, and the applications expect the rate of the format. A frame is accepted up to a quarter of the interval
+// before its time, so that the jitter of the capture thread doesn't drop frames. The frame times keep a fixed cadence, so that
+// the frames which are a little late don't lower the frame rate, and a new cadence only starts after a frame which is more than
+// a full interval late, e.g. after a stall, instead of letting the next ones through early to catch up
+class FramePacer
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    // No pacing with a zero interval
+    void SetInterval(const clock::duration interval) noexcept
+    {
+        _interval = interval;
+        _nextFrameTime = {};
+    }
+
+    clock::duration Interval() const noexcept { return _interval; }
+
+    bool Admit(const clock::time_point captureTime) noexcept
+    {
+        if (_interval <= clock::duration::zero())
+        {
+            return true;
+        }
+
+        if (captureTime + _interval / 4 < _nextFrameTime)
+        {
+            return false;
+        }
+
+        if (_nextFrameTime == clock::time_point{} || captureTime - _nextFrameTime > _interval)
+        {
+            _nextFrameTime = captureTime + _interval;
+        }
+        else
+        {
+            _nextFrameTime += _interval;
+        }
+        return true;
+    }
+
+private:
+    clock::duration _interval{};
+    clock::time_point _nextFrameTime{};
+};
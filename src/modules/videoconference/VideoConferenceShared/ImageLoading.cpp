@@ -1,5 +1,7 @@
 #include <initguid.h>
 
+#include "ImageLoading.h"
+
 #include <dxgiformat.h>
 #include <assert.h>
 #include <winrt/base.h>
@@ -13,19 +15,20 @@
 #include <mfapi.h>
 #include <shcore.h>
 #include <algorithm>
+#include <vector>
 
 #include <wil/resource.h>
 #include <wil/com.h>
 
 #include <mfapi.h>
 #include <mfidl.h>
-#include <mftransform.h>
 #include <dshow.h>
 #include <Wincodecsdk.h>
 
 #include <shlwapi.h>
 
 #include "Logging.h"
+#include "PixelFormatConversion.h"
 
 IWICImagingFactory* _GetWIC() noexcept
 {
@@ -116,10 +119,7 @@ bool ReencodeJPGImage(BYTE* imageBuf, const DWORD imageSize, DWORD& reencodedSiz
     return true;
 }
 
-wil::com_ptr_nothrow<IWICBitmapSource> LoadAsRGB24BitmapWithSize(IWICImagingFactory* pWIC,
-                                                                 wil::com_ptr_nothrow<IStream> image,
-                                                                 const UINT targetWidth,
-                                                                 const UINT targetHeight)
+wil::com_ptr_nothrow<IWICBitmapSource> LoadAsRGB24Bitmap(IWICImagingFactory* pWIC, wil::com_ptr_nothrow<IStream> image)
 {
     wil::com_ptr_nothrow<IWICBitmapSource> bitmap;
     // Initialize image bitmap decoder from filename and get the image frame
@@ -128,23 +128,8 @@ wil::com_ptr_nothrow<IWICBitmapSource> LoadAsRGB24BitmapWithSize(IWICImagingFact
 
     wil::com_ptr_nothrow<IWICBitmapFrameDecode> decodedFrame;
     OK_OR_BAIL(bitmapDecoder->GetFrame(0, &decodedFrame));
+    bitmap.attach(decodedFrame.detach());
 
-    UINT imageWidth = 0, imageHeight = 0;
-    OK_OR_BAIL(decodedFrame->GetSize(&imageWidth, &imageHeight));
-
-    // Scale the image if required
-    if (targetWidth != imageWidth || targetHeight != imageHeight)
-    {
-        wil::com_ptr_nothrow<IWICBitmapScaler> scaler;
-        OK_OR_BAIL(pWIC->CreateBitmapScaler(&scaler));
-        OK_OR_BAIL(
-            scaler->Initialize(decodedFrame.get(), targetWidth, targetHeight, WICBitmapInterpolationModeHighQualityCubic));
-        bitmap.attach(scaler.detach());
-    }
-    else
-    {
-        bitmap.attach(decodedFrame.detach());
-    }
     WICPixelFormatGUID pixelFormat{};
     OK_OR_BAIL(bitmap->GetPixelFormat(&pixelFormat));
 
@@ -218,111 +203,6 @@ wil::com_ptr_nothrow<IStream> EncodeBitmapToContainer(IWICImagingFactory* pWIC,
     return encodedBitmap;
 }
 
-IMFSample* ConvertIMFVideoSample(const MFT_REGISTER_TYPE_INFO& inputType,
-                                 IMFMediaType* outputMediaType,
-                                 const wil::com_ptr_nothrow<IMFSample>& inputSample,
-                                 const UINT width,
-                                 const UINT height)
-{
-    IMFActivate** ppVDActivate = nullptr;
-    UINT32 count = 0;
-
-    MFT_REGISTER_TYPE_INFO outputType = { MFMediaType_Video, {} };
-    outputMediaType->GetGUID(MF_MT_SUBTYPE, &outputType.guidSubtype);
-
-    const std::array<GUID, 3> transformerCategories = {
-        MFT_CATEGORY_VIDEO_PROCESSOR, MFT_CATEGORY_VIDEO_DECODER, MFT_CATEGORY_VIDEO_ENCODER
-    };
-
-    for (const auto& transformerCategory : transformerCategories)
-    {
-        OK_OR_BAIL(MFTEnumEx(transformerCategory, MFT_ENUM_FLAG_SYNCMFT, &inputType, &outputType, &ppVDActivate, &count));
-        if (count != 0)
-        {
-            break;
-        }
-    }
-
-    wil::com_ptr_nothrow<IMFTransform> videoTransformer;
-
-    bool videoDecoderActivated = false;
-    for (UINT32 i = 0; i < count; ++i)
-    {
-        if (!videoDecoderActivated && !FAILED(ppVDActivate[i]->ActivateObject(IID_PPV_ARGS(&videoTransformer))))
-        {
-            videoDecoderActivated = true;
-        }
-        ppVDActivate[i]->Release();
-    }
-
-    if (count)
-    {
-        CoTaskMemFree(ppVDActivate);
-    }
-
-    if (!videoDecoderActivated)
-    {
-        LOG("No converter avialable for the selected format");
-        return nullptr;
-    }
-
-    auto shutdownVideoDecoder = wil::scope_exit([&videoTransformer] { MFShutdownObject(videoTransformer.get()); });
-    // Set input/output types for the decoder
-    wil::com_ptr_nothrow<IMFMediaType> intermediateFrameMediaType;
-    OK_OR_BAIL(MFCreateMediaType(&intermediateFrameMediaType));
-    intermediateFrameMediaType->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video);
-    intermediateFrameMediaType->SetGUID(MF_MT_SUBTYPE, MFVideoFormat_RGB24);
-    intermediateFrameMediaType->SetUINT32(MF_MT_INTERLACE_MODE, MFVideoInterlace_Progressive);
-    intermediateFrameMediaType->SetUINT32(MF_MT_ALL_SAMPLES_INDEPENDENT, TRUE);
-    OK_OR_BAIL(MFSetAttributeSize(intermediateFrameMediaType.get(), MF_MT_FRAME_SIZE, width, height));
-    OK_OR_BAIL(MFSetAttributeRatio(intermediateFrameMediaType.get(), MF_MT_PIXEL_ASPECT_RATIO, width, height));
-    OK_OR_BAIL(videoTransformer->SetInputType(0, intermediateFrameMediaType.get(), 0));
-    OK_OR_BAIL(videoTransformer->SetOutputType(0, outputMediaType, 0));
-
-    // Process the input sample
-    OK_OR_BAIL(videoTransformer->ProcessInput(0, inputSample.get(), 0));
-
-    // Check whether we need to allocate output sample and buffer ourselves
-    MFT_OUTPUT_STREAM_INFO outputStreamInfo{};
-    OK_OR_BAIL(videoTransformer->GetOutputStreamInfo(0, &outputStreamInfo));
-    const bool onlyProvidesSamples = outputStreamInfo.dwFlags & MFT_OUTPUT_STREAM_PROVIDES_SAMPLES;
-    const bool canProvideSamples = outputStreamInfo.dwFlags & MFT_OUTPUT_STREAM_CAN_PROVIDE_SAMPLES;
-    const bool mustAllocateSample =
-        (!onlyProvidesSamples && !canProvideSamples) ||
-        (!onlyProvidesSamples && (outputStreamInfo.dwFlags & MFT_PROCESS_OUTPUT_DISCARD_WHEN_NO_BUFFER));
-
-    MFT_OUTPUT_DATA_BUFFER outputSamples{};
-    IMFSample* outputSample = nullptr;
-
-    // If so, do the allocation
-    if (mustAllocateSample)
-    {
-        OK_OR_BAIL(MFCreateSample(&outputSample));
-        OK_OR_BAIL(outputSample->SetSampleDuration(333333));
-        OK_OR_BAIL(outputSample->SetSampleTime(1));
-        OK_OR_BAIL(outputSample->SetUINT32(MF_MT_VIDEO_ROTATION, MFVideoRotationFormat::MFVideoRotationFormat_0));
-        IMFMediaBuffer* outputMediaBuffer = nullptr;
-        OK_OR_BAIL(
-            MFCreateAlignedMemoryBuffer(outputStreamInfo.cbSize, outputStreamInfo.cbAlignment - 1, &outputMediaBuffer));
-        OK_OR_BAIL(outputMediaBuffer->SetCurrentLength(outputStreamInfo.cbSize));
-        OK_OR_BAIL(outputSample->AddBuffer(outputMediaBuffer));
-        outputSamples.pSample = outputSample;
-    }
-
-    // Finally, produce the output sample
-    DWORD processStatus = 0;
-    if (failed(videoTransformer->ProcessOutput(0, 1, &outputSamples, &processStatus)))
-    {
-        LOG("Failed to convert image frame");
-    }
-    if (outputSamples.pEvents)
-    {
-        outputSamples.pEvents->Release();
-    }
-
-    return outputSamples.pSample;
-}
-
 wil::com_ptr_nothrow<IMFSample> LoadImageAsSample(wil::com_ptr_nothrow<IStream> imageStream,
                                                   IMFMediaType* sampleMediaType,
                                                   const float quality) noexcept
@@ -330,8 +210,8 @@ wil::com_ptr_nothrow<IMFSample> LoadImageAsSample(wil::com_ptr_nothrow<IStream>
     UINT targetWidth = 0;
     UINT targetHeight = 0;
     OK_OR_BAIL(MFGetAttributeSize(sampleMediaType, MF_MT_FRAME_SIZE, &targetWidth, &targetHeight));
-    MFT_REGISTER_TYPE_INFO outputType = { MFMediaType_Video, {} };
-    OK_OR_BAIL(sampleMediaType->GetGUID(MF_MT_SUBTYPE, &outputType.guidSubtype));
+    GUID subtype{};
+    OK_OR_BAIL(sampleMediaType->GetGUID(MF_MT_SUBTYPE, &subtype));
 
     IWICImagingFactory* pWIC = _GetWIC();
     if (!pWIC)
@@ -345,44 +225,45 @@ wil::com_ptr_nothrow<IMFSample> LoadImageAsSample(wil::com_ptr_nothrow<IStream>
         return nullptr;
     }
 
-    const auto srcImageBitmap = LoadAsRGB24BitmapWithSize(pWIC, imageStream, targetWidth, targetHeight);
+    const auto srcImageBitmap = LoadAsRGB24Bitmap(pWIC, imageStream);
     if (!srcImageBitmap)
     {
         return nullptr;
     }
 
-    // First, let's create a sample containing RGB24 bitmap
-    IMFSample* outputSample = nullptr;
-    OK_OR_BAIL(MFCreateSample(&outputSample));
-    OK_OR_BAIL(outputSample->SetUINT32(MF_MT_VIDEO_ROTATION, MFVideoRotationFormat::MFVideoRotationFormat_0));
-    OK_OR_BAIL(outputSample->SetSampleDuration(333333));
-    OK_OR_BAIL(outputSample->SetSampleTime(1));
-    IMFMediaBuffer* outputMediaBuffer = nullptr;
-    const DWORD nPixelBytes = targetWidth * targetHeight * 3;
-    OK_OR_BAIL(MFCreateAlignedMemoryBuffer(nPixelBytes, MF_64_BYTE_ALIGNMENT, &outputMediaBuffer));
+    UINT imageWidth = 0, imageHeight = 0;
+    OK_OR_BAIL(srcImageBitmap->GetSize(&imageWidth, &imageHeight));
+    const UINT imageStride = 3 * imageWidth;
+    std::vector<BYTE> imagePixels(static_cast<size_t>(imageStride) * imageHeight);
+    OK_OR_BAIL(srcImageBitmap->CopyPixels(nullptr, imageStride, static_cast<UINT>(imagePixels.size()), imagePixels.data()));
 
+    // Scale the image to the frame size
     const UINT stride = 3 * targetWidth;
-
-    DWORD max_length = 0, current_length = 0;
-    BYTE* sampleBufferMemory = nullptr;
-    OK_OR_BAIL(outputMediaBuffer->Lock(&sampleBufferMemory, &max_length, &current_length));
-    OK_OR_BAIL(srcImageBitmap->CopyPixels(nullptr, stride, nPixelBytes, sampleBufferMemory));
-    OK_OR_BAIL(outputMediaBuffer->Unlock());
-
-    OK_OR_BAIL(outputMediaBuffer->SetCurrentLength(nPixelBytes));
-    OK_OR_BAIL(outputSample->AddBuffer(outputMediaBuffer));
-
-    if (outputType.guidSubtype == MFVideoFormat_RGB24)
+    const DWORD nPixelBytes = targetWidth * targetHeight * 3;
+    std::vector<BYTE> framePixels(nPixelBytes);
+    if (!PixelFormatConversion::ScaleRGB24(
+            imagePixels.data(), imageStride, imageWidth, imageHeight, framePixels.data(), stride, targetWidth, targetHeight))
     {
-        return outputSample;
+        LOG("Failed to scale the image");
+        return nullptr;
     }
 
+    DWORD max_length = 0, current_length = 0;
+
     // Special case for mjpg, since we need to use jpg container for it instead of supplying raw pixels
-    if (outputType.guidSubtype == MFVideoFormat_MJPG)
+    if (subtype == MFVideoFormat_MJPG)
     {
+        wil::com_ptr_nothrow<IWICBitmap> frameBitmap;
+        OK_OR_BAIL(pWIC->CreateBitmapFromMemory(
+            targetWidth, targetHeight, GUID_WICPixelFormat24bppBGR, stride, nPixelBytes, framePixels.data(), &frameBitmap));
+
         // Use an intermediate jpg container sample which will be transcoded to the target format
         wil::com_ptr_nothrow<IStream> jpgStream =
-            EncodeBitmapToContainer(pWIC, srcImageBitmap, GUID_ContainerFormatJpeg, targetWidth, targetHeight, quality);
+            EncodeBitmapToContainer(pWIC, frameBitmap.get(), GUID_ContainerFormatJpeg, targetWidth, targetHeight, quality);
+        if (!jpgStream)
+        {
+            return nullptr;
+        }
 
         // Obtain stream size and lock its memory pointer
         STATSTG intermediateStreamStat{};
@@ -416,10 +297,118 @@ wil::com_ptr_nothrow<IMFSample> LoadImageAsSample(wil::com_ptr_nothrow<IStream>
         return jpgSample;
     }
 
-    // Now we are ready to convert it to the requested media type
-    MFT_REGISTER_TYPE_INFO intermediateType = { MFMediaType_Video, MFVideoFormat_RGB24 };
+    // The other formats are converted from the scaled RGB24 pixels
+    DWORD frameBytes = 0;
+    if (subtype == MFVideoFormat_RGB24)
+    {
+        frameBytes = nPixelBytes;
+    }
+    else if (subtype == MFVideoFormat_YUY2)
+    {
+        frameBytes = targetWidth * targetHeight * 2;
+    }
+    else if (subtype == MFVideoFormat_NV12)
+    {
+        frameBytes = targetWidth * targetHeight * 3 / 2;
+    }
+    else
+    {
+        LOG("No converter avialable for the selected format");
+        return nullptr;
+    }
 
-    // But if no conversion is needed, just return the input sample
+    wil::com_ptr_nothrow<IMFSample> outputSample;
+    OK_OR_BAIL(MFCreateSample(&outputSample));
+    OK_OR_BAIL(outputSample->SetUINT32(MF_MT_VIDEO_ROTATION, MFVideoRotationFormat::MFVideoRotationFormat_0));
+    OK_OR_BAIL(outputSample->SetSampleDuration(333333));
+    OK_OR_BAIL(outputSample->SetSampleTime(1));
+    wil::com_ptr_nothrow<IMFMediaBuffer> outputMediaBuffer;
+    OK_OR_BAIL(MFCreateAlignedMemoryBuffer(frameBytes, MF_64_BYTE_ALIGNMENT, &outputMediaBuffer));
 
-    return ConvertIMFVideoSample(intermediateType, sampleMediaType, outputSample, targetWidth, targetHeight);
-}
\ No newline at end of file
+    BYTE* sampleBufferMemory = nullptr;
+    OK_OR_BAIL(outputMediaBuffer->Lock(&sampleBufferMemory, &max_length, &current_length));
+    bool converted = true;
+    if (subtype == MFVideoFormat_RGB24)
+    {
+        std::copy(begin(framePixels), end(framePixels), sampleBufferMemory);
+    }
+    else if (subtype == MFVideoFormat_YUY2)
+    {
+        converted = PixelFormatConversion::RGB24ToYUY2(
+            framePixels.data(), stride, sampleBufferMemory, 2 * targetWidth, targetWidth, targetHeight);
+    }
+    else
+    {
+        converted = PixelFormatConversion::RGB24ToNV12(framePixels.data(),
+                                                       stride,
+                                                       sampleBufferMemory,
+                                                       targetWidth,
+                                                       sampleBufferMemory + targetWidth * targetHeight,
+                                                       targetWidth,
+                                                       targetWidth,
+                                                       targetHeight);
+    }
+    OK_OR_BAIL(outputMediaBuffer->Unlock());
+
+    if (!converted)
+    {
+        LOG("Failed to convert image frame");
+        return nullptr;
+    }
+
+    OK_OR_BAIL(outputMediaBuffer->SetCurrentLength(frameBytes));
+    OK_OR_BAIL(outputSample->AddBuffer(outputMediaBuffer.get()));
+    return outputSample;
+}
+
+std::optional<OverlayFrameFormat> OverlayFrameFormatFromSubtype(const GUID& subtype) noexcept
+{
+    if (subtype == MFVideoFormat_RGB24)
+    {
+        return OverlayFrameFormat::RGB24;
+    }
+    else if (subtype == MFVideoFormat_YUY2)
+    {
+        return OverlayFrameFormat::YUY2;
+    }
+    else if (subtype == MFVideoFormat_NV12)
+    {
+        return OverlayFrameFormat::NV12;
+    }
+    else if (subtype == MFVideoFormat_MJPG)
+    {
+        return OverlayFrameFormat::MJPG;
+    }
+
+    return std::nullopt;
+}
+
+wil::com_ptr_nothrow<IMFMediaType> CreateOverlayFrameMediaType(const OverlayFrameDescription& description) noexcept
+{
+    GUID subtype = MFVideoFormat_RGB24;
+    switch (description.format)
+    {
+    case OverlayFrameFormat::RGB24:
+        subtype = MFVideoFormat_RGB24;
+        break;
+    case OverlayFrameFormat::YUY2:
+        subtype = MFVideoFormat_YUY2;
+        break;
+    case OverlayFrameFormat::NV12:
+        subtype = MFVideoFormat_NV12;
+        break;
+    case OverlayFrameFormat::MJPG:
+        subtype = MFVideoFormat_MJPG;
+        break;
+    }
+
+    wil::com_ptr_nothrow<IMFMediaType> mediaType;
+    OK_OR_BAIL(MFCreateMediaType(&mediaType));
+    OK_OR_BAIL(mediaType->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video));
+    OK_OR_BAIL(mediaType->SetGUID(MF_MT_SUBTYPE, subtype));
+    OK_OR_BAIL(mediaType->SetUINT32(MF_MT_INTERLACE_MODE, MFVideoInterlace_Progressive));
+    OK_OR_BAIL(mediaType->SetUINT32(MF_MT_ALL_SAMPLES_INDEPENDENT, TRUE));
+    OK_OR_BAIL(MFSetAttributeSize(mediaType.get(), MF_MT_FRAME_SIZE, description.width, description.height));
+    OK_OR_BAIL(MFSetAttributeRatio(mediaType.get(), MF_MT_PIXEL_ASPECT_RATIO, 1, 1));
+    return mediaType;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <Windows.h>
+#include <mfidl.h>
+#include <optional>
+
+#include <wil/com.h>
+
+#include "CameraStateUpdateChannels.h"
+
+// Decodes the image, scales it to the frame size of the media type and converts it to its subtype
+wil::com_ptr_nothrow<IMFSample> LoadImageAsSample(wil::com_ptr_nothrow<IStream> imageStream,
+                                                  IMFMediaType* sampleMediaType,
+                                                  const float quality) noexcept;
+bool ReencodeJPGImage(BYTE* imageBuf, const DWORD imageSize, DWORD& reencodedSize);
+
+std::optional<OverlayFrameFormat> OverlayFrameFormatFromSubtype(const GUID& subtype) noexcept;
+wil::com_ptr_nothrow<IMFMediaType> CreateOverlayFrameMediaType(const OverlayFrameDescription& description) noexcept;
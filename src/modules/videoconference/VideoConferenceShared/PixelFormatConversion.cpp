@@ -0,0 +1,904 @@
+#include "PixelFormatConversion.h"
+
+#include <algorithm>
+#include <new>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PIXEL_CONVERSION_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define PIXEL_CONVERSION_SSE2
+#define PIXEL_CONVERSION_AVX2
+#else
+#define PIXEL_CONVERSION_SSE2 __attribute__((target("sse2")))
+#define PIXEL_CONVERSION_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace PixelFormatConversion
+{
+    namespace
+    {
+        // The SIMD loops load 16 bytes for every 4 RGB24 pixels, or store 16 bytes for them, so they stop while 4 bytes of the row are left
+        constexpr uint32_t RowPadding = 2;
+
+        inline uint8_t Luma(const int r, const int g, const int b)
+        {
+            return static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        }
+
+        inline uint8_t ChromaU(const int r, const int g, const int b)
+        {
+            return static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+        }
+
+        inline uint8_t ChromaV(const int r, const int g, const int b)
+        {
+            return static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+
+        inline uint8_t Clamp(const int value)
+        {
+            return static_cast<uint8_t>(std::clamp(value, 0, 255));
+        }
+
+        template<typename T>
+        inline T* Row(T* image, const ptrdiff_t stride, const uint32_t y)
+        {
+            return image + stride * static_cast<ptrdiff_t>(y);
+        }
+
+        void RGB24ToYUY2Row(const uint8_t* src, uint8_t* dst, uint32_t x, const uint32_t width)
+        {
+            for (; x < width; x += 2)
+            {
+                const uint8_t* p = src + x * 3;
+                const int b = (p[0] + p[3] + 1) >> 1;
+                const int g = (p[1] + p[4] + 1) >> 1;
+                const int r = (p[2] + p[5] + 1) >> 1;
+                uint8_t* out = dst + x * 2;
+                out[0] = Luma(p[2], p[1], p[0]);
+                out[1] = ChromaU(r, g, b);
+                out[2] = Luma(p[5], p[4], p[3]);
+                out[3] = ChromaV(r, g, b);
+            }
+        }
+
+        void YUY2ToRGB24Row(const uint8_t* src, uint8_t* dst, uint32_t x, const uint32_t width)
+        {
+            for (; x < width; x += 2)
+            {
+                const uint8_t* p = src + x * 2;
+                const int d = p[1] - 128;
+                const int e = p[3] - 128;
+                for (uint32_t i = 0; i < 2; ++i)
+                {
+                    const int c = p[i * 2] - 16;
+                    uint8_t* out = dst + (x + i) * 3;
+                    out[0] = Clamp((298 * c + 516 * d + 128) >> 8);
+                    out[1] = Clamp((298 * c - 100 * d - 208 * e + 128) >> 8);
+                    out[2] = Clamp((298 * c + 409 * e + 128) >> 8);
+                }
+            }
+        }
+
+        // Converts two rows to 4:2:0. The chroma samples are chromaStep bytes apart, which interleaves them for NV12
+        void RGB24ToYUV420Rows(const uint8_t* src0,
+                               const uint8_t* src1,
+                               uint8_t* y0,
+                               uint8_t* y1,
+                               uint8_t* u,
+                               uint8_t* v,
+                               const ptrdiff_t chromaStep,
+                               uint32_t x,
+                               const uint32_t width)
+        {
+            for (; x < width; x += 2)
+            {
+                const uint8_t* a = src0 + x * 3;
+                const uint8_t* c = src1 + x * 3;
+                y0[x] = Luma(a[2], a[1], a[0]);
+                y0[x + 1] = Luma(a[5], a[4], a[3]);
+                y1[x] = Luma(c[2], c[1], c[0]);
+                y1[x + 1] = Luma(c[5], c[4], c[3]);
+
+                const int b = (a[0] + a[3] + c[0] + c[3] + 2) >> 2;
+                const int g = (a[1] + a[4] + c[1] + c[4] + 2) >> 2;
+                const int r = (a[2] + a[5] + c[2] + c[5] + 2) >> 2;
+                u[(x / 2) * chromaStep] = ChromaU(r, g, b);
+                v[(x / 2) * chromaStep] = ChromaV(r, g, b);
+            }
+        }
+
+        // The horizontal taps are 1/128 of a pixel, so the vertical blend of two of them fits in 32 bits
+        void BlendRows(const int16_t* row0, const int16_t* row1, uint8_t* dst, const int weight, size_t x, const size_t count)
+        {
+            for (; x < count; ++x)
+            {
+                dst[x] = static_cast<uint8_t>((row0[x] * (128 - weight) + row1[x] * weight + 8192) >> 14);
+            }
+        }
+
+#if defined(PIXEL_CONVERSION_X86)
+        // 8 pixels with a 16-bit lane per channel
+        struct Channels128
+        {
+            __m128i b, g, r;
+        };
+
+        PIXEL_CONVERSION_SSE2 inline __m128i Pair128(const int16_t first, const int16_t second)
+        {
+            return _mm_set1_epi32(static_cast<int>((static_cast<uint32_t>(static_cast<uint16_t>(second)) << 16) | static_cast<uint16_t>(first)));
+        }
+
+        // Reads 16 bytes and returns their first 4 pixels with a 32-bit lane each
+        PIXEL_CONVERSION_SSE2 inline __m128i LoadRGB24x4(const uint8_t* p)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const __m128i p01 = _mm_unpacklo_epi32(v, _mm_srli_si128(v, 3));
+            const __m128i p23 = _mm_unpacklo_epi32(_mm_srli_si128(v, 6), _mm_srli_si128(v, 9));
+            return _mm_unpacklo_epi64(p01, p23);
+        }
+
+        PIXEL_CONVERSION_SSE2 inline Channels128 LoadRGB24x8(const uint8_t* p)
+        {
+            const __m128i lo = LoadRGB24x4(p);
+            const __m128i hi = LoadRGB24x4(p + 12);
+            const __m128i mask = _mm_set1_epi32(0xFF);
+            return {
+                _mm_packs_epi32(_mm_and_si128(lo, mask), _mm_and_si128(hi, mask)),
+                _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 8), mask), _mm_and_si128(_mm_srli_epi32(hi, 8), mask)),
+                _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 16), mask), _mm_and_si128(_mm_srli_epi32(hi, 16), mask)),
+            };
+        }
+
+        // The sum fits in 16 bits when it's taken as unsigned
+        PIXEL_CONVERSION_SSE2 inline __m128i Luma128(const Channels128& c)
+        {
+            __m128i y = _mm_add_epi16(_mm_mullo_epi16(c.r, _mm_set1_epi16(66)), _mm_mullo_epi16(c.g, _mm_set1_epi16(129)));
+            y = _mm_add_epi16(y, _mm_mullo_epi16(c.b, _mm_set1_epi16(25)));
+            y = _mm_add_epi16(y, _mm_set1_epi16(128));
+            return _mm_add_epi16(_mm_srli_epi16(y, 8), _mm_set1_epi16(16));
+        }
+
+        PIXEL_CONVERSION_SSE2 inline __m128i ChromaU128(const Channels128& c)
+        {
+            __m128i u = _mm_sub_epi16(_mm_mullo_epi16(c.b, _mm_set1_epi16(112)), _mm_mullo_epi16(c.r, _mm_set1_epi16(38)));
+            u = _mm_sub_epi16(u, _mm_mullo_epi16(c.g, _mm_set1_epi16(74)));
+            u = _mm_add_epi16(u, _mm_set1_epi16(128));
+            return _mm_add_epi16(_mm_srai_epi16(u, 8), _mm_set1_epi16(128));
+        }
+
+        PIXEL_CONVERSION_SSE2 inline __m128i ChromaV128(const Channels128& c)
+        {
+            __m128i v = _mm_sub_epi16(_mm_mullo_epi16(c.r, _mm_set1_epi16(112)), _mm_mullo_epi16(c.g, _mm_set1_epi16(94)));
+            v = _mm_sub_epi16(v, _mm_mullo_epi16(c.b, _mm_set1_epi16(18)));
+            v = _mm_add_epi16(v, _mm_set1_epi16(128));
+            return _mm_add_epi16(_mm_srai_epi16(v, 8), _mm_set1_epi16(128));
+        }
+
+        // Averages the pairs of adjacent lanes of both halves, or of their sums with the lanes of the next row
+        PIXEL_CONVERSION_SSE2 inline __m128i PairAverage128(const __m128i lo, const __m128i hi, const int count)
+        {
+            const __m128i ones = _mm_set1_epi16(1);
+            const __m128i rounding = _mm_set1_epi32(count / 2);
+            const int shift = count == 4 ? 2 : 1;
+            const __m128i averageLo = _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(lo, ones), rounding), shift);
+            const __m128i averageHi = _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(hi, ones), rounding), shift);
+            return _mm_packs_epi32(averageLo, averageHi);
+        }
+
+        // Packs 4 pixels with a 32-bit lane each into the first 12 bytes
+        PIXEL_CONVERSION_SSE2 inline __m128i PackRGB24x4(const __m128i v)
+        {
+            const __m128i pairs = _mm_or_si128(_mm_and_si128(v, _mm_set1_epi64x(0xFFFFFF)),
+                                               _mm_and_si128(_mm_srli_epi64(v, 8), _mm_set1_epi64x(0xFFFFFF000000)));
+            return _mm_or_si128(_mm_and_si128(pairs, _mm_set_epi64x(0, -1)), _mm_srli_si128(_mm_and_si128(pairs, _mm_set_epi64x(-1, 0)), 2));
+        }
+
+        // One of the RGB channels of 8 pixels from their luma and two chroma values, in the first 8 bytes
+        PIXEL_CONVERSION_SSE2 inline __m128i RGBChannel128(const __m128i c, const __m128i first, const __m128i firstWeights, const __m128i second, const __m128i secondWeights)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i rounding = _mm_set1_epi32(128);
+            const __m128i lo = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(c, first), firstWeights),
+                                                           _mm_madd_epi16(_mm_unpacklo_epi16(second, zero), secondWeights)),
+                                             rounding);
+            const __m128i hi = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(c, first), firstWeights),
+                                                           _mm_madd_epi16(_mm_unpackhi_epi16(second, zero), secondWeights)),
+                                             rounding);
+            const __m128i value = _mm_packs_epi32(_mm_srai_epi32(lo, 8), _mm_srai_epi32(hi, 8));
+            return _mm_packus_epi16(value, value);
+        }
+
+        PIXEL_CONVERSION_SSE2 void RGB24ToYUY2RowSSE2(const uint8_t* src, uint8_t* dst, const uint32_t width)
+        {
+            uint32_t x = 0;
+            for (; x + 16 + RowPadding <= width; x += 16)
+            {
+                const uint8_t* p = src + x * 3;
+                const Channels128 lo = LoadRGB24x8(p);
+                const Channels128 hi = LoadRGB24x8(p + 24);
+                const __m128i y = _mm_packus_epi16(Luma128(lo), Luma128(hi));
+                const Channels128 chroma{ PairAverage128(lo.b, hi.b, 2), PairAverage128(lo.g, hi.g, 2), PairAverage128(lo.r, hi.r, 2) };
+                const __m128i u = ChromaU128(chroma);
+                const __m128i v = ChromaV128(chroma);
+                const __m128i uv = _mm_unpacklo_epi8(_mm_packus_epi16(u, u), _mm_packus_epi16(v, v));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 2), _mm_unpacklo_epi8(y, uv));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 2 + 16), _mm_unpackhi_epi8(y, uv));
+            }
+
+            RGB24ToYUY2Row(src, dst, x, width);
+        }
+
+        PIXEL_CONVERSION_SSE2 void YUY2ToRGB24RowSSE2(const uint8_t* src, uint8_t* dst, const uint32_t width)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i lowWords = _mm_set1_epi32(0xFFFF);
+            uint32_t x = 0;
+            for (; x + 8 <= width; x += 8)
+            {
+                const __m128i yuy2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 2));
+                const __m128i c = _mm_sub_epi16(_mm_and_si128(yuy2, _mm_set1_epi16(0xFF)), _mm_set1_epi16(16));
+
+                // Each 32-bit lane holds the U and V of two pixels, which are copied to both halves
+                const __m128i uv = _mm_srli_epi16(yuy2, 8);
+                const __m128i d = _mm_sub_epi16(_mm_or_si128(_mm_and_si128(uv, lowWords), _mm_slli_epi32(uv, 16)), _mm_set1_epi16(128));
+                const __m128i e = _mm_sub_epi16(_mm_or_si128(_mm_srli_epi32(uv, 16), _mm_andnot_si128(lowWords, uv)), _mm_set1_epi16(128));
+
+                const __m128i b = RGBChannel128(c, d, Pair128(298, 516), e, Pair128(0, 0));
+                const __m128i g = RGBChannel128(c, d, Pair128(298, -100), e, Pair128(-208, 0));
+                const __m128i r = RGBChannel128(c, e, Pair128(298, 409), d, Pair128(0, 0));
+
+                const __m128i bg = _mm_unpacklo_epi8(b, g);
+                const __m128i r0 = _mm_unpacklo_epi8(r, zero);
+                const __m128i lo = PackRGB24x4(_mm_unpacklo_epi16(bg, r0));
+                const __m128i hi = PackRGB24x4(_mm_unpackhi_epi16(bg, r0));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 3), _mm_or_si128(lo, _mm_slli_si128(hi, 12)));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x * 3 + 16), _mm_srli_si128(hi, 4));
+            }
+
+            YUY2ToRGB24Row(src, dst, x, width);
+        }
+
+        PIXEL_CONVERSION_SSE2 void RGB24ToYUV420RowsSSE2(const uint8_t* src0,
+                                                         const uint8_t* src1,
+                                                         uint8_t* y0,
+                                                         uint8_t* y1,
+                                                         uint8_t* u,
+                                                         uint8_t* v,
+                                                         const ptrdiff_t chromaStep,
+                                                         const uint32_t width)
+        {
+            uint32_t x = 0;
+            for (; x + 16 + RowPadding <= width; x += 16)
+            {
+                const Channels128 lo0 = LoadRGB24x8(src0 + x * 3);
+                const Channels128 hi0 = LoadRGB24x8(src0 + x * 3 + 24);
+                const Channels128 lo1 = LoadRGB24x8(src1 + x * 3);
+                const Channels128 hi1 = LoadRGB24x8(src1 + x * 3 + 24);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(y0 + x), _mm_packus_epi16(Luma128(lo0), Luma128(hi0)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(y1 + x), _mm_packus_epi16(Luma128(lo1), Luma128(hi1)));
+
+                const Channels128 chroma{
+                    PairAverage128(_mm_add_epi16(lo0.b, lo1.b), _mm_add_epi16(hi0.b, hi1.b), 4),
+                    PairAverage128(_mm_add_epi16(lo0.g, lo1.g), _mm_add_epi16(hi0.g, hi1.g), 4),
+                    PairAverage128(_mm_add_epi16(lo0.r, lo1.r), _mm_add_epi16(hi0.r, hi1.r), 4),
+                };
+                const __m128i chromaU = ChromaU128(chroma);
+                const __m128i chromaV = ChromaV128(chroma);
+                const __m128i u8 = _mm_packus_epi16(chromaU, chromaU);
+                const __m128i v8 = _mm_packus_epi16(chromaV, chromaV);
+                if (chromaStep == 2)
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(u + x), _mm_unpacklo_epi8(u8, v8));
+                }
+                else
+                {
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(u + x / 2), u8);
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(v + x / 2), v8);
+                }
+            }
+
+            RGB24ToYUV420Rows(src0, src1, y0, y1, u, v, chromaStep, x, width);
+        }
+
+        PIXEL_CONVERSION_SSE2 inline __m128i Blend128(const __m128i row0, const __m128i row1, const __m128i weights)
+        {
+            const __m128i rounding = _mm_set1_epi32(8192);
+            const __m128i lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(row0, row1), weights), rounding), 14);
+            const __m128i hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(row0, row1), weights), rounding), 14);
+            return _mm_packs_epi32(lo, hi);
+        }
+
+        PIXEL_CONVERSION_SSE2 void BlendRowsSSE2(const int16_t* row0, const int16_t* row1, uint8_t* dst, const int weight, const size_t count)
+        {
+            const __m128i weights = Pair128(static_cast<int16_t>(128 - weight), static_cast<int16_t>(weight));
+            size_t x = 0;
+            for (; x + 16 <= count; x += 16)
+            {
+                const __m128i first = Blend128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x)),
+                                               _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x)),
+                                               weights);
+                const __m128i second = Blend128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x + 8)),
+                                                _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x + 8)),
+                                                weights);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(first, second));
+            }
+
+            BlendRows(row0, row1, dst, weight, x, count);
+        }
+
+        // 16 pixels with a 16-bit lane per channel, the first 8 in the low 128 bits
+        struct Channels256
+        {
+            __m256i b, g, r;
+        };
+
+        PIXEL_CONVERSION_AVX2 inline __m256i Pair256(const int16_t first, const int16_t second)
+        {
+            return _mm256_set1_epi32(static_cast<int>((static_cast<uint32_t>(static_cast<uint16_t>(second)) << 16) | static_cast<uint16_t>(first)));
+        }
+
+        PIXEL_CONVERSION_AVX2 inline __m256i Load128x2(const uint8_t* lo, const uint8_t* hi)
+        {
+            return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lo))),
+                                           _mm_loadu_si128(reinterpret_cast<const __m128i*>(hi)),
+                                           1);
+        }
+
+        PIXEL_CONVERSION_AVX2 inline Channels256 LoadRGB24x16(const uint8_t* p)
+        {
+            // Pixels 0-3 and 8-11, then 4-7 and 12-15, so that joining the halves of the lanes keeps the pixels in order
+            const __m256i first = Load128x2(p, p + 24);
+            const __m256i second = Load128x2(p + 12, p + 36);
+            const __m256i blueGreen = _mm256_setr_epi8(0, -1, 3, -1, 6, -1, 9, -1, 1, -1, 4, -1, 7, -1, 10, -1, 0, -1, 3, -1, 6, -1, 9, -1, 1, -1, 4, -1, 7, -1, 10, -1);
+            const __m256i red = _mm256_setr_epi8(2, -1, 5, -1, 8, -1, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, -1, 5, -1, 8, -1, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+            const __m256i firstBlueGreen = _mm256_shuffle_epi8(first, blueGreen);
+            const __m256i secondBlueGreen = _mm256_shuffle_epi8(second, blueGreen);
+            return {
+                _mm256_unpacklo_epi64(firstBlueGreen, secondBlueGreen),
+                _mm256_unpackhi_epi64(firstBlueGreen, secondBlueGreen),
+                _mm256_unpacklo_epi64(_mm256_shuffle_epi8(first, red), _mm256_shuffle_epi8(second, red)),
+            };
+        }
+
+        PIXEL_CONVERSION_AVX2 inline __m256i Luma256(const Channels256& c)
+        {
+            __m256i y = _mm256_add_epi16(_mm256_mullo_epi16(c.r, _mm256_set1_epi16(66)), _mm256_mullo_epi16(c.g, _mm256_set1_epi16(129)));
+            y = _mm256_add_epi16(y, _mm256_mullo_epi16(c.b, _mm256_set1_epi16(25)));
+            y = _mm256_add_epi16(y, _mm256_set1_epi16(128));
+            return _mm256_add_epi16(_mm256_srli_epi16(y, 8), _mm256_set1_epi16(16));
+        }
+
+        PIXEL_CONVERSION_AVX2 inline __m256i ChromaU256(const Channels256& c)
+        {
+            __m256i u = _mm256_sub_epi16(_mm256_mullo_epi16(c.b, _mm256_set1_epi16(112)), _mm256_mullo_epi16(c.r, _mm256_set1_epi16(38)));
+            u = _mm256_sub_epi16(u, _mm256_mullo_epi16(c.g, _mm256_set1_epi16(74)));
+            u = _mm256_add_epi16(u, _mm256_set1_epi16(128));
+            return _mm256_add_epi16(_mm256_srai_epi16(u, 8), _mm256_set1_epi16(128));
+        }
+
+        PIXEL_CONVERSION_AVX2 inline __m256i ChromaV256(const Channels256& c)
+        {
+            __m256i v = _mm256_sub_epi16(_mm256_mullo_epi16(c.r, _mm256_set1_epi16(112)), _mm256_mullo_epi16(c.g, _mm256_set1_epi16(94)));
+            v = _mm256_sub_epi16(v, _mm256_mullo_epi16(c.b, _mm256_set1_epi16(18)));
+            v = _mm256_add_epi16(v, _mm256_set1_epi16(128));
+            return _mm256_add_epi16(_mm256_srai_epi16(v, 8), _mm256_set1_epi16(128));
+        }
+
+        // The averages of the pairs of adjacent lanes are in the first 4 lanes of each half
+        PIXEL_CONVERSION_AVX2 inline __m256i PairAverage256(const __m256i c, const int count)
+        {
+            const __m256i sums = _mm256_add_epi32(_mm256_madd_epi16(c, _mm256_set1_epi16(1)), _mm256_set1_epi32(count / 2));
+            const __m256i averages = _mm256_srli_epi32(sums, count == 4 ? 2 : 1);
+            return _mm256_packs_epi32(averages, averages);
+        }
+
+        // One of the RGB channels of 16 pixels from their luma and two chroma values, in the first 8 bytes of each half
+        PIXEL_CONVERSION_AVX2 inline __m256i RGBChannel256(const __m256i c, const __m256i first, const __m256i firstWeights, const __m256i second, const __m256i secondWeights)
+        {
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i rounding = _mm256_set1_epi32(128);
+            const __m256i lo = _mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(c, first), firstWeights),
+                                                                 _mm256_madd_epi16(_mm256_unpacklo_epi16(second, zero), secondWeights)),
+                                                rounding);
+            const __m256i hi = _mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(c, first), firstWeights),
+                                                                 _mm256_madd_epi16(_mm256_unpackhi_epi16(second, zero), secondWeights)),
+                                                rounding);
+            const __m256i value = _mm256_packs_epi32(_mm256_srai_epi32(lo, 8), _mm256_srai_epi32(hi, 8));
+            return _mm256_packus_epi16(value, value);
+        }
+
+        PIXEL_CONVERSION_AVX2 void RGB24ToYUY2RowAVX2(const uint8_t* src, uint8_t* dst, const uint32_t width)
+        {
+            uint32_t x = 0;
+            for (; x + 16 + RowPadding <= width; x += 16)
+            {
+                const Channels256 c = LoadRGB24x16(src + x * 3);
+                const __m256i y = Luma256(c);
+                const Channels256 chroma{ PairAverage256(c.b, 2), PairAverage256(c.g, 2), PairAverage256(c.r, 2) };
+                const __m256i u = ChromaU256(chroma);
+                const __m256i v = ChromaV256(chroma);
+                const __m256i uv = _mm256_unpacklo_epi8(_mm256_packus_epi16(u, u), _mm256_packus_epi16(v, v));
+                const __m256i yuy2 = _mm256_unpacklo_epi8(_mm256_packus_epi16(y, y), uv);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 2), yuy2);
+            }
+
+            RGB24ToYUY2Row(src, dst, x, width);
+        }
+
+        PIXEL_CONVERSION_AVX2 void YUY2ToRGB24RowAVX2(const uint8_t* src, uint8_t* dst, const uint32_t width)
+        {
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i lowWords = _mm256_set1_epi32(0xFFFF);
+            const __m256i pack = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1, 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+            uint32_t x = 0;
+            for (; x + 16 + RowPadding <= width; x += 16)
+            {
+                const __m256i yuy2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x * 2));
+                const __m256i c = _mm256_sub_epi16(_mm256_and_si256(yuy2, _mm256_set1_epi16(0xFF)), _mm256_set1_epi16(16));
+                const __m256i uv = _mm256_srli_epi16(yuy2, 8);
+                const __m256i d = _mm256_sub_epi16(_mm256_or_si256(_mm256_and_si256(uv, lowWords), _mm256_slli_epi32(uv, 16)), _mm256_set1_epi16(128));
+                const __m256i e = _mm256_sub_epi16(_mm256_or_si256(_mm256_srli_epi32(uv, 16), _mm256_andnot_si256(lowWords, uv)), _mm256_set1_epi16(128));
+
+                const __m256i b = RGBChannel256(c, d, Pair256(298, 516), e, Pair256(0, 0));
+                const __m256i g = RGBChannel256(c, d, Pair256(298, -100), e, Pair256(-208, 0));
+                const __m256i r = RGBChannel256(c, e, Pair256(298, 409), d, Pair256(0, 0));
+
+                // Pixels 0-3 and 8-11, then 4-7 and 12-15, each packed into the first 12 bytes of its half
+                const __m256i bg = _mm256_unpacklo_epi8(b, g);
+                const __m256i r0 = _mm256_unpacklo_epi8(r, zero);
+                const __m256i lo = _mm256_shuffle_epi8(_mm256_unpacklo_epi16(bg, r0), pack);
+                const __m256i hi = _mm256_shuffle_epi8(_mm256_unpackhi_epi16(bg, r0), pack);
+
+                // Each store overwrites the 4 unused bytes of the previous one
+                uint8_t* out = dst + x * 3;
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(lo));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 12), _mm256_castsi256_si128(hi));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 24), _mm256_extracti128_si256(lo, 1));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 36), _mm256_extracti128_si256(hi, 1));
+            }
+
+            YUY2ToRGB24Row(src, dst, x, width);
+        }
+
+        PIXEL_CONVERSION_AVX2 void RGB24ToYUV420RowsAVX2(const uint8_t* src0,
+                                                         const uint8_t* src1,
+                                                         uint8_t* y0,
+                                                         uint8_t* y1,
+                                                         uint8_t* u,
+                                                         uint8_t* v,
+                                                         const ptrdiff_t chromaStep,
+                                                         const uint32_t width)
+        {
+            const __m256i chromaOrder = _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0);
+            uint32_t x = 0;
+            for (; x + 16 + RowPadding <= width; x += 16)
+            {
+                const Channels256 c0 = LoadRGB24x16(src0 + x * 3);
+                const Channels256 c1 = LoadRGB24x16(src1 + x * 3);
+
+                // The halves hold pixels 0-7 of both rows, then pixels 8-15 of both rows
+                const __m256i y = _mm256_permute4x64_epi64(_mm256_packus_epi16(Luma256(c0), Luma256(c1)), _MM_SHUFFLE(3, 1, 2, 0));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(y0 + x), _mm256_castsi256_si128(y));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(y1 + x), _mm256_extracti128_si256(y, 1));
+
+                const Channels256 chroma{
+                    PairAverage256(_mm256_add_epi16(c0.b, c1.b), 4),
+                    PairAverage256(_mm256_add_epi16(c0.g, c1.g), 4),
+                    PairAverage256(_mm256_add_epi16(c0.r, c1.r), 4),
+                };
+                const __m256i chromaU = ChromaU256(chroma);
+                const __m256i chromaV = ChromaV256(chroma);
+                const __m256i u8 = _mm256_packus_epi16(chromaU, chromaU);
+                const __m256i v8 = _mm256_packus_epi16(chromaV, chromaV);
+                if (chromaStep == 2)
+                {
+                    const __m256i uv = _mm256_permute4x64_epi64(_mm256_unpacklo_epi8(u8, v8), _MM_SHUFFLE(3, 1, 2, 0));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(u + x), _mm256_castsi256_si128(uv));
+                }
+                else
+                {
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(u + x / 2), _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(u8, chromaOrder)));
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(v + x / 2), _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(v8, chromaOrder)));
+                }
+            }
+
+            RGB24ToYUV420Rows(src0, src1, y0, y1, u, v, chromaStep, x, width);
+        }
+
+        PIXEL_CONVERSION_AVX2 inline __m256i Blend256(const __m256i row0, const __m256i row1, const __m256i weights)
+        {
+            const __m256i rounding = _mm256_set1_epi32(8192);
+            const __m256i lo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(row0, row1), weights), rounding), 14);
+            const __m256i hi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(row0, row1), weights), rounding), 14);
+            return _mm256_packs_epi32(lo, hi);
+        }
+
+        PIXEL_CONVERSION_AVX2 void BlendRowsAVX2(const int16_t* row0, const int16_t* row1, uint8_t* dst, const int weight, const size_t count)
+        {
+            const __m256i weights = Pair256(static_cast<int16_t>(128 - weight), static_cast<int16_t>(weight));
+            size_t x = 0;
+            for (; x + 32 <= count; x += 32)
+            {
+                const __m256i first = Blend256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0 + x)),
+                                               _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1 + x)),
+                                               weights);
+                const __m256i second = Blend256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0 + x + 16)),
+                                                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1 + x + 16)),
+                                                weights);
+                const __m256i blended = _mm256_permute4x64_epi64(_mm256_packus_epi16(first, second), _MM_SHUFFLE(3, 1, 2, 0));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x), blended);
+            }
+
+            BlendRows(row0, row1, dst, weight, x, count);
+        }
+
+        Kernels DetectKernels() noexcept
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+            int info[4]{};
+            __cpuid(info, 0);
+            const int maxLeaf = info[0];
+            __cpuid(info, 1);
+            const bool sse2 = (info[3] & (1 << 26)) != 0;
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            const bool avx = (info[2] & (1 << 28)) != 0;
+            bool avx2 = false;
+            if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6)
+            {
+                __cpuidex(info, 7, 0);
+                avx2 = (info[1] & (1 << 5)) != 0;
+            }
+#else
+            __builtin_cpu_init();
+            const bool sse2 = __builtin_cpu_supports("sse2");
+            const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+            if (avx2)
+            {
+                return Kernels::AVX2;
+            }
+
+            return sse2 ? Kernels::SSE2 : Kernels::Scalar;
+        }
+#else
+        Kernels DetectKernels() noexcept
+        {
+            return Kernels::Scalar;
+        }
+#endif
+
+        inline Kernels Supported(const Kernels kernels) noexcept
+        {
+            return std::min(kernels, BestKernels());
+        }
+
+        // Halves the width, the height or both with a box filter. A remaining odd column or row is dropped
+        std::vector<uint8_t> HalveRGB24(const uint8_t* src, const ptrdiff_t srcStride, uint32_t& width, uint32_t& height, const bool halveWidth, const bool halveHeight)
+        {
+            const uint32_t stepX = halveWidth ? 2 : 1;
+            const uint32_t stepY = halveHeight ? 2 : 1;
+            width /= stepX;
+            height /= stepY;
+
+            std::vector<uint8_t> result(static_cast<size_t>(width) * height * 3);
+            for (uint32_t y = 0; y < height; ++y)
+            {
+                const uint8_t* row0 = Row(src, srcStride, y * stepY);
+                const uint8_t* row1 = Row(src, srcStride, y * stepY + stepY - 1);
+                uint8_t* out = result.data() + static_cast<size_t>(y) * width * 3;
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    const uint32_t first = x * stepX * 3;
+                    const uint32_t second = (x * stepX + stepX - 1) * 3;
+                    for (uint32_t c = 0; c < 3; ++c)
+                    {
+                        out[x * 3 + c] = static_cast<uint8_t>((row0[first + c] + row0[second + c] + row1[first + c] + row1[second + c] + 2) >> 2);
+                    }
+                }
+            }
+
+            return result;
+        }
+
+        struct Tap
+        {
+            uint32_t first;
+            uint32_t second;
+            int weight;
+        };
+
+        // The source pixels around the center of each destination pixel, and the weight of the second one in 1/128
+        std::vector<Tap> BilinearTaps(const uint32_t srcSize, const uint32_t dstSize)
+        {
+            std::vector<Tap> taps(dstSize);
+            for (uint32_t i = 0; i < dstSize; ++i)
+            {
+                const int64_t position = std::max<int64_t>((2 * static_cast<int64_t>(i) + 1) * srcSize * 128 / (2 * static_cast<int64_t>(dstSize)) - 64, 0);
+                auto& tap = taps[i];
+                tap.first = static_cast<uint32_t>(position >> 7);
+                tap.weight = static_cast<int>(position & 127);
+                if (tap.first >= srcSize - 1)
+                {
+                    tap.first = srcSize - 1;
+                    tap.weight = 0;
+                }
+                tap.second = std::min(tap.first + 1, srcSize - 1);
+            }
+
+            return taps;
+        }
+    }
+
+    Kernels BestKernels() noexcept
+    {
+        static const Kernels kernels = DetectKernels();
+        return kernels;
+    }
+
+    const char* KernelsName(const Kernels kernels) noexcept
+    {
+        switch (kernels)
+        {
+        case Kernels::Scalar:
+            return "Scalar";
+        case Kernels::SSE2:
+            return "SSE2";
+        case Kernels::AVX2:
+            return "AVX2";
+        }
+
+        return "";
+    }
+
+    bool RGB24ToYUY2(const uint8_t* src,
+                     const ptrdiff_t srcStride,
+                     uint8_t* dst,
+                     const ptrdiff_t dstStride,
+                     const uint32_t width,
+                     const uint32_t height,
+                     Kernels kernels) noexcept
+    {
+        if (!src || !dst || width % 2)
+        {
+            return false;
+        }
+
+        kernels = Supported(kernels);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            const uint8_t* srcRow = Row(src, srcStride, y);
+            uint8_t* dstRow = Row(dst, dstStride, y);
+            switch (kernels)
+            {
+#if defined(PIXEL_CONVERSION_X86)
+            case Kernels::AVX2:
+                RGB24ToYUY2RowAVX2(srcRow, dstRow, width);
+                break;
+            case Kernels::SSE2:
+                RGB24ToYUY2RowSSE2(srcRow, dstRow, width);
+                break;
+#endif
+            default:
+                RGB24ToYUY2Row(srcRow, dstRow, 0, width);
+                break;
+            }
+        }
+
+        return true;
+    }
+
+    bool YUY2ToRGB24(const uint8_t* src,
+                     const ptrdiff_t srcStride,
+                     uint8_t* dst,
+                     const ptrdiff_t dstStride,
+                     const uint32_t width,
+                     const uint32_t height,
+                     Kernels kernels) noexcept
+    {
+        if (!src || !dst || width % 2)
+        {
+            return false;
+        }
+
+        kernels = Supported(kernels);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            const uint8_t* srcRow = Row(src, srcStride, y);
+            uint8_t* dstRow = Row(dst, dstStride, y);
+            switch (kernels)
+            {
+#if defined(PIXEL_CONVERSION_X86)
+            case Kernels::AVX2:
+                YUY2ToRGB24RowAVX2(srcRow, dstRow, width);
+                break;
+            case Kernels::SSE2:
+                YUY2ToRGB24RowSSE2(srcRow, dstRow, width);
+                break;
+#endif
+            default:
+                YUY2ToRGB24Row(srcRow, dstRow, 0, width);
+                break;
+            }
+        }
+
+        return true;
+    }
+
+    namespace
+    {
+        bool RGB24ToYUV420(const uint8_t* src,
+                           const ptrdiff_t srcStride,
+                           uint8_t* dstY,
+                           const ptrdiff_t dstYStride,
+                           uint8_t* dstU,
+                           const ptrdiff_t dstUStride,
+                           uint8_t* dstV,
+                           const ptrdiff_t dstVStride,
+                           const ptrdiff_t chromaStep,
+                           const uint32_t width,
+                           const uint32_t height,
+                           Kernels kernels) noexcept
+        {
+            if (!src || !dstY || !dstU || !dstV || width % 2 || height % 2)
+            {
+                return false;
+            }
+
+            kernels = Supported(kernels);
+            for (uint32_t y = 0; y < height; y += 2)
+            {
+                const uint8_t* src0 = Row(src, srcStride, y);
+                const uint8_t* src1 = Row(src, srcStride, y + 1);
+                uint8_t* y0 = Row(dstY, dstYStride, y);
+                uint8_t* y1 = Row(dstY, dstYStride, y + 1);
+                uint8_t* u = Row(dstU, dstUStride, y / 2);
+                uint8_t* v = Row(dstV, dstVStride, y / 2);
+                switch (kernels)
+                {
+#if defined(PIXEL_CONVERSION_X86)
+                case Kernels::AVX2:
+                    RGB24ToYUV420RowsAVX2(src0, src1, y0, y1, u, v, chromaStep, width);
+                    break;
+                case Kernels::SSE2:
+                    RGB24ToYUV420RowsSSE2(src0, src1, y0, y1, u, v, chromaStep, width);
+                    break;
+#endif
+                default:
+                    RGB24ToYUV420Rows(src0, src1, y0, y1, u, v, chromaStep, 0, width);
+                    break;
+                }
+            }
+
+            return true;
+        }
+    }
+
+    bool RGB24ToNV12(const uint8_t* src,
+                     const ptrdiff_t srcStride,
+                     uint8_t* dstY,
+                     const ptrdiff_t dstYStride,
+                     uint8_t* dstUV,
+                     const ptrdiff_t dstUVStride,
+                     const uint32_t width,
+                     const uint32_t height,
+                     Kernels kernels) noexcept
+    {
+        if (!dstUV)
+        {
+            return false;
+        }
+
+        return RGB24ToYUV420(src, srcStride, dstY, dstYStride, dstUV, dstUVStride, dstUV + 1, dstUVStride, 2, width, height, kernels);
+    }
+
+    bool RGB24ToI420(const uint8_t* src,
+                     const ptrdiff_t srcStride,
+                     uint8_t* dstY,
+                     const ptrdiff_t dstYStride,
+                     uint8_t* dstU,
+                     const ptrdiff_t dstUStride,
+                     uint8_t* dstV,
+                     const ptrdiff_t dstVStride,
+                     const uint32_t width,
+                     const uint32_t height,
+                     Kernels kernels) noexcept
+    {
+        return RGB24ToYUV420(src, srcStride, dstY, dstYStride, dstU, dstUStride, dstV, dstVStride, 1, width, height, kernels);
+    }
+
+    bool ScaleRGB24(const uint8_t* src,
+                    const ptrdiff_t srcStride,
+                    uint32_t srcWidth,
+                    uint32_t srcHeight,
+                    uint8_t* dst,
+                    const ptrdiff_t dstStride,
+                    const uint32_t dstWidth,
+                    const uint32_t dstHeight,
+                    Kernels kernels) noexcept
+    {
+        if (!src || !dst || !srcWidth || !srcHeight || !dstWidth || !dstHeight)
+        {
+            return false;
+        }
+
+        kernels = Supported(kernels);
+        try
+        {
+            std::vector<uint8_t> halved;
+            ptrdiff_t stride = srcStride;
+            while (srcWidth / 2 >= dstWidth || srcHeight / 2 >= dstHeight)
+            {
+                halved = HalveRGB24(src, stride, srcWidth, srcHeight, srcWidth / 2 >= dstWidth, srcHeight / 2 >= dstHeight);
+                src = halved.data();
+                stride = static_cast<ptrdiff_t>(srcWidth) * 3;
+            }
+
+            const auto columns = BilinearTaps(srcWidth, dstWidth);
+            const auto rows = BilinearTaps(srcHeight, dstHeight);
+
+            // The horizontal pass of the two source rows of the current destination row, which the next one usually shares
+            const size_t rowValues = static_cast<size_t>(dstWidth) * 3;
+            std::vector<int16_t> horizontal[2] = { std::vector<int16_t>(rowValues), std::vector<int16_t>(rowValues) };
+            int64_t horizontalRows[2] = { -1, -1 };
+            const auto horizontalRow = [&](const uint32_t srcRow, const uint32_t keepRow) {
+                for (size_t i = 0; i < 2; ++i)
+                {
+                    if (horizontalRows[i] == srcRow)
+                    {
+                        return horizontal[i].data();
+                    }
+                }
+
+                const size_t slot = horizontalRows[0] == keepRow ? 1 : 0;
+                const uint8_t* row = Row(src, stride, srcRow);
+                int16_t* out = horizontal[slot].data();
+                for (uint32_t x = 0; x < dstWidth; ++x)
+                {
+                    const auto& tap = columns[x];
+                    const uint8_t* first = row + tap.first * 3;
+                    const uint8_t* second = row + tap.second * 3;
+                    for (uint32_t c = 0; c < 3; ++c)
+                    {
+                        out[x * 3 + c] = static_cast<int16_t>(first[c] * (128 - tap.weight) + second[c] * tap.weight);
+                    }
+                }
+
+                horizontalRows[slot] = srcRow;
+                return out;
+            };
+
+            for (uint32_t y = 0; y < dstHeight; ++y)
+            {
+                const auto& tap = rows[y];
+                const int16_t* row0 = horizontalRow(tap.first, tap.second);
+                const int16_t* row1 = horizontalRow(tap.second, tap.first);
+                uint8_t* dstRow = Row(dst, dstStride, y);
+                switch (kernels)
+                {
+#if defined(PIXEL_CONVERSION_X86)
+                case Kernels::AVX2:
+                    BlendRowsAVX2(row0, row1, dstRow, tap.weight, rowValues);
+                    break;
+                case Kernels::SSE2:
+                    BlendRowsSSE2(row0, row1, dstRow, tap.weight, rowValues);
+                    break;
+#endif
+                default:
+                    BlendRows(row0, row1, dstRow, tap.weight, 0, rowValues);
+                    break;
+                }
+            }
+        }
+        catch (const std::bad_alloc&)
+        {
+            return false;
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Converts and scales the frames of the camera without Media Foundation transforms.
+// RGB24 is the layout of MFVideoFormat_RGB24 and GUID_WICPixelFormat24bppBGR: a blue, a green and a red byte per pixel.
+// YUV uses the BT.601 matrix with the video range, as in the integer formulas of the "Recommended 8-Bit YUV Formats" documentation,
+// and each chroma sample is computed from the average of the pixels it covers.
+// Strides are in bytes, and a negative stride with a pointer to the last row reads or writes a bottom-up image.
+// The SSE2 and AVX2 kernels give the same bytes as the scalar ones, which are the reference.
+namespace PixelFormatConversion
+{
+    enum class Kernels
+    {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    // The fastest kernels the CPU supports. Asking for faster ones than these runs these instead
+    Kernels BestKernels() noexcept;
+    const char* KernelsName(const Kernels kernels) noexcept;
+
+    // The width must be even
+    bool RGB24ToYUY2(const uint8_t* src,
+                     const ptrdiff_t srcStride,
+                     uint8_t* dst,
+                     const ptrdiff_t dstStride,
+                     const uint32_t width,
+                     const uint32_t height,
+                     Kernels kernels = BestKernels()) noexcept;
+
+    // The width must be even
+    bool YUY2ToRGB24(const uint8_t* src,
+                     const ptrdiff_t srcStride,
+                     uint8_t* dst,
+                     const ptrdiff_t dstStride,
+                     const uint32_t width,
+                     const uint32_t height,
+                     Kernels kernels = BestKernels()) noexcept;
+
+    // The width and the height must be even
+    bool RGB24ToNV12(const uint8_t* src,
+                     const ptrdiff_t srcStride,
+                     uint8_t* dstY,
+                     const ptrdiff_t dstYStride,
+                     uint8_t* dstUV,
+                     const ptrdiff_t dstUVStride,
+                     const uint32_t width,
+                     const uint32_t height,
+                     Kernels kernels = BestKernels()) noexcept;
+
+    // The width and the height must be even
+    bool RGB24ToI420(const uint8_t* src,
+                     const ptrdiff_t srcStride,
+                     uint8_t* dstY,
+                     const ptrdiff_t dstYStride,
+                     uint8_t* dstU,
+                     const ptrdiff_t dstUStride,
+                     uint8_t* dstV,
+                     const ptrdiff_t dstVStride,
+                     const uint32_t width,
+                     const uint32_t height,
+                     Kernels kernels = BestKernels()) noexcept;
+
+    // Bilinear scaling. An image at least twice as large as the destination is first halved with a box filter,
+    // so that downscaling doesn't skip pixels
+    bool ScaleRGB24(const uint8_t* src,
+                    const ptrdiff_t srcStride,
+                    const uint32_t srcWidth,
+                    const uint32_t srcHeight,
+                    uint8_t* dst,
+                    const ptrdiff_t dstStride,
+                    const uint32_t dstWidth,
+                    const uint32_t dstHeight,
+                    Kernels kernels = BestKernels()) noexcept;
+}
@@ -35,6 +35,8 @@ public:
 
     void access(std::function<void(memory_t)> access_routine) noexcept;
     inline size_t size() const noexcept { return _memory._size; }
+    // Access without the lock, for the data which is atomic by itself
+    inline memory_t unserialized_memory() const noexcept { return _memory; }
 
     ~SerializedSharedMemory() noexcept;
     SerializedSharedMemory(SerializedSharedMemory&&) noexcept;
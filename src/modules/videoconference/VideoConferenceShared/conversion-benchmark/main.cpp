@@ -0,0 +1,275 @@
+// Checks that the SIMD pixel format conversion kernels give the same bytes as the scalar ones, and benchmarks them at 720p and 1080p.
+// See README.md for how to build it
+#include "../PixelFormatConversion.h"
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace PixelFormatConversion;
+
+namespace
+{
+    using benchmark_clock = std::chrono::steady_clock;
+
+    int failures = 0;
+
+    void check(bool condition, const std::string& message)
+    {
+        if (!condition)
+        {
+            std::cout << "FAILED: " << message << std::endl;
+            failures++;
+        }
+    }
+
+    std::vector<Kernels> supported_kernels()
+    {
+        std::vector<Kernels> result;
+        for (const auto kernels : { Kernels::Scalar, Kernels::SSE2, Kernels::AVX2 })
+        {
+            if (kernels <= BestKernels())
+            {
+                result.push_back(kernels);
+            }
+        }
+
+        return result;
+    }
+
+    // An image with padding after each row, so that writes past the end of a row are seen
+    struct Image
+    {
+        Image(const uint32_t width, const uint32_t height, const uint32_t bytes_per_pixel, const uint8_t fill = 0xCD) :
+            stride(width * bytes_per_pixel + 7), height(height), pixels(static_cast<size_t>(stride) * height + 64, fill)
+        {
+        }
+
+        uint8_t* row(const uint32_t y) { return pixels.data() + static_cast<size_t>(stride) * y; }
+
+        uint32_t stride;
+        uint32_t height;
+        std::vector<uint8_t> pixels;
+    };
+
+    Image random_image(const uint32_t width, const uint32_t height, const uint32_t bytes_per_pixel, std::mt19937& random)
+    {
+        Image image(width, height, bytes_per_pixel);
+        for (auto& value : image.pixels)
+        {
+            value = static_cast<uint8_t>(random());
+        }
+
+        return image;
+    }
+
+    // The source is read bottom-up, or the destination written bottom-up for YUY2ToRGB24
+    struct Conversion
+    {
+        const char* name;
+        uint32_t src_bytes_per_pixel;
+        std::function<std::vector<Image>(uint32_t width, uint32_t height)> outputs;
+        std::function<bool(Image& src, std::vector<Image>& out, uint32_t width, uint32_t height, Kernels kernels, bool bottom_up)> run;
+    };
+
+    uint8_t* first_row(Image& image, const uint32_t height, const bool bottom_up)
+    {
+        return bottom_up ? image.row(height - 1) : image.row(0);
+    }
+
+    ptrdiff_t stride(const Image& image, const bool bottom_up)
+    {
+        return bottom_up ? -static_cast<ptrdiff_t>(image.stride) : image.stride;
+    }
+
+    std::vector<Conversion> conversions()
+    {
+        return {
+            { "RGB24ToYUY2",
+              3,
+              [](uint32_t width, uint32_t height) { return std::vector<Image>{ Image(width, height, 2) }; },
+              [](Image& src, std::vector<Image>& out, uint32_t width, uint32_t height, Kernels kernels, bool bottom_up) {
+                  return RGB24ToYUY2(first_row(src, height, bottom_up), stride(src, bottom_up), out[0].row(0), out[0].stride, width, height, kernels);
+              } },
+            { "YUY2ToRGB24",
+              2,
+              [](uint32_t width, uint32_t height) { return std::vector<Image>{ Image(width, height, 3) }; },
+              [](Image& src, std::vector<Image>& out, uint32_t width, uint32_t height, Kernels kernels, bool bottom_up) {
+                  return YUY2ToRGB24(src.row(0), src.stride, first_row(out[0], height, bottom_up), stride(out[0], bottom_up), width, height, kernels);
+              } },
+            { "RGB24ToNV12",
+              3,
+              [](uint32_t width, uint32_t height) { return std::vector<Image>{ Image(width, height, 1), Image(width, height / 2, 1) }; },
+              [](Image& src, std::vector<Image>& out, uint32_t width, uint32_t height, Kernels kernels, bool bottom_up) {
+                  return RGB24ToNV12(first_row(src, height, bottom_up), stride(src, bottom_up), out[0].row(0), out[0].stride, out[1].row(0), out[1].stride, width, height, kernels);
+              } },
+            { "RGB24ToI420",
+              3,
+              [](uint32_t width, uint32_t height) { return std::vector<Image>{ Image(width, height, 1), Image(width / 2, height / 2, 1), Image(width / 2, height / 2, 1) }; },
+              [](Image& src, std::vector<Image>& out, uint32_t width, uint32_t height, Kernels kernels, bool bottom_up) {
+                  return RGB24ToI420(first_row(src, height, bottom_up),
+                                     stride(src, bottom_up),
+                                     out[0].row(0),
+                                     out[0].stride,
+                                     out[1].row(0),
+                                     out[1].stride,
+                                     out[2].row(0),
+                                     out[2].stride,
+                                     width,
+                                     height,
+                                     kernels);
+              } },
+        };
+    }
+
+    bool same_images(const std::vector<Image>& a, const std::vector<Image>& b)
+    {
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            if (a[i].pixels != b[i].pixels)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void check_bit_exactness()
+    {
+        std::mt19937 random(42);
+        const std::pair<uint32_t, uint32_t> sizes[] = { { 2, 2 }, { 16, 2 }, { 18, 4 }, { 20, 2 }, { 34, 6 }, { 50, 2 }, { 130, 10 }, { 642, 4 }, { 1280, 8 } };
+        for (const auto& conversion : conversions())
+        {
+            for (const auto& [width, height] : sizes)
+            {
+                auto src = random_image(width, height, conversion.src_bytes_per_pixel, random);
+                for (const bool bottom_up : { false, true })
+                {
+                    auto reference = conversion.outputs(width, height);
+                    check(conversion.run(src, reference, width, height, Kernels::Scalar, bottom_up), std::string(conversion.name) + " failed");
+                    for (const auto kernels : supported_kernels())
+                    {
+                        auto converted = conversion.outputs(width, height);
+                        check(conversion.run(src, converted, width, height, kernels, bottom_up), std::string(conversion.name) + " failed");
+                        check(same_images(converted, reference),
+                              std::string(conversion.name) + " " + KernelsName(kernels) + " differs at " + std::to_string(width) + "x" + std::to_string(height) +
+                                  (bottom_up ? " bottom-up" : ""));
+                    }
+                }
+            }
+        }
+
+        const std::pair<uint32_t, uint32_t> scales[][2] = {
+            { { 64, 48 }, { 64, 48 } },
+            { { 1920, 1080 }, { 1280, 720 } },
+            { { 1280, 720 }, { 1920, 1080 } },
+            { { 4000, 3000 }, { 640, 480 } },
+            { { 33, 17 }, { 101, 7 } },
+            { { 1, 1 }, { 5, 3 } },
+        };
+        for (const auto& [from, to] : scales)
+        {
+            auto src = random_image(from.first, from.second, 3, random);
+            Image reference(to.first, to.second, 3);
+            check(ScaleRGB24(src.row(0), src.stride, from.first, from.second, reference.row(0), reference.stride, to.first, to.second, Kernels::Scalar), "ScaleRGB24 failed");
+            for (const auto kernels : supported_kernels())
+            {
+                Image scaled(to.first, to.second, 3);
+                check(ScaleRGB24(src.row(0), src.stride, from.first, from.second, scaled.row(0), scaled.stride, to.first, to.second, kernels), "ScaleRGB24 failed");
+                check(scaled.pixels == reference.pixels,
+                      std::string("ScaleRGB24 ") + KernelsName(kernels) + " differs from " + std::to_string(from.first) + "x" + std::to_string(from.second) + " to " +
+                          std::to_string(to.first) + "x" + std::to_string(to.second));
+            }
+
+            if (from == to)
+            {
+                bool same = true;
+                for (uint32_t y = 0; y < to.second; y++)
+                {
+                    same = same && std::equal(src.row(y), src.row(y) + to.first * 3, reference.row(y));
+                }
+                check(same, "ScaleRGB24 changed an image of the same size");
+            }
+        }
+    }
+
+    // Known values of the BT.601 formulas, and the conversions which have to fail
+    void check_values()
+    {
+        const uint8_t rgb[] = { 255, 255, 255, 0, 0, 0, 0, 0, 255, 0, 0, 255 };
+        uint8_t yuy2[8]{};
+        check(RGB24ToYUY2(rgb, sizeof(rgb), yuy2, sizeof(yuy2), 4, 1, Kernels::Scalar), "RGB24ToYUY2 failed");
+        check(yuy2[0] == 235 && yuy2[2] == 16, "white and black don't have the luma of the video range");
+        check(yuy2[4] == 82 && yuy2[5] == 90 && yuy2[6] == 82 && yuy2[7] == 240, "red doesn't have the BT.601 values");
+
+        uint8_t back[12]{};
+        check(YUY2ToRGB24(yuy2, sizeof(yuy2), back, sizeof(back), 4, 1, Kernels::Scalar), "YUY2ToRGB24 failed");
+        check(back[0] >= 250 && back[3] <= 5 && back[8] >= 250 && back[6] <= 5 && back[7] <= 5, "the colors don't survive a round trip");
+
+        check(!RGB24ToYUY2(rgb, sizeof(rgb), yuy2, sizeof(yuy2), 3, 1), "an odd width was converted to YUY2");
+        check(!RGB24ToNV12(rgb, sizeof(rgb), yuy2, 4, yuy2 + 4, 4, 4, 1), "an odd height was converted to NV12");
+        check(!ScaleRGB24(rgb, sizeof(rgb), 4, 1, back, sizeof(back), 0, 1), "an image was scaled to an empty one");
+    }
+
+    template<typename Function>
+    double milliseconds_per_call(Function function)
+    {
+        constexpr int iterations = 50;
+        function();
+        const auto start = benchmark_clock::now();
+        for (int i = 0; i < iterations; i++)
+        {
+            function();
+        }
+
+        return std::chrono::duration<double, std::milli>(benchmark_clock::now() - start).count() / iterations;
+    }
+
+    void benchmark(const uint32_t width, const uint32_t height)
+    {
+        std::mt19937 random(7);
+        auto rgb = random_image(width, height, 3, random);
+        auto yuy2 = random_image(width, height, 2, random);
+        for (const auto kernels : supported_kernels())
+        {
+            std::printf("%ux%u %-6s", width, height, KernelsName(kernels));
+            for (const auto& conversion : conversions())
+            {
+                auto& src = conversion.src_bytes_per_pixel == 3 ? rgb : yuy2;
+                auto out = conversion.outputs(width, height);
+                std::printf(" %s %6.3f ms", conversion.name, milliseconds_per_call([&] { conversion.run(src, out, width, height, kernels, false); }));
+            }
+
+            // 720p is scaled to 1080p and the other way around, like an overlay image of the other size
+            const uint32_t scaled_width = 1920 + 1280 - width;
+            const uint32_t scaled_height = 1080 + 720 - height;
+            Image scaled(scaled_width, scaled_height, 3);
+            std::printf(" ScaleRGB24 to %ux%u %6.3f ms\n", scaled_width, scaled_height, milliseconds_per_call([&] {
+                            ScaleRGB24(rgb.row(0), rgb.stride, width, height, scaled.row(0), scaled.stride, scaled_width, scaled_height, kernels);
+                        }));
+        }
+    }
+}
+
+int main()
+{
+    std::printf("best kernels: %s\n", KernelsName(BestKernels()));
+    check_values();
+    check_bit_exactness();
+    benchmark(1280, 720);
+    benchmark(1920, 1080);
+
+    if (failures > 0)
+    {
+        std::cout << failures << " checks failed" << std::endl;
+        return 1;
+    }
+
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,209 @@
+// Benchmarks the path of the overlay image into the camera frames: decoding and converting the image in the proxy filter for every
+// posted image, against converting it once in the module and copying the published frame. See README.md for how to build it
+#include "../CameraStateUpdateChannels.h"
+#include "../ImageLoading.h"
+#include "../SerializedSharedMemory.h"
+
+#include <mfapi.h>
+#include <shlwapi.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <wil/resource.h>
+
+namespace
+{
+    using benchmark_clock = std::chrono::steady_clock;
+
+    constexpr uint32_t frame_width = 1280;
+    constexpr uint32_t frame_height = 720;
+    constexpr int iterations = 50;
+    constexpr float quality = 0.5f;
+
+    int failures = 0;
+
+    void check(bool condition, const std::string& message)
+    {
+        if (!condition)
+        {
+            std::cout << "FAILED: " << message << std::endl;
+            failures++;
+        }
+    }
+
+    double milliseconds_since(benchmark_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(benchmark_clock::now() - start).count();
+    }
+
+    const char* format_name(OverlayFrameFormat format)
+    {
+        switch (format)
+        {
+        case OverlayFrameFormat::RGB24:
+            return "RGB24";
+        case OverlayFrameFormat::YUY2:
+            return "YUY2";
+        case OverlayFrameFormat::NV12:
+            return "NV12";
+        case OverlayFrameFormat::MJPG:
+            return "MJPG";
+        }
+
+        return "";
+    }
+
+    // A 24bpp bottom-up BMP with a gradient, larger than the frames like the pictures users pick
+    std::vector<BYTE> make_bmp(const LONG width, const LONG height)
+    {
+        const DWORD stride = (width * 3 + 3) & ~3;
+        const DWORD headers_size = sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER);
+        std::vector<BYTE> bmp(headers_size + stride * height);
+
+        auto file_header = reinterpret_cast<BITMAPFILEHEADER*>(bmp.data());
+        file_header->bfType = 'MB';
+        file_header->bfSize = static_cast<DWORD>(bmp.size());
+        file_header->bfOffBits = headers_size;
+
+        auto info_header = reinterpret_cast<BITMAPINFOHEADER*>(bmp.data() + sizeof(BITMAPFILEHEADER));
+        info_header->biSize = sizeof(BITMAPINFOHEADER);
+        info_header->biWidth = width;
+        info_header->biHeight = height;
+        info_header->biPlanes = 1;
+        info_header->biBitCount = 24;
+        info_header->biCompression = BI_RGB;
+
+        for (LONG y = 0; y < height; y++)
+        {
+            BYTE* row = bmp.data() + headers_size + y * stride;
+            for (LONG x = 0; x < width; x++)
+            {
+                row[x * 3 + 0] = static_cast<BYTE>(x * 255 / width);
+                row[x * 3 + 1] = static_cast<BYTE>(y * 255 / height);
+                row[x * 3 + 2] = static_cast<BYTE>((x + y) & 0xFF);
+            }
+        }
+
+        return bmp;
+    }
+
+    std::vector<BYTE> sample_bytes(IMFSample* sample)
+    {
+        wil::com_ptr_nothrow<IMFMediaBuffer> buffer;
+        BYTE* data = nullptr;
+        DWORD max_length = 0, length = 0;
+        if (!sample || FAILED(sample->ConvertToContiguousBuffer(&buffer)) || FAILED(buffer->Lock(&data, &max_length, &length)))
+        {
+            return {};
+        }
+
+        std::vector<BYTE> result(data, data + length);
+        buffer->Unlock();
+        return result;
+    }
+
+    // What the proxy filter did for every posted image: wrap the image bytes in a stream, then decode, scale and convert them
+    wil::com_ptr_nothrow<IMFSample> legacy_conversion(const std::vector<BYTE>& image, IMFMediaType* media_type)
+    {
+        wil::com_ptr_nothrow<IStream> stream;
+        stream.attach(SHCreateMemStream(image.data(), static_cast<UINT>(image.size())));
+        return LoadImageAsSample(stream, media_type, quality);
+    }
+
+    void benchmark_format(const std::vector<BYTE>& image, OverlayFrameFormat format, const uint32_t version)
+    {
+        const OverlayFrameDescription description{ format, frame_width, frame_height };
+        auto media_type = CreateOverlayFrameMediaType(description);
+        check(media_type != nullptr, std::string(format_name(format)) + ": no media type");
+        if (!media_type)
+        {
+            return;
+        }
+
+        std::vector<BYTE> legacy_frame;
+        auto start = benchmark_clock::now();
+        for (int i = 0; i < iterations; i++)
+        {
+            legacy_frame = sample_bytes(legacy_conversion(image, media_type.get()).get());
+        }
+        const double legacy_time = milliseconds_since(start) / iterations;
+        check(!legacy_frame.empty(), std::string(format_name(format)) + ": the image wasn't converted");
+
+        // The module converts the image once and publishes it
+        start = benchmark_clock::now();
+        const auto published_frame = sample_bytes(legacy_conversion(image, media_type.get()).get());
+        auto slot = SerializedSharedMemory::create(CameraOverlayFrameChannel::endpoint(version), published_frame.size(), false);
+        check(slot.has_value(), std::string(format_name(format)) + ": the slot wasn't created");
+        if (!slot)
+        {
+            return;
+        }
+        slot->access([&published_frame](auto memory) {
+            std::copy(published_frame.begin(), published_frame.end(), memory._data);
+        });
+        const double publish_time = milliseconds_since(start);
+
+        // The filter maps the slot once per version, then copies it into every frame
+        start = benchmark_clock::now();
+        auto mapped_slot = SerializedSharedMemory::open(CameraOverlayFrameChannel::endpoint(version), published_frame.size(), true);
+        const double open_time = milliseconds_since(start);
+        check(mapped_slot.has_value(), std::string(format_name(format)) + ": the slot wasn't opened");
+        if (!mapped_slot)
+        {
+            return;
+        }
+
+        std::vector<BYTE> frame(published_frame.size());
+        start = benchmark_clock::now();
+        for (int i = 0; i < iterations; i++)
+        {
+            mapped_slot->access([&frame](auto memory) {
+                std::copy(memory._data, memory._data + memory._size, frame.data());
+            });
+        }
+        const double copy_time = milliseconds_since(start) / iterations;
+
+        check(frame == legacy_frame, std::string(format_name(format)) + ": the copied frame differs from the converted image");
+        std::printf("%-5s %ux%u, %7zu bytes: filter conversion %8.3f ms per image, module publish %8.3f ms once, slot open %6.3f ms, frame copy %6.3f ms\n",
+                    format_name(format),
+                    frame_width,
+                    frame_height,
+                    frame.size(),
+                    legacy_time,
+                    publish_time,
+                    open_time,
+                    copy_time);
+    }
+}
+
+int main()
+{
+    auto com = wil::CoInitializeEx(COINIT_MULTITHREADED);
+    if (FAILED(MFStartup(MF_VERSION)))
+    {
+        std::cout << "Media Foundation isn't available" << std::endl;
+        return 1;
+    }
+
+    const auto image = make_bmp(1920, 1080);
+    uint32_t version = GetTickCount();
+    for (const auto format : { OverlayFrameFormat::RGB24, OverlayFrameFormat::YUY2, OverlayFrameFormat::NV12, OverlayFrameFormat::MJPG })
+    {
+        benchmark_format(image, format, ++version);
+    }
+
+    MFShutdown();
+    if (failures > 0)
+    {
+        std::cout << failures << " checks failed" << std::endl;
+        return 1;
+    }
+
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,298 @@
+// Stress test of the frame handoff of the camera proxy filter (FrameRing.h): a synthetic camera thread delivers frames at 60 fps
+// to a worker thread which paces and delivers them like the filter does. See README.md for how to build it
+#include "../FrameRing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace
+{
+    using stress_clock = std::chrono::steady_clock;
+
+    int failures = 0;
+
+    void check(bool condition, const std::string& message)
+    {
+        if (!condition)
+        {
+            std::cout << "FAILED: " << message << std::endl;
+            failures++;
+        }
+    }
+
+    // Stands for the IMediaSample which the capture thread AddRefs before it queues it, and which is released once
+    std::atomic_int64_t live_frames = 0;
+
+    struct frame_t
+    {
+        uint64_t index = 0;
+        bool released = false;
+    };
+
+    frame_t* new_frame(const uint64_t index)
+    {
+        live_frames++;
+        return new frame_t{ index };
+    }
+
+    void release(frame_t* frame)
+    {
+        check(!frame->released, "frame " + std::to_string(frame->index) + " was released twice");
+        frame->released = true;
+        live_frames--;
+        delete frame;
+    }
+
+    struct queued_frame
+    {
+        frame_t* frame = nullptr;
+        stress_clock::time_point capture_time;
+    };
+
+    // The portable counterpart of the auto-reset event which wakes the worker thread of the filter
+    class auto_reset_event
+    {
+    public:
+        void set()
+        {
+            {
+                std::unique_lock lock(mutex);
+                signaled = true;
+            }
+            cv.notify_one();
+        }
+
+        void wait_for(const stress_clock::duration timeout)
+        {
+            std::unique_lock lock(mutex);
+            cv.wait_for(lock, timeout, [this] { return signaled; });
+            signaled = false;
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool signaled = false;
+    };
+
+    // Pushes and pops a sequence as fast as possible, so that the ring is full or empty most of the time
+    void check_ordering(const uint64_t count)
+    {
+        FrameRing<uint64_t, 4> ring;
+        std::thread producer([&ring, count] {
+            for (uint64_t i = 1; i <= count; i++)
+            {
+                while (!ring.TryPush(i))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        uint64_t expected = 1;
+        uint64_t value = 0;
+        bool ordered = true;
+        while (expected <= count)
+        {
+            if (!ring.TryPop(value))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            if (value != expected)
+            {
+                ordered = false;
+                break;
+            }
+            expected++;
+        }
+        producer.join();
+
+        check(ordered, "the ring returned " + std::to_string(value) + " instead of " + std::to_string(expected));
+        check(!ring.TryPop(value), "the ring isn't empty after the sequence");
+        std::cout << "Ordering: " << count << " values through a ring of 4" << std::endl;
+    }
+
+    struct scenario_t
+    {
+        const char* name;
+        double camera_fps;
+        double negotiated_fps;
+        // Frames which the camera delivers at once every this many frames, none if 0
+        int burst_every;
+        // The application blocks in Receive for this long every this many frames, never if 0
+        int stall_every;
+        std::chrono::milliseconds stall;
+        // The camera delivers every frame of the negotiated rate on time, so the worker must deliver at least 98% of it
+        bool keeps_frame_rate;
+    };
+
+    void run_scenario(const scenario_t& scenario, const std::chrono::seconds duration)
+    {
+        FrameRing<queued_frame, 4> frames;
+        auto_reset_event frame_ready;
+        std::atomic_bool shutdown_request = false;
+        std::atomic_uint64_t received = 0;
+        std::atomic_uint64_t dropped_queue_full = 0;
+
+        const auto camera_interval = std::chrono::duration_cast<stress_clock::duration>(std::chrono::duration<double>(1.0 / scenario.camera_fps));
+        const auto negotiated_interval =
+            std::chrono::duration_cast<stress_clock::duration>(std::chrono::duration<double>(1.0 / scenario.negotiated_fps));
+
+        uint64_t delivered = 0;
+        uint64_t dropped_late = 0;
+        uint64_t dropped_paced = 0;
+        uint64_t last_index = 0;
+        bool ordered = true;
+        auto min_gap = stress_clock::duration::max();
+        stress_clock::time_point last_capture_time;
+
+        // The worker thread of the filter, with Receive replaced by a random amount of work
+        std::thread worker([&] {
+            FramePacer pacer;
+            pacer.SetInterval(negotiated_interval);
+            std::mt19937 random(7);
+            std::uniform_int_distribution<int> work_us(500, 4000);
+            while (!shutdown_request)
+            {
+                frame_ready.wait_for(std::chrono::seconds(1));
+
+                queued_frame frame;
+                if (!frames.TryPopNewest(frame, [&dropped_late](queued_frame& stale_frame) {
+                        release(stale_frame.frame);
+                        dropped_late++;
+                    }))
+                {
+                    continue;
+                }
+
+                if (!pacer.Admit(frame.capture_time))
+                {
+                    release(frame.frame);
+                    dropped_paced++;
+                    continue;
+                }
+
+                if (delivered && frame.frame->index <= last_index)
+                {
+                    ordered = false;
+                }
+                if (delivered)
+                {
+                    min_gap = std::min(min_gap, frame.capture_time - last_capture_time);
+                }
+                last_index = frame.frame->index;
+                last_capture_time = frame.capture_time;
+
+                if (scenario.stall_every && frame.frame->index % scenario.stall_every == 0)
+                {
+                    std::this_thread::sleep_for(scenario.stall);
+                }
+                else
+                {
+                    std::this_thread::sleep_for(std::chrono::microseconds(work_us(random)));
+                }
+                release(frame.frame);
+                delivered++;
+            }
+        });
+
+        // The capture thread: frames on a fixed cadence with some jitter, and bursts of two frames if asked
+        std::mt19937 random(11);
+        std::uniform_int_distribution<int> jitter_us(-2000, 2000);
+        const auto start = stress_clock::now();
+        const uint64_t frame_count = static_cast<uint64_t>(scenario.camera_fps * duration.count());
+        for (uint64_t i = 1; i <= frame_count; i++)
+        {
+            const uint64_t burst = scenario.burst_every && i % scenario.burst_every == 1 && i < frame_count ? 1 : 0;
+            std::this_thread::sleep_until(start + camera_interval * i + std::chrono::microseconds(jitter_us(random)));
+            for (uint64_t index = i; index <= i + burst; index++)
+            {
+                received++;
+                auto frame = new_frame(index);
+                if (!frames.TryPush(queued_frame{ frame, stress_clock::now() }))
+                {
+                    release(frame);
+                    dropped_queue_full++;
+                }
+                frame_ready.set();
+            }
+            i += burst;
+        }
+        const auto elapsed = std::chrono::duration<double>(stress_clock::now() - start).count();
+
+        shutdown_request = true;
+        frame_ready.set();
+        worker.join();
+
+        uint64_t left_in_queue = 0;
+        queued_frame frame;
+        while (frames.TryPop(frame))
+        {
+            release(frame.frame);
+            left_in_queue++;
+        }
+
+        char buf[512]{};
+        snprintf(buf,
+                 sizeof(buf),
+                 "%-26s received %5llu, delivered %5llu (%5.1f fps), dropped %3llu with a full queue, %4llu late, %4llu above the frame rate, %llu left, min interval %.2f ms",
+                 scenario.name,
+                 static_cast<unsigned long long>(received.load()),
+                 static_cast<unsigned long long>(delivered),
+                 delivered / elapsed,
+                 static_cast<unsigned long long>(dropped_queue_full.load()),
+                 static_cast<unsigned long long>(dropped_late),
+                 static_cast<unsigned long long>(dropped_paced),
+                 static_cast<unsigned long long>(left_in_queue),
+                 delivered > 1 ? std::chrono::duration<double, std::milli>(min_gap).count() : 0.0);
+        std::cout << buf << std::endl;
+
+        const std::string name = scenario.name;
+        check(received == delivered + dropped_queue_full + dropped_late + dropped_paced + left_in_queue, name + ": frames are missing from the counters");
+        check(live_frames == 0, name + ": " + std::to_string(live_frames.load()) + " frames weren't released");
+        check(ordered, name + ": the frames weren't delivered in order");
+        check(delivered > 0, name + ": no frame was delivered");
+        check(delivered / elapsed <= scenario.negotiated_fps * 1.02, name + ": frames were delivered faster than the negotiated frame rate");
+        check(delivered < 2 || min_gap >= negotiated_interval / 4, name + ": frames were delivered in a burst");
+        check(!scenario.keeps_frame_rate || delivered / elapsed >= scenario.negotiated_fps * 0.98, name + ": frames were delivered slower than the negotiated frame rate");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const auto duration = std::chrono::seconds(argc > 1 ? std::max(1, std::atoi(argv[1])) : 5);
+
+    check_ordering(10'000'000);
+
+    const scenario_t scenarios[] = {
+        { "60 fps camera", 60.0, 60.0, 0, 0, {}, true },
+        { "60 fps with stalls", 60.0, 60.0, 0, 90, std::chrono::milliseconds(120), false },
+        { "60 fps in bursts", 60.0, 60.0, 10, 0, {}, false },
+        { "90 fps camera at 60 fps", 90.0, 60.0, 0, 0, {}, true },
+    };
+    for (const auto& scenario : scenarios)
+    {
+        run_scenario(scenario, duration);
+    }
+
+    if (failures)
+    {
+        std::cout << failures << " checks failed" << std::endl;
+        return 1;
+    }
+
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}
@@ -1,6 +1,9 @@
 #include "pch.h"
 #include "centralized_kb_hook.h"
 #include <common/debug_control.h>
+#include <common/hooks/HookTelemetry.h>
+#include <common/hooks/HotkeyTable.h>
+#include <common/interop/shared_constants.h>
 #include <common/utils/winapi_error.h>
 #include <common/logger/logger.h>
 
@@ -10,7 +13,7 @@ namespace CentralizedKeyboardHook
     {
         Hotkey hotkey;
         std::wstring moduleName;
-        std::function<bool()> action;
+        std::shared_ptr<const std::function<bool()>> action;
 
         bool operator<(const HotkeyDescriptor& other) const
         {
@@ -18,10 +21,26 @@ namespace CentralizedKeyboardHook
         };
     };
 
+    using HotkeyTable = LowlevelHotkeys::Table<std::shared_ptr<const std::function<bool()>>>;
+
+    // Registered hotkeys. Only used to rebuild the hook table when the registrations change
     std::multiset<HotkeyDescriptor> hotkeyDescriptors;
     std::mutex mutex;
+
+    // Table used by the hook, rebuilt from hotkeyDescriptors and swapped in without locking the hook
+    LowlevelHotkeys::Snapshot<HotkeyTable> hotkeyTable;
+
+    // Modifier keys pressed according to the events seen by the hook. Only accessed from the hook thread
+    LowlevelHotkeys::ModifierTracker modifierTracker;
+
     HHOOK hHook{};
 
+    // Hook for the desktop switch and foreground events, after which the tracked modifiers are resynced with the keyboard state
+    HWINEVENTHOOK hResyncEventHook{};
+
+    // Records the processing time of the hook events. Created when the hook is started
+    std::unique_ptr<HookTelemetry::Recorder> hookTelemetry;
+
     struct DestroyOnExit
     {
         ~DestroyOnExit()
@@ -30,59 +49,117 @@ namespace CentralizedKeyboardHook
         }
     } destroyOnExitObj;
 
+    // Function to rebuild the hook table from the registered hotkeys. Must be called with the mutex held
+    void PublishHotkeyTable()
+    {
+        auto table = std::make_unique<HotkeyTable>();
+        for (const auto& descriptor : hotkeyDescriptors)
+        {
+            // Descriptors with the same hotkey are kept in registration order, so the action registered first is used
+            const auto& hotkey = descriptor.hotkey;
+            table->Add(LowlevelHotkeys::MakeModifierMask(hotkey.win, hotkey.ctrl, hotkey.shift, hotkey.alt), hotkey.key, descriptor.action);
+        }
+
+        hotkeyTable.Publish(std::move(table));
+    }
+
+    // Function to invoke the action of the hotkey which is pressed. Returns true if the key press should be swallowed
+    bool HandleKeyDown(const KBDLLHOOKSTRUCT& keyPressInfo)
+    {
+        const HotkeyTable& table = hotkeyTable.Adopt();
+        const auto key = static_cast<uint8_t>(keyPressInfo.vkCode);
+        if (!table.HasKey(key))
+        {
+            return false;
+        }
+
+        const uint8_t trackedMask = modifierTracker.Mask();
+        const std::shared_ptr<const std::function<bool()>>* entry = table.Find(trackedMask, key);
+        if (!entry)
+        {
+            // The tracked state misses the key downs and key ups which the hook didn't see. Desktop switches are handled by ResyncEventProc,
+            // so only a key which hotkeys use but no hotkey matched is checked against the keyboard state, and the keyboard state wins if they disagree
+            modifierTracker.Resync();
+            if (modifierTracker.Mask() == trackedMask)
+            {
+                return false;
+            }
+
+            entry = table.Find(modifierTracker.Mask(), key);
+            if (!entry)
+            {
+                return false;
+            }
+        }
+
+        // The action can re-enter the hook and adopt a new table, so the action is kept alive by a reference of its own
+        const std::shared_ptr<const std::function<bool()>> action = *entry;
+        if ((*action)())
+        {
+            // After invoking the hotkey send a dummy key to prevent Start Menu from activating
+            INPUT dummyEvent[1] = {};
+            dummyEvent[0].type = INPUT_KEYBOARD;
+            dummyEvent[0].ki.wVk = 0xFF;
+            dummyEvent[0].ki.dwFlags = KEYEVENTF_KEYUP;
+            SendInput(1, dummyEvent, sizeof(INPUT));
+
+            // Swallow the key press
+            return true;
+        }
+
+        return false;
+    }
+
     LRESULT CALLBACK KeyboardHookProc(_In_ int nCode, _In_ WPARAM wParam, _In_ LPARAM lParam)
     {
-        if (nCode < 0 || ((wParam != WM_KEYDOWN) && (wParam != WM_SYSKEYDOWN)))
+        if (nCode < 0)
         {
             return CallNextHookEx(hHook, nCode, wParam, lParam);
         }
 
         const auto& keyPressInfo = *reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
 
-        Hotkey hotkey{
-            .win = (GetAsyncKeyState(VK_LWIN) & 0x8000) || (GetAsyncKeyState(VK_RWIN) & 0x8000),
-            .ctrl = static_cast<bool>(GetAsyncKeyState(VK_CONTROL) & 0x8000),
-            .shift = static_cast<bool>(GetAsyncKeyState(VK_SHIFT) & 0x8000),
-            .alt = static_cast<bool>(GetAsyncKeyState(VK_MENU) & 0x8000),
-            .key = static_cast<unsigned char>(keyPressInfo.vkCode)
-        };
+        LARGE_INTEGER start, end;
+        QueryPerformanceCounter(&start);
+        const bool swallow = (wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN) && HandleKeyDown(keyPressInfo);
 
-        std::function<bool()> action;
+        // The tracked state is updated after the lookup, so that the hotkeys see the modifiers as they were before the event, same as GetAsyncKeyState in the hook.
+        // Swallowed key presses don't change the key state
+        if (!swallow)
         {
-            // Hold the lock for the shortest possible duration
-            std::unique_lock lock{ mutex };
-            HotkeyDescriptor dummy{ .hotkey = hotkey };
-            auto it = hotkeyDescriptors.find(dummy);
-            if (it != hotkeyDescriptors.end())
-            {
-                action = it->action;
-            }
+            modifierTracker.Update(keyPressInfo.vkCode, wParam);
         }
+        QueryPerformanceCounter(&end);
 
-        if (action)
+        if (hookTelemetry)
         {
-            if (action())
-            {
-                // After invoking the hotkey send a dummy key to prevent Start Menu from activating
-                INPUT dummyEvent[1] = {};
-                dummyEvent[0].type = INPUT_KEYBOARD;
-                dummyEvent[0].ki.wVk = 0xFF;
-                dummyEvent[0].ki.dwFlags = KEYEVENTF_KEYUP;
-                SendInput(1, dummyEvent, sizeof(INPUT));
-
-                // Swallow the key press
-                return 1;
-            }
+            hookTelemetry->Record(end.QuadPart - start.QuadPart, wParam, keyPressInfo.vkCode, swallow ? HookTelemetry::Decision::Suppressed : HookTelemetry::Decision::PassThrough);
+        }
+
+        if (swallow)
+        {
+            return 1;
         }
 
         return CallNextHookEx(hHook, nCode, wParam, lParam);
     }
 
+    // Function to resync the tracked modifiers after the events which the hook can miss key ups around, e.g. while the secure desktop was active or when
+    // another window took the foreground with a modifier held down. Called on the hook thread, so it doesn't race with KeyboardHookProc
+    void CALLBACK ResyncEventProc(HWINEVENTHOOK, DWORD event, HWND, LONG, LONG, DWORD, DWORD)
+    {
+        if (event == EVENT_SYSTEM_FOREGROUND || event == EVENT_SYSTEM_DESKTOPSWITCH)
+        {
+            modifierTracker.Resync();
+        }
+    }
+
     void SetHotkeyAction(const std::wstring& moduleName, const Hotkey& hotkey, std::function<bool()>&& action) noexcept
     {
         Logger::trace(L"Register hotkey action for {}", moduleName);
         std::unique_lock lock{ mutex };
-        hotkeyDescriptors.insert({ .hotkey = hotkey, .moduleName = moduleName, .action = std::move(action) });
+        hotkeyDescriptors.insert({ .hotkey = hotkey, .moduleName = moduleName, .action = std::make_shared<const std::function<bool()>>(std::move(action)) });
+        PublishHotkeyTable();
     }
 
     void ClearModuleHotkeys(const std::wstring& moduleName) noexcept
@@ -101,6 +178,8 @@ namespace CentralizedKeyboardHook
                 ++it;
             }
         }
+
+        PublishHotkeyTable();
     }
 
     void Start() noexcept
@@ -112,8 +191,22 @@ namespace CentralizedKeyboardHook
 #endif
         if (!hook_disabled)
         {
+            if (!hookTelemetry)
+            {
+                hookTelemetry = std::make_unique<HookTelemetry::Recorder>(CommonSharedConstants::CENTRALIZED_KEYBOARD_HOOK_STATS_SHARED_MEMORY, [](const HookTelemetry::IntervalStats& stats) {
+                    if (stats.timeoutRiskEventCount > 0)
+                    {
+                        Logger::warn(L"{} centralized keyboard hook events took more than half of the {} ms hook timeout", stats.timeoutRiskEventCount, stats.hookTimeoutMs);
+                    }
+
+                    Logger::trace(L"Centralized keyboard hook time over the last {} events ({} swallowed): p50 {:.1f} us, p99 {:.1f} us, max {:.1f} us, {} slow events, {} dropped records", stats.eventCount, stats.suppressedEventCount, stats.p50Us, stats.p99Us, stats.maxUs, stats.slowEventCount, stats.droppedRecordCount);
+                });
+            }
+
             if (!hHook)
             {
+                // Modifiers which are already held down when the hook starts are not seen by it
+                modifierTracker.Resync();
                 hHook = SetWindowsHookExW(WH_KEYBOARD_LL, KeyboardHookProc, NULL, NULL);
                 if (!hHook)
                 {
@@ -121,6 +214,16 @@ namespace CentralizedKeyboardHook
                     show_last_error_message(L"SetWindowsHookEx", errorCode, L"centralized_kb_hook");
                 }
             }
+
+            if (!hResyncEventHook)
+            {
+                // The range between EVENT_SYSTEM_FOREGROUND and EVENT_SYSTEM_DESKTOPSWITCH also contains other events, which are filtered by ResyncEventProc
+                hResyncEventHook = SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_DESKTOPSWITCH, nullptr, ResyncEventProc, 0, 0, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+                if (!hResyncEventHook)
+                {
+                    Logger::warn(L"Failed to set the desktop switch event hook of the centralized keyboard hook: {}", get_last_error_or_default(GetLastError()));
+                }
+            }
         }
     }
 
@@ -130,5 +233,10 @@ namespace CentralizedKeyboardHook
         {
             hHook = NULL;
         }
+
+        if (hResyncEventHook && UnhookWinEvent(hResyncEventHook))
+        {
+            hResyncEventHook = NULL;
+        }
     }
 }
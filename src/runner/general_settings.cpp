@@ -5,6 +5,7 @@
 
 #include <common/SettingsAPI/settings_helpers.h>
 #include "powertoy_module.h"
+#include "startup_scheduler.h"
 #include <common/themes/windows_colors.h>
 
 #include "trace.h"
@@ -79,11 +80,18 @@ GeneralSettings get_general_settings()
         settings.isModulesEnabledMap[name] = powertoy->is_enabled();
     }
 
+    // Modules which are still deferred were disabled at startup and haven't been enabled since
+    for (const auto& name : deferred_module_keys())
+    {
+        settings.isModulesEnabledMap[name] = false;
+    }
+
     return settings;
 }
 
-void apply_general_settings(const json::JsonObject& general_configs, bool save)
+std::vector<std::wstring> apply_general_settings(const json::JsonObject& general_configs, bool save)
 {
+    std::vector<std::wstring> toggled_modules;
     run_as_elevated = general_configs.GetNamedBoolean(L"run_elevated", false);
 
     download_updates_automatically = general_configs.GetNamedBoolean(L"download_updates_automatically", true);
@@ -130,7 +138,7 @@ void apply_general_settings(const json::JsonObject& general_configs, bool save)
             }
             const std::wstring name{ enabled_element.Key().c_str() };
             const bool found = modules().find(name) != modules().end();
-            if (!found)
+            if (!found && !(value.GetBoolean() && load_deferred_module(name)))
             {
                 continue;
             }
@@ -148,6 +156,7 @@ void apply_general_settings(const json::JsonObject& general_configs, bool save)
             {
                 modules().at(name)->disable();
             }
+            toggled_modules.push_back(name);
         }
     }
 
@@ -162,16 +171,17 @@ void apply_general_settings(const json::JsonObject& general_configs, bool save)
         PTSettingsHelper::save_general_settings(save_settings.to_json());
         Trace::SettingsChanged(save_settings);
     }
+
+    return toggled_modules;
 }
 
-void start_initial_powertoys()
+std::unordered_set<std::wstring> get_disabled_powertoys()
 {
     std::unordered_set<std::wstring> powertoys_to_disable;
 
-    json::JsonObject general_settings;
     try
     {
-        general_settings = load_general_settings();
+        json::JsonObject general_settings = load_general_settings();
         if (general_settings.HasKey(L"enabled"))
         {
             json::JsonObject enabled = general_settings.GetNamedObject(L"enabled");
@@ -188,21 +198,5 @@ void start_initial_powertoys()
     {
     }
 
-    if (powertoys_to_disable.empty())
-    {
-        for (auto& [name, powertoy] : modules())
-        {
-            powertoy->enable();
-        }
-    }
-    else
-    {
-        for (auto& [name, powertoy] : modules())
-        {
-            if (powertoys_to_disable.find(name) == powertoys_to_disable.end())
-            {
-                powertoy->enable();
-            }
-        }
-    }
+    return powertoys_to_disable;
 }
@@ -20,5 +20,8 @@ struct GeneralSettings
 
 json::JsonObject load_general_settings();
 GeneralSettings get_general_settings();
-void apply_general_settings(const json::JsonObject& general_configs, bool save = true);
-void start_initial_powertoys();
\ No newline at end of file
+// Function to apply the general settings. Returns the keys of the modules which were enabled or disabled
+std::vector<std::wstring> apply_general_settings(const json::JsonObject& general_configs, bool save = true);
+
+// Function to get the keys of the modules which are disabled in the saved general settings
+std::unordered_set<std::wstring> get_disabled_powertoys();
\ No newline at end of file
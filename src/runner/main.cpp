@@ -10,6 +10,7 @@
 #include "RestartManagement.h"
 #include "Generated files/resource.h"
 #include "settings_telemetry.h"
+#include "startup_scheduler.h"
 
 #include <common/comUtils/comUtils.h>
 #include <common/display/dpi_aware.h>
@@ -22,6 +23,7 @@
 #include <common/utils/elevation.h>
 #include <common/utils/os-detect.h>
 #include <common/utils/processApi.h>
+#include <common/utils/profiler.h>
 #include <common/utils/resources.h>
 
 #include "UpdateUtils.h"
@@ -49,7 +51,6 @@
 namespace
 {
     const wchar_t PT_URI_PROTOCOL_SCHEME[] = L"powertoys://";
-    const wchar_t POWER_TOYS_MODULE_LOAD_FAIL[] = L"Failed to load "; // Module name will be appended on this message and it is not localized.
 }
 
 void chdir_current_executable()
@@ -110,6 +111,8 @@ int runner(bool isProcessElevated, bool openSettings, bool openOobe)
 //init_global_error_handlers();
 #endif
     Trace::RegisterProvider();
+    Profiler::ExportListener profilerExportListener(L"PowerToys");
+    Profiler::RegisterCurrentThread();
     start_tray_icon();
     CentralizedKeyboardHook::Start();
 
@@ -132,39 +135,22 @@ int runner(bool isProcessElevated, bool openSettings, bool openOobe)
         chdir_current_executable();
         // Load Powertoys DLLs
 
-        std::vector<std::wstring_view> knownModules = {
-            L"modules/FancyZones/FancyZonesModuleInterface.dll",
-            L"modules/FileExplorerPreview/powerpreview.dll",
-            L"modules/ImageResizer/ImageResizerExt.dll",
-            L"modules/KeyboardManager/KeyboardManager.dll",
-            L"modules/Launcher/Microsoft.Launcher.dll",
-            L"modules/PowerRename/PowerRenameExt.dll",
-            L"modules/ShortcutGuide/ShortcutGuideModuleInterface/ShortcutGuideModuleInterface.dll",
-            L"modules/ColorPicker/ColorPicker.dll",
-            L"modules/Awake/AwakeModuleInterface.dll",
+        std::vector<KnownModule> knownModules = {
+            { L"modules/FancyZones/FancyZonesModuleInterface.dll", L"FancyZones" },
+            // The constructor updates the registry to match the preview handler toggles, which has to happen even when the module is disabled
+            { L"modules/FileExplorerPreview/powerpreview.dll", L"File Explorer", true, true },
+            { L"modules/ImageResizer/ImageResizerExt.dll", L"Image Resizer" },
+            { L"modules/KeyboardManager/KeyboardManager.dll", L"Keyboard Manager" },
+            { L"modules/Launcher/Microsoft.Launcher.dll", L"PowerToys Run" },
+            { L"modules/PowerRename/PowerRenameExt.dll", L"PowerRename" },
+            { L"modules/ShortcutGuide/ShortcutGuideModuleInterface/ShortcutGuideModuleInterface.dll", L"Shortcut Guide" },
+            { L"modules/ColorPicker/ColorPicker.dll", L"ColorPicker" },
+            { L"modules/Awake/AwakeModuleInterface.dll", L"Awake" },
             // TODO(yuyoyuppe): uncomment when VCM should be enabled
-            //L"modules/VideoConference/VideoConferenceModule.dll"
+            //{ L"modules/VideoConference/VideoConferenceModule.dll", L"Video Conference" }
         };
 
-        for (const auto& moduleSubdir : knownModules)
-        {
-            try
-            {
-                auto pt_module = load_powertoy(moduleSubdir);
-                modules().emplace(pt_module->get_key(), std::move(pt_module));
-            }
-            catch (...)
-            {
-                std::wstring errorMessage = POWER_TOYS_MODULE_LOAD_FAIL;
-                errorMessage += moduleSubdir;
-                MessageBoxW(NULL,
-                            errorMessage.c_str(),
-                            L"PowerToys",
-                            MB_OK | MB_ICONERROR);
-            }
-        }
-        // Start initial powertoys
-        start_initial_powertoys();
+        load_and_start_modules(knownModules);
 
         Trace::EventLaunch(get_product_version(), isProcessElevated);
 
@@ -11,7 +11,7 @@ std::map<std::wstring, PowertoyModule>& modules()
     return modules;
 }
 
-PowertoyModule load_powertoy(const std::wstring_view filename)
+std::pair<HMODULE, PowertoyModuleIface*> create_powertoy(const std::wstring_view filename)
 {
     auto handle = winrt::check_pointer(LoadLibraryW(filename.data()));
     auto create = reinterpret_cast<powertoy_create_func>(GetProcAddress(handle, "powertoy_create"));
@@ -26,17 +26,31 @@ PowertoyModule load_powertoy(const std::wstring_view filename)
         FreeLibrary(handle);
         winrt::throw_hresult(winrt::hresult(E_POINTER));
     }
+    return { handle, pt_module };
+}
+
+PowertoyModule load_powertoy(const std::wstring_view filename)
+{
+    auto [handle, pt_module] = create_powertoy(filename);
     return PowertoyModule(pt_module, handle);
 }
 
-json::JsonObject PowertoyModule::json_config() const
+void PowertoyModule::json_config_string(std::wstring& config) const
 {
-    int size = 0;
-    pt_module->get_config(nullptr, &size);
-    std::wstring result;
-    result.resize(size - 1);
-    pt_module->get_config(result.data(), &size);
-    return json::JsonObject::Parse(result);
+    // The capacity left by the previous config is usually large enough for the current one
+    config.resize(std::max<size_t>(config.capacity(), 1024));
+    int size = static_cast<int>(config.size());
+    if (!pt_module->get_config(config.data(), &size))
+    {
+        config.resize(size);
+        if (!pt_module->get_config(config.data(), &size))
+        {
+            config.clear();
+            return;
+        }
+    }
+
+    config.resize(wcslen(config.c_str()));
 }
 
 PowertoyModule::PowertoyModule(PowertoyModuleIface* pt_module, HMODULE handle) :
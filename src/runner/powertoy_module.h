@@ -38,7 +38,8 @@ public:
         return pt_module.get();
     }
 
-    json::JsonObject json_config() const;
+    // Function to get the serialized config into a buffer which is reused between calls, so that get_config is usually called only once
+    void json_config_string(std::wstring& config) const;
 
     void update_hotkeys();
 
@@ -49,5 +50,8 @@ private:
     std::unique_ptr<PowertoyModuleIface, PowertoyModuleDeleter> pt_module;
 };
 
+// Function to load the DLL and create the module without registering its hotkeys, so that it can run on a worker thread
+std::pair<HMODULE, PowertoyModuleIface*> create_powertoy(const std::wstring_view filename);
+
 PowertoyModule load_powertoy(const std::wstring_view filename);
 std::map<std::wstring, PowertoyModule>& modules();
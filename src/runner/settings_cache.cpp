@@ -0,0 +1,93 @@
+#include "pch.h"
+#include "settings_cache.h"
+
+#include "general_settings.h"
+#include "powertoy_module.h"
+
+#include <common/logger/logger.h>
+
+void SettingsCache::invalidate_module(const std::wstring& name)
+{
+    auto it = module_entries.find(name);
+    if (it != module_entries.end())
+    {
+        it->second.dirty = true;
+    }
+}
+
+void SettingsCache::invalidate_general()
+{
+    general.dirty = true;
+}
+
+void SettingsCache::invalidate_all()
+{
+    general.dirty = true;
+    for (auto& [name, entry] : module_entries)
+    {
+        entry.dirty = true;
+    }
+}
+
+// Function to replace the config of the entry if the serialized config changed. Returns false if it isn't valid JSON, in which case the previous config is kept
+bool SettingsCache::update_entry(Entry& entry, std::wstring& serialized)
+{
+    entry.dirty = false;
+    if (entry.json && serialized == entry.serialized)
+    {
+        return true;
+    }
+
+    json::JsonObject json;
+    if (!json::JsonObject::TryParse(serialized, json))
+    {
+        return false;
+    }
+
+    entry.serialized.swap(serialized);
+    entry.json = json;
+    return true;
+}
+
+void SettingsCache::update()
+{
+    if (general.dirty)
+    {
+        buffer = get_general_settings().to_json().Stringify().c_str();
+        update_entry(general, buffer);
+    }
+
+    for (const auto& [name, powertoy] : modules())
+    {
+        auto& entry = module_entries[name];
+        if (!entry.dirty)
+        {
+            continue;
+        }
+
+        powertoy.json_config_string(buffer);
+        if (!update_entry(entry, buffer))
+        {
+            Logger::error(L"SettingsCache::update(): got malformed json for {} module", name);
+        }
+    }
+}
+
+json::JsonObject SettingsCache::get_all_settings()
+{
+    update();
+
+    json::JsonObject result;
+    json::JsonObject powertoys;
+    result.SetNamedValue(L"general", general.json);
+    for (const auto& [name, entry] : module_entries)
+    {
+        if (entry.json)
+        {
+            powertoys.SetNamedValue(name, entry.json);
+        }
+    }
+
+    result.SetNamedValue(L"powertoys", powertoys);
+    return result;
+}
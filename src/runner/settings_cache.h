@@ -0,0 +1,41 @@
+#pragma once
+
+#include <common/utils/json.h>
+
+#include <map>
+#include <string>
+
+// Keeps the general settings and the parsed config of each module, so that only the configs which were invalidated are requested from the modules again,
+// and a config is only parsed again when its serialized string changed
+class SettingsCache
+{
+public:
+    // Function to mark the config of a module as possibly changed, so that it's requested again from the module on the next update
+    void invalidate_module(const std::wstring& name);
+
+    // Function to mark the general settings as possibly changed
+    void invalidate_general();
+
+    // Function to mark the general settings and all the module configs as possibly changed
+    void invalidate_all();
+
+    // Function to get all the settings in the format of the settings window
+    json::JsonObject get_all_settings();
+
+private:
+    struct Entry
+    {
+        std::wstring serialized;
+        json::JsonObject json{ nullptr };
+        bool dirty = true;
+    };
+
+    void update();
+    static bool update_entry(Entry& entry, std::wstring& serialized);
+
+    Entry general;
+    std::map<std::wstring, Entry> module_entries;
+
+    // Reused for the serialized configs, to avoid an allocation for each of them
+    std::wstring buffer;
+};
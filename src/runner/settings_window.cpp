@@ -11,6 +11,8 @@
 #include "restart_elevated.h"
 #include "UpdateUtils.h"
 #include "centralized_kb_hook.h"
+#include "settings_cache.h"
+#include "startup_scheduler.h"
 
 #include <common/utils/json.h>
 #include <common/SettingsAPI/settings_helpers.cpp>
@@ -19,6 +21,7 @@
 #include <common/logger/logger.h>
 #include <common/utils/elevation.h>
 #include <common/utils/process_path.h>
+#include <common/utils/profiler.h>
 #include <common/utils/timeutil.h>
 #include <common/utils/winapi_error.h>
 #include <common/updating/updateState.h>
@@ -29,31 +32,8 @@
 TwoWayPipeMessageIPC* current_settings_ipc = NULL;
 std::atomic_bool g_isLaunchInProgress = false;
 
-json::JsonObject get_power_toys_settings()
-{
-    json::JsonObject result;
-    for (const auto& [name, powertoy] : modules())
-    {
-        try
-        {
-            result.SetNamedValue(name, powertoy.json_config());
-        }
-        catch (...)
-        {
-            Logger::error(L"get_power_toys_settings(): got malformed json for {} module", name);
-        }
-    }
-    return result;
-}
-
-json::JsonObject get_all_settings()
-{
-    json::JsonObject result;
-
-    result.SetNamedValue(L"general", get_general_settings().to_json());
-    result.SetNamedValue(L"powertoys", get_power_toys_settings());
-    return result;
-}
+// Only used on the main thread, where the messages of the settings window are dispatched
+SettingsCache settings_cache;
 
 std::optional<std::wstring> dispatch_json_action_to_module(const json::JsonObject& powertoys_configs)
 {
@@ -86,6 +66,18 @@ std::optional<std::wstring> dispatch_json_action_to_module(const json::JsonObjec
                 {
                     CheckForUpdatesCallback();
                 }
+                else if (action == L"export_profiler_trace")
+                {
+                    // The runner and the module processes write their traces to the traces folder
+                    if (Profiler::request_export())
+                    {
+                        Logger::info(L"Profiler traces requested in {}", Profiler::traces_folder().wstring());
+                    }
+                    else
+                    {
+                        Logger::error(L"Failed to request the profiler traces. {}", get_last_error_or_default(GetLastError()));
+                    }
+                }
                 else if (action == L"request_update_state_date")
                 {
                     json::JsonObject json;
@@ -108,6 +100,7 @@ std::optional<std::wstring> dispatch_json_action_to_module(const json::JsonObjec
         {
             const auto element = powertoy_element.Value().Stringify();
             modules().at(name)->call_custom_action(element.c_str());
+            settings_cache.invalidate_module(name);
         }
     }
 
@@ -116,6 +109,7 @@ std::optional<std::wstring> dispatch_json_action_to_module(const json::JsonObjec
 
 void send_json_config_to_module(const std::wstring& module_key, const std::wstring& settings)
 {
+    POWERTOYS_PROFILE_SCOPE("Runner.SendJsonConfigToModule");
     auto moduleIt = modules().find(module_key);
     if (moduleIt != modules().end())
     {
@@ -131,11 +125,21 @@ void dispatch_json_config_to_modules(const json::JsonObject& powertoys_configs)
     {
         const auto element = powertoy_element.Value().Stringify();
         send_json_config_to_module(powertoy_element.Key().c_str(), element.c_str());
+        settings_cache.invalidate_module(powertoy_element.Key().c_str());
     }
 };
 
+// Function to send all the settings to the settings window. Only the configs which were invalidated are requested from the modules
+void send_all_settings()
+{
+    POWERTOYS_PROFILE_SCOPE("Runner.SendAllSettings");
+    const std::wstring settings_string{ settings_cache.get_all_settings().Stringify().c_str() };
+    current_settings_ipc->send(settings_string);
+}
+
 void dispatch_received_json(const std::wstring& json_to_parse)
 {
+    POWERTOYS_PROFILE_SCOPE("Runner.DispatchReceivedJson");
     json::JsonObject j;
     const bool ok = json::JsonObject::TryParse(json_to_parse, j);
     if (!ok)
@@ -144,6 +148,9 @@ void dispatch_received_json(const std::wstring& json_to_parse)
         return;
     }
 
+    // The settings window can change and show the settings of any module, including the ones which weren't loaded at startup because they were disabled
+    load_deferred_modules();
+
     for (const auto& base_element : j)
     {
         if (!current_settings_ipc)
@@ -156,20 +163,23 @@ void dispatch_received_json(const std::wstring& json_to_parse)
 
         if (name == L"general")
         {
-            apply_general_settings(value.GetObjectW());
-            const std::wstring settings_string{ get_all_settings().Stringify().c_str() };
-            current_settings_ipc->send(settings_string);
+            // Enabling or disabling a module may change its config too, the configs of the other modules are kept
+            for (const auto& module_name : apply_general_settings(value.GetObjectW()))
+            {
+                settings_cache.invalidate_module(module_name);
+            }
+            settings_cache.invalidate_general();
+            send_all_settings();
         }
         else if (name == L"powertoys")
         {
             dispatch_json_config_to_modules(value.GetObjectW());
-            const std::wstring settings_string{ get_all_settings().Stringify().c_str() };
-            current_settings_ipc->send(settings_string);
+            send_all_settings();
         }
         else if (name == L"refresh")
         {
-            const std::wstring settings_string{ get_all_settings().Stringify().c_str() };
-            current_settings_ipc->send(settings_string);
+            settings_cache.invalidate_all();
+            send_all_settings();
         }
         else if (name == L"action")
         {
@@ -192,6 +202,9 @@ void dispatch_received_json_callback(PVOID data)
 
 void receive_json_send_to_main_thread(const std::wstring& msg)
 {
+    // Called on the thread of the pipe, which only allocates its span buffer for the first message
+    Profiler::RegisterCurrentThread();
+    POWERTOYS_PROFILE_SCOPE("Runner.ReceiveJson");
     std::wstring* copy = new std::wstring(msg);
     dispatch_run_on_main_ui_thread(dispatch_received_json_callback, copy);
 }
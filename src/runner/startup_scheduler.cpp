@@ -0,0 +1,200 @@
+#include "pch.h"
+#include "startup_scheduler.h"
+
+#include "general_settings.h"
+#include "powertoy_module.h"
+
+#include <common/logger/logger.h>
+
+#include <future>
+
+namespace
+{
+    const wchar_t POWER_TOYS_MODULE_LOAD_FAIL[] = L"Failed to load "; // Module name will be appended on this message and it is not localized.
+
+    using startup_clock = std::chrono::steady_clock;
+
+    // Modules which were disabled at startup and haven't been loaded since. Only used on the main thread
+    std::vector<KnownModule> deferred_modules;
+
+    struct CreatedModule
+    {
+        HMODULE handle = nullptr;
+        PowertoyModuleIface* pt_module = nullptr;
+
+        // When the creation started, relative to the start of the scheduling
+        double start_ms = 0;
+        double create_ms = 0;
+        double enable_ms = 0;
+    };
+
+    double elapsed_ms(startup_clock::time_point from, startup_clock::time_point to)
+    {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+
+    CreatedModule create_module(std::wstring_view path, startup_clock::time_point startup_start)
+    {
+        CreatedModule result;
+        const auto start = startup_clock::now();
+        try
+        {
+            std::tie(result.handle, result.pt_module) = create_powertoy(path);
+        }
+        catch (...)
+        {
+        }
+
+        result.start_ms = elapsed_ms(startup_start, start);
+        result.create_ms = elapsed_ms(start, startup_clock::now());
+        return result;
+    }
+
+    void show_load_error(std::wstring_view path)
+    {
+        std::wstring errorMessage = POWER_TOYS_MODULE_LOAD_FAIL;
+        errorMessage += path;
+        MessageBoxW(NULL,
+                    errorMessage.c_str(),
+                    L"PowerToys",
+                    MB_OK | MB_ICONERROR);
+    }
+
+    // Function to add the created module to modules(). Returns the key of the module, or an empty string if it failed to load
+    std::wstring add_module(const KnownModule& known_module, const CreatedModule& created)
+    {
+        if (!created.pt_module)
+        {
+            show_load_error(known_module.path);
+            return {};
+        }
+
+        std::wstring key = created.pt_module->get_key();
+        if (key != known_module.key)
+        {
+            Logger::warn(L"Module {} has the key {} instead of {}", known_module.path, key, known_module.key);
+        }
+
+        modules().emplace(key, PowertoyModule(created.pt_module, created.handle));
+        return key;
+    }
+}
+
+void load_and_start_modules(const std::vector<KnownModule>& known_modules)
+{
+    const auto startup_start = startup_clock::now();
+    const auto powertoys_to_disable = get_disabled_powertoys();
+
+    struct ScheduledModule
+    {
+        const KnownModule& known_module;
+        bool deferred = false;
+        std::future<CreatedModule> parallel_create;
+        CreatedModule created;
+    };
+
+    // The modules which can be created in parallel start first, so that they're created while the others are created on this thread
+    std::vector<ScheduledModule> scheduled_modules;
+    scheduled_modules.reserve(known_modules.size());
+    for (const auto& known_module : known_modules)
+    {
+        auto& scheduled = scheduled_modules.emplace_back(ScheduledModule{ known_module });
+        if (powertoys_to_disable.contains(std::wstring{ known_module.key }) && !known_module.create_when_disabled)
+        {
+            scheduled.deferred = true;
+            deferred_modules.push_back(known_module);
+        }
+        else if (known_module.parallel_create)
+        {
+            scheduled.parallel_create = std::async(std::launch::async, create_module, known_module.path, startup_start);
+        }
+    }
+
+    for (auto& scheduled : scheduled_modules)
+    {
+        if (!scheduled.deferred && !scheduled.known_module.parallel_create)
+        {
+            scheduled.created = create_module(scheduled.known_module.path, startup_start);
+        }
+    }
+
+    // Hotkeys are registered and the modules are enabled on this thread in the order of the list, while the next modules may still be created
+    for (auto& scheduled : scheduled_modules)
+    {
+        if (scheduled.deferred)
+        {
+            continue;
+        }
+
+        if (scheduled.parallel_create.valid())
+        {
+            scheduled.created = scheduled.parallel_create.get();
+        }
+
+        const auto key = add_module(scheduled.known_module, scheduled.created);
+        if (key.empty() || powertoys_to_disable.contains(key))
+        {
+            continue;
+        }
+
+        const auto start = startup_clock::now();
+        modules().at(key)->enable();
+        scheduled.created.enable_ms = elapsed_ms(start, startup_clock::now());
+    }
+
+    for (const auto& scheduled : scheduled_modules)
+    {
+        if (scheduled.deferred)
+        {
+            Logger::info(L"Startup timeline: {} is disabled, loading it is deferred", scheduled.known_module.key);
+            continue;
+        }
+
+        Logger::info(L"Startup timeline: {} created {} at +{:.1f} ms in {:.1f} ms, enabled in {:.1f} ms",
+                     scheduled.known_module.key,
+                     scheduled.known_module.parallel_create ? L"on a worker thread" : L"on the main thread",
+                     scheduled.created.start_ms,
+                     scheduled.created.create_ms,
+                     scheduled.created.enable_ms);
+    }
+
+    Logger::info(L"Startup timeline: modules loaded and enabled in {:.1f} ms", elapsed_ms(startup_start, startup_clock::now()));
+}
+
+bool load_deferred_module(const std::wstring& key)
+{
+    auto it = std::find_if(deferred_modules.begin(), deferred_modules.end(), [&key](const KnownModule& known_module) {
+        return known_module.key == key;
+    });
+
+    if (it == deferred_modules.end())
+    {
+        return false;
+    }
+
+    const auto known_module = *it;
+    deferred_modules.erase(it);
+
+    const auto created = create_module(known_module.path, startup_clock::now());
+    Logger::info(L"Deferred module {} created in {:.1f} ms", known_module.key, created.create_ms);
+    return !add_module(known_module, created).empty();
+}
+
+void load_deferred_modules()
+{
+    while (!deferred_modules.empty())
+    {
+        load_deferred_module(std::wstring{ deferred_modules.front().key });
+    }
+}
+
+std::vector<std::wstring> deferred_module_keys()
+{
+    std::vector<std::wstring> keys;
+    for (const auto& known_module : deferred_modules)
+    {
+        keys.emplace_back(known_module.key);
+    }
+
+    return keys;
+}
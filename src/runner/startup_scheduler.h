@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A module DLL loaded by the runner
+struct KnownModule
+{
+    std::wstring_view path;
+
+    // The non localized key returned by get_key, so that a module can be known as disabled without loading it
+    std::wstring_view key;
+
+    // Whether powertoy_create only reads the settings of the module, so that it can run on a worker thread while the other modules are created
+    bool parallel_create = true;
+
+    // Whether the module has to be created even when it's disabled, because its constructor applies its settings
+    bool create_when_disabled = false;
+};
+
+// Function to load the modules and enable the ones which aren't disabled in the general settings. The modules which can be created in parallel are created
+// on worker threads, and the modules are enabled on this thread afterwards. Disabled modules aren't loaded until they're enabled or their settings are accessed.
+// The time taken by each module is written to the log
+void load_and_start_modules(const std::vector<KnownModule>& known_modules);
+
+// Function to load a module which was deferred at startup. Returns false if the module isn't deferred or failed to load
+bool load_deferred_module(const std::wstring& key);
+
+// Function to load all the deferred modules, when the settings window needs the config of every module
+void load_deferred_modules();
+
+// Function to get the keys of the modules which aren't loaded yet. These modules are disabled
+std::vector<std::wstring> deferred_module_keys();